@@ -1131,6 +1131,353 @@ gst_rtp_buffer_set_timestamp (GstRTPBuffer * rtp, guint32 timestamp)
 }
 
 
+/**
+ * gst_rtp_header_view_init:
+ * @view: (out caller-allocates): a #GstRTPHeaderView
+ * @buffer: a #GstBuffer
+ *
+ * Copy the fixed RTP header of @buffer into @view. Unlike
+ * gst_rtp_buffer_map() this does not map the payload, extension or padding
+ * of multi-memory buffers, only the first four bytes of the extension and
+ * the last byte of the packet are read. The version, payload type, CSRC
+ * count, extension length and padding count are validated the same way
+ * gst_rtp_buffer_map() does.
+ *
+ * Returns: %TRUE if @buffer starts with a valid RTP header.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_rtp_header_view_init (GstRTPHeaderView * view, GstBuffer * buffer)
+{
+  guint8 *data;
+  gsize bufsize, header_len;
+  guint8 padding = 0;
+
+  g_return_val_if_fail (view != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (buffer), FALSE);
+
+  data = view->data;
+  view->buffer = NULL;
+  view->modified = FALSE;
+
+  if (G_UNLIKELY (gst_buffer_extract (buffer, 0, data,
+              GST_RTP_HEADER_LEN) < GST_RTP_HEADER_LEN))
+    goto wrong_length;
+
+  if (G_UNLIKELY ((data[0] & 0xc0) != (GST_RTP_VERSION << 6)))
+    goto wrong_version;
+
+  /* same relaxed RTCP check as in gst_rtp_buffer_map() */
+  if (G_UNLIKELY (data[1] >= 200 && data[1] <= 204))
+    goto reserved_pt;
+
+  bufsize = gst_buffer_get_size (buffer);
+  header_len = GST_RTP_HEADER_LEN + GST_RTP_HEADER_CSRC_SIZE (data);
+  if (G_UNLIKELY (bufsize < header_len))
+    goto wrong_length;
+
+  if (GST_RTP_HEADER_EXTENSION (data)) {
+    guint8 ext[4];
+
+    if (G_UNLIKELY (gst_buffer_extract (buffer, header_len, ext, 4) < 4))
+      goto wrong_length;
+    header_len += 4 + GST_READ_UINT16_BE (ext + 2) * sizeof (guint32);
+    if (G_UNLIKELY (bufsize < header_len))
+      goto wrong_length;
+  }
+
+  if (GST_RTP_HEADER_PADDING (data))
+    gst_buffer_extract (buffer, bufsize - 1, &padding, 1);
+
+  /* check if padding and header not bigger than packet length */
+  if (G_UNLIKELY (bufsize < padding + header_len))
+    goto wrong_padding;
+
+  view->buffer = buffer;
+
+  return TRUE;
+
+  /* ERRORS */
+wrong_length:
+  {
+    GST_DEBUG ("length check failed");
+    return FALSE;
+  }
+wrong_version:
+  {
+    GST_DEBUG ("version check failed (%d != %d)", data[0] >> 6,
+        GST_RTP_VERSION);
+    return FALSE;
+  }
+reserved_pt:
+  {
+    GST_DEBUG ("reserved PT %d found", data[1]);
+    return FALSE;
+  }
+wrong_padding:
+  {
+    GST_DEBUG ("padding check failed (%" G_GSIZE_FORMAT " - %" G_GSIZE_FORMAT
+        " < %d)", bufsize, header_len, padding);
+    return FALSE;
+  }
+}
+
+/**
+ * gst_rtp_header_view_commit:
+ * @view: a #GstRTPHeaderView
+ *
+ * Write the changes made to @view back into the header of its buffer, which
+ * must be writable. Nothing is written when @view was not modified.
+ *
+ * Returns: %TRUE on success.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_rtp_header_view_commit (GstRTPHeaderView * view)
+{
+  g_return_val_if_fail (view != NULL, FALSE);
+  g_return_val_if_fail (GST_IS_BUFFER (view->buffer), FALSE);
+
+  if (!view->modified)
+    return TRUE;
+
+  g_return_val_if_fail (gst_buffer_is_writable (view->buffer), FALSE);
+
+  if (gst_buffer_fill (view->buffer, 0, view->data,
+          GST_RTP_HEADER_LEN) != GST_RTP_HEADER_LEN)
+    return FALSE;
+
+  view->modified = FALSE;
+
+  return TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_ssrc:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the SSRC of the RTP header in @view.
+ *
+ * Returns: the SSRC in host order.
+ *
+ * Since: 1.22
+ */
+guint32
+gst_rtp_header_view_get_ssrc (const GstRTPHeaderView * view)
+{
+  return g_ntohl (GST_RTP_HEADER_SSRC (view->data));
+}
+
+/**
+ * gst_rtp_header_view_set_ssrc:
+ * @view: a #GstRTPHeaderView
+ * @ssrc: the new SSRC
+ *
+ * Set the SSRC of the RTP header in @view to @ssrc.
+ *
+ * Since: 1.22
+ */
+void
+gst_rtp_header_view_set_ssrc (GstRTPHeaderView * view, guint32 ssrc)
+{
+  GST_RTP_HEADER_SSRC (view->data) = g_htonl (ssrc);
+  view->modified = TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_seq:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the sequence number of the RTP header in @view.
+ *
+ * Returns: the sequence number in host order.
+ *
+ * Since: 1.22
+ */
+guint16
+gst_rtp_header_view_get_seq (const GstRTPHeaderView * view)
+{
+  return g_ntohs (GST_RTP_HEADER_SEQ (view->data));
+}
+
+/**
+ * gst_rtp_header_view_set_seq:
+ * @view: a #GstRTPHeaderView
+ * @seq: the new sequence number
+ *
+ * Set the sequence number of the RTP header in @view to @seq.
+ *
+ * Since: 1.22
+ */
+void
+gst_rtp_header_view_set_seq (GstRTPHeaderView * view, guint16 seq)
+{
+  GST_RTP_HEADER_SEQ (view->data) = g_htons (seq);
+  view->modified = TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_timestamp:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the timestamp of the RTP header in @view.
+ *
+ * Returns: the timestamp in host order.
+ *
+ * Since: 1.22
+ */
+guint32
+gst_rtp_header_view_get_timestamp (const GstRTPHeaderView * view)
+{
+  return g_ntohl (GST_RTP_HEADER_TIMESTAMP (view->data));
+}
+
+/**
+ * gst_rtp_header_view_set_timestamp:
+ * @view: a #GstRTPHeaderView
+ * @timestamp: the new timestamp
+ *
+ * Set the timestamp of the RTP header in @view to @timestamp.
+ *
+ * Since: 1.22
+ */
+void
+gst_rtp_header_view_set_timestamp (GstRTPHeaderView * view, guint32 timestamp)
+{
+  GST_RTP_HEADER_TIMESTAMP (view->data) = g_htonl (timestamp);
+  view->modified = TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_payload_type:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the payload type of the RTP header in @view.
+ *
+ * Returns: the payload type.
+ *
+ * Since: 1.22
+ */
+guint8
+gst_rtp_header_view_get_payload_type (const GstRTPHeaderView * view)
+{
+  return GST_RTP_HEADER_PAYLOAD_TYPE (view->data);
+}
+
+/**
+ * gst_rtp_header_view_set_payload_type:
+ * @view: a #GstRTPHeaderView
+ * @payload_type: the new payload type
+ *
+ * Set the payload type of the RTP header in @view to @payload_type.
+ *
+ * Since: 1.22
+ */
+void
+gst_rtp_header_view_set_payload_type (GstRTPHeaderView * view,
+    guint8 payload_type)
+{
+  g_return_if_fail (payload_type < 0x80);
+
+  GST_RTP_HEADER_PAYLOAD_TYPE (view->data) = payload_type;
+  view->modified = TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_marker:
+ * @view: a #GstRTPHeaderView
+ *
+ * Check if the marker bit is set in the RTP header in @view.
+ *
+ * Returns: %TRUE if the marker bit is set.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_rtp_header_view_get_marker (const GstRTPHeaderView * view)
+{
+  return GST_RTP_HEADER_MARKER (view->data);
+}
+
+/**
+ * gst_rtp_header_view_set_marker:
+ * @view: a #GstRTPHeaderView
+ * @marker: the new marker
+ *
+ * Set the marker bit in the RTP header in @view to @marker.
+ *
+ * Since: 1.22
+ */
+void
+gst_rtp_header_view_set_marker (GstRTPHeaderView * view, gboolean marker)
+{
+  GST_RTP_HEADER_MARKER (view->data) = marker;
+  view->modified = TRUE;
+}
+
+/**
+ * gst_rtp_header_view_get_csrc_count:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the CSRC count of the RTP header in @view.
+ *
+ * Returns: the CSRC count.
+ *
+ * Since: 1.22
+ */
+guint8
+gst_rtp_header_view_get_csrc_count (const GstRTPHeaderView * view)
+{
+  return GST_RTP_HEADER_CSRC_COUNT (view->data);
+}
+
+/**
+ * gst_rtp_header_view_get_payload_len:
+ * @view: a #GstRTPHeaderView
+ *
+ * Get the length of the payload of the buffer of @view. This peeks at the
+ * extension length and the padding count, but does not map the packet.
+ *
+ * Returns: The length of the payload, or 0 if the packet is too short for
+ * its header, extension and padding.
+ *
+ * Since: 1.22
+ */
+guint
+gst_rtp_header_view_get_payload_len (const GstRTPHeaderView * view)
+{
+  const guint8 *data = view->data;
+  gsize bufsize, header_len;
+  guint8 padding = 0;
+
+  g_return_val_if_fail (GST_IS_BUFFER (view->buffer), 0);
+
+  bufsize = gst_buffer_get_size (view->buffer);
+  header_len = GST_RTP_HEADER_LEN + GST_RTP_HEADER_CSRC_SIZE (data);
+
+  if (GST_RTP_HEADER_EXTENSION (data)) {
+    guint8 ext[4];
+
+    if (gst_buffer_extract (view->buffer, header_len, ext, 4) < 4)
+      return 0;
+    header_len += 4 + GST_READ_UINT16_BE (ext + 2) * sizeof (guint32);
+  }
+
+  if (GST_RTP_HEADER_PADDING (data)) {
+    if (bufsize < 1 || gst_buffer_extract (view->buffer, bufsize - 1,
+            &padding, 1) < 1)
+      return 0;
+  }
+
+  if (bufsize < header_len + padding)
+    return 0;
+
+  return bufsize - header_len - padding;
+}
+
+
 /**
  * gst_rtp_buffer_get_payload_subbuffer:
  * @rtp: the RTP packet
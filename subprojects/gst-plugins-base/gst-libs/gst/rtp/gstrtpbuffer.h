@@ -192,6 +192,77 @@ gpointer        gst_rtp_buffer_get_payload           (GstRTPBuffer *rtp);
 GST_RTP_API
 GBytes*         gst_rtp_buffer_get_payload_bytes     (GstRTPBuffer *rtp);
 
+/**
+ * GstRTPHeaderView:
+ * @buffer: the #GstBuffer the header was read from
+ * @data: a copy of the fixed RTP header of @buffer
+ *
+ * A copy of the fixed RTP header of a buffer. It gives access to the SSRC,
+ * sequence number, timestamp, payload type and marker bit without mapping
+ * the CSRC list, header extensions and padding like gst_rtp_buffer_map()
+ * does. Changes are only written back to @buffer with
+ * gst_rtp_header_view_commit().
+ *
+ * The size of the structure is made public to allow stack allocations.
+ *
+ * Since: 1.22
+ */
+typedef struct _GstRTPHeaderView GstRTPHeaderView;
+
+struct _GstRTPHeaderView
+{
+  GstBuffer   *buffer;
+  guint8       data[12];
+
+  /*< private >*/
+  gboolean     modified;
+  gpointer     _gst_reserved[GST_PADDING];
+};
+
+#define GST_RTP_HEADER_VIEW_INIT { NULL, { 0, }, FALSE, { NULL, } }
+
+GST_RTP_API
+gboolean        gst_rtp_header_view_init             (GstRTPHeaderView *view, GstBuffer *buffer);
+
+GST_RTP_API
+gboolean        gst_rtp_header_view_commit           (GstRTPHeaderView *view);
+
+GST_RTP_API
+guint32         gst_rtp_header_view_get_ssrc         (const GstRTPHeaderView *view);
+
+GST_RTP_API
+void            gst_rtp_header_view_set_ssrc         (GstRTPHeaderView *view, guint32 ssrc);
+
+GST_RTP_API
+guint16         gst_rtp_header_view_get_seq          (const GstRTPHeaderView *view);
+
+GST_RTP_API
+void            gst_rtp_header_view_set_seq          (GstRTPHeaderView *view, guint16 seq);
+
+GST_RTP_API
+guint32         gst_rtp_header_view_get_timestamp    (const GstRTPHeaderView *view);
+
+GST_RTP_API
+void            gst_rtp_header_view_set_timestamp    (GstRTPHeaderView *view, guint32 timestamp);
+
+GST_RTP_API
+guint8          gst_rtp_header_view_get_payload_type (const GstRTPHeaderView *view);
+
+GST_RTP_API
+void            gst_rtp_header_view_set_payload_type (GstRTPHeaderView *view, guint8 payload_type);
+
+GST_RTP_API
+gboolean        gst_rtp_header_view_get_marker       (const GstRTPHeaderView *view);
+
+GST_RTP_API
+void            gst_rtp_header_view_set_marker       (GstRTPHeaderView *view, gboolean marker);
+
+GST_RTP_API
+guint8          gst_rtp_header_view_get_csrc_count   (const GstRTPHeaderView *view);
+
+GST_RTP_API
+guint           gst_rtp_header_view_get_payload_len  (const GstRTPHeaderView *view);
+
 /* some helpers */
 
 GST_RTP_API
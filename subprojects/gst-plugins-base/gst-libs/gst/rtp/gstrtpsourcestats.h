@@ -0,0 +1,187 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstrtpsourcestats.h: binary statistics of RTP sources
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_SOURCE_STATS_H__
+#define __GST_RTP_SOURCE_STATS_H__
+
+#include <gst/gst.h>
+#include <gst/rtp/rtp-prelude.h>
+
+G_BEGIN_DECLS
+
+/**
+ * SECTION:gstrtpsourcestats
+ * @title: GstRTPSourceStatsSnapshot
+ * @short_description: binary statistics of RTP sources
+ *
+ * The "get-stats-snapshot" action signal of the rtpsession element fills a
+ * #GArray of #GstRTPSourceStatsSnapshot with the statistics of all sources
+ * of the session. Unlike the "source-stats" of its "stats" property, the
+ * snapshots are filled without allocating when the array is reused, so that
+ * the statistics of many sources can be polled often.
+ *
+ * Since: 1.22
+ */
+
+/**
+ * GstRTPSourceStatsSnapshot:
+ * @size: the number of bytes of the structure that were filled in, fields
+ *   that start at or after @size were not filled in
+ * @ssrc: the SSRC of the source
+ * @internal: if the source is a local source
+ * @validated: if the source is validated
+ * @received_bye: if the source received a BYE
+ * @is_csrc: if the source is a CSRC
+ * @is_sender: if the source is a sender
+ * @first_rtp_activity: the running time of the first RTP packet
+ * @last_rtp_activity: the running time of the last RTP packet
+ * @avg_frame_transmission_duration: the average transmission duration of a
+ *   frame
+ * @max_frame_transmission_duration: the maximum transmission duration of a
+ *   frame
+ * @clock_rate: the clock rate of the media, senders only
+ * @bitrate: the bitrate of the stream, senders only
+ * @seqnum_base: the first seqnum, local senders only
+ * @octets_sent: the number of payload bytes sent, local senders only
+ * @packets_sent: the number of packets sent, local senders only
+ * @recv_pli_count: the number of PLI received, local senders only
+ * @recv_fir_count: the number of FIR received, local senders only
+ * @recv_nack_count: the number of NACK received, local senders only
+ * @octets_received: the number of payload bytes received, remote senders
+ *   only
+ * @packets_received: the number of packets received, remote senders only
+ * @bytes_received: the number of bytes received including lower level
+ *   headers, remote senders only
+ * @packets_lost: the number of packets lost, remote senders only
+ * @jitter: the interarrival jitter in clock rate units, remote senders only
+ * @sent_pli_count: the number of PLI sent, remote senders only
+ * @sent_fir_count: the number of FIR sent, remote senders only
+ * @sent_nack_count: the number of NACK sent, remote senders only
+ * @recv_packet_rate: the packet rate in packets per second, remote senders
+ *   only
+ * @have_sr: if a sender report was received
+ * @sr_ntptime: the NTP time of the last sender report
+ * @sr_rtptime: the RTP time of the last sender report
+ * @sr_octet_count: the octet count of the last sender report
+ * @sr_packet_count: the packet count of the last sender report
+ * @sent_rb: if a report block was sent about the source, remote sources
+ *   only
+ * @sent_rb_fractionlost: the fraction lost of the last sent report block
+ * @sent_rb_packetslost: the packets lost of the last sent report block
+ * @sent_rb_exthighestseq: the extended highest seqnum of the last sent
+ *   report block
+ * @sent_rb_jitter: the jitter of the last sent report block
+ * @sent_rb_lsr: the last SR time of the last sent report block
+ * @sent_rb_dlsr: the delay since the last SR of the last sent report block
+ * @have_rb: if a report block was received about the source, local sources
+ *   only
+ * @rb_ssrc: the SSRC of the sender of the last received report block
+ * @rb_fractionlost: the fraction lost of the last received report block
+ * @rb_packetslost: the packets lost of the last received report block
+ * @rb_exthighestseq: the extended highest seqnum of the last received
+ *   report block
+ * @rb_jitter: the jitter of the last received report block
+ * @rb_lsr: the last SR time of the last received report block
+ * @rb_dlsr: the delay since the last SR of the last received report block
+ * @rb_round_trip: the round trip time of the last received report block in
+ *   NTP short format
+ *
+ * The statistics of an RTP source at one point in time, with the same
+ * fields and meaning as the "application/x-rtp-source-stats" structure of
+ * the rtpsession element minus the rtp-from and rtcp-from addresses. Fields
+ * that do not apply to the source, for example the sender fields of a source
+ * that is not sending, are 0.
+ *
+ * New fields are only ever appended. Arrays with a smaller element size than
+ * the size of this structure, from applications built against an older
+ * version, only get the fields that fit, and @size tells which fields were
+ * filled in.
+ *
+ * Since: 1.22
+ */
+typedef struct {
+  guint32      size;
+
+  guint32      ssrc;
+  gboolean     internal;
+  gboolean     validated;
+  gboolean     received_bye;
+  gboolean     is_csrc;
+  gboolean     is_sender;
+  GstClockTime first_rtp_activity;
+  GstClockTime last_rtp_activity;
+  GstClockTime avg_frame_transmission_duration;
+  GstClockTime max_frame_transmission_duration;
+
+  /* senders */
+  gint         clock_rate;
+  guint64      bitrate;
+
+  /* internal senders */
+  gint         seqnum_base;
+  guint64      octets_sent;
+  guint64      packets_sent;
+  guint        recv_pli_count;
+  guint        recv_fir_count;
+  guint        recv_nack_count;
+
+  /* remote senders */
+  guint64      octets_received;
+  guint64      packets_received;
+  guint64      bytes_received;
+  gint         packets_lost;
+  guint        jitter;
+  guint        sent_pli_count;
+  guint        sent_fir_count;
+  guint        sent_nack_count;
+  guint        recv_packet_rate;
+
+  /* last SR */
+  gboolean     have_sr;
+  guint64      sr_ntptime;
+  guint32      sr_rtptime;
+  guint32      sr_octet_count;
+  guint32      sr_packet_count;
+
+  /* last RB sent about a remote source */
+  gboolean     sent_rb;
+  guint8       sent_rb_fractionlost;
+  gint32       sent_rb_packetslost;
+  guint32      sent_rb_exthighestseq;
+  guint32      sent_rb_jitter;
+  guint32      sent_rb_lsr;
+  guint32      sent_rb_dlsr;
+
+  /* last RB received about an internal source */
+  gboolean     have_rb;
+  guint32      rb_ssrc;
+  guint8       rb_fractionlost;
+  gint32       rb_packetslost;
+  guint32      rb_exthighestseq;
+  guint32      rb_jitter;
+  guint32      rb_lsr;
+  guint32      rb_dlsr;
+  guint32      rb_round_trip;
+} GstRTPSourceStatsSnapshot;
+
+G_END_DECLS
+
+#endif /* __GST_RTP_SOURCE_STATS_H__ */
@@ -210,6 +210,165 @@ GST_START_TEST (test_rtp_buffer_validate_padding)
 
 GST_END_TEST;
 
+GST_START_TEST (test_rtp_header_view)
+{
+  GstBuffer *buf, *header, *payload;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPHeaderView view = GST_RTP_HEADER_VIEW_INIT;
+  GstMapInfo map;
+  guint8 ext_data[] = { 0x01, 0x02, 0x03, 0x04 };
+
+  buf = gst_rtp_buffer_new_allocate (20, 4, 2);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_ssrc (&rtp, 0xf04043c2);
+  gst_rtp_buffer_set_seq (&rtp, 0xf2c9);
+  gst_rtp_buffer_set_timestamp (&rtp, 432191);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_marker (&rtp, TRUE);
+  fail_unless (gst_rtp_buffer_add_extension_onebyte_header (&rtp, 1,
+          ext_data, sizeof (ext_data)));
+  gst_rtp_buffer_unmap (&rtp);
+
+  /* put the header with the CSRCs and the rest in different memories */
+  fail_unless (gst_buffer_map (buf, &map, GST_MAP_READ));
+  header = gst_buffer_new_memdup (map.data, 20);
+  payload = gst_buffer_new_memdup (map.data + 20, map.size - 20);
+  gst_buffer_unmap (buf, &map);
+  gst_buffer_unref (buf);
+  buf = gst_buffer_append (header, payload);
+  fail_unless (gst_buffer_n_memory (buf) > 1);
+
+  fail_unless (gst_rtp_header_view_init (&view, buf));
+  fail_unless_equals_int (gst_rtp_header_view_get_ssrc (&view),
+      (gint) 0xf04043c2);
+  fail_unless_equals_int (gst_rtp_header_view_get_seq (&view), 0xf2c9);
+  fail_unless_equals_int (gst_rtp_header_view_get_timestamp (&view), 432191);
+  fail_unless_equals_int (gst_rtp_header_view_get_payload_type (&view), 96);
+  fail_unless (gst_rtp_header_view_get_marker (&view));
+  fail_unless_equals_int (gst_rtp_header_view_get_csrc_count (&view), 2);
+
+  /* the payload length must match the one of a full map */
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_header_view_get_payload_len (&view),
+      gst_rtp_buffer_get_payload_len (&rtp));
+  gst_rtp_buffer_unmap (&rtp);
+
+  /* nothing is written before committing */
+  gst_rtp_header_view_set_ssrc (&view, 0x12345678);
+  gst_rtp_header_view_set_seq (&view, 4242);
+  gst_rtp_header_view_set_timestamp (&view, 1234);
+  gst_rtp_header_view_set_payload_type (&view, 100);
+  gst_rtp_header_view_set_marker (&view, FALSE);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), 0xf2c9);
+  gst_rtp_buffer_unmap (&rtp);
+
+  fail_unless (gst_rtp_header_view_commit (&view));
+  fail_unless_equals_int (gst_buffer_n_memory (buf), 2);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), 0x12345678);
+  fail_unless_equals_int (gst_rtp_buffer_get_seq (&rtp), 4242);
+  fail_unless_equals_int (gst_rtp_buffer_get_timestamp (&rtp), 1234);
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), 100);
+  fail_unless (!gst_rtp_buffer_get_marker (&rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_csrc_count (&rtp), 2);
+  gst_rtp_buffer_unmap (&rtp);
+
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtp_header_view_validate)
+{
+  GstBuffer *buf;
+  GstRTPHeaderView view = GST_RTP_HEADER_VIEW_INIT;
+  guint8 short_packet[] = {
+    0x80, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf
+  };
+  guint8 rtcp_packet[] = {
+    0x80, 0xc8, 0x00, 0x06, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce
+  };
+  guint8 wrong_version[] = {
+    0x40, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce
+  };
+  guint8 missing_csrc[] = {
+    0x81, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce
+  };
+  guint8 missing_extension[] = {
+    0x90, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce,
+    0xbe, 0xde
+  };
+  /* extension of 2 words but only 1 present */
+  guint8 short_extension[] = {
+    0x90, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce,
+    0xbe, 0xde, 0x00, 0x02, 0x10, 0xff, 0x00, 0x00
+  };
+  /* padding count larger than the packet */
+  guint8 wrong_padding[] = {
+    0xa0, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce,
+    0x00, 0x00, 0x00, 0x05
+  };
+  /* padding overlapping the extension */
+  guint8 padding_in_extension[] = {
+    0xb0, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce,
+    0xbe, 0xde, 0x00, 0x01, 0x10, 0xff, 0x00, 0x00, 0x00, 0x03
+  };
+  guint8 valid_padding[] = {
+    0xb0, 0x60, 0x6c, 0x49, 0x58, 0xab, 0xaa, 0x65, 0x65, 0x2e, 0xaf, 0xce,
+    0xbe, 0xde, 0x00, 0x01, 0x10, 0xff, 0x00, 0x00, 0xaa, 0x00, 0x02
+  };
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+  buf = gst_buffer_new_memdup (short_packet, sizeof (short_packet));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (rtcp_packet, sizeof (rtcp_packet));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (wrong_version, sizeof (wrong_version));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (missing_csrc, sizeof (missing_csrc));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  /* the extension and padding are rejected like gst_rtp_buffer_map() does */
+  buf = gst_buffer_new_memdup (missing_extension, sizeof (missing_extension));
+  fail_if (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (short_extension, sizeof (short_extension));
+  fail_if (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (wrong_padding, sizeof (wrong_padding));
+  fail_if (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (padding_in_extension,
+      sizeof (padding_in_extension));
+  fail_if (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_if (gst_rtp_header_view_init (&view, buf));
+  gst_buffer_unref (buf);
+
+  buf = gst_buffer_new_memdup (valid_padding, sizeof (valid_padding));
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_len (&rtp), 1);
+  gst_rtp_buffer_unmap (&rtp);
+  fail_unless (gst_rtp_header_view_init (&view, buf));
+  fail_unless_equals_int (gst_rtp_header_view_get_payload_len (&view), 1);
+  gst_buffer_unref (buf);
+}
+
+GST_END_TEST;
+
 #if 0
 GST_START_TEST (test_rtp_buffer_list)
 {
@@ -2566,6 +2725,8 @@ rtp_suite (void)
   tcase_add_test (tc_chain, test_rtp_buffer);
   tcase_add_test (tc_chain, test_rtp_buffer_validate_corrupt);
   tcase_add_test (tc_chain, test_rtp_buffer_validate_padding);
+  tcase_add_test (tc_chain, test_rtp_header_view);
+  tcase_add_test (tc_chain, test_rtp_header_view_validate);
   tcase_add_test (tc_chain, test_rtp_buffer_set_extension_data);
   //tcase_add_test (tc_chain, test_rtp_buffer_list_set_extension);
   tcase_add_test (tc_chain, test_rtp_seqnum_compare);
@@ -0,0 +1,128 @@
+/* GStreamer RTP header parsing benchmark
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares reading the fixed RTP header with gst_rtp_buffer_map() and with
+ * a GstRTPHeaderView, on single-memory and multi-memory packets. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <gst/gst.h>
+#include <gst/rtp/rtp.h>
+
+#define NUM_ITERATIONS 10000000
+#define PAYLOAD_SIZE 1200
+
+static GstBuffer *
+create_packet (gboolean multi_memory)
+{
+  GstBuffer *buf, *payload;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 ext_data[3] = { 0, };
+
+  buf = gst_rtp_buffer_new_allocate (multi_memory ? 0 : PAYLOAD_SIZE, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_ssrc (&rtp, 0x12345678);
+  gst_rtp_buffer_set_seq (&rtp, 4242);
+  gst_rtp_buffer_set_timestamp (&rtp, 90000);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_add_extension_onebyte_header (&rtp, 1, ext_data,
+      sizeof (ext_data));
+  gst_rtp_buffer_unmap (&rtp);
+
+  if (multi_memory) {
+    payload = gst_buffer_new_allocate (NULL, PAYLOAD_SIZE, NULL);
+    buf = gst_buffer_append (buf, payload);
+  }
+
+  return buf;
+}
+
+static guint32
+bench_map (GstBuffer * buf)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint32 acc = 0;
+  gint i;
+
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp);
+    acc += gst_rtp_buffer_get_ssrc (&rtp) + gst_rtp_buffer_get_seq (&rtp) +
+        gst_rtp_buffer_get_timestamp (&rtp) +
+        gst_rtp_buffer_get_payload_type (&rtp) +
+        gst_rtp_buffer_get_marker (&rtp);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+
+  return acc;
+}
+
+static guint32
+bench_header_view (GstBuffer * buf)
+{
+  GstRTPHeaderView view = GST_RTP_HEADER_VIEW_INIT;
+  guint32 acc = 0;
+  gint i;
+
+  for (i = 0; i < NUM_ITERATIONS; i++) {
+    gst_rtp_header_view_init (&view, buf);
+    acc += gst_rtp_header_view_get_ssrc (&view) +
+        gst_rtp_header_view_get_seq (&view) +
+        gst_rtp_header_view_get_timestamp (&view) +
+        gst_rtp_header_view_get_payload_type (&view) +
+        gst_rtp_header_view_get_marker (&view);
+  }
+
+  return acc;
+}
+
+static void
+run (const gchar * name, guint32 (*func) (GstBuffer *), GstBuffer * buf)
+{
+  GstClockTime start, end;
+  guint32 acc;
+
+  start = gst_util_get_timestamp ();
+  acc = func (buf);
+  end = gst_util_get_timestamp ();
+
+  g_print ("%-32s %" GST_TIME_FORMAT " (%.1f ns/packet, %u)\n", name,
+      GST_TIME_ARGS (end - start), (gdouble) (end - start) / NUM_ITERATIONS,
+      acc);
+}
+
+int
+main (int argc, char **argv)
+{
+  GstBuffer *single, *multi;
+
+  gst_init (&argc, &argv);
+
+  single = create_packet (FALSE);
+  multi = create_packet (TRUE);
+
+  run ("map, single memory", bench_map, single);
+  run ("header view, single memory", bench_header_view, single);
+  run ("map, multi memory", bench_map, multi);
+  run ("header view, multi memory", bench_header_view, multi);
+
+  gst_buffer_unref (single);
+  gst_buffer_unref (multi);
+
+  return 0;
+}
@@ -113,8 +113,10 @@ plugin_init (GstPlugin * plugin)
   ret |= GST_ELEMENT_REGISTER (rtpvorbisdepay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvorbispay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvp8depay, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpvp8layerselect, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvp8pay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvp9depay, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpvp9layerselect, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvp9pay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvrawdepay, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpvrawpay, plugin);
@@ -126,6 +128,8 @@ plugin_init (GstPlugin * plugin)
   ret |= GST_ELEMENT_REGISTER (rtpreddec, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpulpfecdec, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpulpfecenc, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpflexfecdec, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpflexfecenc, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpstorage, plugin);
   ret |= GST_ELEMENT_REGISTER (rtphdrextcolorspace, plugin);
 
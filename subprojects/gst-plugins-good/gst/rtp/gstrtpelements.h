@@ -113,8 +113,10 @@ GST_ELEMENT_REGISTER_DECLARE (rtptheorapay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvorbisdepay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvorbispay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvp8depay);
+GST_ELEMENT_REGISTER_DECLARE (rtpvp8layerselect);
 GST_ELEMENT_REGISTER_DECLARE (rtpvp8pay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvp9depay);
+GST_ELEMENT_REGISTER_DECLARE (rtpvp9layerselect);
 GST_ELEMENT_REGISTER_DECLARE (rtpvp9pay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvrawdepay);
 GST_ELEMENT_REGISTER_DECLARE (rtpvrawpay);
@@ -126,6 +128,8 @@ GST_ELEMENT_REGISTER_DECLARE (rtpredenc);
 GST_ELEMENT_REGISTER_DECLARE (rtpreddec);
 GST_ELEMENT_REGISTER_DECLARE (rtpulpfecdec);
 GST_ELEMENT_REGISTER_DECLARE (rtpulpfecenc);
+GST_ELEMENT_REGISTER_DECLARE (rtpflexfecdec);
+GST_ELEMENT_REGISTER_DECLARE (rtpflexfecenc);
 GST_ELEMENT_REGISTER_DECLARE (rtpstorage);
 GST_ELEMENT_REGISTER_DECLARE (rtphdrextcolorspace);
 
@@ -0,0 +1,660 @@
+/* GStreamer plugin for forward error correction
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:element-rtpflexfecdec
+ * @short_description: RTP Flexible Forward Error Correction (FEC) decoder
+ * @title: rtpflexfecdec
+ *
+ * Flexible Forward Error Correction (FlexFEC) decoder as described in
+ * RFC 8627, for protection packets using the flexible mask.
+ *
+ * This element will work in combination with an upstream #GstRtpStorage
+ * element and attempt to recover packets declared lost through custom
+ * 'GstRTPPacketLost' events, usually emitted by #GstRtpJitterBuffer. The
+ * storage has to see both the media stream and the FlexFEC stream, so it
+ * is usually placed before the #GstRtpSsrcDemux. As one FlexFEC stream can
+ * protect several media streams, one decoder is used for each media stream
+ * and they all share the same storage.
+ *
+ * A decoder only recovers packets of the SSRC in the "ssrc" field of its
+ * sink caps, and ignores lost packets until it received such caps. Packets
+ * of the other SSRCs protected by the same FlexFEC packets are recovered by
+ * the decoders of those streams.
+ *
+ * When a packet can't be recovered directly because the protection packets
+ * covering it are missing other packets too, the decoder will first try to
+ * recover those other packets, which is what makes the row and column
+ * protection of #GstRtpFlexFecEnc effective.
+ *
+ * If no storage is provided using the #GstRtpFlexFecDec:storage
+ * property, it will try to get it from an element upstream.
+ *
+ * Additionally, the payload type of the protection packets *must* be
+ * provided to this element via its #GstRtpFlexFecDec:pt property.
+ *
+ * ## Example pipeline
+ *
+ * |[
+ * gst-launch-1.0 udpsrc port=8888 caps="application/x-rtp, payload=96, clock-rate=90000" ! rtpstorage size-time=220000000 ! rtpssrcdemux name=d d. ! application/x-rtp, payload=96, clock-rate=90000, media=video, encoding-name=H264 ! rtpjitterbuffer do-lost=1 latency=200 ! rtpflexfecdec pt=122 ! rtph264depay ! avdec_h264 ! videoconvert ! autovideosink
+ * ]| This example will receive a stream with FlexFEC and try to reconstruct
+ * the packets.
+ *
+ * See also: #GstRtpFlexFecEnc, #GstRtpUlpFecDec, #GstRtpStorage
+ * Since: 1.22
+ */
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpelements.h"
+#include "rtpulpfeccommon.h"
+#include "gstrtpflexfecdec.h"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp")
+    );
+
+enum
+{
+  PROP_0,
+  PROP_PT,
+  PROP_STORAGE,
+  PROP_RECOVERED,
+  PROP_UNRECOVERED,
+  N_PROPERTIES
+};
+
+#define DEFAULT_FEC_PT 0
+
+/* How many times we go through the FEC packets trying to recover the
+ * packets that prevent the lost one from being recovered */
+#define MAX_RECOVERY_ROUNDS 4
+#define MAX_WANTED_PACKETS 16
+
+static GParamSpec *klass_properties[N_PROPERTIES] = { NULL, };
+
+GST_DEBUG_CATEGORY (gst_rtp_flexfec_dec_debug);
+#define GST_CAT_DEFAULT (gst_rtp_flexfec_dec_debug)
+
+G_DEFINE_TYPE (GstRtpFlexFecDec, gst_rtp_flexfec_dec, GST_TYPE_ELEMENT);
+GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpflexfecdec, "rtpflexfecdec",
+    GST_RANK_NONE, GST_TYPE_RTP_FLEXFEC_DEC, rtp_element_init (plugin));
+
+typedef struct
+{
+  RtpUlpFecMapInfo info;
+  RtpFlexFecProtected protected[RTP_FLEXFEC_PROTECTED_SSRCS_MAX];
+  guint n_protected;
+  guint fec_hdrs_len;
+  gboolean used;
+} FlexFecPacket;
+
+typedef struct
+{
+  guint32 ssrc;
+  guint16 seq;
+} FlexFecPacketId;
+
+#define FLEXFEC_PACKET_NTH(dec, i) (&g_array_index (\
+    ((GstRtpFlexFecDec *)dec)->info_fec, \
+    FlexFecPacket, \
+    (i)))
+
+static void
+flexfec_packet_clear (FlexFecPacket * fec)
+{
+  rtp_ulpfec_map_info_unmap (&fec->info);
+}
+
+static gboolean
+flexfec_packet_protects (FlexFecPacket * fec, guint32 ssrc, guint16 seq)
+{
+  guint i;
+
+  for (i = 0; i < fec->n_protected; i++) {
+    if (fec->protected[i].ssrc == ssrc &&
+        rtp_flexfec_protected_has_seq (&fec->protected[i], seq))
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static void
+gst_rtp_flexfec_dec_start (GstRtpFlexFecDec * self, GstBufferList * buflist)
+{
+  guint len = gst_buffer_list_length (buflist);
+  guint i;
+
+  g_assert (0 == self->info_fec->len);
+
+  for (i = 0; i < len; ++i) {
+    GstBuffer *buffer = gst_buffer_list_get (buflist, i);
+    FlexFecPacket *fec;
+
+    g_array_set_size (self->info_fec, self->info_fec->len + 1);
+    fec = FLEXFEC_PACKET_NTH (self, self->info_fec->len - 1);
+
+    if (!rtp_ulpfec_map_info_map (gst_buffer_ref (buffer), &fec->info) ||
+        !rtp_flexfec_buffer_parse (&fec->info.rtp, fec->protected,
+            &fec->n_protected, &fec->fec_hdrs_len)) {
+      ++self->fec_packets_rejected;
+      g_array_set_size (self->info_fec, self->info_fec->len - 1);
+      continue;
+    }
+
+    GST_LOG_RTP_PACKET (self, "rtp header (fec)", &fec->info.rtp);
+  }
+
+  self->fec_packets_received += len;
+}
+
+static void
+gst_rtp_flexfec_dec_stop (GstRtpFlexFecDec * self)
+{
+  g_array_set_size (self->info_fec, 0);
+  g_array_set_size (self->scratch_buf, 0);
+}
+
+/* Returns the number of packets protected by @fec missing from the storage,
+ * counting stops at 3. The first 2 are stored in @missing */
+static guint
+gst_rtp_flexfec_dec_find_missing (GstRtpFlexFecDec * self, FlexFecPacket * fec,
+    FlexFecPacketId * missing)
+{
+  guint n_missing = 0;
+  guint i, j;
+
+  for (i = 0; i < fec->n_protected; i++) {
+    RtpFlexFecProtected *p = &fec->protected[i];
+
+    for (j = 0; j < RTP_FLEXFEC_PROTECTED_PACKETS_MAX; j++) {
+      guint16 seq = p->seq_base + j;
+      GstBuffer *buffer;
+
+      if (!rtp_flexfec_protected_has_seq (p, seq))
+        continue;
+
+      buffer = rtp_storage_get_redundant_packet (self->storage, p->ssrc, seq);
+      if (buffer) {
+        gst_buffer_unref (buffer);
+        continue;
+      }
+
+      if (n_missing < 2) {
+        missing[n_missing].ssrc = p->ssrc;
+        missing[n_missing].seq = seq;
+      }
+      if (++n_missing > 2)
+        return n_missing;
+    }
+  }
+
+  return n_missing;
+}
+
+static GstBuffer *
+gst_rtp_flexfec_dec_recover_packet (GstRtpFlexFecDec * self,
+    FlexFecPacket * fec, guint32 ssrc, guint16 seq, guint8 * dst_pt)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *ret;
+  guint i, j;
+
+  fec->used = TRUE;
+
+  g_array_set_size (self->scratch_buf, 0);
+  rtp_buffer_to_ulpfec_bitstring (&fec->info.rtp, self->scratch_buf, TRUE,
+      FALSE);
+
+  for (i = 0; i < fec->n_protected; i++) {
+    RtpFlexFecProtected *p = &fec->protected[i];
+
+    for (j = 0; j < RTP_FLEXFEC_PROTECTED_PACKETS_MAX; j++) {
+      RtpUlpFecMapInfo info = { GST_RTP_BUFFER_INIT };
+      guint16 protected_seq = p->seq_base + j;
+      GstBuffer *buffer;
+
+      if (!rtp_flexfec_protected_has_seq (p, protected_seq))
+        continue;
+      if (p->ssrc == ssrc && protected_seq == seq)
+        continue;
+
+      buffer = rtp_storage_get_redundant_packet (self->storage, p->ssrc,
+          protected_seq);
+      if (buffer == NULL || !rtp_ulpfec_map_info_map (buffer, &info))
+        return NULL;
+
+      rtp_buffer_to_flexfec_bitstring (&info.rtp, self->scratch_buf,
+          fec->fec_hdrs_len);
+      rtp_ulpfec_map_info_unmap (&info);
+    }
+  }
+
+  ret = rtp_flexfec_bitstring_to_media_rtp_buffer (self->scratch_buf,
+      fec->fec_hdrs_len, ssrc, seq);
+  if (ret == NULL)
+    return NULL;
+
+  if (!gst_rtp_buffer_map (ret, GST_MAP_READ, &rtp)) {
+    GST_WARNING_OBJECT (self, "Invalid recovered packet");
+    gst_buffer_unref (ret);
+    return NULL;
+  }
+
+  GST_DEBUG_RTP_PACKET (self, "rtp header (recovered)", &rtp);
+  *dst_pt = gst_rtp_buffer_get_payload_type (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return ret;
+}
+
+static GstBuffer *
+gst_rtp_flexfec_dec_recover (GstRtpFlexFecDec * self, guint32 ssrc,
+    guint16 seq, guint8 * dst_pt)
+{
+  FlexFecPacketId wanted[MAX_WANTED_PACKETS];
+  guint round;
+
+  for (round = 0; round < MAX_RECOVERY_ROUNDS; round++) {
+    gboolean progress = FALSE;
+    guint n_wanted = 0;
+    guint i, j;
+
+    /* Looking for a FEC packet which can be used for recovery */
+    for (i = 0; i < self->info_fec->len; i++) {
+      FlexFecPacket *fec = FLEXFEC_PACKET_NTH (self, i);
+      FlexFecPacketId missing[2];
+      guint n_missing;
+
+      if (fec->used || !flexfec_packet_protects (fec, ssrc, seq))
+        continue;
+
+      n_missing = gst_rtp_flexfec_dec_find_missing (self, fec, missing);
+      if (n_missing == 1) {
+        GstBuffer *ret =
+            gst_rtp_flexfec_dec_recover_packet (self, fec, ssrc, seq, dst_pt);
+        if (ret)
+          return ret;
+      } else if (n_missing == 2 && n_wanted < MAX_WANTED_PACKETS) {
+        /* Recovering the other missing packet would allow us to use this
+         * FEC packet */
+        if (missing[0].ssrc == ssrc && missing[0].seq == seq)
+          wanted[n_wanted++] = missing[1];
+        else
+          wanted[n_wanted++] = missing[0];
+      }
+    }
+
+    for (j = 0; j < n_wanted; j++) {
+      for (i = 0; i < self->info_fec->len; i++) {
+        FlexFecPacket *fec = FLEXFEC_PACKET_NTH (self, i);
+        FlexFecPacketId missing[2];
+        GstBuffer *recovered;
+        guint8 recovered_pt;
+
+        if (fec->used || !flexfec_packet_protects (fec, wanted[j].ssrc,
+                wanted[j].seq))
+          continue;
+
+        if (gst_rtp_flexfec_dec_find_missing (self, fec, missing) != 1)
+          continue;
+
+        recovered = gst_rtp_flexfec_dec_recover_packet (self, fec,
+            wanted[j].ssrc, wanted[j].seq, &recovered_pt);
+        if (recovered) {
+          rtp_storage_put_recovered_packet (self->storage, recovered,
+              recovered_pt, wanted[j].ssrc, wanted[j].seq);
+          progress = TRUE;
+          break;
+        }
+      }
+    }
+
+    if (!progress)
+      break;
+  }
+
+  return NULL;
+}
+
+static GstFlowReturn
+gst_rtp_flexfec_dec_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (parent);
+
+  if (G_LIKELY (GST_FLOW_OK == self->chain_return_val)) {
+    if (G_UNLIKELY (self->unset_discont_flag)) {
+      self->unset_discont_flag = FALSE;
+      if (GST_BUFFER_IS_DISCONT (buf)) {
+        buf = gst_buffer_make_writable (buf);
+        GST_BUFFER_FLAG_UNSET (buf, GST_BUFFER_FLAG_DISCONT);
+      }
+    }
+
+    return gst_pad_push (self->srcpad, buf);
+  }
+
+  gst_buffer_unref (buf);
+  return self->chain_return_val;
+}
+
+/* recovers @seqnum of the SSRC of the caps, the other SSRCs in the FlexFEC
+ * headers are left to their own decoders */
+static gboolean
+gst_rtp_flexfec_dec_handle_packet_loss (GstRtpFlexFecDec * self,
+    guint16 seqnum, GstClockTime timestamp)
+{
+  GstBuffer *recovered_buffer;
+  GstBuffer *sent_buffer;
+
+  recovered_buffer = rtp_storage_get_redundant_packet (self->storage,
+      self->caps_ssrc, seqnum);
+
+  if (recovered_buffer) {
+    GST_DEBUG_OBJECT (self, "Received lost packet from the storage");
+  } else {
+    GstBufferList *buflist =
+        rtp_storage_get_packets_with_pt (self->storage, self->fec_pt);
+    guint8 recovered_pt = 0;
+
+    if (buflist) {
+      gst_rtp_flexfec_dec_start (self, buflist);
+      recovered_buffer = gst_rtp_flexfec_dec_recover (self, self->caps_ssrc,
+          seqnum, &recovered_pt);
+      gst_rtp_flexfec_dec_stop (self);
+      gst_buffer_list_unref (buflist);
+    }
+
+    if (recovered_buffer && self->have_caps_pt &&
+        recovered_pt != self->caps_pt) {
+      GST_WARNING_OBJECT (self,
+          "Recovered packet has unexpected payload type (%u)", recovered_pt);
+      gst_buffer_unref (recovered_buffer);
+      recovered_buffer = NULL;
+    }
+
+    if (recovered_buffer) {
+      recovered_buffer = gst_buffer_make_writable (recovered_buffer);
+      GST_BUFFER_PTS (recovered_buffer) = timestamp;
+      rtp_storage_put_recovered_packet (self->storage,
+          gst_buffer_ref (recovered_buffer), recovered_pt, self->caps_ssrc,
+          seqnum);
+    }
+  }
+
+  if (recovered_buffer == NULL) {
+    GST_DEBUG_OBJECT (self, "Packet lost ssrc=0x%08x seq=%u", self->caps_ssrc,
+        seqnum);
+    return TRUE;
+  }
+
+  sent_buffer = gst_buffer_copy_deep (recovered_buffer);
+  gst_buffer_unref (recovered_buffer);
+  GST_BUFFER_PTS (sent_buffer) = timestamp;
+
+  GST_DEBUG_OBJECT (self,
+      "Pushing recovered packet ssrc=0x%08x seq=%u %" GST_PTR_FORMAT,
+      self->caps_ssrc, seqnum, sent_buffer);
+
+  self->unset_discont_flag = TRUE;
+  self->chain_return_val = gst_pad_push (self->srcpad, sent_buffer);
+
+  return FALSE;
+}
+
+static gboolean
+gst_rtp_flexfec_dec_handle_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (parent);
+  gboolean forward = TRUE;
+
+  GST_LOG_OBJECT (self, "Received event %" GST_PTR_FORMAT, event);
+
+  if (GST_FLOW_OK == self->chain_return_val &&
+      GST_EVENT_CUSTOM_DOWNSTREAM == GST_EVENT_TYPE (event) &&
+      gst_event_has_name (event, "GstRTPPacketLost") && self->have_caps_ssrc) {
+    guint seqnum;
+    GstClockTime timestamp;
+    GstStructure *s;
+
+    event = gst_event_make_writable (event);
+    s = gst_event_writable_structure (event);
+
+    if (self->storage == NULL) {
+      GstQuery *q = gst_query_new_custom (GST_QUERY_CUSTOM,
+          gst_structure_new_empty ("GstRtpStorage"));
+
+      if (gst_pad_peer_query (self->sinkpad, q)) {
+        const GstStructure *s = gst_query_get_structure (q);
+
+        if (gst_structure_has_field_typed (s, "storage", G_TYPE_OBJECT)) {
+          gst_structure_get (s, "storage", G_TYPE_OBJECT, &self->storage, NULL);
+        }
+      }
+      gst_query_unref (q);
+    }
+
+    if (self->storage == NULL) {
+      GST_ELEMENT_WARNING (self, STREAM, FAILED, ("Internal storage not found"),
+          ("You need to add rtpstorage element upstream from rtpflexfecdec."));
+      return FALSE;
+    }
+
+    if (!gst_structure_get (s,
+            "seqnum", G_TYPE_UINT, &seqnum,
+            "timestamp", G_TYPE_UINT64, &timestamp, NULL))
+      g_assert_not_reached ();
+
+    forward = gst_rtp_flexfec_dec_handle_packet_loss (self, seqnum, timestamp);
+
+    if (forward) {
+      gst_structure_remove_field (s, "seqnum");
+      gst_structure_set (s, "might-have-been-fec", G_TYPE_BOOLEAN, TRUE, NULL);
+      ++self->packets_unrecovered;
+    } else {
+      ++self->packets_recovered;
+    }
+
+    GST_DEBUG_OBJECT (self, "Unrecovered / Recovered: %lu / %lu",
+        (gulong) self->packets_unrecovered, (gulong) self->packets_recovered);
+  } else if (GST_EVENT_CAPS == GST_EVENT_TYPE (event)) {
+    GstCaps *caps;
+    GstStructure *s;
+    guint caps_ssrc = 0;
+    gint caps_pt = 0;
+
+    gst_event_parse_caps (event, &caps);
+    s = gst_caps_get_structure (caps, 0);
+    self->have_caps_ssrc = gst_structure_get_uint (s, "ssrc", &caps_ssrc);
+    self->have_caps_pt = gst_structure_get_int (s, "payload", &caps_pt);
+    self->caps_ssrc = caps_ssrc;
+    self->caps_pt = caps_pt;
+
+    GST_DEBUG_OBJECT (self, "SSRC %u, 0x%08x PT %u, %u", self->have_caps_ssrc,
+        self->caps_ssrc, self->have_caps_pt, self->caps_pt);
+  }
+
+  if (forward)
+    return gst_pad_push_event (self->srcpad, event);
+  gst_event_unref (event);
+  return TRUE;
+}
+
+static void
+gst_rtp_flexfec_dec_init (GstRtpFlexFecDec * self)
+{
+  self->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  self->sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_handle_sink_event));
+
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->fec_pt = DEFAULT_FEC_PT;
+
+  self->chain_return_val = GST_FLOW_OK;
+  self->info_fec = g_array_new (FALSE, TRUE, sizeof (FlexFecPacket));
+  g_array_set_clear_func (self->info_fec,
+      (GDestroyNotify) flexfec_packet_clear);
+  self->scratch_buf = g_array_new (FALSE, TRUE, sizeof (guint8));
+}
+
+static void
+gst_rtp_flexfec_dec_dispose (GObject * obj)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (obj);
+
+  GST_INFO_OBJECT (self,
+      " ssrc=0x%08x pt=%u"
+      " packets_recovered=%" G_GSIZE_FORMAT
+      " packets_unrecovered=%" G_GSIZE_FORMAT,
+      self->caps_ssrc, self->caps_pt,
+      self->packets_recovered, self->packets_unrecovered);
+
+  if (self->fec_packets_received) {
+    GST_INFO_OBJECT (self,
+        " fec_packets_received=%" G_GSIZE_FORMAT
+        " fec_packets_rejected=%" G_GSIZE_FORMAT,
+        self->fec_packets_received, self->fec_packets_rejected);
+  }
+
+  if (self->storage)
+    g_object_unref (self->storage);
+  self->storage = NULL;
+
+  G_OBJECT_CLASS (gst_rtp_flexfec_dec_parent_class)->dispose (obj);
+}
+
+static void
+gst_rtp_flexfec_dec_finalize (GObject * obj)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (obj);
+
+  g_assert (0 == self->info_fec->len);
+  g_array_free (self->info_fec, TRUE);
+  g_array_free (self->scratch_buf, TRUE);
+
+  G_OBJECT_CLASS (gst_rtp_flexfec_dec_parent_class)->finalize (obj);
+}
+
+static void
+gst_rtp_flexfec_dec_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_PT:
+      self->fec_pt = g_value_get_uint (value);
+      break;
+    case PROP_STORAGE:
+      if (self->storage)
+        g_object_unref (self->storage);
+      self->storage = g_value_get_object (value);
+      if (self->storage)
+        g_object_ref (self->storage);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_flexfec_dec_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpFlexFecDec *self = GST_RTP_FLEXFEC_DEC (object);
+
+  switch (prop_id) {
+    case PROP_PT:
+      g_value_set_uint (value, self->fec_pt);
+      break;
+    case PROP_STORAGE:
+      g_value_set_object (value, self->storage);
+      break;
+    case PROP_RECOVERED:
+      g_value_set_uint (value, (guint) self->packets_recovered);
+      break;
+    case PROP_UNRECOVERED:
+      g_value_set_uint (value, (guint) self->packets_unrecovered);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_flexfec_dec_class_init (GstRtpFlexFecDecClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_flexfec_dec_debug,
+      "rtpflexfecdec", 0, "RTP FlexFEC Decoder");
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&srctemplate));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sinktemplate));
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTP FlexFEC Decoder",
+      "Codec/Depayloader/Network/RTP",
+      "Decodes RTP FlexFEC (RFC8627)", "Pexip <pexip.com>");
+
+  gobject_class->set_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_set_property);
+  gobject_class->get_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_get_property);
+  gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_dispose);
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_rtp_flexfec_dec_finalize);
+
+  klass_properties[PROP_PT] = g_param_spec_uint ("pt", "pt",
+      "FEC packets payload type", 0, 127,
+      DEFAULT_FEC_PT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  klass_properties[PROP_STORAGE] =
+      g_param_spec_object ("storage", "RTP storage", "RTP storage",
+      G_TYPE_OBJECT, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+  klass_properties[PROP_RECOVERED] =
+      g_param_spec_uint ("recovered", "recovered",
+      "The number of recovered packets", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+  klass_properties[PROP_UNRECOVERED] =
+      g_param_spec_uint ("unrecovered", "unrecovered",
+      "The number of unrecovered packets", 0, G_MAXUINT, 0,
+      G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+  g_object_class_install_properties (gobject_class, N_PROPERTIES,
+      klass_properties);
+}
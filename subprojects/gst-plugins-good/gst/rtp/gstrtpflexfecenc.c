@@ -0,0 +1,451 @@
+/* GStreamer plugin for forward error correction
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+/**
+ * SECTION:element-rtpflexfecenc
+ * @short_description: RTP Flexible Forward Error Correction (FEC) encoder
+ * @title: rtpflexfecenc
+ *
+ * Flexible Forward Error Correction (FlexFEC) encoder as described in
+ * RFC 8627.
+ *
+ * Unlike #GstRtpUlpFecEnc, the protection packets are sent as a separate
+ * RTP stream with their own SSRC (#GstRtpFlexFecEnc:ssrc) and sequence
+ * numbers, and a single protection packet can cover packets from up to 15
+ * different media streams. This makes it a good fit for bundled streams such
+ * as simulcast, where one FEC stream protects all the layers.
+ *
+ * The media packets are arranged, in the order they arrive in, in a block of
+ * #GstRtpFlexFecEnc:columns by #GstRtpFlexFecEnc:rows packets. One protection
+ * packet is generated for each row of the block, and when
+ * #GstRtpFlexFecEnc:rows is bigger than 1, one protection packet is also
+ * generated for each column once the block is complete. Column protection
+ * recovers bursts of up to #GstRtpFlexFecEnc:columns consecutive losses,
+ * row and column protection together can recover some patterns where
+ * neither could alone.
+ *
+ * Only the flexible mask variant of the FlexFEC header is generated, so
+ * each stream can have at most 110 packets between the first and the last
+ * packet covered by a protection packet. A column protection packet spans
+ * (#GstRtpFlexFecEnc:rows - 1) * #GstRtpFlexFecEnc:columns packets, so
+ * #GstRtpFlexFecEnc:rows is reduced when needed to keep that below 110.
+ *
+ * The media packets are forwarded untouched, so the element can be placed
+ * anywhere on the sending side, including after #GstRtpFunnel.
+ *
+ * ## Example pipeline
+ *
+ * |[
+ * gst-launch-1.0 videotestsrc ! x264enc ! video/x-h264, profile=baseline ! rtph264pay pt=96 ! rtpflexfecenc pt=122 columns=5 rows=4 ! udpsink port=8888
+ * ]| This example will send a stream protected by row and column FEC.
+ *
+ * See also: #GstRtpFlexFecDec, #GstRtpUlpFecEnc
+ * Since: 1.22
+ */
+
+#include <gst/rtp/gstrtpbuffer.h>
+#include <string.h>
+
+#include "gstrtpelements.h"
+#include "rtpulpfeccommon.h"
+#include "gstrtpflexfecenc.h"
+
+static GstStaticPadTemplate sinktemplate = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+static GstStaticPadTemplate srctemplate = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp"));
+
+#define UNDEF_PT                255
+
+#define DEFAULT_PT              UNDEF_PT
+#define DEFAULT_SSRC            -1
+#define DEFAULT_COLUMNS         10
+#define DEFAULT_ROWS            1
+
+GST_DEBUG_CATEGORY (gst_rtp_flexfec_enc_debug);
+#define GST_CAT_DEFAULT (gst_rtp_flexfec_enc_debug)
+
+G_DEFINE_TYPE (GstRtpFlexFecEnc, gst_rtp_flexfec_enc, GST_TYPE_ELEMENT);
+GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpflexfecenc, "rtpflexfecenc",
+    GST_RANK_NONE, GST_TYPE_RTP_FLEXFEC_ENC, rtp_element_init (plugin));
+
+enum
+{
+  PROP_0,
+  PROP_PT,
+  PROP_SSRC,
+  PROP_COLUMNS,
+  PROP_ROWS,
+  PROP_PROTECTED,
+};
+
+#define RTP_FEC_MAP_INFO_NTH(enc, i) (&g_array_index (\
+    ((GstRtpFlexFecEnc *)enc)->info_arr, \
+    RtpUlpFecMapInfo, \
+    (i)))
+
+static RtpFlexFecProtected *
+gst_rtp_flexfec_enc_get_protected (RtpFlexFecProtected * protected,
+    guint * n_protected, guint32 ssrc)
+{
+  RtpFlexFecProtected *ret;
+  guint i;
+
+  for (i = 0; i < *n_protected; i++) {
+    if (protected[i].ssrc == ssrc)
+      return &protected[i];
+  }
+
+  if (*n_protected == RTP_FLEXFEC_PROTECTED_SSRCS_MAX)
+    return NULL;
+
+  ret = &protected[(*n_protected)++];
+  memset (ret, 0, sizeof (RtpFlexFecProtected));
+  ret->ssrc = ssrc;
+  return ret;
+}
+
+/* Generates and pushes one FEC packet protecting @count packets of the
+ * current block, starting at @start and @stride packets apart */
+static GstFlowReturn
+gst_rtp_flexfec_enc_push_fec_packet (GstRtpFlexFecEnc * self, guint8 pt,
+    guint start, guint stride, guint count)
+{
+  RtpFlexFecProtected protected[RTP_FLEXFEC_PROTECTED_SSRCS_MAX];
+  guint n_protected = 0;
+  RtpUlpFecMapInfo *info = NULL;
+  GstBuffer *latest_packet = NULL;
+  GstRTPBuffer *rtps[RTP_FLEXFEC_PROTECTED_PACKETS_MAX];
+  guint fec_hdrs_len;
+  guint32 timestamp;
+  GstBuffer *fec;
+  guint i;
+
+  g_assert (0 == self->info_arr->len);
+
+  for (i = 0; i < count; ++i) {
+    GstBuffer *buffer = g_ptr_array_index (self->block, start + i * stride);
+    RtpFlexFecProtected *p;
+
+    g_array_set_size (self->info_arr, self->info_arr->len + 1);
+    info = RTP_FEC_MAP_INFO_NTH (self, self->info_arr->len - 1);
+
+    if (!rtp_ulpfec_map_info_map (gst_buffer_ref (buffer), info)) {
+      g_array_set_size (self->info_arr, self->info_arr->len - 1);
+      continue;
+    }
+
+    GST_LOG_RTP_PACKET (self, "rtp header (incoming)", &info->rtp);
+
+    p = gst_rtp_flexfec_enc_get_protected (protected, &n_protected,
+        gst_rtp_buffer_get_ssrc (&info->rtp));
+    if (p == NULL || !rtp_flexfec_protected_add_seq (p,
+            gst_rtp_buffer_get_seq (&info->rtp))) {
+      GST_DEBUG_OBJECT (self, "Can't protect packet ssrc=0x%08x seq=%u",
+          gst_rtp_buffer_get_ssrc (&info->rtp),
+          gst_rtp_buffer_get_seq (&info->rtp));
+      g_array_set_size (self->info_arr, self->info_arr->len - 1);
+      continue;
+    }
+
+    latest_packet = buffer;
+  }
+
+  if (self->info_arr->len == 0)
+    return GST_FLOW_OK;
+
+  fec_hdrs_len = rtp_flexfec_get_headers_len (protected, n_protected);
+
+  g_array_set_size (self->scratch_buf, 0);
+  g_array_set_size (self->scratch_buf, fec_hdrs_len);
+  for (i = 0; i < self->info_arr->len; ++i) {
+    info = RTP_FEC_MAP_INFO_NTH (self, i);
+    rtps[i] = &info->rtp;
+  }
+  rtp_buffers_to_flexfec_bitstring (rtps, self->info_arr->len,
+      self->scratch_buf, fec_hdrs_len);
+  timestamp = gst_rtp_buffer_get_timestamp (&info->rtp);
+
+  fec = rtp_flexfec_bitstring_to_fec_rtp_buffer (self->scratch_buf,
+      protected, n_protected, pt, self->seqnum++, timestamp,
+      self->current_ssrc);
+  gst_buffer_copy_into (fec, latest_packet, GST_BUFFER_COPY_TIMESTAMPS, 0, -1);
+
+  self->num_packets_protected += self->info_arr->len;
+  self->num_packets_fec++;
+
+  g_array_set_size (self->info_arr, 0);
+
+  GST_LOG_OBJECT (self, "Pushing generated fec buffer %" GST_PTR_FORMAT, fec);
+  return gst_pad_push (self->srcpad, fec);
+}
+
+static GstFlowReturn
+gst_rtp_flexfec_enc_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buffer)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (parent);
+  GstFlowReturn ret;
+  guint columns, rows;
+  guint pt;
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  pt = self->pt;
+  columns = self->columns;
+  rows = self->rows;
+  GST_OBJECT_UNLOCK (self);
+
+  if (pt == UNDEF_PT)
+    return gst_pad_push (self->srcpad, buffer);
+
+  self->num_packets_received++;
+  g_ptr_array_add (self->block, gst_buffer_ref (buffer));
+
+  ret = gst_pad_push (self->srcpad, buffer);
+
+  /* Row protection, every @columns packets */
+  if (GST_FLOW_OK == ret && self->block->len % columns == 0)
+    ret = gst_rtp_flexfec_enc_push_fec_packet (self, pt,
+        self->block->len - columns, 1, columns);
+
+  /* Column protection, once the block is complete */
+  if (rows > 1 && self->block->len >= columns * rows) {
+    for (i = 0; i < columns && GST_FLOW_OK == ret; i++)
+      ret = gst_rtp_flexfec_enc_push_fec_packet (self, pt, i, columns, rows);
+  }
+
+  if (self->block->len >= columns * rows)
+    g_ptr_array_set_size (self->block, 0);
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_flexfec_enc_event_sink (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_FLUSH_STOP:
+      g_ptr_array_set_size (self->block, 0);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+/* call with the object lock */
+static void
+gst_rtp_flexfec_enc_clamp_rows (GstRtpFlexFecEnc * self)
+{
+  guint max_rows;
+
+  /* a column FEC packet spans (rows - 1) * columns seqnums of a stream */
+  max_rows = (RTP_FLEXFEC_PROTECTED_PACKETS_MAX - 1) / self->columns + 1;
+  if (self->rows > max_rows) {
+    GST_WARNING_OBJECT (self, "%u rows of %u columns exceed the %u packets "
+        "a FEC packet can protect, using %u rows", self->rows, self->columns,
+        RTP_FLEXFEC_PROTECTED_PACKETS_MAX, max_rows);
+    self->rows = max_rows;
+  }
+}
+
+static void
+gst_rtp_flexfec_enc_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_PT:
+      self->pt = g_value_get_uint (value);
+      break;
+    case PROP_SSRC:
+      self->ssrc = g_value_get_uint (value);
+      if (self->ssrc != -1)
+        self->current_ssrc = self->ssrc;
+      break;
+    case PROP_COLUMNS:
+      self->columns = g_value_get_uint (value);
+      gst_rtp_flexfec_enc_clamp_rows (self);
+      break;
+    case PROP_ROWS:
+      self->rows = g_value_get_uint (value);
+      gst_rtp_flexfec_enc_clamp_rows (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_flexfec_enc_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_PT:
+      g_value_set_uint (value, self->pt);
+      break;
+    case PROP_SSRC:
+      g_value_set_uint (value, self->ssrc);
+      break;
+    case PROP_COLUMNS:
+      g_value_set_uint (value, self->columns);
+      break;
+    case PROP_ROWS:
+      g_value_set_uint (value, self->rows);
+      break;
+    case PROP_PROTECTED:
+      g_value_set_uint (value, self->num_packets_protected);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_flexfec_enc_dispose (GObject * obj)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (obj);
+
+  if (self->num_packets_received) {
+    GST_INFO_OBJECT (self, "Actual FEC overhead is %4.2f%% (%u/%u)",
+        self->num_packets_fec * (double) 100. / self->num_packets_received,
+        self->num_packets_fec, self->num_packets_received);
+  }
+
+  if (self->block)
+    g_ptr_array_free (self->block, TRUE);
+  self->block = NULL;
+
+  G_OBJECT_CLASS (gst_rtp_flexfec_enc_parent_class)->dispose (obj);
+}
+
+static void
+gst_rtp_flexfec_enc_finalize (GObject * obj)
+{
+  GstRtpFlexFecEnc *self = GST_RTP_FLEXFEC_ENC (obj);
+
+  g_assert (0 == self->info_arr->len);
+  g_array_free (self->info_arr, TRUE);
+  g_array_free (self->scratch_buf, TRUE);
+
+  G_OBJECT_CLASS (gst_rtp_flexfec_enc_parent_class)->finalize (obj);
+}
+
+static void
+gst_rtp_flexfec_enc_init (GstRtpFlexFecEnc * self)
+{
+  self->srcpad = gst_pad_new_from_static_template (&srctemplate, "src");
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->sinkpad = gst_pad_new_from_static_template (&sinktemplate, "sink");
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_chain));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_event_sink));
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->pt = DEFAULT_PT;
+  self->ssrc = DEFAULT_SSRC;
+  self->columns = DEFAULT_COLUMNS;
+  self->rows = DEFAULT_ROWS;
+
+  self->current_ssrc = g_random_int ();
+  self->seqnum = g_random_int_range (0, G_MAXUINT16 / 2);
+
+  self->block = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_buffer_unref);
+  self->info_arr = g_array_new (FALSE, TRUE, sizeof (RtpUlpFecMapInfo));
+  g_array_set_clear_func (self->info_arr,
+      (GDestroyNotify) rtp_ulpfec_map_info_unmap);
+  self->scratch_buf = g_array_new (FALSE, TRUE, sizeof (guint8));
+}
+
+static void
+gst_rtp_flexfec_enc_class_init (GstRtpFlexFecEncClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_flexfec_enc_debug, "rtpflexfecenc", 0,
+      "FlexFEC encoder element");
+
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&srctemplate));
+  gst_element_class_add_pad_template (element_class,
+      gst_static_pad_template_get (&sinktemplate));
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTP FlexFEC Encoder",
+      "Codec/Payloader/Network/RTP",
+      "Encodes RTP FlexFEC (RFC8627)", "Pexip <pexip.com>");
+
+  gobject_class->set_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_set_property);
+  gobject_class->get_property =
+      GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_get_property);
+  gobject_class->dispose = GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_dispose);
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_rtp_flexfec_enc_finalize);
+
+  g_object_class_install_property (gobject_class, PROP_PT,
+      g_param_spec_uint ("pt", "payload type",
+          "The payload type of FEC packets", 0, 255, DEFAULT_PT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SSRC,
+      g_param_spec_uint ("ssrc", "SSRC",
+          "The SSRC of the FEC stream (-1 = random)", 0, G_MAXUINT32,
+          DEFAULT_SSRC, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_COLUMNS,
+      g_param_spec_uint ("columns", "Columns",
+          "Number of consecutive packets protected by one row FEC packet",
+          1, RTP_FLEXFEC_PROTECTED_PACKETS_MAX, DEFAULT_COLUMNS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_ROWS,
+      g_param_spec_uint ("rows", "Rows",
+          "Number of rows in a block, column FEC packets are only generated "
+          "when bigger than 1 (reduced so that (rows - 1) * columns < 110)", 1, RTP_FLEXFEC_PROTECTED_PACKETS_MAX,
+          DEFAULT_ROWS, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_PROTECTED,
+      g_param_spec_uint ("protected", "Protected",
+          "Count of protected packets", 0, G_MAXUINT32, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+}
@@ -41,12 +41,14 @@ GST_DEBUG_CATEGORY_STATIC (rtph264depay_debug);
 #define DEFAULT_ACCESS_UNIT   FALSE
 #define DEFAULT_WAIT_FOR_KEYFRAME FALSE
 #define DEFAULT_REQUEST_KEYFRAME FALSE
+#define DEFAULT_NON_CONTIGUOUS_FRAMES FALSE
 
 enum
 {
   PROP_0,
   PROP_WAIT_FOR_KEYFRAME,
   PROP_REQUEST_KEYFRAME,
+  PROP_NON_CONTIGUOUS_FRAMES,
 };
 
 
@@ -126,6 +128,9 @@ gst_rtp_h264_depay_set_property (GObject * object, guint prop_id,
     case PROP_REQUEST_KEYFRAME:
       self->request_keyframe = g_value_get_boolean (value);
       break;
+    case PROP_NON_CONTIGUOUS_FRAMES:
+      self->non_contiguous_frames = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -145,6 +150,9 @@ gst_rtp_h264_depay_get_property (GObject * object, guint prop_id,
     case PROP_REQUEST_KEYFRAME:
       g_value_set_boolean (value, self->request_keyframe);
       break;
+    case PROP_NON_CONTIGUOUS_FRAMES:
+      g_value_set_boolean (value, self->non_contiguous_frames);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -194,6 +202,24 @@ gst_rtp_h264_depay_class_init (GstRtpH264DepayClass * klass)
           DEFAULT_REQUEST_KEYFRAME,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpH264Depay:non-contiguous-frames:
+   *
+   * Output fragmented NAL units and access units as buffers made of the RTP
+   * payload memories instead of copying them into one contiguous
+   * allocation. Only enable this when downstream can handle buffers with
+   * multiple memories without mapping them as a whole. Output made of more
+   * memories than a #GstBuffer can hold is still copied.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_NON_CONTIGUOUS_FRAMES,
+      g_param_spec_boolean ("non-contiguous-frames", "Non-contiguous Frames",
+          "Output NAL units and access units as multi-memory buffers without "
+          "copying the payloads (downstream must handle non-contiguous input)",
+          DEFAULT_NON_CONTIGUOUS_FRAMES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gst_element_class_add_static_pad_template (gstelement_class,
       &gst_rtp_h264_depay_src_template);
   gst_element_class_add_static_pad_template (gstelement_class,
@@ -223,15 +249,18 @@ gst_rtp_h264_depay_init (GstRtpH264Depay * rtph264depay)
       (GDestroyNotify) gst_buffer_unref);
   rtph264depay->wait_for_keyframe = DEFAULT_WAIT_FOR_KEYFRAME;
   rtph264depay->request_keyframe = DEFAULT_REQUEST_KEYFRAME;
+  rtph264depay->non_contiguous_frames = DEFAULT_NON_CONTIGUOUS_FRAMES;
 }
 
 static void
 gst_rtp_h264_depay_reset (GstRtpH264Depay * rtph264depay, gboolean hard)
 {
   gst_adapter_clear (rtph264depay->adapter);
+  rtph264depay->adapter_n_memory = 0;
   rtph264depay->wait_start = TRUE;
   rtph264depay->waiting_for_keyframe = rtph264depay->wait_for_keyframe;
   gst_adapter_clear (rtph264depay->picture_adapter);
+  rtph264depay->picture_n_memory = 0;
   rtph264depay->picture_start = FALSE;
   rtph264depay->last_keyframe = FALSE;
   rtph264depay->last_ts = 0;
@@ -908,6 +937,14 @@ gst_rtp_h264_complete_au (GstRtpH264Depay * rtph264depay,
   GST_DEBUG_OBJECT (rtph264depay, "taking completed AU");
   outsize = gst_adapter_available (rtph264depay->picture_adapter);
 
+  if (rtph264depay->non_contiguous_frames &&
+      rtph264depay->picture_n_memory <= gst_buffer_get_max_memory ()) {
+    /* hand out the NAL memories as they are, this also copies the metas */
+    outbuf = gst_adapter_take_buffer_fast (rtph264depay->picture_adapter,
+        outsize);
+    goto done;
+  }
+
   outbuf = gst_rtp_h264_depay_allocate_output_buffer (rtph264depay, outsize);
 
   if (outbuf == NULL)
@@ -942,6 +979,9 @@ gst_rtp_h264_complete_au (GstRtpH264Depay * rtph264depay,
   gst_buffer_list_unref (list);
   gst_buffer_unmap (outbuf, &outmap);
 
+done:
+  rtph264depay->picture_n_memory = 0;
+
   *out_timestamp = rtph264depay->last_ts;
   *out_keyframe = rtph264depay->last_keyframe;
 
@@ -990,16 +1030,19 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 {
   GstRTPBaseDepayload *depayload = GST_RTP_BASE_DEPAYLOAD (rtph264depay);
   gint nal_type;
-  GstMapInfo map;
+  guint8 header[6];
+  gsize header_size;
   GstBuffer *outbuf = NULL;
   GstClockTime out_timestamp;
   gboolean keyframe, out_keyframe;
 
-  gst_buffer_map (nal, &map, GST_MAP_READ);
-  if (G_UNLIKELY (map.size < 5))
+  /* only peek at the NAL header, mapping the whole NAL would merge it when
+   * it is made of several memories */
+  header_size = gst_buffer_extract (nal, 0, header, sizeof (header));
+  if (G_UNLIKELY (header_size < 5))
     goto short_nal;
 
-  nal_type = map.data[4] & 0x1f;
+  nal_type = header[4] & 0x1f;
   GST_DEBUG_OBJECT (rtph264depay, "handle NAL type %d", nal_type);
 
   keyframe = NAL_TYPE_IS_KEY (nal_type);
@@ -1012,7 +1055,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
       gst_rtp_h264_depay_add_sps_pps (rtph264depay,
           gst_buffer_copy_region (nal, GST_BUFFER_COPY_ALL,
               4, gst_buffer_get_size (nal) - 4));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return;
     } else if (rtph264depay->sps->len == 0 || rtph264depay->pps->len == 0) {
@@ -1023,7 +1065,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
           gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
               gst_structure_new ("GstForceKeyUnit",
                   "all-headers", G_TYPE_BOOLEAN, TRUE, NULL)));
-      gst_buffer_unmap (nal, &map);
       gst_buffer_unref (nal);
       return;
     }
@@ -1049,7 +1090,7 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     if (nal_type == 1 || nal_type == 2 || nal_type == 5) {
       /* we have a picture start */
       start = TRUE;
-      if (map.data[5] & 0x80) {
+      if (header_size > 5 && (header[5] & 0x80)) {
         /* first_mb_in_slice == 0 completes a picture */
         complete = TRUE;
       }
@@ -1067,12 +1108,11 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
             &out_keyframe);
     }
     /* add to adapter */
-    gst_buffer_unmap (nal, &map);
-
     if (!rtph264depay->picture_start && start && out_keyframe)
       rtph264depay->waiting_for_keyframe = FALSE;
 
     GST_DEBUG_OBJECT (depayload, "adding NAL to picture adapter");
+    rtph264depay->picture_n_memory += gst_buffer_n_memory (nal);
     gst_adapter_push (rtph264depay->picture_adapter, nal);
     rtph264depay->last_ts = in_timestamp;
     rtph264depay->last_keyframe |= keyframe;
@@ -1085,7 +1125,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
     /* no merge, output is input nal */
     GST_DEBUG_OBJECT (depayload, "using NAL as output");
     outbuf = nal;
-    gst_buffer_unmap (nal, &map);
   }
 
   if (outbuf) {
@@ -1106,7 +1145,6 @@ gst_rtp_h264_depay_handle_nal (GstRtpH264Depay * rtph264depay, GstBuffer * nal,
 short_nal:
   {
     GST_WARNING_OBJECT (depayload, "dropping short NAL");
-    gst_buffer_unmap (nal, &map);
     gst_buffer_unref (nal);
     return;
   }
@@ -1120,9 +1158,28 @@ gst_rtp_h264_finish_fragmentation_unit (GstRtpH264Depay * rtph264depay)
   GstBuffer *outbuf;
 
   outsize = gst_adapter_available (rtph264depay->adapter);
-  outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
 
-  gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+  if (rtph264depay->non_contiguous_frames &&
+      rtph264depay->adapter_n_memory <= gst_buffer_get_max_memory ()) {
+    GstBuffer *rest = NULL;
+
+    /* the NAL prefix and header were queued in a small buffer of their own,
+     * take that one separately so the prefix can be written into it */
+    outbuf = gst_adapter_take_buffer (rtph264depay->adapter,
+        sizeof (sync_bytes) + 1);
+    if (outsize > sizeof (sync_bytes) + 1)
+      rest = gst_adapter_take_buffer_fast (rtph264depay->adapter,
+          outsize - sizeof (sync_bytes) - 1);
+    if (rest)
+      outbuf = gst_buffer_append (outbuf, rest);
+    outbuf = gst_buffer_make_writable (outbuf);
+  } else {
+    outbuf = gst_adapter_take_buffer (rtph264depay->adapter, outsize);
+  }
+  rtph264depay->adapter_n_memory = 0;
+
+  /* only map the memory holding the prefix */
+  gst_buffer_map_range (outbuf, 0, 1, &map, GST_MAP_WRITE);
   GST_DEBUG_OBJECT (rtph264depay, "output %d bytes", outsize);
 
   if (rtph264depay->byte_stream) {
@@ -1157,6 +1214,7 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
   /* flush remaining data on discont */
   if (GST_BUFFER_IS_DISCONT (rtp->buffer)) {
     gst_adapter_clear (rtph264depay->adapter);
+    rtph264depay->adapter_n_memory = 0;
     rtph264depay->wait_start = TRUE;
     rtph264depay->current_fu_type = 0;
     rtph264depay->last_fu_seqnum = 0;
@@ -1336,32 +1394,54 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
           /* reconstruct NAL header */
           nal_header = (payload[0] & 0xe0) | (payload[1] & 0x1f);
 
-          /* strip type header, keep FU header, we'll reuse it to reconstruct
-           * the NAL header. */
-          payload += 1;
-          payload_len -= 1;
+          if (rtph264depay->non_contiguous_frames) {
+            /* queue the prefix and NAL header in a buffer of their own and
+             * the fragment as a subbuffer of the RTP payload */
+            outbuf = gst_buffer_new_and_alloc (sizeof (sync_bytes) + 1);
+            gst_buffer_fill (outbuf, sizeof (sync_bytes), &nal_header, 1);
+            gst_rtp_copy_video_meta (rtph264depay, outbuf, rtp->buffer);
 
-          nalu_size = payload_len;
-          outsize = nalu_size + sizeof (sync_bytes);
-          outbuf = gst_buffer_new_and_alloc (outsize);
+            GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes",
+                payload_len - 2 + (gint) sizeof (sync_bytes) + 1);
 
-          gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
-          memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
-          map.data[sizeof (sync_bytes)] = nal_header;
-          gst_buffer_unmap (outbuf, &map);
+            rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
+            gst_adapter_push (rtph264depay->adapter, outbuf);
 
-          gst_rtp_copy_video_meta (rtph264depay, outbuf, rtp->buffer);
+            if (payload_len > 2) {
+              outbuf = gst_rtp_buffer_get_payload_subbuffer (rtp, 2, -1);
+              rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
+              gst_adapter_push (rtph264depay->adapter, outbuf);
+            }
+          } else {
+            /* strip type header, keep FU header, we'll reuse it to
+             * reconstruct the NAL header. */
+            payload += 1;
+            payload_len -= 1;
 
-          GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
+            nalu_size = payload_len;
+            outsize = nalu_size + sizeof (sync_bytes);
+            outbuf = gst_buffer_new_and_alloc (outsize);
 
-          /* and assemble in the adapter */
-          gst_adapter_push (rtph264depay->adapter, outbuf);
+            gst_buffer_map (outbuf, &map, GST_MAP_WRITE);
+            memcpy (map.data + sizeof (sync_bytes), payload, nalu_size);
+            map.data[sizeof (sync_bytes)] = nal_header;
+            gst_buffer_unmap (outbuf, &map);
+
+            gst_rtp_copy_video_meta (rtph264depay, outbuf, rtp->buffer);
+
+            GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
+
+            /* and assemble in the adapter */
+            rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
+            gst_adapter_push (rtph264depay->adapter, outbuf);
+          }
         } else {
           if (rtph264depay->current_fu_type == 0) {
             /* previous FU packet missing start bit? */
             GST_WARNING_OBJECT (rtph264depay, "missing FU start bit on an "
                 "earlier packet. Dropping.");
             gst_adapter_clear (rtph264depay->adapter);
+            rtph264depay->adapter_n_memory = 0;
             return NULL;
           }
           if (gst_rtp_buffer_compare_seqnum (rtph264depay->last_fu_seqnum,
@@ -1372,6 +1452,7 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
                 "stored.", rtph264depay->last_fu_seqnum,
                 gst_rtp_buffer_get_seq (rtp));
             gst_adapter_clear (rtph264depay->adapter);
+            rtph264depay->adapter_n_memory = 0;
             return NULL;
           }
           rtph264depay->last_fu_seqnum = gst_rtp_buffer_get_seq (rtp);
@@ -1381,15 +1462,23 @@ gst_rtp_h264_depay_process (GstRTPBaseDepayload * depayload, GstRTPBuffer * rtp)
           payload_len -= 2;
 
           outsize = payload_len;
-          outbuf = gst_buffer_new_and_alloc (outsize);
-          gst_buffer_fill (outbuf, 0, payload, outsize);
+          if (rtph264depay->non_contiguous_frames) {
+            outbuf = outsize > 0 ?
+                gst_rtp_buffer_get_payload_subbuffer (rtp, 2, -1) : NULL;
+          } else {
+            outbuf = gst_buffer_new_and_alloc (outsize);
+            gst_buffer_fill (outbuf, 0, payload, outsize);
 
-          gst_rtp_copy_video_meta (rtph264depay, outbuf, rtp->buffer);
+            gst_rtp_copy_video_meta (rtph264depay, outbuf, rtp->buffer);
+          }
 
           GST_DEBUG_OBJECT (rtph264depay, "queueing %d bytes", outsize);
 
           /* and assemble in the adapter */
-          gst_adapter_push (rtph264depay->adapter, outbuf);
+          if (outbuf) {
+            rtph264depay->adapter_n_memory += gst_buffer_n_memory (outbuf);
+            gst_adapter_push (rtph264depay->adapter, outbuf);
+          }
         }
 
         outbuf = NULL;
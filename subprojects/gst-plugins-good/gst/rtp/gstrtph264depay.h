@@ -48,11 +48,13 @@ struct _GstRtpH264Depay
 
   GstBuffer  *codec_data;
   GstAdapter *adapter;
+  guint       adapter_n_memory;
   gboolean    wait_start;
 
   /* nal merging */
   gboolean    merge;
   GstAdapter *picture_adapter;
+  guint       picture_n_memory;
   gboolean    picture_start;
   GstClockTime last_ts;
   gboolean    last_keyframe;
@@ -75,6 +77,7 @@ struct _GstRtpH264Depay
   gboolean wait_for_keyframe;
   gboolean request_keyframe;
   gboolean waiting_for_keyframe;
+  gboolean non_contiguous_frames;
 };
 
 struct _GstRtpH264DepayClass
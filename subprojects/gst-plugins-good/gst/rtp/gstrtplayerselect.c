@@ -0,0 +1,543 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/*
+ * GstRtpLayerSelect:
+ *
+ * Base class for elements that forward a subset of the layers of a scalable
+ * RTP video stream, without depayloading it. Subclasses parse the payload
+ * descriptor of their codec, and the base class decides which packets to
+ * drop and rewrites the rest so the output is a valid stream of its own:
+ *
+ *  - sequence numbers are shifted to close the gaps left by dropped packets,
+ *    packets that arrive after a later packet was dropped are dropped too
+ *  - picture IDs are shifted to close the gaps left by dropped pictures
+ *  - when the input switches to another SSRC, like between simulcast
+ *    streams, the output waits for a key frame and then continues the
+ *    SSRC, sequence numbers, timestamps, picture IDs and TL0PICIDX of the
+ *    previous stream
+ *
+ * Temporal layers are switched down at the next picture and up one layer at
+ * a time at switching points. Spatial layers are switched down at the next
+ * picture and up at a key frame.
+ *
+ * Packets that need no rewriting are pushed as they are. The others get a
+ * new memory with the RTP header and the start of the payload descriptor,
+ * followed by the rest of the packet shared from the input buffer, so the
+ * payload is never copied.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/video/video.h>
+
+#include "gstrtplayerselect.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_layer_select_debug);
+#define GST_CAT_DEFAULT (gst_rtp_layer_select_debug)
+
+#define DEFAULT_TARGET_TEMPORAL_LAYER -1
+
+enum
+{
+  PROP_0,
+  PROP_TARGET_TEMPORAL_LAYER,
+  PROP_DROPPED,
+};
+
+#define gst_rtp_layer_select_parent_class parent_class
+G_DEFINE_ABSTRACT_TYPE (GstRtpLayerSelect, gst_rtp_layer_select,
+    GST_TYPE_ELEMENT);
+
+static void
+gst_rtp_layer_select_reset (GstRtpLayerSelect * self)
+{
+  self->have_input = FALSE;
+  self->waiting_for_keyframe = TRUE;
+  self->current_tid = 0;
+  self->current_sid = 0;
+  self->dropping_picture = FALSE;
+
+  self->seq_delta = 0;
+  self->ts_delta = 0;
+  self->picture_id_delta = 0;
+  self->tl0picidx_delta = 0;
+
+  self->have_output = FALSE;
+  self->last_picture_id = GST_RTP_LAYER_PICTURE_ID_NONE;
+  self->have_tl0picidx = FALSE;
+  self->last_pts = GST_CLOCK_TIME_NONE;
+}
+
+static gint
+target_layer (gint target)
+{
+  return target < 0 ? G_MAXINT : target;
+}
+
+/* Starts forwarding a new input stream, continuing from the last packet
+ * that was pushed if there is one */
+static void
+gst_rtp_layer_select_rebase (GstRtpLayerSelect * self, guint32 ssrc,
+    guint16 seq, guint32 ts, GstClockTime pts, const GstRtpLayerInfo * info)
+{
+  if (self->have_output) {
+    guint32 base_ts = self->last_ts;
+
+    if (self->clock_rate > 0 && GST_CLOCK_TIME_IS_VALID (pts) &&
+        GST_CLOCK_TIME_IS_VALID (self->last_pts) && pts > self->last_pts)
+      base_ts += gst_util_uint64_scale_int (pts - self->last_pts,
+          self->clock_rate, GST_SECOND);
+    else
+      base_ts += 1;
+
+    self->seq_delta = (guint16) (self->last_seq + 1) - seq;
+    self->ts_delta = base_ts - ts;
+    if (info->picture_id != GST_RTP_LAYER_PICTURE_ID_NONE &&
+        self->last_picture_id != GST_RTP_LAYER_PICTURE_ID_NONE)
+      self->picture_id_delta = (self->last_picture_id + 1) - info->picture_id;
+    else
+      self->picture_id_delta = 0;
+    if (info->tl0picidx_offset >= 0 && self->have_tl0picidx)
+      self->tl0picidx_delta = (self->last_tl0picidx + 1) - info->tl0picidx;
+    else
+      self->tl0picidx_delta = 0;
+  }
+
+  self->seq_floor = seq - 1;
+
+  GST_OBJECT_LOCK (self);
+  if (!self->have_output)
+    self->out_ssrc = ssrc;
+  self->in_ssrc = ssrc;
+  self->have_input = TRUE;
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "Forwarding ssrc %08x as %08x, seqnum delta %u, "
+      "timestamp delta %u, picture id delta %u, tl0picidx delta %u", ssrc,
+      self->out_ssrc, self->seq_delta, self->ts_delta, self->picture_id_delta,
+      self->tl0picidx_delta);
+}
+
+static void
+gst_rtp_layer_select_request_keyframe (GstRtpLayerSelect * self)
+{
+  GstEvent *event;
+
+  GST_DEBUG_OBJECT (self, "Requesting key frame for ssrc %08x",
+      self->in_ssrc);
+
+  event = gst_video_event_new_upstream_force_key_unit (GST_CLOCK_TIME_NONE,
+      TRUE, 0);
+  gst_structure_set (gst_event_writable_structure (event),
+      "ssrc", G_TYPE_UINT, self->in_ssrc, NULL);
+  gst_pad_push_event (self->sinkpad, event);
+}
+
+/* Returns the packet to push for @buf, which may be @buf itself, or NULL
+ * when it is dropped. Takes ownership of @buf. */
+static GstBuffer *
+gst_rtp_layer_select_process (GstRtpLayerSelect * self, GstBuffer * buf)
+{
+  GstRtpLayerSelectClass *klass = GST_RTP_LAYER_SELECT_GET_CLASS (self);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRtpLayerInfo info = { 0, };
+  gint target_tid, target_sid;
+  guint32 ssrc, ts;
+  guint16 seq;
+  guint hdr_len;
+  gboolean marker, set_marker = FALSE;
+  gboolean parsed;
+  GstClockTime pts = GST_BUFFER_PTS (buf);
+  guint16 out_seq;
+  guint32 out_ts;
+  guint out_picture_id = GST_RTP_LAYER_PICTURE_ID_NONE;
+  guint8 out_tl0picidx = 0;
+  guint prefix_len = 0;
+  GstMemory *mem;
+  GstMapInfo map;
+  GstBuffer *out;
+
+  GST_OBJECT_LOCK (self);
+  target_tid = target_layer (self->target_temporal_layer);
+  target_sid = target_layer (self->target_spatial_layer);
+  GST_OBJECT_UNLOCK (self);
+
+  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp)) {
+    GST_WARNING_OBJECT (self, "Dropping invalid RTP buffer %" GST_PTR_FORMAT,
+        buf);
+    goto drop;
+  }
+
+  info.picture_id = GST_RTP_LAYER_PICTURE_ID_NONE;
+  info.picture_id_offset = -1;
+  info.tl0picidx_offset = -1;
+
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  seq = gst_rtp_buffer_get_seq (&rtp);
+  ts = gst_rtp_buffer_get_timestamp (&rtp);
+  marker = gst_rtp_buffer_get_marker (&rtp);
+  hdr_len = gst_rtp_buffer_get_header_len (&rtp);
+  parsed = klass->parse (self, gst_rtp_buffer_get_payload (&rtp),
+      gst_rtp_buffer_get_payload_len (&rtp), marker, &info);
+  gst_rtp_buffer_unmap (&rtp);
+
+  if (!parsed) {
+    GST_LOG_OBJECT (self, "Dropping packet with invalid payload descriptor");
+    goto drop;
+  }
+
+  if (!self->have_input || ssrc != self->in_ssrc) {
+    if (!info.keyframe) {
+      if (!self->waiting_for_keyframe || ssrc != self->in_ssrc) {
+        GST_OBJECT_LOCK (self);
+        self->in_ssrc = ssrc;
+        self->have_input = FALSE;
+        GST_OBJECT_UNLOCK (self);
+        self->waiting_for_keyframe = TRUE;
+        gst_rtp_layer_select_request_keyframe (self);
+      }
+      goto drop;
+    }
+    gst_rtp_layer_select_rebase (self, ssrc, seq, ts, pts, &info);
+  }
+
+  /* the seqnum this packet would get is already taken */
+  if (gst_rtp_buffer_compare_seqnum (self->seq_floor, seq) <= 0) {
+    GST_LOG_OBJECT (self, "Dropping late packet with seqnum %u", seq);
+    goto drop;
+  }
+
+  if (info.picture_start) {
+    if (info.keyframe) {
+      self->waiting_for_keyframe = FALSE;
+      self->current_tid = target_tid;
+      self->current_sid = target_sid;
+    } else {
+      if (target_tid < self->current_tid)
+        self->current_tid = target_tid;
+      else if (target_tid > self->current_tid &&
+          info.tid == self->current_tid + 1 && info.switching_point)
+        self->current_tid = info.tid;
+
+      if (target_sid < self->current_sid)
+        self->current_sid = target_sid;
+    }
+
+    self->dropping_picture = info.tid > self->current_tid;
+    if (self->dropping_picture && info.picture_id != GST_RTP_LAYER_PICTURE_ID_NONE)
+      self->picture_id_delta--;
+  }
+
+  if (self->dropping_picture || info.sid > self->current_sid) {
+    /* close the gap, the next packet gets this seqnum */
+    self->seq_delta--;
+    self->seq_floor = seq;
+    goto drop;
+  }
+
+  /* the end of the highest forwarded spatial layer ends the picture */
+  if (!marker && info.layer_end && info.sid == self->current_sid &&
+      self->current_sid != G_MAXINT)
+    set_marker = TRUE;
+
+  out_seq = seq + self->seq_delta;
+  out_ts = ts + self->ts_delta;
+  if (info.picture_id_offset >= 0) {
+    out_picture_id = (info.picture_id + self->picture_id_delta) &
+        (info.picture_id_15bits ? 0x7fff : 0x7f);
+    prefix_len = info.picture_id_offset + (info.picture_id_15bits ? 2 : 1);
+  }
+  if (info.tl0picidx_offset >= 0) {
+    out_tl0picidx = info.tl0picidx + self->tl0picidx_delta;
+    prefix_len = MAX (prefix_len, info.tl0picidx_offset + 1);
+  }
+
+  self->have_output = TRUE;
+  self->last_seq = out_seq;
+  self->last_ts = out_ts;
+  self->last_pts = pts;
+  if (out_picture_id != GST_RTP_LAYER_PICTURE_ID_NONE)
+    self->last_picture_id = out_picture_id;
+  if (info.tl0picidx_offset >= 0) {
+    self->last_tl0picidx = out_tl0picidx;
+    self->have_tl0picidx = TRUE;
+  }
+
+  if (!set_marker && self->seq_delta == 0 && self->ts_delta == 0 &&
+      self->out_ssrc == ssrc && (info.picture_id_offset < 0 ||
+          out_picture_id == info.picture_id) &&
+      (info.tl0picidx_offset < 0 || out_tl0picidx == info.tl0picidx))
+    return buf;
+
+  /* new memory for the header and the start of the payload descriptor,
+   * the rest is shared with the input */
+  mem = gst_allocator_alloc (NULL, hdr_len + prefix_len, NULL);
+  gst_memory_map (mem, &map, GST_MAP_WRITE);
+  gst_buffer_extract (buf, 0, map.data, hdr_len + prefix_len);
+  if (set_marker)
+    map.data[1] |= 0x80;
+  GST_WRITE_UINT16_BE (map.data + 2, out_seq);
+  GST_WRITE_UINT32_BE (map.data + 4, out_ts);
+  GST_WRITE_UINT32_BE (map.data + 8, self->out_ssrc);
+  if (info.picture_id_offset >= 0) {
+    guint8 *p = map.data + hdr_len + info.picture_id_offset;
+
+    if (info.picture_id_15bits) {
+      p[0] = 0x80 | (out_picture_id >> 8);
+      p[1] = out_picture_id & 0xff;
+    } else {
+      p[0] = out_picture_id;
+    }
+  }
+  if (info.tl0picidx_offset >= 0)
+    map.data[hdr_len + info.tl0picidx_offset] = out_tl0picidx;
+  gst_memory_unmap (mem, &map);
+
+  /* copying the timestamps is only done for regions at offset 0 */
+  out = gst_buffer_copy_region (buf, GST_BUFFER_COPY_FLAGS |
+      GST_BUFFER_COPY_META | GST_BUFFER_COPY_MEMORY, hdr_len + prefix_len, -1);
+  GST_BUFFER_PTS (out) = pts;
+  GST_BUFFER_DTS (out) = GST_BUFFER_DTS (buf);
+  GST_BUFFER_DURATION (out) = GST_BUFFER_DURATION (buf);
+  gst_buffer_prepend_memory (out, mem);
+  gst_buffer_unref (buf);
+
+  return out;
+
+drop:
+  GST_LOG_OBJECT (self, "Dropping %" GST_PTR_FORMAT, buf);
+  GST_OBJECT_LOCK (self);
+  self->dropped++;
+  GST_OBJECT_UNLOCK (self);
+  gst_buffer_unref (buf);
+  return NULL;
+}
+
+static GstFlowReturn
+gst_rtp_layer_select_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (parent);
+
+  buf = gst_rtp_layer_select_process (self, buf);
+  if (buf == NULL)
+    return GST_FLOW_OK;
+
+  return gst_pad_push (self->srcpad, buf);
+}
+
+static GstFlowReturn
+gst_rtp_layer_select_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (parent);
+  guint i, len = gst_buffer_list_length (list);
+  GstBufferList *out_list = gst_buffer_list_new_sized (len);
+
+  for (i = 0; i < len; i++) {
+    GstBuffer *buf = gst_buffer_ref (gst_buffer_list_get (list, i));
+
+    buf = gst_rtp_layer_select_process (self, buf);
+    if (buf)
+      gst_buffer_list_add (out_list, buf);
+  }
+  gst_buffer_list_unref (list);
+
+  if (gst_buffer_list_length (out_list) == 0) {
+    gst_buffer_list_unref (out_list);
+    return GST_FLOW_OK;
+  }
+
+  return gst_pad_push_list (self->srcpad, out_list);
+}
+
+static gboolean
+gst_rtp_layer_select_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (event, &caps);
+    if (!gst_structure_get_int (gst_caps_get_structure (caps, 0),
+            "clock-rate", &self->clock_rate))
+      self->clock_rate = -1;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static gboolean
+gst_rtp_layer_select_src_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (parent);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM) {
+    const GstStructure *s = gst_event_get_structure (event);
+    guint ssrc;
+
+    /* seqnums of dropped packets are reused, so a retransmission can not be
+     * mapped back to the input. Keep the packets for retransmission after
+     * this element instead. */
+    if (gst_structure_has_name (s, "GstRTPRetransmissionRequest") ||
+        gst_structure_has_name (s, "GstRTPRetransmissionRequestBatch")) {
+      gst_event_unref (event);
+      return TRUE;
+    }
+
+    GST_OBJECT_LOCK (self);
+    if (gst_structure_get_uint (s, "ssrc", &ssrc) && ssrc == self->out_ssrc &&
+        self->have_input) {
+      event = gst_event_make_writable (event);
+      gst_structure_set (gst_event_writable_structure (event),
+          "ssrc", G_TYPE_UINT, self->in_ssrc, NULL);
+    }
+    GST_OBJECT_UNLOCK (self);
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static GstStateChangeReturn
+gst_rtp_layer_select_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      GST_OBJECT_LOCK (self);
+      gst_rtp_layer_select_reset (self);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  return ret;
+}
+
+static void
+gst_rtp_layer_select_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (object);
+
+  switch (prop_id) {
+    case PROP_TARGET_TEMPORAL_LAYER:
+      GST_OBJECT_LOCK (self);
+      self->target_temporal_layer = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_layer_select_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpLayerSelect *self = GST_RTP_LAYER_SELECT (object);
+
+  switch (prop_id) {
+    case PROP_TARGET_TEMPORAL_LAYER:
+      GST_OBJECT_LOCK (self);
+      g_value_set_int (value, self->target_temporal_layer);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    case PROP_DROPPED:
+      GST_OBJECT_LOCK (self);
+      g_value_set_uint (value, self->dropped);
+      GST_OBJECT_UNLOCK (self);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_layer_select_class_init (GstRtpLayerSelectClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_layer_select_set_property;
+  gobject_class->get_property = gst_rtp_layer_select_get_property;
+  element_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_layer_select_change_state);
+
+  g_object_class_install_property (gobject_class, PROP_TARGET_TEMPORAL_LAYER,
+      g_param_spec_int ("target-temporal-layer", "Target Temporal Layer",
+          "The highest temporal layer to forward (-1 = all)", -1, 7,
+          DEFAULT_TARGET_TEMPORAL_LAYER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_DROPPED,
+      g_param_spec_uint ("dropped", "Dropped",
+          "The number of dropped packets", 0, G_MAXUINT, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+  gst_type_mark_as_plugin_api (GST_TYPE_RTP_LAYER_SELECT, 0);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_layer_select_debug, "rtplayerselect", 0,
+      "RTP layer selector base class");
+}
+
+static void
+gst_rtp_layer_select_init (GstRtpLayerSelect * self)
+{
+  GstPadTemplate *pad_template;
+
+  pad_template =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self), "src");
+  self->srcpad = gst_pad_new_from_template (pad_template, "src");
+  gst_pad_set_event_function (self->srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_layer_select_src_event));
+  gst_element_add_pad (GST_ELEMENT_CAST (self), self->srcpad);
+
+  pad_template =
+      gst_element_class_get_pad_template (GST_ELEMENT_GET_CLASS (self), "sink");
+  self->sinkpad = gst_pad_new_from_template (pad_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_layer_select_chain));
+  gst_pad_set_chain_list_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_layer_select_chain_list));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_layer_select_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->target_temporal_layer = DEFAULT_TARGET_TEMPORAL_LAYER;
+  self->target_spatial_layer = -1;
+  self->clock_rate = -1;
+  gst_rtp_layer_select_reset (self);
+}
@@ -0,0 +1,119 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_LAYER_SELECT_H__
+#define __GST_RTP_LAYER_SELECT_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_LAYER_SELECT \
+  (gst_rtp_layer_select_get_type())
+#define GST_RTP_LAYER_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_LAYER_SELECT,GstRtpLayerSelect))
+#define GST_RTP_LAYER_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_LAYER_SELECT,GstRtpLayerSelectClass))
+#define GST_RTP_LAYER_SELECT_GET_CLASS(obj) \
+  (G_TYPE_INSTANCE_GET_CLASS ((obj),GST_TYPE_RTP_LAYER_SELECT,GstRtpLayerSelectClass))
+#define GST_IS_RTP_LAYER_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_LAYER_SELECT))
+#define GST_IS_RTP_LAYER_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_LAYER_SELECT))
+
+typedef struct _GstRtpLayerSelect GstRtpLayerSelect;
+typedef struct _GstRtpLayerSelectClass GstRtpLayerSelectClass;
+
+#define GST_RTP_LAYER_PICTURE_ID_NONE (G_MAXUINT)
+
+/* What a subclass found in the payload descriptor of a packet. The offsets
+ * are in bytes from the start of the payload, -1 when the field is absent. */
+typedef struct
+{
+  /* first packet of a picture, and of a key frame */
+  gboolean picture_start;
+  gboolean keyframe;
+
+  guint8 tid;
+  guint8 sid;
+  /* the temporal layer may be switched up to at this picture */
+  gboolean switching_point;
+  /* last packet of the spatial layer frame */
+  gboolean layer_end;
+
+  guint picture_id;
+  gboolean picture_id_15bits;
+  gint picture_id_offset;
+
+  guint8 tl0picidx;
+  gint tl0picidx_offset;
+} GstRtpLayerInfo;
+
+struct _GstRtpLayerSelectClass {
+  GstElementClass parent_class;
+
+  /* fills @info from the payload descriptor, returns FALSE when the packet
+   * can not be parsed */
+  gboolean (*parse) (GstRtpLayerSelect * self, const guint8 * payload,
+      guint size, gboolean marker, GstRtpLayerInfo * info);
+};
+
+struct _GstRtpLayerSelect {
+  GstElement parent;
+  GstPad *srcpad;
+  GstPad *sinkpad;
+
+  /* properties, protected by OBJECT_LOCK */
+  gint target_temporal_layer;
+  gint target_spatial_layer;
+  guint dropped;
+
+  /* streaming thread, the ssrcs are also read under OBJECT_LOCK for
+   * upstream events */
+  gboolean have_input;
+  guint32 in_ssrc;
+  guint32 out_ssrc;
+  gboolean waiting_for_keyframe;
+  gint current_tid;
+  gint current_sid;
+  gboolean dropping_picture;
+
+  guint16 seq_delta;
+  /* input packets at or before this seqnum arrive too late, their output
+   * seqnums were given to later packets when closing a gap */
+  guint16 seq_floor;
+  guint32 ts_delta;
+  guint16 picture_id_delta;
+  guint8 tl0picidx_delta;
+
+  gboolean have_output;
+  guint16 last_seq;
+  guint32 last_ts;
+  guint last_picture_id;
+  gboolean have_tl0picidx;
+  guint8 last_tl0picidx;
+  GstClockTime last_pts;
+  gint clock_rate;
+};
+
+GType gst_rtp_layer_select_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_LAYER_SELECT_H__ */
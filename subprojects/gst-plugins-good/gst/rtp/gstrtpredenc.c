@@ -44,6 +44,22 @@
  * gst-launch-1.0 videotestsrc ! x264enc ! video/x-h264, profile=baseline ! rtph264pay pt=96 ! rtpulpfecenc percentage=100 pt=122 ! rtpredenc pt=122 distance=2 ! identity drop-probability=0.05 ! udpsink port=8888
  * ]| This example will send a stream with RED and ULP FEC.
  *
+ * ## Adaptive redundancy
+ *
+ * With #GstRtpRedEnc:adaptive set, the element picks the number of redundant
+ * blocks for every packet itself instead of using #GstRtpRedEnc:distance.
+ * The application feeds it the loss of the link through
+ * #GstRtpRedEnc:packet-loss-percentage, for instance from the
+ * "packet-loss-pct" field of the #GstRtpSession:twcc-stats or from the
+ * "rb-fractionlost" of the receiver reports in the #GstRtpSession:stats.
+ * Assuming independent losses, a packet is lost for good only when its
+ * original and all of its copies are, so the element adds the blocks of the
+ * previous 1, 2, ... packets until the remaining loss is below
+ * #GstRtpRedEnc:target-loss-percentage, up to #GstRtpRedEnc:max-distance
+ * blocks. With #GstRtpRedEnc:max-redundancy-bitrate set, the redundant
+ * blocks also have to fit in that bitrate, and blocks that do not fit are
+ * left out of the packet, the most recent ones being preferred.
+ *
  * See also: #GstRtpRedDec, #GstWebRTCBin, #GstRtpBin
  * Since: 1.14
  */
@@ -76,6 +92,17 @@ static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
 #define DEFAULT_PT                  (0)
 #define DEFAULT_DISTANCE            (0)
 #define DEFAULT_ALLOW_NO_RED_BLOCKS (TRUE)
+#define DEFAULT_ADAPTIVE            (FALSE)
+#define DEFAULT_MAX_DISTANCE        (2)
+#define DEFAULT_PACKET_LOSS_PERCENTAGE (0.0)
+#define DEFAULT_TARGET_LOSS_PERCENTAGE (1.0)
+#define DEFAULT_MAX_REDUNDANCY_BITRATE (0)
+
+/* upper limit of the max-distance property */
+#define MAX_ADAPTIVE_DISTANCE       (16)
+/* how much of the redundancy budget can be saved up while the redundant
+ * blocks are smaller than the budget */
+#define BUDGET_WINDOW               (250 * GST_MSECOND)
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtp_red_enc_debug);
 #define GST_CAT_DEFAULT (gst_rtp_red_enc_debug)
@@ -89,7 +116,13 @@ enum
   PROP_PT,
   PROP_SENT,
   PROP_DISTANCE,
-  PROP_ALLOW_NO_RED_BLOCKS
+  PROP_ALLOW_NO_RED_BLOCKS,
+  PROP_ADAPTIVE,
+  PROP_MAX_DISTANCE,
+  PROP_PACKET_LOSS_PERCENTAGE,
+  PROP_TARGET_LOSS_PERCENTAGE,
+  PROP_MAX_REDUNDANCY_BITRATE,
+  PROP_NUM_REDUNDANT_BLOCKS
 };
 
 static void
@@ -139,12 +172,14 @@ _create_caps_event (const GstCaps * caps, guint8 pt)
   return ret;
 }
 
+/* @redundant_blocks are ordered from the oldest to the most recent one */
 static GstBuffer *
 _alloc_red_packet_and_fill_headers (GstRtpRedEnc * self,
-    RTPHistItem * redundant_block, GstRTPBuffer * inp_rtp)
+    RTPHistItem ** redundant_blocks, guint n_redundant_blocks,
+    GstRTPBuffer * inp_rtp)
 {
   guint red_header_size = rtp_red_block_header_get_length (FALSE) +
-      (redundant_block ? rtp_red_block_header_get_length (TRUE) : 0);
+      n_redundant_blocks * rtp_red_block_header_get_length (TRUE);
 
   guint32 timestamp = gst_rtp_buffer_get_timestamp (inp_rtp);
   guint csrc_count = gst_rtp_buffer_get_csrc_count (inp_rtp);
@@ -174,7 +209,9 @@ _alloc_red_packet_and_fill_headers (GstRtpRedEnc * self,
 
   /* Filling RED block headers */
   red_block_header = gst_rtp_buffer_get_payload (&red_rtp);
-  if (redundant_block) {
+  for (i = 0; i != n_redundant_blocks; ++i) {
+    RTPHistItem *redundant_block = redundant_blocks[i];
+
     rtp_red_block_set_is_redundant (red_block_header, TRUE);
     rtp_red_block_set_payload_type (red_block_header, redundant_block->pt);
     rtp_red_block_set_timestamp_offset (red_block_header,
@@ -217,35 +254,33 @@ _alloc_red_packet_and_fill_headers (GstRtpRedEnc * self,
 
 static GstBuffer *
 _create_red_packet (GstRtpRedEnc * self,
-    GstRTPBuffer * rtp, RTPHistItem * redundant_block, GstBuffer * main_block)
+    GstRTPBuffer * rtp, RTPHistItem ** redundant_blocks,
+    guint n_redundant_blocks, GstBuffer * main_block)
 {
-  GstBuffer *red =
-      _alloc_red_packet_and_fill_headers (self, redundant_block, rtp);
-  if (redundant_block)
-    red = gst_buffer_append (red, gst_buffer_ref (redundant_block->payload));
+  GstBuffer *red = _alloc_red_packet_and_fill_headers (self, redundant_blocks,
+      n_redundant_blocks, rtp);
+  guint i;
+
+  for (i = 0; i != n_redundant_blocks; ++i)
+    red = gst_buffer_append (red,
+        gst_buffer_ref (redundant_blocks[i]->payload));
   red = gst_buffer_append (red, gst_buffer_ref (main_block));
   return red;
 }
 
-static RTPHistItem *
-_red_history_get_redundant_block (GstRtpRedEnc * self,
+static gboolean
+_red_history_item_is_usable (GstRtpRedEnc * self, RTPHistItem * item,
     guint32 current_timestamp, guint distance)
 {
-  RTPHistItem *item;
-  gint32 timestamp_offset;
+  gint32 timestamp_offset = current_timestamp - item->timestamp;
 
-  if (0 == distance || 0 == self->rtp_history->length)
-    return NULL;
-
-  item = self->rtp_history->tail->data;
-  timestamp_offset = current_timestamp - item->timestamp;
   if (G_UNLIKELY (timestamp_offset > RED_BLOCK_TIMESTAMP_OFFSET_MAX)) {
     GST_WARNING_OBJECT (self,
         "Can't create redundant block with distance %u, "
         "timestamp offset is too large %d (%u - %u) > %u",
         distance, timestamp_offset, current_timestamp, item->timestamp,
         RED_BLOCK_TIMESTAMP_OFFSET_MAX);
-    return NULL;
+    return FALSE;
   }
 
   if (G_UNLIKELY (timestamp_offset < 0)) {
@@ -253,7 +288,7 @@ _red_history_get_redundant_block (GstRtpRedEnc * self,
         "Can't create redundant block with distance %u, "
         "timestamp offset is negative %d (%u - %u)",
         distance, timestamp_offset, current_timestamp, item->timestamp);
-    return NULL;
+    return FALSE;
   }
 
   if (G_UNLIKELY (gst_buffer_get_size (item->payload) > RED_BLOCK_LENGTH_MAX)) {
@@ -262,9 +297,25 @@ _red_history_get_redundant_block (GstRtpRedEnc * self,
         "red block is too large %u > %u",
         distance, (guint) gst_buffer_get_size (item->payload),
         RED_BLOCK_LENGTH_MAX);
-    return NULL;
+    return FALSE;
   }
 
+  return TRUE;
+}
+
+static RTPHistItem *
+_red_history_get_redundant_block (GstRtpRedEnc * self,
+    guint32 current_timestamp, guint distance)
+{
+  RTPHistItem *item;
+
+  if (0 == distance || 0 == self->rtp_history->length)
+    return NULL;
+
+  item = self->rtp_history->tail->data;
+  if (!_red_history_item_is_usable (self, item, current_timestamp, distance))
+    return NULL;
+
   /* _red_history_trim should take care it never happens */
   g_assert_cmpint (self->rtp_history->length, <=, distance);
 
@@ -276,6 +327,92 @@ _red_history_get_redundant_block (GstRtpRedEnc * self,
   return item;
 }
 
+/* The number of redundant blocks that brings the packet loss seen by the
+ * receiver down to the target, assuming independent losses */
+static guint
+_adaptive_get_wanted_blocks (GstRtpRedEnc * self, guint max_distance)
+{
+  gdouble loss = self->packet_loss_percentage / 100.0;
+  gdouble target = self->target_loss_percentage / 100.0;
+  gdouble residual_loss = loss;
+  guint n = 0;
+
+  while (residual_loss > target && n < max_distance) {
+    residual_loss *= loss;
+    n++;
+  }
+
+  return n;
+}
+
+static void
+_adaptive_refill_budget (GstRtpRedEnc * self, GstClockTime pts)
+{
+  guint bitrate = self->max_redundancy_bitrate;
+  gint64 max_budget;
+
+  /* without timestamps there is no budget to spend */
+  if (0 == bitrate || !GST_CLOCK_TIME_IS_VALID (pts))
+    return;
+
+  max_budget = gst_util_uint64_scale (BUDGET_WINDOW, bitrate, 8 * GST_SECOND);
+  if (!GST_CLOCK_TIME_IS_VALID (self->budget_last_pts))
+    self->budget = max_budget;
+  else if (pts > self->budget_last_pts)
+    self->budget += gst_util_uint64_scale (pts - self->budget_last_pts,
+        bitrate, 8 * GST_SECOND);
+  self->budget = MIN (self->budget, max_budget);
+  self->budget_last_pts = pts;
+}
+
+/* Fills @blocks, oldest first, with the redundant blocks to send with the
+ * packet at @current_timestamp and returns how many there are */
+static guint
+_red_history_get_adaptive_blocks (GstRtpRedEnc * self,
+    guint32 current_timestamp, GstClockTime pts, guint max_distance,
+    RTPHistItem ** blocks)
+{
+  RTPHistItem *picked[MAX_ADAPTIVE_DISTANCE];
+  guint wanted = _adaptive_get_wanted_blocks (self, max_distance);
+  guint n = 0, distance, i;
+  GList *link;
+
+  _adaptive_refill_budget (self, pts);
+
+  for (distance = 1, link = self->rtp_history->head;
+      distance <= wanted && link != NULL; distance++, link = link->next) {
+    RTPHistItem *item = link->data;
+    gint64 size;
+
+    if (!_red_history_item_is_usable (self, item, current_timestamp,
+            distance))
+      continue;
+
+    size = gst_buffer_get_size (item->payload) +
+        rtp_red_block_header_get_length (TRUE);
+    if (self->max_redundancy_bitrate > 0) {
+      if (size > self->budget) {
+        GST_LOG_OBJECT (self, "Leaving out redundant block with distance %u, "
+            "%" G_GINT64_FORMAT " bytes over budget", distance,
+            size - self->budget);
+        continue;
+      }
+      self->budget -= size;
+    }
+    picked[n++] = item;
+  }
+
+  if (n != self->num_redundant_blocks)
+    GST_DEBUG_OBJECT (self, "Sending %u redundant blocks (wanted %u) "
+        "for %.2f%% packet loss", n, wanted, self->packet_loss_percentage);
+  self->num_redundant_blocks = n;
+
+  for (i = 0; i != n; ++i)
+    blocks[i] = picked[n - 1 - i];
+
+  return n;
+}
+
 static void
 _red_history_prepend (GstRtpRedEnc * self,
     GstRTPBuffer * rtp, GstBuffer * rtp_payload, guint max_history_length)
@@ -340,12 +477,12 @@ _push_nonred_packet (GstRtpRedEnc * self,
 
 static GstFlowReturn
 _push_red_packet (GstRtpRedEnc * self,
-    GstRTPBuffer * rtp, GstBuffer * buffer, RTPHistItem * redundant_block,
-    guint distance)
+    GstRTPBuffer * rtp, GstBuffer * buffer, RTPHistItem ** redundant_blocks,
+    guint n_redundant_blocks, guint distance)
 {
   GstBuffer *main_block = gst_rtp_buffer_get_payload_buffer (rtp);
-  GstBuffer *red_buffer =
-      _create_red_packet (self, rtp, redundant_block, main_block);
+  GstBuffer *red_buffer = _create_red_packet (self, rtp, redundant_blocks,
+      n_redundant_blocks, main_block);
 
   _red_history_prepend (self, rtp, main_block, distance);
   gst_rtp_buffer_unmap (rtp);
@@ -360,12 +497,15 @@ gst_rtp_red_enc_chain (GstPad G_GNUC_UNUSED * pad, GstObject * parent,
     GstBuffer * buffer)
 {
   GstRtpRedEnc *self = GST_RTP_RED_ENC (parent);
-  guint distance = self->distance;
+  gboolean adaptive = self->adaptive;
+  guint distance = adaptive ? self->max_distance : self->distance;
   guint only_with_redundant_data = !self->allow_no_red_blocks;
-  RTPHistItem *redundant_block;
+  RTPHistItem *redundant_blocks[MAX_ADAPTIVE_DISTANCE];
+  guint n_redundant_blocks;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
 
-  /* We need to "trim" the history if 'distance' property has changed */
+  /* We need to "trim" the history if 'distance' property has changed,
+   * in adaptive mode the history covers all the blocks we may send */
   _red_history_trim (self, distance);
 
   if (0 == distance && only_with_redundant_data)
@@ -374,14 +514,23 @@ gst_rtp_red_enc_chain (GstPad G_GNUC_UNUSED * pad, GstObject * parent,
   if (!gst_rtp_buffer_map (buffer, GST_MAP_READ, &rtp))
     return _pad_push (self, buffer, self->is_current_caps_red);
 
+  if (adaptive) {
+    n_redundant_blocks = _red_history_get_adaptive_blocks (self,
+        gst_rtp_buffer_get_timestamp (&rtp), GST_BUFFER_PTS (buffer),
+        distance, redundant_blocks);
+  } else {
+    redundant_blocks[0] = _red_history_get_redundant_block (self,
+        gst_rtp_buffer_get_timestamp (&rtp), distance);
+    n_redundant_blocks = redundant_blocks[0] ? 1 : 0;
+  }
+
   /* If can't get data for redundant block push the packet as is */
-  redundant_block = _red_history_get_redundant_block (self,
-      gst_rtp_buffer_get_timestamp (&rtp), distance);
-  if (NULL == redundant_block && only_with_redundant_data)
+  if (0 == n_redundant_blocks && only_with_redundant_data)
     return _push_nonred_packet (self, &rtp, buffer, distance);
 
   /* About to create RED packet with or without redundant data */
-  return _push_red_packet (self, &rtp, buffer, redundant_block, distance);
+  return _push_red_packet (self, &rtp, buffer, redundant_blocks,
+      n_redundant_blocks, distance);
 }
 
 static guint8
@@ -479,6 +628,15 @@ gst_rtp_red_enc_init (GstRtpRedEnc * self)
   self->num_sent = 0;
   self->rtp_history = g_queue_new ();
   self->ignoring_extension_warned = FALSE;
+
+  self->adaptive = DEFAULT_ADAPTIVE;
+  self->max_distance = DEFAULT_MAX_DISTANCE;
+  self->packet_loss_percentage = DEFAULT_PACKET_LOSS_PERCENTAGE;
+  self->target_loss_percentage = DEFAULT_TARGET_LOSS_PERCENTAGE;
+  self->max_redundancy_bitrate = DEFAULT_MAX_REDUNDANCY_BITRATE;
+  self->num_redundant_blocks = 0;
+  self->budget = 0;
+  self->budget_last_pts = GST_CLOCK_TIME_NONE;
 }
 
 
@@ -501,6 +659,21 @@ gst_rtp_red_enc_set_property (GObject * object, guint prop_id,
     case PROP_ALLOW_NO_RED_BLOCKS:
       self->allow_no_red_blocks = g_value_get_boolean (value);
       break;
+    case PROP_ADAPTIVE:
+      self->adaptive = g_value_get_boolean (value);
+      break;
+    case PROP_MAX_DISTANCE:
+      self->max_distance = g_value_get_uint (value);
+      break;
+    case PROP_PACKET_LOSS_PERCENTAGE:
+      self->packet_loss_percentage = g_value_get_double (value);
+      break;
+    case PROP_TARGET_LOSS_PERCENTAGE:
+      self->target_loss_percentage = g_value_get_double (value);
+      break;
+    case PROP_MAX_REDUNDANCY_BITRATE:
+      self->max_redundancy_bitrate = g_value_get_uint (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -525,6 +698,24 @@ gst_rtp_red_enc_get_property (GObject * object, guint prop_id,
     case PROP_ALLOW_NO_RED_BLOCKS:
       g_value_set_boolean (value, self->allow_no_red_blocks);
       break;
+    case PROP_ADAPTIVE:
+      g_value_set_boolean (value, self->adaptive);
+      break;
+    case PROP_MAX_DISTANCE:
+      g_value_set_uint (value, self->max_distance);
+      break;
+    case PROP_PACKET_LOSS_PERCENTAGE:
+      g_value_set_double (value, self->packet_loss_percentage);
+      break;
+    case PROP_TARGET_LOSS_PERCENTAGE:
+      g_value_set_double (value, self->target_loss_percentage);
+      break;
+    case PROP_MAX_REDUNDANCY_BITRATE:
+      g_value_set_uint (value, self->max_redundancy_bitrate);
+      break;
+    case PROP_NUM_REDUNDANT_BLOCKS:
+      g_value_set_uint (value, self->num_redundant_blocks);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -583,6 +774,94 @@ gst_rtp_red_enc_class_init (GstRtpRedEncClass * klass)
           DEFAULT_ALLOW_NO_RED_BLOCKS,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpRedEnc:adaptive:
+   *
+   * Choose the redundant blocks from the packet loss instead of using
+   * #GstRtpRedEnc:distance.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_ADAPTIVE,
+      g_param_spec_boolean ("adaptive", "Adaptive",
+          "Choose the number of redundant blocks from the packet loss",
+          DEFAULT_ADAPTIVE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpRedEnc:max-distance:
+   *
+   * In adaptive mode, the distance of the oldest packet that can be used as
+   * a redundant block, which is also the largest number of redundant blocks
+   * in a packet.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass), PROP_MAX_DISTANCE,
+      g_param_spec_uint ("max-distance", "Max RED distance",
+          "The largest distance of a redundant block in adaptive mode",
+          1, MAX_ADAPTIVE_DISTANCE, DEFAULT_MAX_DISTANCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpRedEnc:packet-loss-percentage:
+   *
+   * The packet loss of the link, as reported by the receiver. Used in
+   * adaptive mode.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_PACKET_LOSS_PERCENTAGE,
+      g_param_spec_double ("packet-loss-percentage", "Packet loss percentage",
+          "The packet loss reported by the receiver, for adaptive mode",
+          0.0, 100.0, DEFAULT_PACKET_LOSS_PERCENTAGE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpRedEnc:target-loss-percentage:
+   *
+   * In adaptive mode, the packet loss that is acceptable after the receiver
+   * recovered what it could from the redundant blocks.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_TARGET_LOSS_PERCENTAGE,
+      g_param_spec_double ("target-loss-percentage", "Target loss percentage",
+          "The packet loss to aim for after recovery in adaptive mode",
+          0.0, 100.0, DEFAULT_TARGET_LOSS_PERCENTAGE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpRedEnc:max-redundancy-bitrate:
+   *
+   * In adaptive mode, the most bits per second to spend on redundant
+   * blocks, 0 for no limit. The budget is tracked from the buffer
+   * timestamps.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_MAX_REDUNDANCY_BITRATE,
+      g_param_spec_uint ("max-redundancy-bitrate", "Max redundancy bitrate",
+          "The bitrate available for redundant blocks in adaptive mode "
+          "(0 = unlimited)", 0, G_MAXUINT, DEFAULT_MAX_REDUNDANCY_BITRATE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpRedEnc:num-redundant-blocks:
+   *
+   * The number of redundant blocks in the last packet sent in adaptive mode.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (G_OBJECT_CLASS (klass),
+      PROP_NUM_REDUNDANT_BLOCKS,
+      g_param_spec_uint ("num-redundant-blocks", "Number of redundant blocks",
+          "The number of redundant blocks in the last packet in adaptive mode",
+          0, MAX_ADAPTIVE_DISTANCE, 0,
+          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (gst_rtp_red_enc_debug, "rtpredenc", 0,
       "RTP RED Encoder");
 }
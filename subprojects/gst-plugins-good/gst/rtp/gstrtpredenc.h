@@ -53,6 +53,17 @@ struct _GstRtpRedEnc {
   guint distance;
   gboolean allow_no_red_blocks;
 
+  /* adaptive mode */
+  gboolean adaptive;
+  guint max_distance;
+  gdouble packet_loss_percentage;
+  gdouble target_loss_percentage;
+  guint max_redundancy_bitrate;
+  guint num_redundant_blocks;
+  /* the redundancy budget in bytes, refilled from the buffer timestamps */
+  gint64 budget;
+  GstClockTime budget_last_pts;
+
   GQueue *rtp_history;
   gboolean send_caps;
   gboolean is_current_caps_red;
@@ -215,6 +215,8 @@ gst_rtp_ulpfec_dec_recover_from_fec (GstRtpUlpFecDec * self,
   guint64 fec_mask = rtp_ulpfec_buffer_get_mask (&info_fec->rtp);
   gboolean fec_mask_long = rtp_ulpfec_buffer_get_fechdr (&info_fec->rtp)->L;
   guint16 fec_seq_base = rtp_ulpfec_buffer_get_seq_base (&info_fec->rtp);
+  GstRTPBuffer *rtps[RTP_ULPFEC_PROTECTED_PACKETS_MAX (TRUE)];
+  guint n_rtps = 0;
   GstBuffer *ret;
   GList *it;
 
@@ -230,10 +232,11 @@ gst_rtp_ulpfec_dec_recover_from_fec (GstRtpUlpFecDec * self,
 
     if (fec_mask & packet_mask) {
       fec_mask ^= packet_mask;
-      rtp_buffer_to_ulpfec_bitstring (&info->rtp, self->scratch_buf, FALSE,
-          fec_mask_long);
+      rtps[n_rtps++] = &info->rtp;
     }
   }
+  rtp_buffers_to_ulpfec_bitstring (rtps, n_rtps, self->scratch_buf,
+      fec_mask_long);
 
   ret =
       rtp_ulpfec_bitstring_to_media_rtp_buffer (self->scratch_buf,
@@ -229,6 +229,8 @@ gst_rtp_ulpfec_enc_stream_ctx_protect (GstRtpUlpFecEncStreamCtx * ctx,
   GstBuffer *ret;
   guint64 tmp_mask;
   gboolean fec_mask_long;
+  GstRTPBuffer *rtps[RTP_ULPFEC_PROTECTED_PACKETS_MAX (TRUE)];
+  guint n_rtps = 0;
   guint i;
 
   if (ctx->fec_packet_idx >= ctx->fec_packets)
@@ -249,12 +251,13 @@ gst_rtp_ulpfec_enc_stream_ctx_protect (GstRtpUlpFecEncStreamCtx * ctx,
 
     if (tmp_mask & packet_mask) {
       tmp_mask ^= packet_mask;
-      rtp_buffer_to_ulpfec_bitstring (&info->rtp, ctx->scratch_buf, FALSE,
-          fec_mask_long);
+      rtps[n_rtps++] = &info->rtp;
     }
   }
 
   g_assert (tmp_mask == 0);
+  rtp_buffers_to_ulpfec_bitstring (rtps, n_rtps, ctx->scratch_buf,
+      fec_mask_long);
   ret =
       rtp_ulpfec_bitstring_to_fec_rtp_buffer (ctx->scratch_buf, seq_base,
       fec_mask_long, fec_mask, FALSE, pt, seq, timestamp, ssrc);
@@ -67,6 +67,7 @@ enum
   PROP_0,
   PROP_WAIT_FOR_KEYFRAME,
   PROP_HIDE_PICTURE_ID_GAP,
+  PROP_NON_CONTIGUOUS_FRAMES,
 };
 
 typedef struct _GstVP8PacketInfo
@@ -92,6 +93,7 @@ typedef struct _GstVP8PacketInfo
 
 #define DEFAULT_WAIT_FOR_KEYFRAME FALSE
 #define DEFAULT_HIDE_PICTURE_ID_GAP FALSE
+#define DEFAULT_NON_CONTIGUOUS_FRAMES FALSE
 
 // VP8 Payload Descriptor Format
 // (see RFC:7741 Section-4.2)
@@ -242,6 +244,9 @@ gst_rtp_vp8_depay_set_property (GObject * object, guint prop_id,
     case PROP_HIDE_PICTURE_ID_GAP:
       self->hide_picture_id_gap = g_value_get_boolean (value);
       break;
+    case PROP_NON_CONTIGUOUS_FRAMES:
+      self->non_contiguous_frames = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -260,6 +265,9 @@ gst_rtp_vp8_depay_get_property (GObject * object, guint prop_id,
     case PROP_HIDE_PICTURE_ID_GAP:
       g_value_set_boolean (value, self->hide_picture_id_gap);
       break;
+    case PROP_NON_CONTIGUOUS_FRAMES:
+      g_value_set_boolean (value, self->non_contiguous_frames);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -272,6 +280,7 @@ gst_rtp_vp8_depay_init (GstRtpVP8Depay * self)
   self->adapter = gst_adapter_new ();
   self->started = FALSE;
   self->wait_for_keyframe = DEFAULT_WAIT_FOR_KEYFRAME;
+  self->non_contiguous_frames = DEFAULT_NON_CONTIGUOUS_FRAMES;
   self->last_pushed_was_lost_event = FALSE;
 }
 
@@ -315,6 +324,24 @@ gst_rtp_vp8_depay_class_init (GstRtpVP8DepayClass * gst_rtp_vp8_depay_class)
           "the picture ID", DEFAULT_HIDE_PICTURE_ID_GAP,
           G_PARAM_CONSTRUCT | G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpVP8Depay:non-contiguous-frames:
+   *
+   * Output frames as buffers made of the RTP payload memories instead of
+   * copying every frame that spans several packets into one contiguous
+   * allocation. Only enable this when downstream can handle buffers with
+   * multiple memories without mapping them as a whole. Frames made of more
+   * memories than a #GstBuffer can hold are still copied.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (object_class, PROP_NON_CONTIGUOUS_FRAMES,
+      g_param_spec_boolean ("non-contiguous-frames", "Non-contiguous Frames",
+          "Output frames as multi-memory buffers without copying the payloads "
+          "(downstream must handle non-contiguous input)",
+          DEFAULT_NON_CONTIGUOUS_FRAMES,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   GST_DEBUG_CATEGORY_INIT (gst_rtp_vp8_depay_debug, "rtpvp8depay", 0,
       "VP8 Video RTP Depayloader");
 }
@@ -478,6 +505,7 @@ gst_rtp_vp8_depay_reset_current_frame (GstRtpVP8Depay * self,
 
   GST_DEBUG_OBJECT (self, "%s, flushing adapter", reason);
   gst_adapter_clear (self->adapter);
+  self->adapter_n_memory = 0;
 
   // Preventing for flooding with gap_events
   if (!self->last_pushed_was_lost_event) {
@@ -497,9 +525,20 @@ static GstBuffer *
 gst_rtp_vp8_depay_get_frame (GstRtpVP8Depay * self,
     const GstVP8PacketInfo * packet_info, const GstVP8PFrameInfo * frame_info)
 {
-  /* mark keyframes */
-  GstBuffer *out = gst_adapter_take_buffer (self->adapter,
-      gst_adapter_available (self->adapter));
+  gsize avail = gst_adapter_available (self->adapter);
+  GstBuffer *out;
+
+  /* Hand out the payload memories as they are if downstream can cope with
+   * that, falling back to a single copy when the frame is spread over more
+   * memories than a buffer can hold, since appending beyond that limit
+   * would merge (and copy) the memories anyway */
+  if (self->non_contiguous_frames &&
+      self->adapter_n_memory <= gst_buffer_get_max_memory ()) {
+    out = gst_adapter_take_buffer_fast (self->adapter, avail);
+  } else {
+    out = gst_adapter_take_buffer (self->adapter, avail);
+  }
+  self->adapter_n_memory = 0;
 
   out = gst_buffer_make_writable (out);
 
@@ -602,9 +641,12 @@ gst_rtp_vp8_depay_process (GstRTPBaseDepayload * depay, GstRTPBuffer * rtp)
   }
 
   if (self->started) {
+    GstBuffer *payload =
+        gst_rtp_buffer_get_payload_subbuffer (rtp, packet_info.hdrsize, -1);
+
     /* Store rtp payload data in adapter */
-    gst_adapter_push (self->adapter, gst_rtp_buffer_get_payload_subbuffer (rtp,
-            packet_info.hdrsize, -1));
+    self->adapter_n_memory += gst_buffer_n_memory (payload);
+    gst_adapter_push (self->adapter, payload);
 
     /* Marker indicates that it was the last rtp packet for this frame */
     if (packet_info.end_of_frame) {
@@ -649,6 +691,8 @@ gst_rtp_vp8_depay_change_state (GstElement * element, GstStateChange transition)
       self->waiting_for_keyframe = TRUE;
       self->caps_sent = FALSE;
       self->last_picture_id = PICTURE_ID_NONE;
+      gst_adapter_clear (self->adapter);
+      self->adapter_n_memory = 0;
       if (self->last_lost_event) {
         gst_event_unref (self->last_lost_event);
         self->last_lost_event = NULL;
@@ -52,6 +52,7 @@ struct _GstRtpVP8Depay
 {
   GstRTPBaseDepayload parent;
   GstAdapter *adapter;
+  guint adapter_n_memory;
   gboolean started;
 
   gboolean caps_sent;
@@ -67,6 +68,7 @@ struct _GstRtpVP8Depay
   /* properties */
   gboolean wait_for_keyframe;
   gboolean hide_picture_id_gap;
+  gboolean non_contiguous_frames;
 };
 
 GType gst_rtp_vp8_depay_get_type (void);
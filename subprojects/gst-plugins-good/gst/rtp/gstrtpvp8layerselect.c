@@ -0,0 +1,183 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpvp8layerselect
+ * @title: rtpvp8layerselect
+ * @see_also: rtpvp9layerselect, rtpvp8depay
+ *
+ * Forwards the temporal layers of a VP8 RTP stream up to
+ * #GstRtpLayerSelect:target-temporal-layer and drops the rest, without
+ * depayloading. The sequence numbers and picture IDs of the forwarded
+ * packets are rewritten so the receiver sees a stream without gaps.
+ *
+ * When the input switches to another SSRC, like when an upstream selector
+ * switches between simulcast streams, the element waits for a key frame of
+ * the new stream and continues the SSRC, sequence numbers, timestamps,
+ * picture IDs and TL0PICIDX of the previous one.
+ *
+ * ## Example pipeline
+ * |[
+ * gst-launch-1.0 videotestsrc ! vp8enc temporal-scalability-number-layers=3 temporal-scalability-periodicity=4 temporal-scalability-layer-id="<0,2,1,2>" temporal-scalability-rate-decimator="<4,2,1>" temporal-scalability-target-bitrate="<100000,200000,400000>" ! rtpvp8pay picture-id-mode=15-bit ! rtpvp8layerselect target-temporal-layer=1 ! rtpvp8depay ! vp8dec ! autovideosink
+ * ]| Forward the two lowest of three temporal layers.
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstrtpelements.h"
+#include "gstrtpvp8layerselect.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_vp8_layer_select_debug);
+#define GST_CAT_DEFAULT (gst_rtp_vp8_layer_select_debug)
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, "
+        "clock-rate = (int) 90000, "
+        "media = (string) \"video\", "
+        "encoding-name = (string) { \"VP8\", \"VP8-DRAFT-IETF-01\" }"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, "
+        "clock-rate = (int) 90000, "
+        "media = (string) \"video\", "
+        "encoding-name = (string) { \"VP8\", \"VP8-DRAFT-IETF-01\" }"));
+
+#define gst_rtp_vp8_layer_select_parent_class parent_class
+G_DEFINE_TYPE (GstRtpVP8LayerSelect, gst_rtp_vp8_layer_select,
+    GST_TYPE_RTP_LAYER_SELECT);
+GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpvp8layerselect, "rtpvp8layerselect",
+    GST_RANK_NONE, GST_TYPE_RTP_VP8_LAYER_SELECT, rtp_element_init (plugin));
+
+/* VP8 Payload Descriptor, RFC 7741 section 4.2
+ *
+ *      0 1 2 3 4 5 6 7
+ *     +-+-+-+-+-+-+-+-+
+ *     |X|R|N|S|R| PID | (REQUIRED)
+ *     +-+-+-+-+-+-+-+-+
+ * X:  |I|L|T|K| RSV   | (OPTIONAL)
+ *     +-+-+-+-+-+-+-+-+
+ * I:  |M| PictureID   | (OPTIONAL)
+ *     +-+-+-+-+-+-+-+-+
+ *     |   PictureID   | (if M is set)
+ *     +-+-+-+-+-+-+-+-+
+ * L:  |   TL0PICIDX   | (OPTIONAL)
+ *     +-+-+-+-+-+-+-+-+
+ * T/K:|TID|Y| KEYIDX  | (OPTIONAL)
+ *     +-+-+-+-+-+-+-+-+
+ */
+static gboolean
+gst_rtp_vp8_layer_select_parse (GstRtpLayerSelect * select,
+    const guint8 * payload, guint size, gboolean marker, GstRtpLayerInfo * info)
+{
+  guint offset = 1;
+
+  if (G_UNLIKELY (size < 2))
+    return FALSE;
+
+  /* S bit and partition index 0 */
+  info->picture_start = (payload[0] & 0x17) == 0x10;
+  info->layer_end = marker;
+
+  if (payload[0] & 0x80) {
+    guint8 ext = payload[offset++];
+    gboolean has_tid = (ext & 0x20) != 0;
+
+    if (ext & 0x80) {
+      if (G_UNLIKELY (offset >= size))
+        return FALSE;
+      info->picture_id_offset = offset;
+      if (payload[offset] & 0x80) {
+        if (G_UNLIKELY (offset + 1 >= size))
+          return FALSE;
+        info->picture_id = GST_READ_UINT16_BE (payload + offset) & 0x7fff;
+        info->picture_id_15bits = TRUE;
+        offset += 2;
+      } else {
+        info->picture_id = payload[offset];
+        offset += 1;
+      }
+    }
+
+    if (ext & 0x40) {
+      if (G_UNLIKELY (offset >= size))
+        return FALSE;
+      /* TL0PICIDX must be ignored unless T is set */
+      if (has_tid) {
+        info->tl0picidx = payload[offset];
+        info->tl0picidx_offset = offset;
+      }
+      offset += 1;
+    }
+
+    if (ext & 0x30) {
+      if (G_UNLIKELY (offset >= size))
+        return FALSE;
+      if (has_tid) {
+        info->tid = payload[offset] >> 6;
+        info->switching_point = (payload[offset] & 0x20) != 0;
+      }
+      offset += 1;
+    }
+  }
+
+  if (G_UNLIKELY (offset >= size))
+    return FALSE;
+
+  /* the P bit of the VP8 frame tag is 0 for key frames */
+  info->keyframe = info->picture_start && (payload[offset] & 0x01) == 0;
+
+  GST_LOG_OBJECT (select, "picture id 0x%x, tid %u, Y %d, start %d, key %d",
+      info->picture_id, info->tid, info->switching_point, info->picture_start,
+      info->keyframe);
+
+  return TRUE;
+}
+
+static void
+gst_rtp_vp8_layer_select_class_init (GstRtpVP8LayerSelectClass * klass)
+{
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstRtpLayerSelectClass *select_class = GST_RTP_LAYER_SELECT_CLASS (klass);
+
+  gst_element_class_add_static_pad_template (element_class, &sink_template);
+  gst_element_class_add_static_pad_template (element_class, &src_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTP VP8 layer selector", "Codec/Filter/Network/RTP",
+      "Forwards the temporal layers of a VP8 RTP stream up to a target layer",
+      "Pexip <pexip.com>");
+
+  select_class->parse = GST_DEBUG_FUNCPTR (gst_rtp_vp8_layer_select_parse);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_vp8_layer_select_debug,
+      "rtpvp8layerselect", 0, "VP8 RTP layer selector");
+}
+
+static void
+gst_rtp_vp8_layer_select_init (GstRtpVP8LayerSelect * self)
+{
+}
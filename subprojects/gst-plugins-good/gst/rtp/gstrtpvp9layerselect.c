@@ -0,0 +1,229 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpvp9layerselect
+ * @title: rtpvp9layerselect
+ * @see_also: rtpvp8layerselect, rtpvp9depay
+ *
+ * Forwards the spatial and temporal layers of a VP9 RTP stream up to
+ * #GstRtpVP9LayerSelect:target-spatial-layer and
+ * #GstRtpLayerSelect:target-temporal-layer and drops the rest, without
+ * depayloading. The marker bit is set on the last packet of the highest
+ * forwarded spatial layer, and the sequence numbers and picture IDs of the
+ * forwarded packets are rewritten so the receiver sees a stream without
+ * gaps.
+ *
+ * When the input switches to another SSRC, the element waits for a key
+ * frame of the new stream and continues the SSRC, sequence numbers,
+ * timestamps, picture IDs and TL0PICIDX of the previous one.
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "gstrtpelements.h"
+#include "gstrtpvp9layerselect.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_vp9_layer_select_debug);
+#define GST_CAT_DEFAULT (gst_rtp_vp9_layer_select_debug)
+
+#define DEFAULT_TARGET_SPATIAL_LAYER -1
+
+enum
+{
+  PROP_0,
+  PROP_TARGET_SPATIAL_LAYER,
+};
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, "
+        "clock-rate = (int) 90000, "
+        "media = (string) \"video\", "
+        "encoding-name = (string) { \"VP9\", \"VP9-DRAFT-IETF-01\" }"));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS ("application/x-rtp, "
+        "clock-rate = (int) 90000, "
+        "media = (string) \"video\", "
+        "encoding-name = (string) { \"VP9\", \"VP9-DRAFT-IETF-01\" }"));
+
+#define gst_rtp_vp9_layer_select_parent_class parent_class
+G_DEFINE_TYPE (GstRtpVP9LayerSelect, gst_rtp_vp9_layer_select,
+    GST_TYPE_RTP_LAYER_SELECT);
+GST_ELEMENT_REGISTER_DEFINE_WITH_CODE (rtpvp9layerselect, "rtpvp9layerselect",
+    GST_RANK_NONE, GST_TYPE_RTP_VP9_LAYER_SELECT, rtp_element_init (plugin));
+
+/* VP9 Payload Descriptor, draft-ietf-payload-vp9
+ *
+ *      0 1 2 3 4 5 6 7
+ *     +-+-+-+-+-+-+-+-+
+ *     |I|P|L|F|B|E|V|-| (REQUIRED)
+ *     +-+-+-+-+-+-+-+-+
+ * I:  |M| PICTURE ID  | (RECOMMENDED)
+ *     +-+-+-+-+-+-+-+-+
+ * M:  | EXTENDED PID  | (RECOMMENDED)
+ *     +-+-+-+-+-+-+-+-+
+ * L:  |  T  |U|  S  |D| (CONDITIONALLY RECOMMENDED)
+ *     +-+-+-+-+-+-+-+-+
+ *     |   TL0PICIDX   | (CONDITIONALLY REQUIRED, not in flexible mode)
+ *     +-+-+-+-+-+-+-+-+
+ *
+ * followed by the reference indices and the scalability structure, which
+ * are left untouched.
+ */
+static gboolean
+gst_rtp_vp9_layer_select_parse (GstRtpLayerSelect * select,
+    const guint8 * payload, guint size, gboolean marker, GstRtpLayerInfo * info)
+{
+  gboolean inter_picture, begin;
+  guint offset = 1;
+
+  if (G_UNLIKELY (size < 2))
+    return FALSE;
+
+  inter_picture = (payload[0] & 0x40) != 0;
+  begin = (payload[0] & 0x08) != 0;
+  info->layer_end = (payload[0] & 0x04) != 0;
+
+  if (payload[0] & 0x80) {
+    if (G_UNLIKELY (offset >= size))
+      return FALSE;
+    info->picture_id_offset = offset;
+    if (payload[offset] & 0x80) {
+      if (G_UNLIKELY (offset + 1 >= size))
+        return FALSE;
+      info->picture_id = GST_READ_UINT16_BE (payload + offset) & 0x7fff;
+      info->picture_id_15bits = TRUE;
+      offset += 2;
+    } else {
+      info->picture_id = payload[offset];
+      offset += 1;
+    }
+  }
+
+  if (payload[0] & 0x20) {
+    if (G_UNLIKELY (offset >= size))
+      return FALSE;
+    info->tid = payload[offset] >> 5;
+    info->switching_point = (payload[offset] & 0x10) != 0;
+    info->sid = (payload[offset] >> 1) & 0x07;
+    offset += 1;
+
+    /* non-flexible mode */
+    if (!(payload[0] & 0x10)) {
+      if (G_UNLIKELY (offset >= size))
+        return FALSE;
+      info->tl0picidx = payload[offset];
+      info->tl0picidx_offset = offset;
+      offset += 1;
+    }
+  }
+
+  if (G_UNLIKELY (offset >= size))
+    return FALSE;
+
+  info->picture_start = begin && info->sid == 0;
+  info->keyframe = info->picture_start && !inter_picture;
+
+  GST_LOG_OBJECT (select, "picture id 0x%x, tid %u, sid %u, U %d, start %d, "
+      "key %d, end %d", info->picture_id, info->tid, info->sid,
+      info->switching_point, info->picture_start, info->keyframe,
+      info->layer_end);
+
+  return TRUE;
+}
+
+static void
+gst_rtp_vp9_layer_select_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpLayerSelect *select = GST_RTP_LAYER_SELECT (object);
+
+  switch (prop_id) {
+    case PROP_TARGET_SPATIAL_LAYER:
+      GST_OBJECT_LOCK (select);
+      select->target_spatial_layer = g_value_get_int (value);
+      GST_OBJECT_UNLOCK (select);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_vp9_layer_select_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpLayerSelect *select = GST_RTP_LAYER_SELECT (object);
+
+  switch (prop_id) {
+    case PROP_TARGET_SPATIAL_LAYER:
+      GST_OBJECT_LOCK (select);
+      g_value_set_int (value, select->target_spatial_layer);
+      GST_OBJECT_UNLOCK (select);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+}
+
+static void
+gst_rtp_vp9_layer_select_class_init (GstRtpVP9LayerSelectClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *element_class = GST_ELEMENT_CLASS (klass);
+  GstRtpLayerSelectClass *select_class = GST_RTP_LAYER_SELECT_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_vp9_layer_select_set_property;
+  gobject_class->get_property = gst_rtp_vp9_layer_select_get_property;
+
+  g_object_class_install_property (gobject_class, PROP_TARGET_SPATIAL_LAYER,
+      g_param_spec_int ("target-spatial-layer", "Target Spatial Layer",
+          "The highest spatial layer to forward (-1 = all)", -1, 7,
+          DEFAULT_TARGET_SPATIAL_LAYER,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_add_static_pad_template (element_class, &sink_template);
+  gst_element_class_add_static_pad_template (element_class, &src_template);
+
+  gst_element_class_set_static_metadata (element_class,
+      "RTP VP9 layer selector", "Codec/Filter/Network/RTP",
+      "Forwards the spatial and temporal layers of a VP9 RTP stream up to "
+      "a target layer", "Pexip <pexip.com>");
+
+  select_class->parse = GST_DEBUG_FUNCPTR (gst_rtp_vp9_layer_select_parse);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_vp9_layer_select_debug,
+      "rtpvp9layerselect", 0, "VP9 RTP layer selector");
+}
+
+static void
+gst_rtp_vp9_layer_select_init (GstRtpVP9LayerSelect * self)
+{
+}
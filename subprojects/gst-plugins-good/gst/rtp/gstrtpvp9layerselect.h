@@ -0,0 +1,53 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_RTP_VP9_LAYER_SELECT_H__
+#define __GST_RTP_VP9_LAYER_SELECT_H__
+
+#include "gstrtplayerselect.h"
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_RTP_VP9_LAYER_SELECT \
+  (gst_rtp_vp9_layer_select_get_type())
+#define GST_RTP_VP9_LAYER_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_RTP_VP9_LAYER_SELECT,GstRtpVP9LayerSelect))
+#define GST_RTP_VP9_LAYER_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_RTP_VP9_LAYER_SELECT,GstRtpVP9LayerSelectClass))
+#define GST_IS_RTP_VP9_LAYER_SELECT(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_RTP_VP9_LAYER_SELECT))
+#define GST_IS_RTP_VP9_LAYER_SELECT_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_RTP_VP9_LAYER_SELECT))
+
+typedef struct _GstRtpVP9LayerSelect GstRtpVP9LayerSelect;
+typedef struct _GstRtpVP9LayerSelectClass GstRtpVP9LayerSelectClass;
+
+struct _GstRtpVP9LayerSelectClass {
+  GstRtpLayerSelectClass parent_class;
+};
+
+struct _GstRtpVP9LayerSelect {
+  GstRtpLayerSelect parent;
+};
+
+GType gst_rtp_vp9_layer_select_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_VP9_LAYER_SELECT_H__ */
@@ -93,17 +93,11 @@ rtp_storage_get_packets_for_recovery (RtpStorage * self, gint fec_pt,
   if (NULL == stream) {
     GST_ERROR_OBJECT (self, "Can't find ssrc = 0x08%x", ssrc);
   } else {
-    STREAM_LOCK (stream);
-    if (stream->queue.length > 0) {
-      GST_LOG_OBJECT (self, "Looking for recovery packets for fec_pt=%u around"
-          " lost_seq=%u for ssrc=%08x", fec_pt, lost_seq, ssrc);
-      ret =
-          rtp_storage_stream_get_packets_for_recovery (stream, fec_pt,
-          lost_seq);
-    } else {
-      GST_DEBUG_OBJECT (self, "Empty RTP storage for ssrc=%08x", ssrc);
-    }
-    STREAM_UNLOCK (stream);
+    /* Does not block the streaming thread storing packets */
+    GST_LOG_OBJECT (self, "Looking for recovery packets for fec_pt=%u around"
+        " lost_seq=%u for ssrc=%08x", fec_pt, lost_seq, ssrc);
+    ret =
+        rtp_storage_stream_get_packets_for_recovery (stream, fec_pt, lost_seq);
   }
 
   return ret;
@@ -129,29 +123,71 @@ rtp_storage_get_redundant_packet (RtpStorage * self, guint32 ssrc,
   if (NULL == stream) {
     GST_ERROR_OBJECT (self, "Can't find ssrc = 0x%x", ssrc);
   } else {
-    STREAM_LOCK (stream);
-    if (stream->queue.length > 0) {
-      ret = rtp_storage_stream_get_redundant_packet (stream, lost_seq);
-    } else {
-      GST_DEBUG_OBJECT (self, "Empty RTP storage for ssrc=%08x", ssrc);
-    }
-    STREAM_UNLOCK (stream);
+    ret = rtp_storage_stream_get_redundant_packet (stream, lost_seq);
   }
 
   return ret;
 }
 
-static void
-rtp_storage_do_put_recovered_packet (RtpStorage * self,
-    GstBuffer * buffer, guint8 pt, guint32 ssrc, guint16 seq)
+GstBufferList *
+rtp_storage_get_packets_with_pt (RtpStorage * self, guint8 pt)
+{
+  GstBufferList *ret;
+  GHashTableIter iter;
+  gpointer value;
+
+  if (0 == self->size_time) {
+    GST_WARNING_OBJECT (self, "Received request for RTP packets with pt=%u,"
+        " but size is 0", pt);
+    return NULL;
+  }
+
+  ret = gst_buffer_list_new ();
+
+  STORAGE_LOCK (self);
+  g_hash_table_iter_init (&iter, self->streams);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    RtpStorageStream *stream = value;
+
+    rtp_storage_stream_collect_packets_with_pt (stream, pt, ret);
+  }
+  STORAGE_UNLOCK (self);
+
+  GST_LOG_OBJECT (self, "Found %u packets with pt=%u",
+      gst_buffer_list_length (ret), pt);
+
+  return ret;
+}
+
+static RtpStorageStream *
+rtp_storage_get_or_create_stream (RtpStorage * self, guint32 ssrc, guint8 pt)
 {
   RtpStorageStream *stream;
 
   STORAGE_LOCK (self);
+
   stream = g_hash_table_lookup (self->streams, GUINT_TO_POINTER (ssrc));
+  if (NULL == stream) {
+    GST_DEBUG_OBJECT (self,
+        "New media stream (ssrc=0x%08x, pt=%u) detected", ssrc, pt);
+    stream = rtp_storage_stream_new (ssrc, self->size_time);
+    g_hash_table_insert (self->streams, GUINT_TO_POINTER (ssrc), stream);
+  }
+
   STORAGE_UNLOCK (self);
 
-  g_assert (stream);
+  return stream;
+}
+
+static void
+rtp_storage_do_put_recovered_packet (RtpStorage * self,
+    GstBuffer * buffer, guint8 pt, guint32 ssrc, guint16 seq)
+{
+  RtpStorageStream *stream;
+
+  /* FlexFEC can recover packets of any of the protected streams, not only
+   * the ones we already stored packets for */
+  stream = rtp_storage_get_or_create_stream (self, ssrc, pt);
 
   GST_LOG_OBJECT (self,
       "Storing recovered RTP packet with ssrc=%08x pt=%u seq=%u %"
@@ -196,17 +232,7 @@ rtp_storage_append_buffer (RtpStorage * self, GstBuffer * buf)
   pt = gst_rtp_buffer_get_payload_type (&rtpbuf);
   seq = gst_rtp_buffer_get_seq (&rtpbuf);
 
-  STORAGE_LOCK (self);
-
-  stream = g_hash_table_lookup (self->streams, GUINT_TO_POINTER (ssrc));
-  if (NULL == stream) {
-    GST_DEBUG_OBJECT (self,
-        "New media stream (ssrc=0x%08x, pt=%u) detected", ssrc, pt);
-    stream = rtp_storage_stream_new (ssrc);
-    g_hash_table_insert (self->streams, GUINT_TO_POINTER (ssrc), stream);
-  }
-
-  STORAGE_UNLOCK (self);
+  stream = rtp_storage_get_or_create_stream (self, ssrc, pt);
 
   GST_LOG_OBJECT (self,
       "Storing RTP packet with ssrc=%08x pt=%u seq=%u %" GST_PTR_FORMAT,
@@ -56,6 +56,7 @@ void            rtp_storage_put_recovered_packet     (RtpStorage * self, GstBuff
                                                       guint8 pt, guint32 ssrc, guint16 seq);
 GstBuffer     * rtp_storage_get_redundant_packet     (RtpStorage * self, guint32 ssrc,
                                                       guint16 lost_seq);
+GstBufferList * rtp_storage_get_packets_with_pt      (RtpStorage * self, guint8 pt);
 gboolean        rtp_storage_append_buffer            (RtpStorage *self, GstBuffer *buffer);
 void            rtp_storage_clear                    (RtpStorage *self);
 RtpStorage    * rtp_storage_new                      (void);
@@ -18,100 +18,294 @@
  * Author: Mikhail Fludkov <misha@pexip.com>
  */
 
+
 #include "rtpstoragestream.h"
 
 #define GST_CAT_DEFAULT (gst_rtp_storage_debug)
 
-static RtpStorageItem *
-rtp_storage_item_new (GstBuffer * buffer, guint8 pt, guint16 seq)
+/* The ring is first sized for this many packets per second of size-time,
+ * and grows when a stream sends more */
+#define PRESIZE_PACKET_RATE (500)
+#define MIN_RING_SIZE (16)
+#define MAX_RING_SIZE (32768)
+
+/* These match RTP_MAX_DROPOUT and RTP_MAX_MISORDER of the jitterbuffer */
+#define MAX_DROPOUT (3000)
+#define MAX_MISORDER (100)
+
+/* How often a reader tries without the lock before waiting for the writer */
+#define MAX_READ_ATTEMPTS (4)
+
+static RtpStorageRing *
+rtp_storage_ring_new (guint size)
 {
-  RtpStorageItem *ret = g_slice_new0 (RtpStorageItem);
-  ret->buffer = buffer;
-  ret->pt = pt;
-  ret->seq = seq;
-  return ret;
+  RtpStorageRing *ring = g_new (RtpStorageRing, 1);
+
+  g_assert ((size & (size - 1)) == 0);
+  ring->mask = size - 1;
+  ring->items = g_new0 (RtpStorageItem, size);
+  return ring;
+}
+
+static void
+rtp_storage_ring_free (RtpStorageRing * ring)
+{
+  g_free (ring->items);
+  g_free (ring);
+}
+
+/* Returns the buffer with @seq, without a ref, or NULL. Writers set the
+ * buffer last, so @pt is the one of the buffer unless a writer is in the
+ * middle of changing the item, which readers detect afterwards. */
+static GstBuffer *
+rtp_storage_ring_peek (RtpStorageRing * ring, guint16 seq, guint8 * pt)
+{
+  RtpStorageItem *item = &ring->items[seq & ring->mask];
+  GstBuffer *buffer = g_atomic_pointer_get (&item->buffer);
+  gint key;
+
+  if (buffer == NULL)
+    return NULL;
+
+  key = g_atomic_int_get (&item->key);
+  if (ITEM_KEY_SEQ (key) != seq)
+    return NULL;
+  if (pt)
+    *pt = ITEM_KEY_PT (key);
+  return buffer;
+}
+
+static guint
+rtp_storage_ring_size_for (guint n_packets)
+{
+  guint size = MIN_RING_SIZE;
+
+  while (size < n_packets && size < MAX_RING_SIZE)
+    size <<= 1;
+  return size;
 }
 
+/* Writers */
+
 static void
-rtp_storage_item_free (RtpStorageItem * item)
+rtp_storage_stream_write_begin (RtpStorageStream * stream)
 {
-  g_assert (item->buffer != NULL);
-  gst_buffer_unref (item->buffer);
-  g_slice_free (RtpStorageItem, item);
+  g_atomic_int_inc (&stream->sequence);
 }
 
-static gint
-rtp_storage_item_compare (gconstpointer a, gconstpointer b, gpointer userdata)
+/* Releases what was taken out of the ring once no reader is looking, must be
+ * called with the stream_lock. Readers that come in from now on can't find
+ * anything that was retired before. */
+static void
+rtp_storage_stream_reclaim (RtpStorageStream * stream)
 {
-  gint seq_diff = gst_rtp_buffer_compare_seqnum (
-      ((RtpStorageItem const *) a)->seq, ((RtpStorageItem const *) b)->seq);
+  guint i;
+
+  if (g_atomic_int_get (&stream->readers) != 0)
+    return;
 
-  if (seq_diff >= 0)
-    return 0;
+  for (i = 0; i < stream->retired_buffers->len; i++)
+    gst_buffer_unref (g_ptr_array_index (stream->retired_buffers, i));
+  g_ptr_array_set_size (stream->retired_buffers, 0);
 
-  return 1;
+  g_slist_free_full (stream->retired_rings,
+      (GDestroyNotify) rtp_storage_ring_free);
+  stream->retired_rings = NULL;
+}
+
+static void
+rtp_storage_stream_write_end (RtpStorageStream * stream)
+{
+  gint range = -1;
+
+  if (stream->length > 0)
+    range = (gint) (stream->tail_seq |
+        ((guint) (guint16) (stream->head_seq - stream->tail_seq) << 16));
+  g_atomic_int_set (&stream->range, range);
+
+  g_atomic_int_inc (&stream->sequence);
+
+  rtp_storage_stream_reclaim (stream);
+}
+
+static void
+rtp_storage_stream_evict_tail (RtpStorageStream * stream)
+{
+  RtpStorageRing *ring = stream->ring;
+  RtpStorageItem *item = &ring->items[stream->tail_seq & ring->mask];
+
+  g_assert (stream->length > 0);
+  g_assert (item->buffer != NULL
+      && ITEM_KEY_SEQ (item->key) == stream->tail_seq);
+
+  GST_TRACE ("Removing pt=%d seq=%d for ssrc=%08x", ITEM_KEY_PT (item->key),
+      stream->tail_seq, stream->ssrc);
+
+  g_ptr_array_add (stream->retired_buffers, item->buffer);
+  g_atomic_pointer_set (&item->buffer, NULL);
+  stream->length--;
+
+  /* The next oldest packet becomes the tail */
+  while (stream->length > 0) {
+    stream->tail_seq++;
+    if (rtp_storage_ring_peek (ring, stream->tail_seq, NULL))
+      break;
+  }
+}
+
+static void
+rtp_storage_stream_evict_all (RtpStorageStream * stream)
+{
+  while (stream->length > 0)
+    rtp_storage_stream_evict_tail (stream);
+}
+
+/* Moves the packets to a ring that can hold @n_packets seqnums */
+static gboolean
+rtp_storage_stream_grow (RtpStorageStream * stream, guint n_packets)
+{
+  RtpStorageRing *ring = stream->ring;
+  RtpStorageRing *new_ring;
+  guint i, span;
+
+  if (n_packets > MAX_RING_SIZE)
+    return FALSE;
+
+  new_ring = rtp_storage_ring_new (rtp_storage_ring_size_for (n_packets));
+  GST_DEBUG ("Growing ring for ssrc=%08x from %u to %u packets", stream->ssrc,
+      ring->mask + 1, new_ring->mask + 1);
+
+  span = stream->length ? (guint16) (stream->head_seq - stream->tail_seq) + 1
+      : 0;
+  for (i = 0; i < span; i++) {
+    guint16 seq = stream->tail_seq + i;
+
+    if (rtp_storage_ring_peek (ring, seq, NULL))
+      new_ring->items[seq & new_ring->mask] = ring->items[seq & ring->mask];
+  }
+
+  g_atomic_pointer_set (&stream->ring, new_ring);
+  stream->retired_rings = g_slist_prepend (stream->retired_rings, ring);
+  return TRUE;
 }
 
 static void
 rtp_storage_stream_resize (RtpStorageStream * stream, GstClockTime size_time)
 {
-  GList *it;
-  guint i, too_old_buffers_num = 0;
+  RtpStorageRing *ring = stream->ring;
+  guint i, span;
+  guint16 too_old_seq = 0;
+  gboolean found_too_old = FALSE;
 
   g_assert (GST_CLOCK_TIME_IS_VALID (stream->max_arrival_time));
   g_assert (GST_CLOCK_TIME_IS_VALID (size_time));
   g_assert_cmpint (size_time, >, 0);
 
+  if (stream->length == 0)
+    return;
+
   /* Iterating from oldest sequence numbers to newest */
-  for (i = 0, it = stream->queue.tail; it; it = it->prev, ++i) {
-    RtpStorageItem *item = it->data;
-    GstClockTime arrival_time = GST_BUFFER_DTS_OR_PTS (item->buffer);
+  span = (guint16) (stream->head_seq - stream->tail_seq) + 1;
+  for (i = 0; i < span; i++) {
+    guint16 seq = stream->tail_seq + i;
+    GstBuffer *buffer = rtp_storage_ring_peek (ring, seq, NULL);
+    GstClockTime arrival_time;
+
+    if (!buffer)
+      continue;
+
+    arrival_time = GST_BUFFER_DTS_OR_PTS (buffer);
     if (GST_CLOCK_TIME_IS_VALID (arrival_time)) {
       if (stream->max_arrival_time - arrival_time > size_time) {
-        too_old_buffers_num = i + 1;
+        too_old_seq = seq;
+        found_too_old = TRUE;
       } else
         break;
     }
   }
 
-  for (i = 0; i < too_old_buffers_num; ++i) {
-    RtpStorageItem *item = g_queue_pop_tail (&stream->queue);
-
-    GST_TRACE ("Removing %u/%u buffers, pt=%d seq=%d for ssrc=%08x",
-        i, too_old_buffers_num, item->pt, item->seq, stream->ssrc);
+  if (!found_too_old)
+    return;
 
-    rtp_storage_item_free (item);
-  }
+  while (stream->length > 0 &&
+      gst_rtp_buffer_compare_seqnum (stream->tail_seq, too_old_seq) >= 0)
+    rtp_storage_stream_evict_tail (stream);
 }
 
-/* This algorithm corresponds to rtp_jitter_buffer_get_seqnum_diff(),
- * we want to keep the same number of packets in the worse case.
- */
-
-static guint16
-rtp_storage_stream_get_seqnum_diff (RtpStorageStream * stream)
+/* Makes room for @seq, returns FALSE if the packet should not be stored */
+static gboolean
+rtp_storage_stream_make_room (RtpStorageStream * stream, guint16 seq)
 {
-  guint32 high_seqnum, low_seqnum;
-  RtpStorageItem *high_item, *low_item;
-  guint16 result;
+  guint size = stream->ring->mask + 1;
+  gint diff;
+  guint span;
+
+  if (stream->length == 0) {
+    stream->head_seq = stream->tail_seq = seq;
+    return TRUE;
+  }
 
+  diff = gst_rtp_buffer_compare_seqnum (stream->head_seq, seq);
+  if (diff > 0) {
+    /* Newer than anything we have */
+    span = (guint16) (seq - stream->tail_seq) + 1;
+    if (span > size) {
+      if (diff >= MAX_DROPOUT || !rtp_storage_stream_grow (stream, span)) {
+        while (stream->length > 0 &&
+            (guint16) (seq - stream->tail_seq) + 1 > size)
+          rtp_storage_stream_evict_tail (stream);
+      }
+    }
+    if (stream->length == 0)
+      stream->tail_seq = seq;
+    stream->head_seq = seq;
+  } else if (gst_rtp_buffer_compare_seqnum (stream->tail_seq, seq) < 0) {
+    /* Older than anything we have */
+    span = (guint16) (stream->head_seq - seq) + 1;
+    if (span > size) {
+      if (-diff >= MAX_DROPOUT) {
+        GST_DEBUG ("Seqnum jumped back from %u to %u for ssrc=%08x, "
+            "starting over", stream->head_seq, seq, stream->ssrc);
+        rtp_storage_stream_evict_all (stream);
+        stream->head_seq = seq;
+      } else if (-diff > MAX_MISORDER ||
+          !rtp_storage_stream_grow (stream, span)) {
+        GST_DEBUG ("Not storing too old packet seq=%u for ssrc=%08x", seq,
+            stream->ssrc);
+        return FALSE;
+      }
+    }
+    stream->tail_seq = seq;
+  }
 
-  high_item = (RtpStorageItem *) g_queue_peek_head (&stream->queue);
-  low_item = (RtpStorageItem *) g_queue_peek_tail (&stream->queue);
+  return TRUE;
+}
 
-  if (!high_item || !low_item || high_item == low_item)
-    return 0;
+static void
+rtp_storage_stream_insert (RtpStorageStream * stream, GstBuffer * buffer,
+    guint8 pt, guint16 seq)
+{
+  RtpStorageRing *ring;
+  RtpStorageItem *item;
 
-  high_seqnum = high_item->seq;
-  low_seqnum = low_item->seq;
+  if (!rtp_storage_stream_make_room (stream, seq)) {
+    gst_buffer_unref (buffer);
+    return;
+  }
 
-  /* it needs to work if seqnum wraps */
-  if (high_seqnum >= low_seqnum) {
-    result = (guint32) (high_seqnum - low_seqnum);
+  ring = stream->ring;
+  item = &ring->items[seq & ring->mask];
+  if (item->buffer) {
+    /* The same packet again, a recovered one most likely */
+    g_assert (ITEM_KEY_SEQ (item->key) == seq);
+    g_ptr_array_add (stream->retired_buffers, item->buffer);
+    g_atomic_pointer_set (&item->buffer, NULL);
   } else {
-    result = (guint32) (high_seqnum + G_MAXUINT16 + 1 - low_seqnum);
+    stream->length++;
   }
-  return result;
+
+  g_atomic_int_set (&item->key, ITEM_KEY (seq, pt));
+  g_atomic_pointer_set (&item->buffer, buffer);
 }
 
 void
@@ -120,18 +314,18 @@ rtp_storage_stream_resize_and_add_item (RtpStorageStream * stream,
 {
   GstClockTime arrival_time = GST_BUFFER_DTS_OR_PTS (buffer);
 
+  rtp_storage_stream_write_begin (stream);
+
   /* These limits match those of the jittebuffer, we keep a couple more
    * packets to avoid races as it can be queried after the output of the
    * jitterbuffer.
    */
-  if (rtp_storage_stream_get_seqnum_diff (stream) >= 32765 ||
-      stream->queue.length > 10100) {
-    RtpStorageItem *item = g_queue_pop_tail (&stream->queue);
-
-    GST_WARNING ("Queue too big, removing pt=%d seq=%d for ssrc=%08x",
-        item->pt, item->seq, stream->ssrc);
-
-    rtp_storage_item_free (item);
+  while (stream->length > 0 &&
+      ((guint16) (stream->head_seq - stream->tail_seq) >= 32765 ||
+          stream->length > 10100)) {
+    GST_WARNING ("Queue too big, removing seq=%d for ssrc=%08x",
+        stream->tail_seq, stream->ssrc);
+    rtp_storage_stream_evict_tail (stream);
   }
 
   if (G_LIKELY (GST_CLOCK_TIME_IS_VALID (arrival_time))) {
@@ -141,18 +335,27 @@ rtp_storage_stream_resize_and_add_item (RtpStorageStream * stream,
       stream->max_arrival_time = arrival_time;
 
     rtp_storage_stream_resize (stream, size_time);
-    rtp_storage_stream_add_item (stream, buffer, pt, seq);
-  } else {
-    rtp_storage_stream_add_item (stream, buffer, pt, seq);
   }
+  rtp_storage_stream_insert (stream, buffer, pt, seq);
+
+  rtp_storage_stream_write_end (stream);
 }
 
 RtpStorageStream *
-rtp_storage_stream_new (guint32 ssrc)
+rtp_storage_stream_new (guint32 ssrc, GstClockTime size_time)
 {
   RtpStorageStream *ret = g_slice_new0 (RtpStorageStream);
+  guint n_packets = 0;
+
+  if (GST_CLOCK_TIME_IS_VALID (size_time))
+    n_packets = gst_util_uint64_scale (size_time, PRESIZE_PACKET_RATE,
+        GST_SECOND);
+
   ret->max_arrival_time = GST_CLOCK_TIME_NONE;
   ret->ssrc = ssrc;
+  ret->range = -1;
+  ret->ring = rtp_storage_ring_new (rtp_storage_ring_size_for (n_packets));
+  ret->retired_buffers = g_ptr_array_new ();
   g_mutex_init (&ret->stream_lock);
   return ret;
 }
@@ -161,9 +364,15 @@ void
 rtp_storage_stream_free (RtpStorageStream * stream)
 {
   STREAM_LOCK (stream);
-  while (stream->queue.length)
-    rtp_storage_item_free (g_queue_pop_tail (&stream->queue));
+  rtp_storage_stream_write_begin (stream);
+  rtp_storage_stream_evict_all (stream);
+  rtp_storage_stream_write_end (stream);
   STREAM_UNLOCK (stream);
+
+  g_assert_cmpint (stream->readers, ==, 0);
+  g_assert (stream->retired_buffers->len == 0);
+  g_ptr_array_free (stream->retired_buffers, TRUE);
+  rtp_storage_ring_free (stream->ring);
   g_mutex_clear (&stream->stream_lock);
   g_slice_free (RtpStorageStream, stream);
 }
@@ -172,22 +381,91 @@ void
 rtp_storage_stream_add_item (RtpStorageStream * stream, GstBuffer * buffer,
     guint8 pt, guint16 seq)
 {
-  RtpStorageItem *item = rtp_storage_item_new (buffer, pt, seq);
-  GList *sibling = g_queue_find_custom (&stream->queue, item,
-      (GCompareFunc) rtp_storage_item_compare);
+  rtp_storage_stream_write_begin (stream);
+  rtp_storage_stream_insert (stream, buffer, pt, seq);
+  rtp_storage_stream_write_end (stream);
+}
+
+/* Readers */
 
-  g_queue_insert_before (&stream->queue, sibling, item);
+static void
+rtp_storage_stream_reader_enter (RtpStorageStream * stream)
+{
+  g_atomic_int_inc (&stream->readers);
 }
 
-GstBufferList *
-rtp_storage_stream_get_packets_for_recovery (RtpStorageStream * stream,
+static void
+rtp_storage_stream_reader_leave (RtpStorageStream * stream)
+{
+  /* The writer only releases what it retired when no reader is looking, which
+   * might never be the case at the end of a write under steady lookups. The
+   * last reader to leave does it then, unless a writer is busy and will do
+   * it itself at the end of its write. */
+  if (g_atomic_int_dec_and_test (&stream->readers)
+      && g_mutex_trylock (&stream->stream_lock)) {
+    rtp_storage_stream_reclaim (stream);
+    STREAM_UNLOCK (stream);
+  }
+}
+
+/* Returns FALSE while a writer is changing the ring */
+static gboolean
+rtp_storage_stream_read_begin (RtpStorageStream * stream, gint * sequence)
+{
+  *sequence = g_atomic_int_get (&stream->sequence);
+  return (*sequence & 1) == 0;
+}
+
+/* Returns FALSE if a writer changed the ring since the read began */
+static gboolean
+rtp_storage_stream_read_end (RtpStorageStream * stream, gint sequence)
+{
+  return g_atomic_int_get (&stream->sequence) == sequence;
+}
+
+/* The oldest and newest seqnum of the ring, FALSE if the ring is empty or
+ * the reader saw it half way through a change */
+static gboolean
+rtp_storage_stream_get_range (RtpStorageStream * stream, RtpStorageRing * ring,
+    guint16 * tail_seq, guint16 * head_seq)
+{
+  gint range = g_atomic_int_get (&stream->range);
+  guint16 span;
+
+  if (range < 0)
+    return FALSE;
+
+  span = (guint16) ((guint) range >> 16);
+  *tail_seq = (guint16) (range & 0xffff);
+  *head_seq = *tail_seq + span;
+  return span <= ring->mask;
+}
+
+static GstBufferList *
+rtp_storage_stream_find_packets_for_recovery (RtpStorageStream * stream,
     guint8 pt_fec, guint16 lost_seq)
 {
-  guint ret_length = 0;
-  GList *end = NULL;
-  GList *start = NULL;
-  gboolean saw_fec = TRUE;      /* To initialize the start pointer in the loop below */
-  GList *it;
+  RtpStorageRing *ring = g_atomic_pointer_get (&stream->ring);
+  GstBufferList *ret;
+  GstBuffer *buffer;
+  guint16 tail_seq, head_seq, seq, start, end = 0;
+  gboolean found_fec = FALSE, in_media = FALSE;
+  guint8 pt;
+
+  if (!rtp_storage_stream_get_range (stream, ring, &tail_seq, &head_seq))
+    return NULL;
+
+  /* Is the buffer we lost in the storage? It can happen if:
+   * - it could have arrived right after it was considered lost (more of a
+   *   corner case)
+   * - it was recovered together with the other lost packet (most likely)
+   */
+  buffer = rtp_storage_ring_peek (ring, lost_seq, NULL);
+  if (buffer) {
+    ret = gst_buffer_list_new_sized (1);
+    gst_buffer_list_add (ret, gst_buffer_ref (buffer));
+    return ret;
+  }
 
   /* Looking for media stream chunk with FEC packets at the end, which could
    * can have the lost packet. For example:
@@ -197,81 +475,189 @@ rtp_storage_stream_get_packets_for_recovery (RtpStorageStream * stream,
    * Say @lost_seq = 7. Want to return bufferlist with packets [#6 : #10]. Other
    * packets are not relevant for recovery of packet 7.
    *
-   * Or the lost packet can be in the storage. In that case single packet is returned.
-   * It can happen if:
-   * - it could have arrived right after it was considered lost (more of a corner case)
-   * - it was recovered together with the other lost packet (most likely)
+   * The end is the first FEC packet from @lost_seq on that is followed by a
+   * media packet, or by nothing.
    */
-  for (it = stream->queue.tail; it; it = it->prev) {
-    RtpStorageItem *item = it->data;
-    gboolean found_end = FALSE;
-
-    /* Is the buffer we lost in the storage? */
-    if (item->seq == lost_seq) {
-      start = it;
-      end = it;
-      ret_length = 1;
-      break;
+  if (gst_rtp_buffer_compare_seqnum (head_seq, lost_seq) > 0)
+    return NULL;
+
+  seq = gst_rtp_buffer_compare_seqnum (tail_seq, lost_seq) > 0 ?
+      lost_seq : tail_seq;
+  for (;; seq++) {
+    if (rtp_storage_ring_peek (ring, seq, &pt)) {
+      if (pt_fec == pt) {
+        found_fec = TRUE;
+        end = seq;
+      } else if (found_fec) {
+        break;
+      }
     }
+    if (seq == head_seq)
+      break;
+  }
 
-    if (pt_fec == item->pt) {
-      gint seq_diff = gst_rtp_buffer_compare_seqnum (lost_seq, item->seq);
-
-      if (seq_diff >= 0) {
-        if (it->prev) {
-          gboolean media_next =
-              pt_fec != ((RtpStorageItem *) it->prev->data)->pt;
-          found_end = media_next;
-        } else
-          found_end = TRUE;
+  if (!found_fec)
+    return NULL;
+
+  /* The start is the first media packet after the FEC packets protecting
+   * the previous chunk */
+  start = end;
+  for (seq = end;; seq--) {
+    if (rtp_storage_ring_peek (ring, seq, &pt)) {
+      if (pt_fec != pt) {
+        in_media = TRUE;
+        start = seq;
+      } else if (in_media) {
+        break;
       }
-      saw_fec = TRUE;
-    } else if (saw_fec) {
-      saw_fec = FALSE;
-      start = it;
-      ret_length = 0;
     }
+    if (seq == tail_seq)
+      break;
+  }
 
-    ++ret_length;
-    if (found_end) {
-      end = it;
+  ret = gst_buffer_list_new_sized ((guint16) (end - start) + 1);
+  for (seq = start;; seq++) {
+    buffer = rtp_storage_ring_peek (ring, seq, NULL);
+    if (buffer)
+      gst_buffer_list_add (ret, gst_buffer_ref (buffer));
+    if (seq == end)
       break;
-    }
   }
 
-  if (end && !start)
-    start = end;
+  return ret;
+}
 
-  if (start && end) {
-    GstBufferList *ret = gst_buffer_list_new_sized (ret_length);
-    GList *it;
+GstBufferList *
+rtp_storage_stream_get_packets_for_recovery (RtpStorageStream * stream,
+    guint8 pt_fec, guint16 lost_seq)
+{
+  GstBufferList *ret = NULL;
+  gint sequence, attempt;
 
-    GST_LOG ("Found %u buffers with lost seq=%d for ssrc=%08x, creating %"
-        GST_PTR_FORMAT, ret_length, lost_seq, stream->ssrc, ret);
+  rtp_storage_stream_reader_enter (stream);
 
-    for (it = start; it != end->prev; it = it->prev)
-      gst_buffer_list_add (ret,
-          gst_buffer_ref (((RtpStorageItem *) it->data)->buffer));
-    return ret;
+  for (attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+    if (!rtp_storage_stream_read_begin (stream, &sequence))
+      continue;
+
+    ret = rtp_storage_stream_find_packets_for_recovery (stream, pt_fec,
+        lost_seq);
+    if (rtp_storage_stream_read_end (stream, sequence))
+      goto done;
+
+    if (ret)
+      gst_buffer_list_unref (ret);
   }
 
-  return NULL;
+  /* The writer is busy with this stream, wait for it */
+  STREAM_LOCK (stream);
+  ret = rtp_storage_stream_find_packets_for_recovery (stream, pt_fec,
+      lost_seq);
+  STREAM_UNLOCK (stream);
+
+done:
+  rtp_storage_stream_reader_leave (stream);
+
+  if (ret)
+    GST_LOG ("Found %u buffers with lost seq=%d for ssrc=%08x, creating %"
+        GST_PTR_FORMAT, gst_buffer_list_length (ret), lost_seq, stream->ssrc,
+        ret);
+
+  return ret;
+}
+
+static GstBuffer *
+rtp_storage_stream_find_packet (RtpStorageStream * stream, guint16 seq)
+{
+  RtpStorageRing *ring = g_atomic_pointer_get (&stream->ring);
+  GstBuffer *buffer = rtp_storage_ring_peek (ring, seq, NULL);
+
+  return buffer ? gst_buffer_ref (buffer) : NULL;
 }
 
 GstBuffer *
 rtp_storage_stream_get_redundant_packet (RtpStorageStream * stream,
     guint16 lost_seq)
 {
-  GList *it;
-  for (it = stream->queue.head; it; it = it->next) {
-    RtpStorageItem *item = it->data;
-    if (item->seq == lost_seq) {
-      GST_LOG ("Found buffer pt=%u seq=%u for ssrc=%08x %" GST_PTR_FORMAT,
-          item->pt, item->seq, stream->ssrc, item->buffer);
-      return gst_buffer_ref (item->buffer);
-    }
+  GstBuffer *ret = NULL;
+  gint sequence, attempt;
+
+  rtp_storage_stream_reader_enter (stream);
+
+  for (attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+    if (!rtp_storage_stream_read_begin (stream, &sequence))
+      continue;
+
+    ret = rtp_storage_stream_find_packet (stream, lost_seq);
+    if (rtp_storage_stream_read_end (stream, sequence))
+      goto done;
+
+    gst_clear_buffer (&ret);
+  }
+
+  STREAM_LOCK (stream);
+  ret = rtp_storage_stream_find_packet (stream, lost_seq);
+  STREAM_UNLOCK (stream);
+
+done:
+  rtp_storage_stream_reader_leave (stream);
+
+  if (ret)
+    GST_LOG ("Found buffer seq=%u for ssrc=%08x %" GST_PTR_FORMAT,
+        lost_seq, stream->ssrc, ret);
+  else
+    GST_DEBUG ("Could not find packet with seq=%u for ssrc=%08x",
+        lost_seq, stream->ssrc);
+
+  return ret;
+}
+
+static void
+rtp_storage_stream_find_packets_with_pt (RtpStorageStream * stream, guint8 pt,
+    GstBufferList * list)
+{
+  RtpStorageRing *ring = g_atomic_pointer_get (&stream->ring);
+  guint16 tail_seq, head_seq, seq;
+
+  if (!rtp_storage_stream_get_range (stream, ring, &tail_seq, &head_seq))
+    return;
+
+  /* Oldest first */
+  for (seq = tail_seq;; seq++) {
+    guint8 item_pt;
+    GstBuffer *buffer = rtp_storage_ring_peek (ring, seq, &item_pt);
+
+    if (buffer && item_pt == pt)
+      gst_buffer_list_add (list, gst_buffer_ref (buffer));
+    if (seq == head_seq)
+      break;
   }
-  GST_DEBUG ("Could not find packet with seq=%u for ssrc=%08x",
-      lost_seq, stream->ssrc);
-  return NULL;
+}
+
+void
+rtp_storage_stream_collect_packets_with_pt (RtpStorageStream * stream,
+    guint8 pt, GstBufferList * list)
+{
+  guint len = gst_buffer_list_length (list);
+  gint sequence, attempt;
+
+  rtp_storage_stream_reader_enter (stream);
+
+  for (attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+    if (!rtp_storage_stream_read_begin (stream, &sequence))
+      continue;
+
+    rtp_storage_stream_find_packets_with_pt (stream, pt, list);
+    if (rtp_storage_stream_read_end (stream, sequence))
+      goto done;
+
+    gst_buffer_list_remove (list, len, gst_buffer_list_length (list) - len);
+  }
+
+  STREAM_LOCK (stream);
+  rtp_storage_stream_find_packets_with_pt (stream, pt, list);
+  STREAM_UNLOCK (stream);
+
+done:
+  rtp_storage_stream_reader_leave (stream);
 }
@@ -25,23 +25,55 @@
 
 GST_DEBUG_CATEGORY_EXTERN (gst_rtp_storage_debug);
 
+/* The seqnum and payload type of an item are kept in one integer, so that
+ * readers can load them atomically */
 typedef struct {
   GstBuffer *buffer;
-  guint16 seq;
-  guint8 pt;
+  gint key;
 } RtpStorageItem;
 
+#define ITEM_KEY(seq,pt) ((gint) ((guint16) (seq) | ((guint) (pt) << 16)))
+#define ITEM_KEY_SEQ(key) ((guint16) ((key) & 0xffff))
+#define ITEM_KEY_PT(key)  ((guint8) ((key) >> 16))
+
+/* Items indexed by seqnum, the size is a power of two */
+typedef struct {
+  guint mask;
+  RtpStorageItem *items;
+} RtpStorageRing;
+
+/* The ring is only changed with the stream_lock held, readers go without
+ * it. They check that 'sequence', odd while a writer is changing the ring,
+ * stayed the same while they were looking, and everything a writer takes
+ * out of the ring is only released once no reader is looking. Readers only
+ * use atomic loads, so none of them can be moved past the final check of
+ * 'sequence', and they find the seqnums in the ring in 'range' instead of
+ * the fields of the writer. */
 typedef struct {
-  GQueue queue;
   GMutex stream_lock;
   guint32 ssrc;
   GstClockTime max_arrival_time;
+
+  RtpStorageRing *ring;
+  gint sequence;
+  gint readers;
+  guint length;
+  guint16 head_seq;
+  guint16 tail_seq;
+  /* tail_seq and the distance to head_seq in the upper 16 bits, or -1 when
+   * the ring is empty. Set at the end of every write */
+  gint range;
+
+  /* buffers and rings waiting for the readers to leave */
+  GPtrArray *retired_buffers;
+  GSList *retired_rings;
 } RtpStorageStream;
 
 #define STREAM_LOCK(s)   g_mutex_lock   (&(s)->stream_lock)
 #define STREAM_UNLOCK(s) g_mutex_unlock (&(s)->stream_lock)
 
-RtpStorageStream * rtp_storage_stream_new                      (guint32 ssrc);
+RtpStorageStream * rtp_storage_stream_new                      (guint32 ssrc,
+                                                                GstClockTime size_time);
 void               rtp_storage_stream_free                     (RtpStorageStream * stream);
 void               rtp_storage_stream_resize_and_add_item      (RtpStorageStream * stream,
                                                                 GstClockTime size_time,
@@ -57,6 +89,9 @@ GstBufferList    * rtp_storage_stream_get_packets_for_recovery (RtpStorageStream
                                                                 guint16 lost_seq);
 GstBuffer        * rtp_storage_stream_get_redundant_packet     (RtpStorageStream *stream,
                                                                 guint16 lost_seq);
+void               rtp_storage_stream_collect_packets_with_pt  (RtpStorageStream *stream,
+                                                                guint8 pt,
+                                                                GstBufferList *list);
 
 #endif /* __GST_RTP_STORAGE_ITEM_H__ */
 
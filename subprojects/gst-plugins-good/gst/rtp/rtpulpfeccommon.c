@@ -20,6 +20,7 @@
 
 #include <string.h>
 #include "rtpulpfeccommon.h"
+#include "gstrtpfecorc.h"
 
 #define MIN_RTP_HEADER_LEN 12
 
@@ -120,21 +121,31 @@ fec_hdr_get_timestamp_recovery (RtpUlpFecHeader const *fec_hdr)
 static void
 _xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
 {
-  guint i;
+  gst_rtp_fec_orc_xor_u8 (dst, src, length);
+}
 
-  for (i = 0; i < (length / sizeof (guint64)); ++i) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    GST_WRITE_UINT64_LE (dst,
-        GST_READ_UINT64_LE (dst) ^ GST_READ_UINT64_LE (src));
-#else
-    GST_WRITE_UINT64_BE (dst,
-        GST_READ_UINT64_BE (dst) ^ GST_READ_UINT64_BE (src));
-#endif
-    dst += sizeof (guint64);
-    src += sizeof (guint64);
+/* XORs @n sources of possibly different lengths into @dst. Four sources are
+ * folded per pass over their common length, so @dst is only loaded and
+ * stored once for every four packets. */
+static void
+_xor_mem_multi (guint8 * dst, const guint8 ** srcs, const guint * lens,
+    guint n)
+{
+  guint i, j;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    guint common = MIN (MIN (lens[i], lens[i + 1]),
+        MIN (lens[i + 2], lens[i + 3]));
+
+    gst_rtp_fec_orc_xor4_u8 (dst, srcs[i], srcs[i + 1], srcs[i + 2],
+        srcs[i + 3], common);
+    for (j = i; j < i + 4; j++) {
+      if (lens[j] > common)
+        _xor_mem (dst + common, srcs[j] + common, lens[j] - common);
+    }
   }
-  for (i = 0; i < (length % sizeof (guint64)); ++i)
-    dst[i] ^= src[i];
+  for (; i < n; i++)
+    _xor_mem (dst, srcs[i], lens[i]);
 }
 
 guint16
@@ -225,6 +236,255 @@ invalidcontent:
   return FALSE;
 }
 
+/* RFC 8627 FlexFEC header, flexible mask (R = 0, F = 0). The SSRCs of the
+ * protected streams are carried in the CSRC list of the FEC packet.
+ *
+    0                   1                   2                   3
+    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |0|0|P|X|  CC   |M| PT recovery |        length recovery        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                          TS recovery                          |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |           SN base_i           |k|          Mask [0-14]        |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |k|                   Mask [15-45] (optional)                   |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                     Mask [46-109] (optional)                  |
+   |                                                               |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |   ... next SN base and Mask for CSRC_i in CSRC list ...       |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+*/
+#define FLEXFEC_BASE_HEADER_LEN 8
+
+static inline gboolean
+flexfec_protected_get_bit (const RtpFlexFecProtected * protected, guint n)
+{
+  return (protected->mask[n / 64] & (ONE_64BIT << (n % 64))) ? TRUE : FALSE;
+}
+
+static inline void
+flexfec_protected_set_bit (RtpFlexFecProtected * protected, guint n)
+{
+  protected->mask[n / 64] |= ONE_64BIT << (n % 64);
+}
+
+static guint
+flexfec_protected_get_mask_size (const RtpFlexFecProtected * protected)
+{
+  gint i;
+
+  for (i = RTP_FLEXFEC_PROTECTED_PACKETS_MAX - 1; i >= 15; i--) {
+    if (flexfec_protected_get_bit (protected, i))
+      return i < 46 ? 6 : 14;
+  }
+  return 2;
+}
+
+static guint
+flexfec_protected_write (guint8 * data, const RtpFlexFecProtected * protected)
+{
+  guint mask_size = flexfec_protected_get_mask_size (protected);
+  guint16 mask0 = 0;
+  guint32 mask1 = 0;
+  guint64 mask2 = 0;
+  guint i;
+
+  for (i = 0; i < RTP_FLEXFEC_PROTECTED_PACKETS_MAX; i++) {
+    if (!flexfec_protected_get_bit (protected, i))
+      continue;
+
+    if (i < 15)
+      mask0 |= 1 << (14 - i);
+    else if (i < 46)
+      mask1 |= 1U << (30 - (i - 15));
+    else
+      mask2 |= ONE_64BIT << (63 - (i - 46));
+  }
+
+  /* The k bit is set on the last mask field */
+  GST_WRITE_UINT16_BE (data, protected->seq_base);
+  GST_WRITE_UINT16_BE (data + 2, mask0 | (mask_size == 2 ? 0x8000 : 0));
+  if (mask_size > 2)
+    GST_WRITE_UINT32_BE (data + 4, mask1 | (mask_size == 6 ? 0x80000000 : 0));
+  if (mask_size > 6)
+    GST_WRITE_UINT64_BE (data + 8, mask2);
+
+  return 2 + mask_size;
+}
+
+static guint
+flexfec_protected_read (const guint8 * data, guint len,
+    RtpFlexFecProtected * protected)
+{
+  guint16 mask0;
+  guint32 mask1 = 0;
+  guint64 mask2 = 0;
+  guint size = 4;
+  guint i;
+
+  if (len < size)
+    return 0;
+
+  protected->seq_base = GST_READ_UINT16_BE (data);
+  mask0 = GST_READ_UINT16_BE (data + 2);
+  if (!(mask0 & 0x8000)) {
+    size = 8;
+    if (len < size)
+      return 0;
+    mask1 = GST_READ_UINT32_BE (data + 4);
+    if (!(mask1 & 0x80000000)) {
+      size = 16;
+      if (len < size)
+        return 0;
+      mask2 = GST_READ_UINT64_BE (data + 8);
+    }
+  }
+
+  protected->mask[0] = protected->mask[1] = 0;
+  for (i = 0; i < 15; i++) {
+    if (mask0 & (1 << (14 - i)))
+      flexfec_protected_set_bit (protected, i);
+  }
+  for (i = 0; i < 31; i++) {
+    if (mask1 & (1U << (30 - i)))
+      flexfec_protected_set_bit (protected, 15 + i);
+  }
+  for (i = 0; i < 64; i++) {
+    if (mask2 & (ONE_64BIT << (63 - i)))
+      flexfec_protected_set_bit (protected, 46 + i);
+  }
+
+  return size;
+}
+
+guint
+rtp_flexfec_get_headers_len (const RtpFlexFecProtected * protected,
+    guint n_protected)
+{
+  guint len = FLEXFEC_BASE_HEADER_LEN;
+  guint i;
+
+  for (i = 0; i < n_protected; i++)
+    len += 2 + flexfec_protected_get_mask_size (&protected[i]);
+
+  return len;
+}
+
+/**
+ * rtp_flexfec_protected_add_seq:
+ * @protected: #RtpFlexFecProtected
+ * @seq: sequence number
+ *
+ * Marks @seq as protected. The first call on an empty mask sets the
+ * sequence number base.
+ *
+ * Returns: %FALSE if @seq is before the sequence number base or too far after
+ * it to be described by the mask
+ **/
+gboolean
+rtp_flexfec_protected_add_seq (RtpFlexFecProtected * protected, guint16 seq)
+{
+  gint offset;
+
+  if (protected->mask[0] == 0 && protected->mask[1] == 0)
+    protected->seq_base = seq;
+
+  offset = gst_rtp_buffer_compare_seqnum (protected->seq_base, seq);
+  if (offset < 0 || offset >= RTP_FLEXFEC_PROTECTED_PACKETS_MAX)
+    return FALSE;
+
+  flexfec_protected_set_bit (protected, offset);
+  return TRUE;
+}
+
+gboolean
+rtp_flexfec_protected_has_seq (const RtpFlexFecProtected * protected,
+    guint16 seq)
+{
+  guint16 offset = seq - protected->seq_base;
+
+  if (offset >= RTP_FLEXFEC_PROTECTED_PACKETS_MAX)
+    return FALSE;
+
+  return flexfec_protected_get_bit (protected, offset);
+}
+
+guint
+rtp_flexfec_protected_count (const RtpFlexFecProtected * protected)
+{
+  guint count = 0;
+  guint i;
+
+  for (i = 0; i < G_N_ELEMENTS (protected->mask); i++) {
+    guint64 mask = protected->mask[i];
+
+    while (mask) {
+      mask &= mask - 1;
+      ++count;
+    }
+  }
+  return count;
+}
+
+/**
+ * rtp_flexfec_buffer_parse:
+ * @rtp: mapped FlexFEC packet
+ * @protected: array of at least %RTP_FLEXFEC_PROTECTED_SSRCS_MAX entries
+ * @n_protected: (out): number of protected streams written to @protected
+ * @fec_hdrs_len: (out): length of the FlexFEC header
+ *
+ * Only the flexible mask format (R = 0, F = 0) is supported.
+ *
+ * Returns: %TRUE if @rtp is a valid FlexFEC packet
+ **/
+gboolean
+rtp_flexfec_buffer_parse (GstRTPBuffer * rtp, RtpFlexFecProtected * protected,
+    guint * n_protected, guint * fec_hdrs_len)
+{
+  guint payload_len = gst_rtp_buffer_get_payload_len (rtp);
+  const guint8 *data = gst_rtp_buffer_get_payload (rtp);
+  guint n = gst_rtp_buffer_get_csrc_count (rtp);
+  guint offset = FLEXFEC_BASE_HEADER_LEN;
+  guint i;
+
+  if (payload_len < FLEXFEC_BASE_HEADER_LEN)
+    goto toosmall;
+
+  if (data[0] & 0xc0)
+    goto unsupported;
+
+  if (n == 0)
+    goto nossrc;
+
+  for (i = 0; i < n; i++) {
+    guint size = flexfec_protected_read (data + offset, payload_len - offset,
+        &protected[i]);
+
+    if (size == 0)
+      goto toosmall;
+
+    protected[i].ssrc = gst_rtp_buffer_get_csrc (rtp, i);
+    offset += size;
+  }
+
+  *n_protected = n;
+  *fec_hdrs_len = offset;
+  return TRUE;
+
+toosmall:
+  GST_WARNING ("FlexFEC packet too small");
+  return FALSE;
+
+unsupported:
+  GST_WARNING ("FlexFEC packet with unsupported R or F bits: 0x%02x", data[0]);
+  return FALSE;
+
+nossrc:
+  GST_WARNING ("FlexFEC packet without protected SSRCs");
+  return FALSE;
+}
 
 void
 rtp_buffer_to_ulpfec_bitstring (GstRTPBuffer * rtp, GArray * dst_arr,
@@ -235,21 +495,39 @@ rtp_buffer_to_ulpfec_bitstring (GstRTPBuffer * rtp, GArray * dst_arr,
     g_array_set_size (dst_arr, MAX (payload_len, dst_arr->len));
     memcpy (dst_arr->data, gst_rtp_buffer_get_payload (rtp), payload_len);
   } else {
-    const guint8 *src = rtp->data[0];
-    guint len = gst_rtp_buffer_get_packet_len (rtp) - MIN_RTP_HEADER_LEN;
-    guint dst_offset = rtp_ulpfec_get_headers_len (fec_mask_long);
-    guint src_offset = MIN_RTP_HEADER_LEN;
-    guint8 *dst;
-
-    g_array_set_size (dst_arr, MAX (dst_offset + len, dst_arr->len));
-    dst = (guint8 *) dst_arr->data;
-
-    *((guint64 *) dst) ^= *((const guint64 *) src);
-    ((RtpUlpFecHeader *) dst)->len ^= g_htons (len);
-    _xor_mem (dst + dst_offset, src + src_offset, len);
+    rtp_buffers_to_ulpfec_bitstring (&rtp, 1, dst_arr, fec_mask_long);
   }
 }
 
+void
+rtp_buffers_to_ulpfec_bitstring (GstRTPBuffer ** rtps, guint n,
+    GArray * dst_arr, gboolean fec_mask_long)
+{
+  const guint8 *srcs[RTP_FEC_XOR_SOURCES_MAX];
+  guint lens[RTP_FEC_XOR_SOURCES_MAX];
+  guint dst_offset = rtp_ulpfec_get_headers_len (fec_mask_long);
+  guint max_len = 0;
+  guint8 *dst;
+  guint i;
+
+  g_return_if_fail (n <= RTP_FEC_XOR_SOURCES_MAX);
+
+  for (i = 0; i < n; i++) {
+    lens[i] = gst_rtp_buffer_get_packet_len (rtps[i]) - MIN_RTP_HEADER_LEN;
+    srcs[i] = (const guint8 *) rtps[i]->data[0] + MIN_RTP_HEADER_LEN;
+    max_len = MAX (max_len, lens[i]);
+  }
+
+  g_array_set_size (dst_arr, MAX (dst_offset + max_len, dst_arr->len));
+  dst = (guint8 *) dst_arr->data;
+
+  for (i = 0; i < n; i++) {
+    *((guint64 *) dst) ^= *((const guint64 *) rtps[i]->data[0]);
+    ((RtpUlpFecHeader *) dst)->len ^= g_htons (lens[i]);
+  }
+  _xor_mem_multi (dst + dst_offset, srcs, lens, n);
+}
+
 GstBuffer *
 rtp_ulpfec_bitstring_to_media_rtp_buffer (GArray * arr,
     gboolean fec_mask_long, guint32 ssrc, guint16 seq)
@@ -324,6 +602,116 @@ rtp_ulpfec_bitstring_to_fec_rtp_buffer (GArray * arr,
   return ret;
 }
 
+void
+rtp_buffer_to_flexfec_bitstring (GstRTPBuffer * rtp, GArray * dst_arr,
+    guint fec_hdrs_len)
+{
+  rtp_buffers_to_flexfec_bitstring (&rtp, 1, dst_arr, fec_hdrs_len);
+}
+
+void
+rtp_buffers_to_flexfec_bitstring (GstRTPBuffer ** rtps, guint n,
+    GArray * dst_arr, guint fec_hdrs_len)
+{
+  const guint8 *srcs[RTP_FEC_XOR_SOURCES_MAX];
+  guint lens[RTP_FEC_XOR_SOURCES_MAX];
+  guint max_len = 0;
+  guint8 *dst;
+  guint i;
+
+  g_return_if_fail (n <= RTP_FEC_XOR_SOURCES_MAX);
+
+  for (i = 0; i < n; i++) {
+    lens[i] = gst_rtp_buffer_get_packet_len (rtps[i]) - MIN_RTP_HEADER_LEN;
+    srcs[i] = (const guint8 *) rtps[i]->data[0] + MIN_RTP_HEADER_LEN;
+    max_len = MAX (max_len, lens[i]);
+  }
+
+  g_array_set_size (dst_arr, MAX (fec_hdrs_len + max_len, dst_arr->len));
+  dst = (guint8 *) dst_arr->data;
+
+  for (i = 0; i < n; i++) {
+    const guint8 *src = rtps[i]->data[0];
+
+    /* Same fields as ULPFEC, but the length recovery takes the place of the
+     * sequence number */
+    dst[0] ^= src[0];
+    dst[1] ^= src[1];
+    GST_WRITE_UINT16_BE (dst + 2, GST_READ_UINT16_BE (dst + 2) ^ lens[i]);
+    GST_WRITE_UINT32_BE (dst + 4,
+        GST_READ_UINT32_BE (dst + 4) ^ GST_READ_UINT32_BE (src + 4));
+  }
+  _xor_mem_multi (dst + fec_hdrs_len, srcs, lens, n);
+}
+
+GstBuffer *
+rtp_flexfec_bitstring_to_media_rtp_buffer (GArray * arr, guint fec_hdrs_len,
+    guint32 ssrc, guint16 seq)
+{
+  guint8 *src = (guint8 *) arr->data;
+  guint payload_len = GST_READ_UINT16_BE (src + 2);
+  GstMapInfo ret_info = GST_MAP_INFO_INIT;
+  GstMemory *ret_mem;
+  GstBuffer *ret;
+
+  if (arr->len < fec_hdrs_len || payload_len > arr->len - fec_hdrs_len)
+    return NULL;                // Not enough data
+
+  ret_mem = gst_allocator_alloc (NULL, MIN_RTP_HEADER_LEN + payload_len, NULL);
+  gst_memory_map (ret_mem, &ret_info, GST_MAP_READWRITE);
+
+  /* Filling 12 bytes of RTP header */
+  ret_info.data[0] = (src[0] & 0x3f) | 0x80;
+  ret_info.data[1] = src[1];
+  GST_WRITE_UINT16_BE (ret_info.data + 2, seq);
+  memcpy (ret_info.data + 4, src + 4, 4);
+  GST_WRITE_UINT32_BE (ret_info.data + 8, ssrc);
+  /* Filling payload */
+  memcpy (ret_info.data + MIN_RTP_HEADER_LEN, src + fec_hdrs_len, payload_len);
+
+  gst_memory_unmap (ret_mem, &ret_info);
+  ret = gst_buffer_new ();
+  gst_buffer_append_memory (ret, ret_mem);
+  return ret;
+}
+
+GstBuffer *
+rtp_flexfec_bitstring_to_fec_rtp_buffer (GArray * arr,
+    const RtpFlexFecProtected * protected, guint n_protected, guint8 pt,
+    guint16 seq, guint32 timestamp, guint32 ssrc)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *hdr = (guint8 *) arr->data;
+  guint offset = FLEXFEC_BASE_HEADER_LEN;
+  GstBuffer *ret;
+  guint i;
+
+  g_assert (arr->len >= rtp_flexfec_get_headers_len (protected, n_protected));
+
+  /* Filling FEC headers, R = 0 and F = 0 for the flexible mask */
+  hdr[0] &= 0x3f;
+  for (i = 0; i < n_protected; i++)
+    offset += flexfec_protected_write (hdr + offset, &protected[i]);
+
+  /* Filling RTP header, copying payload */
+  ret = gst_rtp_buffer_new_allocate (arr->len, 0, n_protected);
+  if (!gst_rtp_buffer_map (ret, GST_MAP_READWRITE, &rtp))
+    g_assert_not_reached ();
+
+  gst_rtp_buffer_set_payload_type (&rtp, pt);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, timestamp);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  for (i = 0; i < n_protected; i++)
+    gst_rtp_buffer_set_csrc (&rtp, i, protected[i].ssrc);
+
+  memcpy (gst_rtp_buffer_get_payload (&rtp), arr->data, arr->len);
+
+  gst_rtp_buffer_unmap (&rtp);
+
+  return ret;
+}
+
 /**
  * rtp_ulpfec_map_info_map:
  * @buffer: (transfer: full) #GstBuffer
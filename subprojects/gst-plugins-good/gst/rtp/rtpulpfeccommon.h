@@ -37,6 +37,13 @@ G_BEGIN_DECLS
 #define RTP_ULPFEC_PROTECTED_PACKETS_MAX(L)    ((L) ? 48 : 16)
 #define RTP_ULPFEC_SEQ_BASE_OFFSET_MAX(L)      (RTP_ULPFEC_PROTECTED_PACKETS_MAX(L) - 1)
 
+/* RFC 8627, flexible mask: 15 + 31 + 64 bits */
+#define RTP_FLEXFEC_PROTECTED_PACKETS_MAX      110
+/* The protected SSRCs are carried in the CSRC list */
+#define RTP_FLEXFEC_PROTECTED_SSRCS_MAX        15
+
+#define RTP_FEC_XOR_SOURCES_MAX                RTP_FLEXFEC_PROTECTED_PACKETS_MAX
+
 /**
  * RtpUlpFecMapInfo: Helper wrapper around GstRTPBuffer
  *
@@ -48,6 +55,19 @@ typedef struct {
   GstRTPBuffer rtp;
 } RtpUlpFecMapInfo;
 
+/**
+ * RtpFlexFecProtected: One protected source stream of a FlexFEC packet
+ *
+ * @ssrc: SSRC of the protected stream
+ * @seq_base: sequence number of the first packet covered by @mask
+ * @mask: bit n of mask[n / 64] is set if packet @seq_base + n is protected
+ **/
+typedef struct {
+  guint32 ssrc;
+  guint16 seq_base;
+  guint64 mask[2];
+} RtpFlexFecProtected;
+
 /* FIXME: parse/write these properly instead of relying in packed structs */
 #ifdef _MSC_VER
 #pragma pack(push, 1)
@@ -130,12 +150,25 @@ gboolean          rtp_ulpfec_map_info_map                  (GstBuffer *buffer, R
 void              rtp_ulpfec_map_info_unmap                (RtpUlpFecMapInfo *info);
 void              rtp_buffer_to_ulpfec_bitstring           (GstRTPBuffer *rtp, GArray *dst_arr,
                                                             gboolean fec_buffer, gboolean fec_mask_long);
+void              rtp_buffers_to_ulpfec_bitstring          (GstRTPBuffer **rtps, guint n, GArray *dst_arr,
+                                                            gboolean fec_mask_long);
 GstBuffer       * rtp_ulpfec_bitstring_to_media_rtp_buffer (GArray *arr,
                                                             gboolean fec_mask_long, guint32 ssrc, guint16 seq);
 GstBuffer       * rtp_ulpfec_bitstring_to_fec_rtp_buffer   (GArray *arr, guint16 seq_base, gboolean fec_mask_long,
                                                             guint64 fec_mask, gboolean marker, guint8 pt, guint16 seq,
                                                             guint32 timestamp, guint32 ssrc);
 
+void              rtp_buffer_to_flexfec_bitstring          (GstRTPBuffer *rtp, GArray *dst_arr,
+                                                            guint fec_hdrs_len);
+void              rtp_buffers_to_flexfec_bitstring         (GstRTPBuffer **rtps, guint n, GArray *dst_arr,
+                                                            guint fec_hdrs_len);
+GstBuffer       * rtp_flexfec_bitstring_to_media_rtp_buffer (GArray *arr, guint fec_hdrs_len,
+                                                            guint32 ssrc, guint16 seq);
+GstBuffer       * rtp_flexfec_bitstring_to_fec_rtp_buffer  (GArray *arr,
+                                                            const RtpFlexFecProtected *protected,
+                                                            guint n_protected, guint8 pt, guint16 seq,
+                                                            guint32 timestamp, guint32 ssrc);
+
 #ifndef GST_DISABLE_GST_DEBUG
 void              rtp_ulpfec_log_rtppacket                 (GstDebugCategory * cat, GstDebugLevel level,
                                                             gpointer object, const gchar *name,
@@ -157,6 +190,16 @@ guint16           rtp_ulpfec_buffer_get_seq_base           (GstRTPBuffer *rtp);
 gboolean          rtp_ulpfec_mask_is_long                  (guint64 mask);
 gboolean          rtp_ulpfec_buffer_is_valid               (GstRTPBuffer * rtp);
 
+guint             rtp_flexfec_get_headers_len              (const RtpFlexFecProtected *protected,
+                                                            guint n_protected);
+gboolean          rtp_flexfec_protected_add_seq            (RtpFlexFecProtected *protected, guint16 seq);
+gboolean          rtp_flexfec_protected_has_seq            (const RtpFlexFecProtected *protected,
+                                                            guint16 seq);
+guint             rtp_flexfec_protected_count              (const RtpFlexFecProtected *protected);
+gboolean          rtp_flexfec_buffer_parse                 (GstRTPBuffer *rtp,
+                                                            RtpFlexFecProtected *protected,
+                                                            guint *n_protected, guint *fec_hdrs_len);
+
 G_END_DECLS
 
 #endif
@@ -358,6 +358,8 @@ enum
 #define DEFAULT_MAX_TS_OFFSET        G_GINT64_CONSTANT(3000000000)
 #define DEFAULT_MIN_TS_OFFSET        MIN_TS_OFFSET_ROUND_OFF_COMP
 #define DEFAULT_TS_OFFSET_SMOOTHING_FACTOR  0
+#define DEFAULT_FORWARD_ONLY         FALSE
+#define DEFAULT_RTX_BATCH_REQUESTS   FALSE
 
 enum
 {
@@ -390,6 +392,8 @@ enum
   PROP_TS_OFFSET_SMOOTHING_FACTOR,
   PROP_FEC_DECODERS,
   PROP_FEC_ENCODERS,
+  PROP_FORWARD_ONLY,
+  PROP_RTX_BATCH_REQUESTS,
 };
 
 #define GST_RTP_BIN_RTCP_SYNC_TYPE (gst_rtp_bin_rtcp_sync_get_type())
@@ -439,6 +443,7 @@ static GstPad *complete_session_rtcp (GstRtpBin * rtpbin,
     GstRtpBinSession * session, guint sessid);
 static GstElement *session_request_element (GstRtpBinSession * session,
     guint signal);
+static void remove_recv_src_ghost_pad (GstRtpBin * rtpbin, GstPad * pad);
 
 /* Manages the RTP stream for one SSRC.
  *
@@ -715,6 +720,9 @@ ssrc_demux_pad_removed (GstElement * element, guint ssrc, GstPad * pad,
 
   rtpbin = session->bin;
 
+  /* the pad was exposed directly when forwarding */
+  remove_recv_src_ghost_pad (rtpbin, pad);
+
   GST_RTP_BIN_LOCK (rtpbin);
 
   GST_RTP_SESSION_LOCK (session);
@@ -1992,6 +2000,9 @@ create_stream (GstRtpBinSession * session, guint32 ssrc)
     g_object_set (buffer, "mode", rtpbin->buffer_mode, NULL);
   if (g_object_class_find_property (jb_class, "do-retransmission"))
     g_object_set (buffer, "do-retransmission", rtpbin->do_retransmission, NULL);
+  if (g_object_class_find_property (jb_class, "rtx-batch-requests"))
+    g_object_set (buffer, "rtx-batch-requests", rtpbin->rtx_batch_requests,
+        NULL);
   if (g_object_class_find_property (jb_class, "max-rtcp-rtp-time-diff"))
     g_object_set (buffer, "max-rtcp-rtp-time-diff",
         rtpbin->max_rtcp_rtp_time_diff, NULL);
@@ -3020,6 +3031,41 @@ gst_rtp_bin_class_init (GstRtpBinClass * klass)
           "fec-encoders='fec,0=\"rtpst2022-1-fecenc\\ rows\\=5\\ columns\\=5\";'",
           GST_TYPE_STRUCTURE, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpBin:forward-only:
+   *
+   * Expose the packets of every received SSRC as they come out of the
+   * session, for applications that only forward them, like an SFU.
+   *
+   * No jitterbuffer and payload demuxer are created for the SSRC. The
+   * recv_rtp_src_%u_%u_%u pad, with payload type 255 as with
+   * #GstRtpBin:ignore-pt, is a ghost of the SSRC demuxer pad, and the
+   * session still does all RTCP bookkeeping for the source. Received RTCP is
+   * not used for lip-sync and no FEC decoder is requested for the SSRC.
+   *
+   * Only applies to SSRCs found after it was set.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_FORWARD_ONLY,
+      g_param_spec_boolean ("forward-only", "Forward only",
+          "Expose received SSRCs without a jitterbuffer and payload demuxer",
+          DEFAULT_FORWARD_ONLY, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  /**
+   * GstRtpBin:rtx-batch-requests:
+   *
+   * Set the #GstRtpJitterBuffer:rtx-batch-requests property on the
+   * jitterbuffers of all streams.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_RTX_BATCH_REQUESTS,
+      g_param_spec_boolean ("rtx-batch-requests", "RTX Batch Requests",
+          "Send the retransmission requests of one timeout pass upstream "
+          "as a single event on all streams", DEFAULT_RTX_BATCH_REQUESTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstelement_class->change_state = GST_DEBUG_FUNCPTR (gst_rtp_bin_change_state);
   gstelement_class->request_new_pad =
       GST_DEBUG_FUNCPTR (gst_rtp_bin_request_new_pad);
@@ -3112,6 +3158,8 @@ gst_rtp_bin_init (GstRtpBin * rtpbin)
   rtpbin->min_ts_offset = DEFAULT_MIN_TS_OFFSET;
   rtpbin->min_ts_offset_is_set = FALSE;
   rtpbin->ts_offset_smoothing_factor = DEFAULT_TS_OFFSET_SMOOTHING_FACTOR;
+  rtpbin->forward_only = DEFAULT_FORWARD_ONLY;
+  rtpbin->rtx_batch_requests = DEFAULT_RTX_BATCH_REQUESTS;
 
   /* some default SDES entries */
   cname = g_strdup_printf ("user%u@host-%x", g_random_int (), g_random_int ());
@@ -3451,6 +3499,16 @@ gst_rtp_bin_set_property (GObject * object, guint prop_id,
     case PROP_FEC_ENCODERS:
       gst_rtp_bin_set_fec_encoders_struct (rtpbin, g_value_get_boxed (value));
       break;
+    case PROP_FORWARD_ONLY:
+      rtpbin->forward_only = g_value_get_boolean (value);
+      break;
+    case PROP_RTX_BATCH_REQUESTS:
+      GST_RTP_BIN_LOCK (rtpbin);
+      rtpbin->rtx_batch_requests = g_value_get_boolean (value);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      gst_rtp_bin_propagate_property_to_jitterbuffer (rtpbin,
+          "rtx-batch-requests", value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3560,6 +3618,14 @@ gst_rtp_bin_get_property (GObject * object, guint prop_id,
     case PROP_FEC_ENCODERS:
       g_value_take_boxed (value, gst_rtp_bin_get_fec_encoders_struct (rtpbin));
       break;
+    case PROP_FORWARD_ONLY:
+      g_value_set_boolean (value, rtpbin->forward_only);
+      break;
+    case PROP_RTX_BATCH_REQUESTS:
+      GST_RTP_BIN_LOCK (rtpbin);
+      g_value_set_boolean (value, rtpbin->rtx_batch_requests);
+      GST_RTP_BIN_UNLOCK (rtpbin);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -3912,15 +3978,62 @@ done:
   return session->early_fec_decoder != NULL;
 }
 
+/* ghost @pad as the recv_rtp_src pad for @ssrc and @pt of session
+ * @session_id */
 static void
-expose_recv_src_pad (GstRtpBin * rtpbin, GstPad * pad, GstRtpBinStream * stream,
-    guint8 pt)
+ghost_recv_src_pad (GstRtpBin * rtpbin, GstPad * pad, guint session_id,
+    guint32 ssrc, guint8 pt)
 {
   GstElementClass *klass;
   GstPadTemplate *templ;
   gchar *padname;
   GstPad *gpad;
 
+  GST_RTP_BIN_SHUTDOWN_LOCK (rtpbin, shutdown);
+
+  /* ghost the pad to the parent */
+  klass = GST_ELEMENT_GET_CLASS (rtpbin);
+  templ = gst_element_class_get_pad_template (klass, "recv_rtp_src_%u_%u_%u");
+  padname = g_strdup_printf ("recv_rtp_src_%u_%u_%u", session_id, ssrc, pt);
+  gpad = gst_ghost_pad_new_from_template (padname, pad, templ);
+  g_free (padname);
+  g_object_set_data (G_OBJECT (pad), "GstRTPBin.ghostpad", gpad);
+
+  gst_pad_set_active (gpad, TRUE);
+  GST_RTP_BIN_SHUTDOWN_UNLOCK (rtpbin);
+
+  gst_pad_sticky_events_foreach (pad, copy_sticky_events, gpad);
+  gst_element_add_pad (GST_ELEMENT_CAST (rtpbin), gpad);
+
+  return;
+
+shutdown:
+  {
+    GST_DEBUG ("ignoring, we are shutting down");
+    return;
+  }
+}
+
+/* remove the ghost pad that ghost_recv_src_pad() made for @pad, if any */
+static void
+remove_recv_src_ghost_pad (GstRtpBin * rtpbin, GstPad * pad)
+{
+  GstPad *gpad;
+
+  GST_RTP_BIN_DYN_LOCK (rtpbin);
+  if ((gpad = g_object_get_data (G_OBJECT (pad), "GstRTPBin.ghostpad"))) {
+    g_object_set_data (G_OBJECT (pad), "GstRTPBin.ghostpad", NULL);
+
+    gst_pad_set_active (gpad, FALSE);
+    gst_element_remove_pad (GST_ELEMENT_CAST (rtpbin), gpad);
+  }
+  GST_RTP_BIN_DYN_UNLOCK (rtpbin);
+}
+
+static void
+expose_recv_src_pad (GstRtpBin * rtpbin, GstPad * pad, GstRtpBinStream * stream,
+    guint8 pt)
+{
   gst_object_ref (pad);
 
   if (stream->session->storage) {
@@ -3963,33 +4076,13 @@ expose_recv_src_pad (GstRtpBin * rtpbin, GstPad * pad, GstRtpBinStream * stream,
     }
   }
 
-  GST_RTP_BIN_SHUTDOWN_LOCK (rtpbin, shutdown);
-
-  /* ghost the pad to the parent */
-  klass = GST_ELEMENT_GET_CLASS (rtpbin);
-  templ = gst_element_class_get_pad_template (klass, "recv_rtp_src_%u_%u_%u");
-  padname = g_strdup_printf ("recv_rtp_src_%u_%u_%u",
-      stream->session->id, stream->ssrc, pt);
-  gpad = gst_ghost_pad_new_from_template (padname, pad, templ);
-  g_free (padname);
-  g_object_set_data (G_OBJECT (pad), "GstRTPBin.ghostpad", gpad);
-
-  gst_pad_set_active (gpad, TRUE);
-  GST_RTP_BIN_SHUTDOWN_UNLOCK (rtpbin);
-
-  gst_pad_sticky_events_foreach (pad, copy_sticky_events, gpad);
-  gst_element_add_pad (GST_ELEMENT_CAST (rtpbin), gpad);
+  ghost_recv_src_pad (rtpbin, pad, stream->session->id, stream->ssrc, pt);
 
 done:
   gst_object_unref (pad);
 
   return;
 
-shutdown:
-  {
-    GST_DEBUG ("ignoring, we are shutting down");
-    goto done;
-  }
 fec_decoder_sink_failed:
   {
     g_warning ("rtpbin: failed to get fec encoder sink pad for session %u",
@@ -4029,21 +4122,9 @@ static void
 payload_pad_removed (GstElement * element, GstPad * pad,
     GstRtpBinStream * stream)
 {
-  GstRtpBin *rtpbin;
-  GstPad *gpad;
-
-  rtpbin = stream->bin;
-
   GST_DEBUG ("payload pad removed");
 
-  GST_RTP_BIN_DYN_LOCK (rtpbin);
-  if ((gpad = g_object_get_data (G_OBJECT (pad), "GstRTPBin.ghostpad"))) {
-    g_object_set_data (G_OBJECT (pad), "GstRTPBin.ghostpad", NULL);
-
-    gst_pad_set_active (gpad, FALSE);
-    gst_element_remove_pad (GST_ELEMENT_CAST (rtpbin), gpad);
-  }
-  GST_RTP_BIN_DYN_UNLOCK (rtpbin);
+  remove_recv_src_ghost_pad (stream->bin, pad);
 }
 
 static GstCaps *
@@ -4144,6 +4225,37 @@ caps_changed (GstPad * pad, GParamSpec * pspec, GstRtpBinSession * session)
   GST_RTP_SESSION_UNLOCK (session);
 }
 
+static GstPadProbeReturn
+drop_probe (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  return GST_PAD_PROBE_DROP;
+}
+
+/* expose the SSRC demuxer pad @pad of @ssrc without any per-SSRC elements */
+static void
+forward_ssrc_pad (GstRtpBin * rtpbin, GstRtpBinSession * session,
+    GstElement * demux, guint32 ssrc, GstPad * pad)
+{
+  GstPad *rtcp_pad;
+  gchar *padname;
+
+  GST_DEBUG_OBJECT (rtpbin, "forwarding SSRC %08x of session %u", ssrc,
+      session->id);
+
+  /* there is no jitterbuffer to use the RTCP for lip-sync, so drop it rather
+   * than failing with not-linked */
+  padname = g_strdup_printf ("rtcp_src_%u", ssrc);
+  rtcp_pad = gst_element_get_static_pad (demux, padname);
+  g_free (padname);
+  if (rtcp_pad) {
+    gst_pad_add_probe (rtcp_pad, GST_PAD_PROBE_TYPE_BUFFER |
+        GST_PAD_PROBE_TYPE_BUFFER_LIST, drop_probe, NULL, NULL);
+    gst_object_unref (rtcp_pad);
+  }
+
+  ghost_recv_src_pad (rtpbin, pad, session->id, ssrc, 255);
+}
+
 /* a new pad (SSRC) was created in @session */
 static void
 new_ssrc_pad_found (GstElement * element, guint ssrc, GstPad * pad,
@@ -4159,6 +4271,11 @@ new_ssrc_pad_found (GstElement * element, guint ssrc, GstPad * pad,
   GST_DEBUG_OBJECT (rtpbin, "new SSRC pad %08x, %s:%s", ssrc,
       GST_DEBUG_PAD_NAME (pad));
 
+  if (rtpbin->forward_only) {
+    forward_ssrc_pad (rtpbin, session, element, ssrc, pad);
+    return;
+  }
+
   GST_RTP_BIN_SHUTDOWN_LOCK (rtpbin, shutdown);
 
   GST_RTP_SESSION_LOCK (session);
@@ -4492,9 +4609,19 @@ session_sink_failed:
   }
 }
 
+static gboolean
+remove_forward_pad (GstElement * element, GstPad * pad, gpointer user_data)
+{
+  remove_recv_src_ghost_pad (GST_RTP_BIN (user_data), pad);
+  return TRUE;
+}
+
 static void
 remove_recv_rtp (GstRtpBin * rtpbin, GstRtpBinSession * session)
 {
+  /* SSRCs that were forwarded are exposed from the SSRC demuxer */
+  gst_element_foreach_src_pad (session->demux, remove_forward_pad, rtpbin);
+
   if (session->demux_newpad_sig) {
     g_signal_handler_disconnect (session->demux, session->demux_newpad_sig);
     session->demux_newpad_sig = 0;
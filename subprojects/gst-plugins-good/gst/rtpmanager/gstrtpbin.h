@@ -82,6 +82,8 @@ struct _GstRtpBin {
   guint64         min_ts_offset;
   gboolean        min_ts_offset_is_set;
   guint           ts_offset_smoothing_factor;
+  gboolean        forward_only;
+  gboolean        rtx_batch_requests;
 
   /* a list of session */
   GSList         *sessions;
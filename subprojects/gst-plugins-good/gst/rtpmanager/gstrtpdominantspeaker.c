@@ -0,0 +1,720 @@
+/* RTP dominant speaker element for GStreamer
+ *
+ * gstrtpdominantspeaker.c:
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpdominantspeaker
+ * @title: rtpdominantspeaker
+ * @see_also: rtpfunnel, rtphdrextclientaudiolevel
+ *
+ * rtpdominantspeaker finds out who is talking in a set of audio streams by
+ * looking only at the client-to-mixer audio level header extension
+ * (RFC 6464) of the RTP packets, without decoding any of them. It is placed
+ * after an rtpfunnel (or anywhere else all the audio SSRCs of a conference
+ * pass through) and forwards all packets unchanged.
+ *
+ * For every SSRC the element keeps two activity scores, averaged over a
+ * short and a long window. At every "interval" of stream time it picks the
+ * dominant speaker from the short scores, only switching away from the
+ * current one when another SSRC is clearly louder, and the "top-n" most
+ * active SSRCs from the long scores. When either of them changes, an element
+ * message is posted on the bus:
+ *
+ * ```
+ * GstRTPActiveSpeakers, dominant-ssrc=(uint)1234, ssrcs=(uint)< 1234, 5678 >,
+ *     running-time=(guint64)...
+ * ```
+ *
+ * "dominant-ssrc" is left out while nobody is talking, and when present it
+ * is always the first entry of "ssrcs". A mixer can use the message to only
+ * decode and mix the streams in "ssrcs".
+ *
+ * The extension id is taken from the "audio-level-ext-id" property, or from
+ * the `extmap-N` field in the caps when the property is 0. Packets without
+ * the extension count as silence.
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpdominantspeaker.h"
+#include "gstrtputils.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_dominant_speaker_debug);
+#define GST_CAT_DEFAULT gst_rtp_dominant_speaker_debug
+
+#define AUDIO_LEVEL_URI "urn:ietf:params:rtp-hdrext:ssrc-audio-level"
+
+enum
+{
+  PROP_0,
+  PROP_AUDIO_LEVEL_EXT_ID,
+  PROP_SILENCE_LEVEL,
+  PROP_INTERVAL,
+  PROP_TOP_N,
+  PROP_TIMEOUT,
+};
+
+#define DEFAULT_AUDIO_LEVEL_EXT_ID 0
+#define DEFAULT_SILENCE_LEVEL 90
+#define DEFAULT_INTERVAL 200
+#define DEFAULT_TOP_N 3
+#define DEFAULT_TIMEOUT 5000
+
+/* the averaging windows of the dominant speaker and top-n scores */
+#define SHORT_WINDOW (400 * GST_MSECOND)
+#define LONG_WINDOW (2 * GST_SECOND)
+/* how long the level of a packet counts for when no next packet arrives,
+ * longer than any sane packet duration, DTX gaps count as silence */
+#define LEVEL_HOLD (100 * GST_MSECOND)
+/* below this score a stream is not considered to be talking */
+#define MIN_SCORE 0.05
+/* how much louder than the current dominant speaker another one has to be
+ * to take over */
+#define SWITCH_RATIO 1.25
+
+typedef struct
+{
+  guint32 ssrc;
+
+  gdouble short_score;
+  gdouble long_score;
+  /* activity of the last packet, between 0.0 and 1.0 */
+  gdouble activity;
+
+  /* the scores include everything up to this running time */
+  GstClockTime last_update;
+  GstClockTime last_seen;
+} SpeakerState;
+
+struct _GstRtpDominantSpeakerClass
+{
+  GstElementClass class;
+};
+
+struct _GstRtpDominantSpeaker
+{
+  GstElement element;
+
+  GstPad *sinkpad;
+  GstPad *srcpad;
+
+  /* properties, protected by OBJECT_LOCK */
+  guint audio_level_ext_id;
+  guint silence_level;
+  guint interval;
+  guint top_n;
+  guint timeout;
+  /* the id from the extmap in the caps */
+  guint8 caps_ext_id;
+
+  /* streaming thread */
+  GstSegment segment;
+  /* guint32 ssrc -> SpeakerState */
+  GHashTable *speakers;
+  GstClockTime next_evaluation;
+
+  gboolean have_dominant;
+  guint32 dominant_ssrc;
+  /* the ssrcs of the last message, dominant speaker first */
+  GArray *active;
+  /* scratch space for sorting */
+  GPtrArray *sorted;
+};
+
+#define RTP_CAPS "application/x-rtp"
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (RTP_CAPS));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src",
+    GST_PAD_SRC,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (RTP_CAPS));
+
+#define gst_rtp_dominant_speaker_parent_class parent_class
+G_DEFINE_TYPE (GstRtpDominantSpeaker, gst_rtp_dominant_speaker,
+    GST_TYPE_ELEMENT);
+GST_ELEMENT_REGISTER_DEFINE (rtpdominantspeaker, "rtpdominantspeaker",
+    GST_RANK_NONE, GST_TYPE_RTP_DOMINANT_SPEAKER);
+
+/* Moves both scores towards @activity as if it had been measured for
+ * @duration. This is an exponential moving average with a time constant of
+ * the window, which works for any packet duration. */
+static void
+speaker_state_average (SpeakerState * state, GstClockTime duration,
+    gdouble activity)
+{
+  gdouble dt = (gdouble) duration;
+
+  state->short_score += dt / (SHORT_WINDOW + dt) *
+      (activity - state->short_score);
+  state->long_score += dt / (LONG_WINDOW + dt) *
+      (activity - state->long_score);
+}
+
+/* Brings the scores up to @running_time: the activity of the last packet
+ * holds for LEVEL_HOLD after it, anything after that is silence */
+static void
+speaker_state_update (SpeakerState * state, GstClockTime running_time)
+{
+  GstClockTime hold_end = state->last_seen + LEVEL_HOLD;
+
+  if (running_time <= state->last_update)
+    return;
+
+  if (state->last_update < hold_end) {
+    GstClockTime end = MIN (running_time, hold_end);
+
+    speaker_state_average (state, end - state->last_update, state->activity);
+    state->last_update = end;
+  }
+
+  if (running_time > state->last_update) {
+    speaker_state_average (state, running_time - state->last_update, 0.0);
+    state->last_update = running_time;
+  }
+}
+
+static void
+gst_rtp_dominant_speaker_reset (GstRtpDominantSpeaker * self)
+{
+  g_hash_table_remove_all (self->speakers);
+  g_array_set_size (self->active, 0);
+  self->next_evaluation = GST_CLOCK_TIME_NONE;
+  self->have_dominant = FALSE;
+  self->dominant_ssrc = 0;
+}
+
+/* returns the RFC 6464 level (0 is loudest, 127 silence) of @buf, or -1 if
+ * the packet does not carry it */
+static gint
+gst_rtp_dominant_speaker_get_level (GstRtpDominantSpeaker * self,
+    GstRTPBuffer * rtp, guint8 ext_id)
+{
+  gpointer data;
+  guint size;
+  guint8 appbits;
+
+  if (ext_id == 0)
+    return -1;
+
+  if ((ext_id <= 14 && gst_rtp_buffer_get_extension_onebyte_header (rtp,
+              ext_id, 0, &data, &size)) ||
+      gst_rtp_buffer_get_extension_twobytes_header (rtp, &appbits, ext_id, 0,
+          &data, &size)) {
+    if (size >= 1)
+      return ((guint8 *) data)[0] & 0x7F;
+  }
+
+  return -1;
+}
+
+static gint
+compare_short_score (gconstpointer a, gconstpointer b)
+{
+  const SpeakerState *sa = *(const SpeakerState **) a;
+  const SpeakerState *sb = *(const SpeakerState **) b;
+
+  if (sa->short_score != sb->short_score)
+    return sa->short_score > sb->short_score ? -1 : 1;
+  /* keep the order stable between evaluations */
+  return sa->ssrc < sb->ssrc ? -1 : sa->ssrc > sb->ssrc;
+}
+
+static gint
+compare_long_score (gconstpointer a, gconstpointer b)
+{
+  const SpeakerState *sa = *(const SpeakerState **) a;
+  const SpeakerState *sb = *(const SpeakerState **) b;
+
+  if (sa->long_score != sb->long_score)
+    return sa->long_score > sb->long_score ? -1 : 1;
+  return sa->ssrc < sb->ssrc ? -1 : sa->ssrc > sb->ssrc;
+}
+
+static gboolean
+ssrc_array_contains (GArray * array, guint32 ssrc)
+{
+  guint i;
+
+  for (i = 0; i < array->len; i++) {
+    if (g_array_index (array, guint32, i) == ssrc)
+      return TRUE;
+  }
+  return FALSE;
+}
+
+static GstMessage *
+gst_rtp_dominant_speaker_create_message (GstRtpDominantSpeaker * self,
+    GstClockTime running_time)
+{
+  GstStructure *s;
+  GValue ssrcs = G_VALUE_INIT;
+  GValue v = G_VALUE_INIT;
+  guint i;
+
+  g_value_init (&ssrcs, GST_TYPE_ARRAY);
+  g_value_init (&v, G_TYPE_UINT);
+  for (i = 0; i < self->active->len; i++) {
+    g_value_set_uint (&v, g_array_index (self->active, guint32, i));
+    gst_value_array_append_value (&ssrcs, &v);
+  }
+  g_value_unset (&v);
+
+  s = gst_structure_new ("GstRTPActiveSpeakers",
+      "running-time", G_TYPE_UINT64, running_time, NULL);
+  if (self->have_dominant)
+    gst_structure_set (s, "dominant-ssrc", G_TYPE_UINT, self->dominant_ssrc,
+        NULL);
+  gst_structure_take_value (s, "ssrcs", &ssrcs);
+
+  return gst_message_new_element (GST_OBJECT_CAST (self), s);
+}
+
+/* Decays all scores up to @running_time, forgets streams that went away and
+ * picks the dominant speaker and the top-n. Returns a message when either of
+ * them changed. */
+static GstMessage *
+gst_rtp_dominant_speaker_evaluate (GstRtpDominantSpeaker * self,
+    GstClockTime running_time)
+{
+  GHashTableIter iter;
+  SpeakerState *state, *best, *dominant = NULL;
+  GstClockTime timeout;
+  guint top_n, n, i;
+  gboolean changed = FALSE;
+
+  GST_OBJECT_LOCK (self);
+  timeout = self->timeout * GST_MSECOND;
+  top_n = self->top_n;
+  GST_OBJECT_UNLOCK (self);
+
+  g_ptr_array_set_size (self->sorted, 0);
+  g_hash_table_iter_init (&iter, self->speakers);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & state)) {
+    if (running_time > state->last_seen + timeout) {
+      GST_DEBUG_OBJECT (self, "ssrc %08x timed out", state->ssrc);
+      g_hash_table_iter_remove (&iter);
+      continue;
+    }
+    speaker_state_update (state, running_time);
+    g_ptr_array_add (self->sorted, state);
+    if (self->have_dominant && state->ssrc == self->dominant_ssrc)
+      dominant = state;
+  }
+
+  /* the dominant speaker */
+  g_ptr_array_sort (self->sorted, compare_short_score);
+  best = self->sorted->len > 0 ? g_ptr_array_index (self->sorted, 0) : NULL;
+  if (best && best->short_score < MIN_SCORE)
+    best = NULL;
+
+  if (best && best != dominant && (dominant == NULL ||
+          dominant->short_score < MIN_SCORE ||
+          best->short_score > dominant->short_score * SWITCH_RATIO)) {
+    GST_DEBUG_OBJECT (self, "dominant speaker %08x -> %08x (%f)",
+        self->dominant_ssrc, best->ssrc, best->short_score);
+    self->dominant_ssrc = best->ssrc;
+    self->have_dominant = TRUE;
+    dominant = best;
+    changed = TRUE;
+  } else if (!best && self->have_dominant) {
+    GST_DEBUG_OBJECT (self, "no dominant speaker anymore");
+    self->have_dominant = FALSE;
+    dominant = NULL;
+    changed = TRUE;
+  }
+
+  /* the top-n, with the dominant speaker always in it */
+  g_ptr_array_sort (self->sorted, compare_long_score);
+  n = 0;
+  if (dominant) {
+    changed |= self->active->len == 0 ||
+        g_array_index (self->active, guint32, 0) != dominant->ssrc;
+    n++;
+  }
+  for (i = 0; i < self->sorted->len && n < top_n; i++) {
+    state = g_ptr_array_index (self->sorted, i);
+    if (state->long_score < MIN_SCORE)
+      break;
+    if (state == dominant)
+      continue;
+    changed |= !ssrc_array_contains (self->active, state->ssrc);
+    n++;
+  }
+  changed |= n != self->active->len;
+
+  if (!changed)
+    return NULL;
+
+  g_array_set_size (self->active, 0);
+  if (dominant)
+    g_array_append_val (self->active, dominant->ssrc);
+  for (i = 0; i < self->sorted->len && self->active->len < top_n; i++) {
+    state = g_ptr_array_index (self->sorted, i);
+    if (state->long_score < MIN_SCORE)
+      break;
+    if (state != dominant)
+      g_array_append_val (self->active, state->ssrc);
+  }
+
+  return gst_rtp_dominant_speaker_create_message (self, running_time);
+}
+
+static void
+gst_rtp_dominant_speaker_process (GstRtpDominantSpeaker * self,
+    GstBuffer * buf, guint8 ext_id, guint silence_level)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstClockTime running_time;
+  SpeakerState *state;
+  guint32 ssrc;
+  gint level;
+  gdouble activity = 0.0;
+  GstMessage *msg = NULL;
+
+  running_time = gst_segment_to_running_time (&self->segment, GST_FORMAT_TIME,
+      GST_BUFFER_PTS (buf));
+  if (!GST_CLOCK_TIME_IS_VALID (running_time)) {
+    GST_LOG_OBJECT (self, "ignoring buffer without timestamp");
+    return;
+  }
+
+  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp)) {
+    GST_LOG_OBJECT (self, "ignoring invalid RTP buffer");
+    return;
+  }
+  ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  level = gst_rtp_dominant_speaker_get_level (self, &rtp, ext_id);
+  gst_rtp_buffer_unmap (&rtp);
+
+  if (level >= 0 && (guint) level < silence_level)
+    activity = (gdouble) (silence_level - level) / silence_level;
+
+  state = g_hash_table_lookup (self->speakers, GUINT_TO_POINTER (ssrc));
+  if (state == NULL) {
+    GST_DEBUG_OBJECT (self, "new ssrc %08x", ssrc);
+    state = g_new0 (SpeakerState, 1);
+    state->ssrc = ssrc;
+    state->last_update = running_time;
+    state->last_seen = running_time;
+    g_hash_table_insert (self->speakers, GUINT_TO_POINTER (ssrc), state);
+  } else {
+    speaker_state_update (state, running_time);
+  }
+  state->activity = activity;
+  state->last_seen = MAX (state->last_seen, running_time);
+
+  GST_LOG_OBJECT (self, "ssrc %08x level %d: scores %f %f", ssrc, level,
+      state->short_score, state->long_score);
+
+  if (!GST_CLOCK_TIME_IS_VALID (self->next_evaluation))
+    self->next_evaluation = running_time;
+
+  if (running_time >= self->next_evaluation) {
+    GstClockTime interval;
+
+    GST_OBJECT_LOCK (self);
+    interval = self->interval * GST_MSECOND;
+    GST_OBJECT_UNLOCK (self);
+
+    msg = gst_rtp_dominant_speaker_evaluate (self, running_time);
+    self->next_evaluation = running_time + interval;
+  }
+
+  if (msg) {
+    GST_DEBUG_OBJECT (self, "active speakers changed: %" GST_PTR_FORMAT,
+        gst_message_get_structure (msg));
+    gst_element_post_message (GST_ELEMENT_CAST (self), msg);
+  }
+}
+
+static void
+gst_rtp_dominant_speaker_get_config (GstRtpDominantSpeaker * self,
+    guint8 * ext_id, guint * silence_level)
+{
+  GST_OBJECT_LOCK (self);
+  *ext_id = self->audio_level_ext_id ? self->audio_level_ext_id :
+      self->caps_ext_id;
+  *silence_level = self->silence_level;
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GstFlowReturn
+gst_rtp_dominant_speaker_chain (GstPad * pad, GstObject * parent,
+    GstBuffer * buf)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (parent);
+  guint8 ext_id;
+  guint silence_level;
+
+  gst_rtp_dominant_speaker_get_config (self, &ext_id, &silence_level);
+  gst_rtp_dominant_speaker_process (self, buf, ext_id, silence_level);
+
+  return gst_pad_push (self->srcpad, buf);
+}
+
+static GstFlowReturn
+gst_rtp_dominant_speaker_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (parent);
+  guint8 ext_id;
+  guint silence_level;
+  guint i, len;
+
+  gst_rtp_dominant_speaker_get_config (self, &ext_id, &silence_level);
+  len = gst_buffer_list_length (list);
+  for (i = 0; i < len; i++)
+    gst_rtp_dominant_speaker_process (self, gst_buffer_list_get (list, i),
+        ext_id, silence_level);
+
+  return gst_pad_push_list (self->srcpad, list);
+}
+
+static gboolean
+gst_rtp_dominant_speaker_sink_event (GstPad * pad, GstObject * parent,
+    GstEvent * event)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (parent);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+      guint8 ext_id;
+
+      gst_event_parse_caps (event, &caps);
+      ext_id = gst_rtp_get_extmap_id_for_attribute (gst_caps_get_structure
+          (caps, 0), AUDIO_LEVEL_URI);
+
+      GST_OBJECT_LOCK (self);
+      self->caps_ext_id = ext_id;
+      GST_OBJECT_UNLOCK (self);
+      GST_DEBUG_OBJECT (self, "audio level extension id from caps: %u",
+          ext_id);
+      break;
+    }
+    case GST_EVENT_SEGMENT:
+      gst_event_copy_segment (event, &self->segment);
+      if (self->segment.format != GST_FORMAT_TIME) {
+        GST_WARNING_OBJECT (self, "ignoring non-TIME segment");
+        gst_segment_init (&self->segment, GST_FORMAT_TIME);
+      }
+      break;
+    case GST_EVENT_FLUSH_STOP:
+      gst_segment_init (&self->segment, GST_FORMAT_TIME);
+      gst_rtp_dominant_speaker_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return gst_pad_event_default (pad, parent, event);
+}
+
+static void
+gst_rtp_dominant_speaker_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_AUDIO_LEVEL_EXT_ID:
+      self->audio_level_ext_id = g_value_get_uint (value);
+      break;
+    case PROP_SILENCE_LEVEL:
+      self->silence_level = g_value_get_uint (value);
+      break;
+    case PROP_INTERVAL:
+      self->interval = g_value_get_uint (value);
+      break;
+    case PROP_TOP_N:
+      self->top_n = g_value_get_uint (value);
+      break;
+    case PROP_TIMEOUT:
+      self->timeout = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+gst_rtp_dominant_speaker_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (object);
+
+  GST_OBJECT_LOCK (self);
+  switch (prop_id) {
+    case PROP_AUDIO_LEVEL_EXT_ID:
+      g_value_set_uint (value, self->audio_level_ext_id);
+      break;
+    case PROP_SILENCE_LEVEL:
+      g_value_set_uint (value, self->silence_level);
+      break;
+    case PROP_INTERVAL:
+      g_value_set_uint (value, self->interval);
+      break;
+    case PROP_TOP_N:
+      g_value_set_uint (value, self->top_n);
+      break;
+    case PROP_TIMEOUT:
+      g_value_set_uint (value, self->timeout);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static GstStateChangeReturn
+gst_rtp_dominant_speaker_change_state (GstElement * element,
+    GstStateChange transition)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      gst_segment_init (&self->segment, GST_FORMAT_TIME);
+      gst_rtp_dominant_speaker_reset (self);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_dominant_speaker_finalize (GObject * object)
+{
+  GstRtpDominantSpeaker *self = GST_RTP_DOMINANT_SPEAKER_CAST (object);
+
+  g_hash_table_unref (self->speakers);
+  g_array_free (self->active, TRUE);
+  g_ptr_array_free (self->sorted, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_dominant_speaker_class_init (GstRtpDominantSpeakerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_dominant_speaker_set_property;
+  gobject_class->get_property = gst_rtp_dominant_speaker_get_property;
+  gobject_class->finalize =
+      GST_DEBUG_FUNCPTR (gst_rtp_dominant_speaker_finalize);
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_dominant_speaker_change_state);
+
+  g_object_class_install_property (gobject_class, PROP_AUDIO_LEVEL_EXT_ID,
+      g_param_spec_uint ("audio-level-ext-id", "Audio Level Extension ID",
+          "The RTP header extension id of the audio level "
+          "(0 = from the extmap in the caps)",
+          0, 255, DEFAULT_AUDIO_LEVEL_EXT_ID,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_SILENCE_LEVEL,
+      g_param_spec_uint ("silence-level", "Silence Level",
+          "Audio levels at or below -silence-level dBov count as silence",
+          1, 127, DEFAULT_SILENCE_LEVEL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_INTERVAL,
+      g_param_spec_uint ("interval", "Interval",
+          "How often to look for a new dominant speaker in ms",
+          1, G_MAXUINT, DEFAULT_INTERVAL,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TOP_N,
+      g_param_spec_uint ("top-n", "Top N",
+          "The maximum number of active speakers to report",
+          1, G_MAXUINT, DEFAULT_TOP_N,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PROP_TIMEOUT,
+      g_param_spec_uint ("timeout", "Timeout",
+          "Forget an SSRC after not receiving packets from it for this "
+          "many ms", 1, G_MAXUINT, DEFAULT_TIMEOUT,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  gst_element_class_set_static_metadata (gstelement_class,
+      "RTP dominant speaker", "Filter/Network/RTP",
+      "Find the active speakers from the audio level header extension",
+      "Pexip <pexip.com>");
+
+  gst_element_class_add_static_pad_template (gstelement_class, &sink_template);
+  gst_element_class_add_static_pad_template (gstelement_class, &src_template);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_dominant_speaker_debug,
+      "rtpdominantspeaker", 0, "dominant speaker element");
+}
+
+static void
+gst_rtp_dominant_speaker_init (GstRtpDominantSpeaker * self)
+{
+  self->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_dominant_speaker_chain));
+  gst_pad_set_chain_list_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_dominant_speaker_chain_list));
+  gst_pad_set_event_function (self->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_dominant_speaker_sink_event));
+  GST_PAD_SET_PROXY_CAPS (self->sinkpad);
+  GST_PAD_SET_PROXY_ALLOCATION (self->sinkpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->sinkpad);
+
+  self->srcpad = gst_pad_new_from_static_template (&src_template, "src");
+  GST_PAD_SET_PROXY_CAPS (self->srcpad);
+  gst_element_add_pad (GST_ELEMENT (self), self->srcpad);
+
+  self->audio_level_ext_id = DEFAULT_AUDIO_LEVEL_EXT_ID;
+  self->silence_level = DEFAULT_SILENCE_LEVEL;
+  self->interval = DEFAULT_INTERVAL;
+  self->top_n = DEFAULT_TOP_N;
+  self->timeout = DEFAULT_TIMEOUT;
+
+  gst_segment_init (&self->segment, GST_FORMAT_TIME);
+  self->speakers = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+  self->active = g_array_new (FALSE, FALSE, sizeof (guint32));
+  self->sorted = g_ptr_array_new ();
+  gst_rtp_dominant_speaker_reset (self);
+}
@@ -0,0 +1,789 @@
+/* RTP fan-out element for GStreamer
+ *
+ * gstrtpfanout.c:
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/**
+ * SECTION:element-rtpfanout
+ * @title: rtpfanout
+ * @see_also: rtpfunnel, tee
+ *
+ * RTP fan-out forwards one RTP stream to any number of receivers, giving
+ * every receiver its own SSRC, sequence numbers and RTP timestamps. It is
+ * meant for the egress side of a selective forwarding unit, where the same
+ * packets go out in many sessions.
+ *
+ * Doing the same with a tee means every branch has to make the buffer
+ * writable before the header can be changed, which copies the payload once
+ * per receiver. rtpfanout instead writes the headers of all outputs into
+ * one small memory and builds every output buffer from its slice of that
+ * memory followed by the payload memory of the input buffer, which is shared
+ * by all outputs and never copied.
+ *
+ * Each `src_%u` pad translates sequence numbers and timestamps with an offset
+ * that is picked on the first packet, from the "seqnum-offset" and
+ * "timestamp-offset" pad properties. When the input SSRC changes, the offsets
+ * are picked again so that the output continues where it left off, which
+ * lets a receiver be switched between input streams without noticing.
+ *
+ * Buffer lists are pushed as one buffer list per output. Upstream events
+ * carrying the "ssrc" of an output, like the GstForceKeyUnit and
+ * GstRTPRetransmissionRequest events from rtpsession, get the input SSRC and
+ * sequence number put back before they are sent upstream.
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <gst/base/gstflowcombiner.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#include "gstrtpfanout.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_rtp_fanout_debug);
+#define GST_CAT_DEFAULT gst_rtp_fanout_debug
+
+/**************** GstRtpFanoutPad ****************/
+
+enum
+{
+  PAD_PROP_0,
+  PAD_PROP_SSRC,
+  PAD_PROP_SEQNUM_OFFSET,
+  PAD_PROP_TIMESTAMP_OFFSET,
+};
+
+#define DEFAULT_SEQNUM_OFFSET -1
+#define DEFAULT_TIMESTAMP_OFFSET -1
+
+struct _GstRtpFanoutPadClass
+{
+  GstPadClass class;
+};
+
+/* all fields are protected by the OBJECT_LOCK of the pad */
+struct _GstRtpFanoutPad
+{
+  GstPad pad;
+
+  /* properties */
+  guint32 ssrc;
+  gint seqnum_offset;
+  guint32 timestamp_offset;
+
+  /* the ssrc changed and new caps have to be sent */
+  gboolean send_caps;
+  /* set in release_pad, the pad no longer takes part in the flow combining */
+  gboolean released;
+
+  /* translation from the input stream */
+  gboolean have_base;
+  guint32 in_ssrc;
+  guint16 seq_delta;
+  guint32 ts_delta;
+
+  /* the newest packet pushed on this pad */
+  gboolean have_output;
+  guint16 last_seq;
+  guint32 last_ts;
+  GstClockTime last_pts;
+};
+
+G_DEFINE_TYPE (GstRtpFanoutPad, gst_rtp_fanout_pad, GST_TYPE_PAD);
+GST_ELEMENT_REGISTER_DEFINE (rtpfanout, "rtpfanout", GST_RANK_NONE,
+    GST_TYPE_RTP_FANOUT);
+
+static void
+gst_rtp_fanout_pad_set_property (GObject * object, guint prop_id,
+    const GValue * value, GParamSpec * pspec)
+{
+  GstRtpFanoutPad *pad = GST_RTP_FANOUT_PAD_CAST (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PAD_PROP_SSRC:
+    {
+      guint32 ssrc = g_value_get_uint (value);
+      if (ssrc != pad->ssrc) {
+        pad->ssrc = ssrc;
+        pad->send_caps = TRUE;
+      }
+      break;
+    }
+    case PAD_PROP_SEQNUM_OFFSET:
+      pad->seqnum_offset = g_value_get_int (value);
+      break;
+    case PAD_PROP_TIMESTAMP_OFFSET:
+      pad->timestamp_offset = g_value_get_uint (value);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_rtp_fanout_pad_get_property (GObject * object, guint prop_id,
+    GValue * value, GParamSpec * pspec)
+{
+  GstRtpFanoutPad *pad = GST_RTP_FANOUT_PAD_CAST (object);
+
+  GST_OBJECT_LOCK (pad);
+  switch (prop_id) {
+    case PAD_PROP_SSRC:
+      g_value_set_uint (value, pad->ssrc);
+      break;
+    case PAD_PROP_SEQNUM_OFFSET:
+      g_value_set_int (value, pad->seqnum_offset);
+      break;
+    case PAD_PROP_TIMESTAMP_OFFSET:
+      g_value_set_uint (value, pad->timestamp_offset);
+      break;
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static void
+gst_rtp_fanout_pad_class_init (GstRtpFanoutPadClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->set_property = gst_rtp_fanout_pad_set_property;
+  gobject_class->get_property = gst_rtp_fanout_pad_get_property;
+
+  g_object_class_install_property (gobject_class, PAD_PROP_SSRC,
+      g_param_spec_uint ("ssrc", "SSRC",
+          "The SSRC of the packets on this pad (default == random)",
+          0, G_MAXUINT32, 0, G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PAD_PROP_SEQNUM_OFFSET,
+      g_param_spec_int ("seqnum-offset", "Sequence number Offset",
+          "The seqnum of the first packet on this pad (-1 = random)",
+          -1, G_MAXUINT16, DEFAULT_SEQNUM_OFFSET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+  g_object_class_install_property (gobject_class, PAD_PROP_TIMESTAMP_OFFSET,
+      g_param_spec_uint ("timestamp-offset", "Timestamp Offset",
+          "The RTP timestamp of the first packet on this pad (default = random)",
+          0, G_MAXUINT32, DEFAULT_TIMESTAMP_OFFSET,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+}
+
+static void
+gst_rtp_fanout_pad_init (GstRtpFanoutPad * pad)
+{
+  pad->ssrc = g_random_int ();
+  pad->seqnum_offset = DEFAULT_SEQNUM_OFFSET;
+  pad->timestamp_offset = DEFAULT_TIMESTAMP_OFFSET;
+  pad->last_pts = GST_CLOCK_TIME_NONE;
+}
+
+/* Maps a packet of the input stream to this pad. The offsets are picked on
+ * the first packet and again whenever the input SSRC changes, continuing
+ * from the last packet that was pushed so the output stays contiguous. */
+static void
+gst_rtp_fanout_pad_translate (GstRtpFanoutPad * pad, gint clock_rate,
+    guint32 in_ssrc, guint16 in_seq, guint32 in_ts, GstClockTime pts,
+    guint32 * ssrc, guint16 * seq, guint32 * ts)
+{
+  GST_OBJECT_LOCK (pad);
+  if (!pad->have_base || pad->in_ssrc != in_ssrc) {
+    guint16 base_seq;
+    guint32 base_ts;
+
+    if (pad->have_output) {
+      base_seq = pad->last_seq + 1;
+      base_ts = pad->last_ts;
+      if (clock_rate > 0 && GST_CLOCK_TIME_IS_VALID (pts) &&
+          GST_CLOCK_TIME_IS_VALID (pad->last_pts) && pts > pad->last_pts)
+        base_ts += gst_util_uint64_scale_int (pts - pad->last_pts,
+            clock_rate, GST_SECOND);
+      else
+        base_ts += 1;
+    } else {
+      base_seq = pad->seqnum_offset == -1 ?
+          g_random_int_range (0, G_MAXUINT16 + 1) : pad->seqnum_offset;
+      base_ts = pad->timestamp_offset == (guint32) - 1 ?
+          g_random_int () : pad->timestamp_offset;
+    }
+
+    GST_DEBUG_OBJECT (pad, "input ssrc %08x: seqnum %u -> %u, "
+        "timestamp %u -> %u", in_ssrc, in_seq, base_seq, in_ts, base_ts);
+
+    pad->seq_delta = base_seq - in_seq;
+    pad->ts_delta = base_ts - in_ts;
+    pad->in_ssrc = in_ssrc;
+    pad->have_base = TRUE;
+  }
+
+  *ssrc = pad->ssrc;
+  *seq = in_seq + pad->seq_delta;
+  *ts = in_ts + pad->ts_delta;
+
+  if (!pad->have_output || (gint16) (*seq - pad->last_seq) > 0) {
+    pad->last_seq = *seq;
+    pad->last_ts = *ts;
+    pad->last_pts = pts;
+    pad->have_output = TRUE;
+  }
+  GST_OBJECT_UNLOCK (pad);
+}
+
+static GstEvent *
+gst_rtp_fanout_pad_caps_event (GstRtpFanoutPad * pad, GstCaps * caps)
+{
+  GstStructure *s;
+  GstEvent *event;
+  guint32 ssrc;
+
+  GST_OBJECT_LOCK (pad);
+  ssrc = pad->ssrc;
+  pad->send_caps = FALSE;
+  GST_OBJECT_UNLOCK (pad);
+
+  caps = gst_caps_copy (caps);
+  s = gst_caps_get_structure (caps, 0);
+  gst_structure_set (s, "ssrc", G_TYPE_UINT, ssrc, NULL);
+  /* these describe the input stream, not ours */
+  gst_structure_remove_fields (s, "seqnum-offset", "timestamp-offset",
+      "seqnum-base", "clock-base", NULL);
+
+  event = gst_event_new_caps (caps);
+  gst_caps_unref (caps);
+
+  return event;
+}
+
+/* Puts the input SSRC and seqnum back into an upstream event that was sent
+ * for the output stream of @pad */
+static GstEvent *
+gst_rtp_fanout_pad_translate_event (GstRtpFanoutPad * pad, GstEvent * event,
+    guint32 ssrc)
+{
+  GstStructure *s;
+  guint32 in_ssrc;
+  guint16 seq_delta;
+  guint seqnum;
+
+  GST_OBJECT_LOCK (pad);
+  if (!pad->have_base || pad->ssrc != ssrc) {
+    GST_OBJECT_UNLOCK (pad);
+    return event;
+  }
+  in_ssrc = pad->in_ssrc;
+  seq_delta = pad->seq_delta;
+  GST_OBJECT_UNLOCK (pad);
+
+  event = gst_event_make_writable (event);
+  s = gst_event_writable_structure (event);
+  gst_structure_set (s, "ssrc", G_TYPE_UINT, in_ssrc, NULL);
+  /* also covers the first seqnum of a GstRTPRetransmissionRequestBatch, the
+   * bitmap is relative to it */
+  if (gst_structure_get_uint (s, "seqnum", &seqnum))
+    gst_structure_set (s, "seqnum", G_TYPE_UINT,
+        (guint) (guint16) (seqnum - seq_delta), NULL);
+
+  return event;
+}
+
+/**************** GstRtpFanout ****************/
+
+struct _GstRtpFanoutClass
+{
+  GstElementClass class;
+};
+
+struct _GstRtpFanout
+{
+  GstElement element;
+
+  GstPad *sinkpad;
+  GstFlowCombiner *flow_combiner;       /* protected by OBJECT_LOCK */
+  guint next_pad_id;            /* protected by OBJECT_LOCK */
+
+  /* streaming thread */
+  gint clock_rate;
+  /* the src pads and their output for the buffer (list) being pushed, kept
+   * around to not allocate them for every packet */
+  GPtrArray *pads;
+  GPtrArray *outputs;
+};
+
+#define RTP_CAPS "application/x-rtp"
+
+static GstStaticPadTemplate sink_template = GST_STATIC_PAD_TEMPLATE ("sink",
+    GST_PAD_SINK,
+    GST_PAD_ALWAYS,
+    GST_STATIC_CAPS (RTP_CAPS));
+
+static GstStaticPadTemplate src_template = GST_STATIC_PAD_TEMPLATE ("src_%u",
+    GST_PAD_SRC,
+    GST_PAD_REQUEST,
+    GST_STATIC_CAPS (RTP_CAPS));
+
+#define gst_rtp_fanout_parent_class parent_class
+G_DEFINE_TYPE (GstRtpFanout, gst_rtp_fanout, GST_TYPE_ELEMENT);
+
+/* takes a reference to every src pad into fanout->pads */
+static guint
+gst_rtp_fanout_collect_pads (GstRtpFanout * fanout)
+{
+  GList *walk;
+
+  GST_OBJECT_LOCK (fanout);
+  for (walk = GST_ELEMENT_CAST (fanout)->srcpads; walk; walk = walk->next)
+    g_ptr_array_add (fanout->pads, gst_object_ref (walk->data));
+  GST_OBJECT_UNLOCK (fanout);
+
+  return fanout->pads->len;
+}
+
+static void
+gst_rtp_fanout_clear_pads (GstRtpFanout * fanout)
+{
+  guint i;
+
+  for (i = 0; i < fanout->pads->len; i++)
+    gst_object_unref (g_ptr_array_index (fanout->pads, i));
+  g_ptr_array_set_size (fanout->pads, 0);
+}
+
+/* Makes one output buffer per pad in fanout->pads out of @buf, and either
+ * stores it in fanout->outputs or adds it to the buffer list there. The
+ * headers of all outputs are written to a single memory, and the rest of
+ * @buf is shared by all of them. */
+static void
+gst_rtp_fanout_rewrite (GstRtpFanout * fanout, GstBuffer * buf,
+    gboolean to_lists)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint n = fanout->pads->len;
+  guint hdr_len, i;
+  guint32 in_ssrc, in_ts;
+  guint16 in_seq;
+  GstClockTime pts;
+  GstMemory *hdr_mem;
+  GstMapInfo map;
+
+  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp)) {
+    GST_WARNING_OBJECT (fanout, "Dropping invalid RTP buffer %" GST_PTR_FORMAT,
+        buf);
+    return;
+  }
+  hdr_len = gst_rtp_buffer_get_header_len (&rtp);
+  in_ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  in_seq = gst_rtp_buffer_get_seq (&rtp);
+  in_ts = gst_rtp_buffer_get_timestamp (&rtp);
+  gst_rtp_buffer_unmap (&rtp);
+
+  pts = GST_BUFFER_PTS (buf);
+
+  hdr_mem = gst_allocator_alloc (NULL, n * hdr_len, NULL);
+  gst_memory_map (hdr_mem, &map, GST_MAP_WRITE);
+  gst_buffer_extract (buf, 0, map.data, hdr_len);
+  for (i = 0; i < n; i++) {
+    GstRtpFanoutPad *pad = g_ptr_array_index (fanout->pads, i);
+    guint8 *hdr = map.data + i * hdr_len;
+    guint32 ssrc, ts;
+    guint16 seq;
+
+    if (i > 0)
+      memcpy (hdr, map.data, hdr_len);
+
+    gst_rtp_fanout_pad_translate (pad, fanout->clock_rate, in_ssrc, in_seq,
+        in_ts, pts, &ssrc, &seq, &ts);
+
+    GST_WRITE_UINT16_BE (hdr + 2, seq);
+    GST_WRITE_UINT32_BE (hdr + 4, ts);
+    GST_WRITE_UINT32_BE (hdr + 8, ssrc);
+  }
+  gst_memory_unmap (hdr_mem, &map);
+
+  for (i = 0; i < n; i++) {
+    GstBuffer *out;
+
+    /* shares the memory of the payload, copying the timestamps is only done
+     * for regions at offset 0 so that is done by hand */
+    out = gst_buffer_copy_region (buf, GST_BUFFER_COPY_FLAGS |
+        GST_BUFFER_COPY_META | GST_BUFFER_COPY_MEMORY, hdr_len, -1);
+    GST_BUFFER_PTS (out) = pts;
+    GST_BUFFER_DTS (out) = GST_BUFFER_DTS (buf);
+    GST_BUFFER_DURATION (out) = GST_BUFFER_DURATION (buf);
+    gst_buffer_prepend_memory (out,
+        gst_memory_share (hdr_mem, i * hdr_len, hdr_len));
+
+    if (to_lists)
+      gst_buffer_list_add (g_ptr_array_index (fanout->outputs, i), out);
+    else
+      g_ptr_array_index (fanout->outputs, i) = out;
+  }
+
+  gst_memory_unref (hdr_mem);
+}
+
+static void
+gst_rtp_fanout_send_caps (GstRtpFanout * fanout, GstRtpFanoutPad * pad)
+{
+  GstCaps *caps;
+  gboolean send_caps;
+
+  GST_OBJECT_LOCK (pad);
+  send_caps = pad->send_caps;
+  GST_OBJECT_UNLOCK (pad);
+
+  if (!send_caps)
+    return;
+
+  caps = gst_pad_get_current_caps (fanout->sinkpad);
+  if (caps) {
+    gst_pad_push_event (GST_PAD_CAST (pad),
+        gst_rtp_fanout_pad_caps_event (pad, caps));
+    gst_caps_unref (caps);
+  }
+}
+
+static GstFlowReturn
+gst_rtp_fanout_chain_object (GstRtpFanout * fanout, gboolean is_list,
+    GstMiniObject * obj)
+{
+  GstFlowReturn ret = GST_FLOW_OK;
+  guint n, i;
+
+  GST_LOG_OBJECT (fanout, "received %" GST_PTR_FORMAT, obj);
+
+  n = gst_rtp_fanout_collect_pads (fanout);
+  if (n == 0) {
+    gst_mini_object_unref (obj);
+    return GST_FLOW_OK;
+  }
+
+  g_ptr_array_set_size (fanout->outputs, n);
+  if (is_list) {
+    GstBufferList *list = GST_BUFFER_LIST_CAST (obj);
+    guint len = gst_buffer_list_length (list);
+
+    for (i = 0; i < n; i++)
+      g_ptr_array_index (fanout->outputs, i) = gst_buffer_list_new_sized (len);
+    for (i = 0; i < len; i++)
+      gst_rtp_fanout_rewrite (fanout, gst_buffer_list_get (list, i), TRUE);
+  } else {
+    gst_rtp_fanout_rewrite (fanout, GST_BUFFER_CAST (obj), FALSE);
+  }
+  gst_mini_object_unref (obj);
+
+  for (i = 0; i < n; i++) {
+    GstRtpFanoutPad *pad = g_ptr_array_index (fanout->pads, i);
+    GstMiniObject *out = g_ptr_array_index (fanout->outputs, i);
+    GstFlowReturn pad_ret;
+    gboolean released;
+
+    g_ptr_array_index (fanout->outputs, i) = NULL;
+    if (out == NULL)
+      continue;
+    if (is_list && gst_buffer_list_length (GST_BUFFER_LIST_CAST (out)) == 0) {
+      gst_mini_object_unref (out);
+      continue;
+    }
+
+    gst_rtp_fanout_send_caps (fanout, pad);
+
+    if (is_list)
+      pad_ret = gst_pad_push_list (GST_PAD_CAST (pad),
+          GST_BUFFER_LIST_CAST (out));
+    else
+      pad_ret = gst_pad_push (GST_PAD_CAST (pad), GST_BUFFER_CAST (out));
+
+    GST_OBJECT_LOCK (fanout);
+    GST_OBJECT_LOCK (pad);
+    released = pad->released;
+    GST_OBJECT_UNLOCK (pad);
+    /* a pad that was released while pushing is flushing, which must not
+     * stop the other receivers */
+    if (!released)
+      ret = gst_flow_combiner_update_pad_flow (fanout->flow_combiner,
+          GST_PAD_CAST (pad), pad_ret);
+    GST_OBJECT_UNLOCK (fanout);
+  }
+  g_ptr_array_set_size (fanout->outputs, 0);
+  gst_rtp_fanout_clear_pads (fanout);
+
+  return ret;
+}
+
+static GstFlowReturn
+gst_rtp_fanout_sink_chain_list (GstPad * pad, GstObject * parent,
+    GstBufferList * list)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (parent);
+
+  return gst_rtp_fanout_chain_object (fanout, TRUE,
+      GST_MINI_OBJECT_CAST (list));
+}
+
+static GstFlowReturn
+gst_rtp_fanout_sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (parent);
+
+  return gst_rtp_fanout_chain_object (fanout, FALSE,
+      GST_MINI_OBJECT_CAST (buffer));
+}
+
+static gboolean
+gst_rtp_fanout_sink_caps (GstRtpFanout * fanout, GstCaps * caps)
+{
+  GstStructure *s = gst_caps_get_structure (caps, 0);
+  gboolean ret = TRUE;
+  guint n, i;
+
+  if (!gst_structure_get_int (s, "clock-rate", &fanout->clock_rate))
+    fanout->clock_rate = -1;
+
+  n = gst_rtp_fanout_collect_pads (fanout);
+  for (i = 0; i < n; i++) {
+    GstRtpFanoutPad *pad = g_ptr_array_index (fanout->pads, i);
+
+    ret &= gst_pad_push_event (GST_PAD_CAST (pad),
+        gst_rtp_fanout_pad_caps_event (pad, caps));
+  }
+  gst_rtp_fanout_clear_pads (fanout);
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_fanout_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (parent);
+  gboolean ret;
+
+  GST_DEBUG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
+
+  switch (GST_EVENT_TYPE (event)) {
+    case GST_EVENT_CAPS:
+    {
+      GstCaps *caps;
+
+      gst_event_parse_caps (event, &caps);
+      ret = gst_rtp_fanout_sink_caps (fanout, caps);
+      gst_event_unref (event);
+      break;
+    }
+    case GST_EVENT_FLUSH_STOP:
+      ret = gst_pad_event_default (pad, parent, event);
+      GST_OBJECT_LOCK (fanout);
+      gst_flow_combiner_reset (fanout->flow_combiner);
+      GST_OBJECT_UNLOCK (fanout);
+      break;
+    default:
+      ret = gst_pad_event_default (pad, parent, event);
+      break;
+  }
+
+  return ret;
+}
+
+static gboolean
+gst_rtp_fanout_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (parent);
+
+  GST_DEBUG_OBJECT (pad, "received event %" GST_PTR_FORMAT, event);
+
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM) {
+    const GstStructure *s = gst_event_get_structure (event);
+    guint ssrc;
+
+    if (s && gst_structure_get_uint (s, "ssrc", &ssrc))
+      event = gst_rtp_fanout_pad_translate_event (GST_RTP_FANOUT_PAD_CAST (pad),
+          event, ssrc);
+  }
+
+  return gst_pad_push_event (fanout->sinkpad, event);
+}
+
+static gboolean
+copy_sticky_event (GstPad * pad, GstEvent ** event, gpointer user_data)
+{
+  GstRtpFanoutPad *srcpad = GST_RTP_FANOUT_PAD_CAST (user_data);
+  GstEvent *ev;
+
+  if (GST_EVENT_TYPE (*event) == GST_EVENT_CAPS) {
+    GstCaps *caps;
+
+    gst_event_parse_caps (*event, &caps);
+    ev = gst_rtp_fanout_pad_caps_event (srcpad, caps);
+  } else {
+    ev = gst_event_ref (*event);
+  }
+
+  if (gst_pad_store_sticky_event (GST_PAD_CAST (srcpad), ev) != GST_FLOW_OK)
+    GST_WARNING_OBJECT (srcpad, "Could not store %" GST_PTR_FORMAT, ev);
+  gst_event_unref (ev);
+
+  return TRUE;
+}
+
+static GstPad *
+gst_rtp_fanout_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name, const GstCaps * caps)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (element);
+  GstPad *srcpad;
+  gchar *pad_name;
+
+  GST_OBJECT_LOCK (fanout);
+  if (name)
+    pad_name = g_strdup (name);
+  else
+    pad_name = g_strdup_printf ("src_%u", fanout->next_pad_id++);
+  GST_OBJECT_UNLOCK (fanout);
+
+  srcpad = GST_PAD_CAST (g_object_new (GST_TYPE_RTP_FANOUT_PAD,
+          "name", pad_name, "direction", templ->direction, "template", templ,
+          NULL));
+  g_free (pad_name);
+
+  gst_pad_set_event_function (srcpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_src_event));
+  gst_pad_use_fixed_caps (srcpad);
+
+  gst_pad_set_active (srcpad, TRUE);
+  gst_pad_sticky_events_foreach (fanout->sinkpad, copy_sticky_event, srcpad);
+
+  GST_OBJECT_LOCK (fanout);
+  gst_flow_combiner_add_pad (fanout->flow_combiner, srcpad);
+  GST_OBJECT_UNLOCK (fanout);
+
+  gst_element_add_pad (element, srcpad);
+
+  GST_DEBUG_OBJECT (element, "requested pad %s:%s",
+      GST_DEBUG_PAD_NAME (srcpad));
+
+  return srcpad;
+}
+
+static void
+gst_rtp_fanout_release_pad (GstElement * element, GstPad * pad)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (element);
+
+  GST_DEBUG_OBJECT (fanout, "releasing pad %s:%s", GST_DEBUG_PAD_NAME (pad));
+
+  GST_OBJECT_LOCK (fanout);
+  GST_OBJECT_LOCK (pad);
+  GST_RTP_FANOUT_PAD_CAST (pad)->released = TRUE;
+  GST_OBJECT_UNLOCK (pad);
+  gst_flow_combiner_remove_pad (fanout->flow_combiner, pad);
+  GST_OBJECT_UNLOCK (fanout);
+
+  gst_pad_set_active (pad, FALSE);
+  gst_element_remove_pad (element, pad);
+}
+
+static GstStateChangeReturn
+gst_rtp_fanout_change_state (GstElement * element, GstStateChange transition)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (element);
+  GstStateChangeReturn ret;
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_OBJECT_LOCK (fanout);
+      gst_flow_combiner_reset (fanout->flow_combiner);
+      GST_OBJECT_UNLOCK (fanout);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
+static void
+gst_rtp_fanout_finalize (GObject * object)
+{
+  GstRtpFanout *fanout = GST_RTP_FANOUT_CAST (object);
+
+  gst_flow_combiner_free (fanout->flow_combiner);
+  g_ptr_array_free (fanout->pads, TRUE);
+  g_ptr_array_free (fanout->outputs, TRUE);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_rtp_fanout_class_init (GstRtpFanoutClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GstElementClass *gstelement_class = GST_ELEMENT_CLASS (klass);
+
+  gobject_class->finalize = GST_DEBUG_FUNCPTR (gst_rtp_fanout_finalize);
+  gstelement_class->request_new_pad =
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_request_new_pad);
+  gstelement_class->release_pad =
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_release_pad);
+  gstelement_class->change_state =
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_change_state);
+
+  gst_element_class_set_static_metadata (gstelement_class, "RTP fan-out",
+      "Generic/RTP",
+      "Forward an RTP stream to many receivers with their own SSRC, "
+      "seqnum and timestamp", "Pexip <pexip.com>");
+
+  gst_element_class_add_static_pad_template (gstelement_class, &sink_template);
+  gst_element_class_add_static_pad_template_with_gtype (gstelement_class,
+      &src_template, GST_TYPE_RTP_FANOUT_PAD);
+
+  gst_type_mark_as_plugin_api (GST_TYPE_RTP_FANOUT_PAD, 0);
+
+  GST_DEBUG_CATEGORY_INIT (gst_rtp_fanout_debug,
+      "gstrtpfanout", 0, "fan-out element");
+}
+
+static void
+gst_rtp_fanout_init (GstRtpFanout * fanout)
+{
+  fanout->sinkpad = gst_pad_new_from_static_template (&sink_template, "sink");
+  gst_pad_set_chain_function (fanout->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_sink_chain));
+  gst_pad_set_chain_list_function (fanout->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_sink_chain_list));
+  gst_pad_set_event_function (fanout->sinkpad,
+      GST_DEBUG_FUNCPTR (gst_rtp_fanout_sink_event));
+
+  gst_element_add_pad (GST_ELEMENT (fanout), fanout->sinkpad);
+
+  fanout->flow_combiner = gst_flow_combiner_new ();
+  fanout->clock_rate = -1;
+  fanout->pads = g_ptr_array_new ();
+  fanout->outputs = g_ptr_array_new ();
+}
@@ -0,0 +1,49 @@
+/* RTP fan-out element for GStreamer
+ *
+ * gstrtpfanout.h:
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#ifndef __GST_RTP_FANOUT_H__
+#define __GST_RTP_FANOUT_H__
+
+#include <gst/gst.h>
+
+G_BEGIN_DECLS
+
+typedef struct _GstRtpFanoutClass GstRtpFanoutClass;
+typedef struct _GstRtpFanout GstRtpFanout;
+
+#define GST_TYPE_RTP_FANOUT (gst_rtp_fanout_get_type())
+#define GST_RTP_FANOUT_CAST(obj) ((GstRtpFanout *)(obj))
+
+GType gst_rtp_fanout_get_type (void);
+
+GST_ELEMENT_REGISTER_DECLARE (rtpfanout);
+
+typedef struct _GstRtpFanoutPadClass GstRtpFanoutPadClass;
+typedef struct _GstRtpFanoutPad GstRtpFanoutPad;
+
+#define GST_TYPE_RTP_FANOUT_PAD (gst_rtp_fanout_pad_get_type())
+#define GST_RTP_FANOUT_PAD_CAST(obj) ((GstRtpFanoutPad *)(obj))
+
+GType gst_rtp_fanout_pad_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_RTP_FANOUT_H__ */
@@ -84,6 +84,13 @@
  * retransmission requests are sent and the regular logic is performed to
  * schedule a lost packet as discussed above.
  *
+ * With #GstRtpJitterBuffer:rtx-batch-requests set, all the packets that are
+ * late at the same time are requested with a single
+ * GstRTPRetransmissionRequestBatch event instead. It has the same fields as
+ * GstRTPRetransmissionRequest, but `seqnum` is the first requested seqnum and
+ * the #GBytes `bitmap` field has bit N (least significant bit first) set when
+ * seqnum + N is requested.
+ *
  * This element acts as a live element and so adds #GstRtpJitterBuffer:latency
  * to the pipeline.
  *
@@ -154,6 +161,7 @@ enum
 #define DEFAULT_RTX_MAX_RETRIES    -1
 #define DEFAULT_RTX_DEADLINE       -1
 #define DEFAULT_RTX_STATS_TIMEOUT   1000
+#define DEFAULT_RTX_BATCH_REQUESTS  FALSE
 #define DEFAULT_MAX_RTCP_RTP_TIME_DIFF 1000
 #define DEFAULT_MAX_DROPOUT_TIME    60000
 #define DEFAULT_MAX_MISORDER_TIME   2000
@@ -188,6 +196,7 @@ enum
   PROP_RTX_MAX_RETRIES,
   PROP_RTX_DEADLINE,
   PROP_RTX_STATS_TIMEOUT,
+  PROP_RTX_BATCH_REQUESTS,
   PROP_STATS,
   PROP_MAX_RTCP_RTP_TIME_DIFF,
   PROP_MAX_DROPOUT_TIME,
@@ -342,6 +351,7 @@ struct _GstRtpJitterBufferPrivate
   gint rtx_max_retries;
   guint rtx_stats_timeout;
   gint rtx_deadline_ms;
+  gboolean rtx_batch_requests;
   gint max_rtcp_rtp_time_diff;
   guint32 max_dropout_time;
   guint32 max_misorder_time;
@@ -384,6 +394,12 @@ struct _GstRtpJitterBufferPrivate
 
   /* "normal" timers */
   RtpTimerQueue *timers;
+  /* retransmission requests collected during one pass over the expired
+   * timers when rtx-batch-requests is set */
+  GArray *rtx_batch;
+  GstClockTime rtx_batch_running_time;
+  guint rtx_batch_delay_ms;
+  guint rtx_batch_retry;
   /* timers used for RTX statistics backlog */
   RtpTimerQueue *rtx_stats_timers;
 
@@ -955,6 +971,21 @@ gst_rtp_jitter_buffer_class_init (GstRtpJitterBufferClass * klass)
           0, G_MAXUINT, DEFAULT_RTX_STATS_TIMEOUT,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstRtpJitterBuffer:rtx-batch-requests:
+   *
+   * Instead of one GstRTPRetransmissionRequest event per missing packet, send
+   * a single GstRTPRetransmissionRequestBatch event for all the packets that
+   * became late during one pass over the expired timers.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_RTX_BATCH_REQUESTS,
+      g_param_spec_boolean ("rtx-batch-requests", "RTX Batch Requests",
+          "Send the retransmission requests of one timeout pass upstream "
+          "as a single event", DEFAULT_RTX_BATCH_REQUESTS,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   g_object_class_install_property (gobject_class, PROP_MAX_DROPOUT_TIME,
       g_param_spec_uint ("max-dropout-time", "Max dropout time",
           "The maximum time (milliseconds) of missing packets tolerated.",
@@ -1186,6 +1217,7 @@ gst_rtp_jitter_buffer_init (GstRtpJitterBuffer * jitterbuffer)
   priv->rtx_max_retries = DEFAULT_RTX_MAX_RETRIES;
   priv->rtx_deadline_ms = DEFAULT_RTX_DEADLINE;
   priv->rtx_stats_timeout = DEFAULT_RTX_STATS_TIMEOUT;
+  priv->rtx_batch_requests = DEFAULT_RTX_BATCH_REQUESTS;
   priv->max_rtcp_rtp_time_diff = DEFAULT_MAX_RTCP_RTP_TIME_DIFF;
   priv->max_dropout_time = DEFAULT_MAX_DROPOUT_TIME;
   priv->max_misorder_time = DEFAULT_MAX_MISORDER_TIME;
@@ -1215,6 +1247,7 @@ gst_rtp_jitter_buffer_init (GstRtpJitterBuffer * jitterbuffer)
   priv->segment_seqnum = GST_SEQNUM_INVALID;
   priv->timers = rtp_timer_queue_new ();
   priv->rtx_stats_timers = rtp_timer_queue_new ();
+  priv->rtx_batch = g_array_new (FALSE, FALSE, sizeof (guint16));
   priv->jbuf = rtp_jitter_buffer_new ();
   g_mutex_init (&priv->jbuf_lock);
   g_cond_init (&priv->jbuf_queue);
@@ -1286,6 +1319,7 @@ gst_rtp_jitter_buffer_finalize (GObject * object)
 
   g_object_unref (priv->timers);
   g_object_unref (priv->rtx_stats_timers);
+  g_array_free (priv->rtx_batch, TRUE);
   g_mutex_clear (&priv->jbuf_lock);
   g_cond_clear (&priv->jbuf_queue);
   g_cond_clear (&priv->jbuf_timer);
@@ -4345,19 +4379,37 @@ do_expected_timeout (GstRtpJitterBuffer * jitterbuffer, RtpTimer * timer,
   rtx_deadline_ms =
       priv->rtx_deadline_ms != -1 ? priv->rtx_deadline_ms : priv->latency_ms;
 
-  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
-      gst_structure_new ("GstRTPRetransmissionRequest",
-          "seqnum", G_TYPE_UINT, (guint) timer->seqnum,
-          "running-time", G_TYPE_UINT64, timer->rtx_base,
-          "delay", G_TYPE_UINT, delay_ms,
-          "retry", G_TYPE_UINT, timer->num_rtx_retry,
-          "frequency", G_TYPE_UINT, rtx_retry_timeout_ms,
-          "period", G_TYPE_UINT, rtx_retry_period_ms,
-          "deadline", G_TYPE_UINT, rtx_deadline_ms,
-          "packet-spacing", G_TYPE_UINT64, priv->packet_spacing,
-          "avg-rtt", G_TYPE_UINT, avg_rtx_rtt_ms, NULL));
-  g_queue_push_tail (events, event);
-  GST_DEBUG_OBJECT (jitterbuffer, "Request RTX: %" GST_PTR_FORMAT, event);
+  if (priv->rtx_batch_requests) {
+    /* the event is created by queue_rtx_batch_event() once all the expired
+     * timers have been handled */
+    if (priv->rtx_batch->len == 0) {
+      priv->rtx_batch_running_time = timer->rtx_base;
+      priv->rtx_batch_delay_ms = delay_ms;
+      priv->rtx_batch_retry = timer->num_rtx_retry;
+    } else {
+      priv->rtx_batch_running_time =
+          MIN (priv->rtx_batch_running_time, timer->rtx_base);
+      priv->rtx_batch_delay_ms = MAX (priv->rtx_batch_delay_ms, delay_ms);
+      priv->rtx_batch_retry = MAX (priv->rtx_batch_retry, timer->num_rtx_retry);
+    }
+    g_array_append_val (priv->rtx_batch, timer->seqnum);
+    GST_DEBUG_OBJECT (jitterbuffer, "Request RTX: #%d (batched)",
+        timer->seqnum);
+  } else {
+    event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+        gst_structure_new ("GstRTPRetransmissionRequest",
+            "seqnum", G_TYPE_UINT, (guint) timer->seqnum,
+            "running-time", G_TYPE_UINT64, timer->rtx_base,
+            "delay", G_TYPE_UINT, delay_ms,
+            "retry", G_TYPE_UINT, timer->num_rtx_retry,
+            "frequency", G_TYPE_UINT, rtx_retry_timeout_ms,
+            "period", G_TYPE_UINT, rtx_retry_period_ms,
+            "deadline", G_TYPE_UINT, rtx_deadline_ms,
+            "packet-spacing", G_TYPE_UINT64, priv->packet_spacing,
+            "avg-rtt", G_TYPE_UINT, avg_rtx_rtt_ms, NULL));
+    g_queue_push_tail (events, event);
+    GST_DEBUG_OBJECT (jitterbuffer, "Request RTX: %" GST_PTR_FORMAT, event);
+  }
 
   priv->num_rtx_requests++;
   timer->num_rtx_retry++;
@@ -4490,6 +4542,76 @@ do_timeout (GstRtpJitterBuffer * jitterbuffer, RtpTimer * timer,
   return removed;
 }
 
+/* called with JBUF lock
+ *
+ * Turns the retransmission requests collected by do_expected_timeout() into
+ * one GstRTPRetransmissionRequestBatch event on @events. The seqnums are
+ * carried as a bitmap relative to the lowest one, bit N set for seqnum + N.
+ */
+static void
+queue_rtx_batch_event (GstRtpJitterBuffer * jitterbuffer, GQueue * events)
+{
+  GstRtpJitterBufferPrivate *priv = jitterbuffer->priv;
+  guint16 *seqnums = (guint16 *) priv->rtx_batch->data;
+  GstClockTime rtx_retry_timeout, rtx_retry_period;
+  guint rtx_deadline_ms;
+  gint min_diff = 0, max_diff = 0;
+  guint16 base;
+  guint8 *bitmap;
+  gsize size;
+  GBytes *bytes;
+  GstEvent *event;
+  guint i;
+
+  if (priv->rtx_batch->len == 0)
+    return;
+
+  for (i = 1; i < priv->rtx_batch->len; i++) {
+    gint diff = (gint16) (seqnums[i] - seqnums[0]);
+
+    min_diff = MIN (min_diff, diff);
+    max_diff = MAX (max_diff, diff);
+  }
+  base = seqnums[0] + min_diff;
+
+  size = (max_diff - min_diff) / 8 + 1;
+  bitmap = g_malloc0 (size);
+  for (i = 0; i < priv->rtx_batch->len; i++) {
+    guint16 bit = seqnums[i] - base;
+
+    bitmap[bit / 8] |= 1 << (bit % 8);
+  }
+  bytes = g_bytes_new_take (bitmap, size);
+
+  rtx_retry_timeout = get_rtx_retry_timeout (priv);
+  rtx_retry_period = get_rtx_retry_period (priv, rtx_retry_timeout);
+  rtx_deadline_ms =
+      priv->rtx_deadline_ms != -1 ? priv->rtx_deadline_ms : priv->latency_ms;
+
+  event = gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+      gst_structure_new ("GstRTPRetransmissionRequestBatch",
+          "seqnum", G_TYPE_UINT, (guint) base,
+          "bitmap", G_TYPE_BYTES, bytes,
+          "running-time", G_TYPE_UINT64, priv->rtx_batch_running_time,
+          "delay", G_TYPE_UINT, priv->rtx_batch_delay_ms,
+          "retry", G_TYPE_UINT, priv->rtx_batch_retry,
+          "frequency", G_TYPE_UINT,
+          (guint) GST_TIME_AS_MSECONDS (rtx_retry_timeout),
+          "period", G_TYPE_UINT,
+          (guint) GST_TIME_AS_MSECONDS (rtx_retry_period),
+          "deadline", G_TYPE_UINT, rtx_deadline_ms,
+          "packet-spacing", G_TYPE_UINT64, priv->packet_spacing,
+          "avg-rtt", G_TYPE_UINT,
+          (guint) GST_TIME_AS_MSECONDS (priv->avg_rtx_rtt), NULL));
+  g_bytes_unref (bytes);
+
+  g_queue_push_tail (events, event);
+  GST_DEBUG_OBJECT (jitterbuffer, "Request RTX for %u packets: %"
+      GST_PTR_FORMAT, priv->rtx_batch->len, event);
+
+  g_array_set_size (priv->rtx_batch, 0);
+}
+
 static void
 push_rtx_events_unlocked (GstRtpJitterBuffer * jitterbuffer, GQueue * events)
 {
@@ -4570,6 +4692,7 @@ wait_next_timeout (GstRtpJitterBuffer * jitterbuffer)
     /* Iterate expired "normal" timers */
     while ((timer = rtp_timer_queue_pop_until (priv->timers, now)))
       do_timeout (jitterbuffer, timer, now, &events);
+    queue_rtx_batch_event (jitterbuffer, &events);
 
     timer = rtp_timer_queue_peek_earliest (priv->timers);
     if (timer) {
@@ -5347,6 +5470,11 @@ gst_rtp_jitter_buffer_set_property (GObject * object,
       priv->rtx_stats_timeout = g_value_get_uint (value);
       JBUF_UNLOCK (priv);
       break;
+    case PROP_RTX_BATCH_REQUESTS:
+      JBUF_LOCK (priv);
+      priv->rtx_batch_requests = g_value_get_boolean (value);
+      JBUF_UNLOCK (priv);
+      break;
     case PROP_MAX_RTCP_RTP_TIME_DIFF:
       JBUF_LOCK (priv);
       priv->max_rtcp_rtp_time_diff = g_value_get_int (value);
@@ -5509,6 +5637,11 @@ gst_rtp_jitter_buffer_get_property (GObject * object,
       g_value_set_uint (value, priv->rtx_stats_timeout);
       JBUF_UNLOCK (priv);
       break;
+    case PROP_RTX_BATCH_REQUESTS:
+      JBUF_LOCK (priv);
+      g_value_set_boolean (value, priv->rtx_batch_requests);
+      JBUF_UNLOCK (priv);
+      break;
     case PROP_STATS:
       g_value_take_boxed (value,
           gst_rtp_jitter_buffer_create_stats (jitterbuffer));
@@ -32,6 +32,8 @@
 #include "gstrtpdtmfmux.h"
 #include "gstrtpmux.h"
 #include "gstrtpfunnel.h"
+#include "gstrtpfanout.h"
+#include "gstrtpdominantspeaker.h"
 #include "gstrtpst2022-1-fecdec.h"
 #include "gstrtpst2022-1-fecenc.h"
 #include "gstrtphdrext-twcc.h"
@@ -58,6 +60,8 @@ plugin_init (GstPlugin * plugin)
   ret |= GST_ELEMENT_REGISTER (rtpmux, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpdtmfmux, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpfunnel, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpfanout, plugin);
+  ret |= GST_ELEMENT_REGISTER (rtpdominantspeaker, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpst2022_1_fecdec, plugin);
   ret |= GST_ELEMENT_REGISTER (rtpst2022_1_fecenc, plugin);
   ret |= GST_ELEMENT_REGISTER (rtphdrexttwcc, plugin);
@@ -450,15 +450,14 @@ gst_rtp_pt_demux_chain (GstPad * pad, GstObject * parent, GstBuffer * buf)
   guint8 pt;
   GstPad *srcpad;
   GstCaps *caps;
-  GstRTPBuffer rtp = { NULL };
+  GstRTPHeaderView rtp = GST_RTP_HEADER_VIEW_INIT;
 
   rtpdemux = GST_RTP_PT_DEMUX (parent);
 
-  if (!gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp))
+  if (!gst_rtp_header_view_init (&rtp, buf))
     goto invalid_buffer;
 
-  pt = gst_rtp_buffer_get_payload_type (&rtp);
-  gst_rtp_buffer_unmap (&rtp);
+  pt = gst_rtp_header_view_get_payload_type (&rtp);
 
   if (gst_rtp_pt_demux_pt_is_ignored (rtpdemux, pt))
     goto ignored;
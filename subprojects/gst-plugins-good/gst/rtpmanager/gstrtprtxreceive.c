@@ -82,7 +82,8 @@
  * drop-probability to something greater than 0.
  *
  * Internally, the rtpjitterbuffer will generate a custom upstream event,
- * GstRTPRetransmissionRequest, when it detects that one packet is missing.
+ * GstRTPRetransmissionRequest, when it detects that one packet is missing
+ * (or GstRTPRetransmissionRequestBatch for several packets at once).
  * Then this request is translated to a FB NACK in the rtcp link by rtpsession.
  * Finally the rtpsession of the sender side will re-convert it in a
  * GstRTPRetransmissionRequest that will be handled by rtprtxsend. rtprtxsend
@@ -427,6 +428,92 @@ gst_rtp_rtx_receive_init (GstRtpRtxReceive * rtx)
   rtx->dummy_writable = gst_buffer_new ();
 }
 
+/* Called with the object lock. Remembers that @seqnum of @ssrc was requested
+ * so the retransmission stream can be associated to it. Returns %FALSE if
+ * the request has to be rejected. */
+static gboolean
+gst_rtp_rtx_receive_register_request (GstRtpRtxReceive * rtx, guint seqnum,
+    guint ssrc)
+{
+  gpointer ssrc2 = 0;
+
+  /* increase number of seen requests for our statistics */
+  ++rtx->num_rtx_requests;
+
+  /* First, we lookup in our map to see if we have already associate this
+   * master stream ssrc with its retransmitted stream.
+   * Every ssrc are unique so we can use the same hash table
+   * for both retrieving the ssrc1 from ssrc2 and also ssrc2 from ssrc1
+   */
+  if (g_hash_table_lookup_extended (rtx->ssrc2_ssrc1_map,
+          GUINT_TO_POINTER (ssrc), NULL, &ssrc2)
+      && GPOINTER_TO_UINT (ssrc2) != GPOINTER_TO_UINT (ssrc)) {
+    GST_TRACE_OBJECT (rtx, "Retransmitted stream %X already associated "
+        "to its master, %X", GPOINTER_TO_UINT (ssrc2), ssrc);
+  } else {
+    SsrcAssoc *assoc;
+
+    /* not already associated but also we have to check that we have not
+     * already considered this request.
+     */
+    if (g_hash_table_lookup_extended (rtx->seqnum_ssrc1_map,
+            GUINT_TO_POINTER (seqnum), NULL, (gpointer *) & assoc)) {
+      if (assoc->ssrc == ssrc) {
+        /* same seqnum, same ssrc */
+
+        /* do nothing because we have already considered this request
+         * The jitter may be too impatient of the rtx packet has been
+         * lost too.
+         * It does not mean we reject the event, we still want to forward
+         * the request to the gstrtpsession to be translator into a FB NACK
+         */
+        GST_LOG_OBJECT (rtx, "Duplicate request: seqnum: %u, ssrc: %X",
+            seqnum, ssrc);
+      } else {
+        /* same seqnum, different ssrc */
+
+        /* If the association attempt is larger than ASSOC_TIMEOUT,
+         * then we give up on it, and try this one.
+         */
+        if (!GST_CLOCK_TIME_IS_VALID (rtx->last_time) ||
+            !GST_CLOCK_TIME_IS_VALID (assoc->time) ||
+            assoc->time + ASSOC_TIMEOUT < rtx->last_time) {
+          /* From RFC 4588:
+           * the receiver MUST NOT have two outstanding requests for the
+           * same packet sequence number in two different original streams
+           * before the association is resolved. Otherwise it's impossible
+           * to associate a rtx stream and its master stream
+           */
+
+          /* remove seqnum in order to reuse the spot */
+          g_hash_table_remove (rtx->seqnum_ssrc1_map,
+              GUINT_TO_POINTER (seqnum));
+          goto retransmit;
+        } else {
+          GST_INFO_OBJECT (rtx, "rejecting request for seqnum %u"
+              " of master stream %X; there is already a pending request "
+              "for the same seqnum on ssrc %X that has not expired",
+              seqnum, ssrc, assoc->ssrc);
+
+          /* do not forward the event as we are rejecting this request */
+          return FALSE;
+        }
+      }
+    } else {
+    retransmit:
+      /* the request has not been already considered
+       * insert it for the first time */
+      g_hash_table_insert (rtx->seqnum_ssrc1_map,
+          GUINT_TO_POINTER (seqnum), ssrc_assoc_new (ssrc, rtx->last_time));
+    }
+  }
+
+  GST_DEBUG_OBJECT (rtx, "packet number %u of master stream %X"
+      " needs to be retransmitted", seqnum, ssrc);
+
+  return TRUE;
+}
+
 static gboolean
 gst_rtp_rtx_receive_src_event (GstPad * pad, GstObject * parent,
     GstEvent * event)
@@ -443,7 +530,7 @@ gst_rtp_rtx_receive_src_event (GstPad * pad, GstObject * parent,
       if (gst_structure_has_name (s, "GstRTPRetransmissionRequest")) {
         guint seqnum = 0;
         guint ssrc = 0;
-        gpointer ssrc2 = 0;
+        gboolean accepted;
 
         /* retrieve seqnum of the packet that need to be retransmitted */
         if (!gst_structure_get_uint (s, "seqnum", &seqnum))
@@ -458,87 +545,71 @@ gst_rtp_rtx_receive_src_event (GstPad * pad, GstObject * parent,
             seqnum, ssrc);
 
         GST_OBJECT_LOCK (rtx);
+        accepted = gst_rtp_rtx_receive_register_request (rtx, seqnum, ssrc);
+        GST_OBJECT_UNLOCK (rtx);
 
-        /* increase number of seen requests for our statistics */
-        ++rtx->num_rtx_requests;
+        if (!accepted) {
+          gst_event_unref (event);
+          return TRUE;
+        }
+      } else if (gst_structure_has_name (s,
+              "GstRTPRetransmissionRequestBatch")) {
+        guint seqnum = 0;
+        guint ssrc = 0;
+        GBytes *bytes = NULL;
+        guint8 *bitmap;
+        gsize size, i;
+        gboolean rejected = FALSE, accepted = FALSE;
 
-        /* First, we lookup in our map to see if we have already associate this
-         * master stream ssrc with its retransmitted stream.
-         * Every ssrc are unique so we can use the same hash table
-         * for both retrieving the ssrc1 from ssrc2 and also ssrc2 from ssrc1
-         */
-        if (g_hash_table_lookup_extended (rtx->ssrc2_ssrc1_map,
-                GUINT_TO_POINTER (ssrc), NULL, &ssrc2)
-            && GPOINTER_TO_UINT (ssrc2) != GPOINTER_TO_UINT (ssrc)) {
-          GST_TRACE_OBJECT (rtx, "Retransmitted stream %X already associated "
-              "to its master, %X", GPOINTER_TO_UINT (ssrc2), ssrc);
-        } else {
-          SsrcAssoc *assoc;
+        if (!gst_structure_get_uint (s, "seqnum", &seqnum) ||
+            !gst_structure_get (s, "bitmap", G_TYPE_BYTES, &bytes, NULL))
+          goto forward;
 
-          /* not already associated but also we have to check that we have not
-           * already considered this request.
-           */
-          if (g_hash_table_lookup_extended (rtx->seqnum_ssrc1_map,
-                  GUINT_TO_POINTER (seqnum), NULL, (gpointer *) & assoc)) {
-            if (assoc->ssrc == ssrc) {
-              /* same seqnum, same ssrc */
-
-              /* do nothing because we have already considered this request
-               * The jitter may be too impatient of the rtx packet has been
-               * lost too.
-               * It does not mean we reject the event, we still want to forward
-               * the request to the gstrtpsession to be translator into a FB NACK
-               */
-              GST_LOG_OBJECT (rtx, "Duplicate request: seqnum: %u, ssrc: %X",
-                  seqnum, ssrc);
-            } else {
-              /* same seqnum, different ssrc */
-
-              /* If the association attempt is larger than ASSOC_TIMEOUT,
-               * then we give up on it, and try this one.
-               */
-              if (!GST_CLOCK_TIME_IS_VALID (rtx->last_time) ||
-                  !GST_CLOCK_TIME_IS_VALID (assoc->time) ||
-                  assoc->time + ASSOC_TIMEOUT < rtx->last_time) {
-                /* From RFC 4588:
-                 * the receiver MUST NOT have two outstanding requests for the
-                 * same packet sequence number in two different original streams
-                 * before the association is resolved. Otherwise it's impossible
-                 * to associate a rtx stream and its master stream
-                 */
-
-                /* remove seqnum in order to reuse the spot */
-                g_hash_table_remove (rtx->seqnum_ssrc1_map,
-                    GUINT_TO_POINTER (seqnum));
-                goto retransmit;
-              } else {
-                GST_INFO_OBJECT (rtx, "rejecting request for seqnum %u"
-                    " of master stream %X; there is already a pending request "
-                    "for the same seqnum on ssrc %X that has not expired",
-                    seqnum, ssrc, assoc->ssrc);
-
-                /* do not forward the event as we are rejecting this request */
-                GST_OBJECT_UNLOCK (rtx);
-                gst_event_unref (event);
-                return TRUE;
-              }
-            }
+        if (!gst_structure_get_uint (s, "ssrc", &ssrc))
+          ssrc = -1;
+
+        GST_DEBUG_OBJECT (rtx, "got rtx request batch from seqnum: %u, "
+            "ssrc: %X", seqnum, ssrc);
+
+        bitmap = g_bytes_unref_to_data (bytes, &size);
+
+        GST_OBJECT_LOCK (rtx);
+        for (i = 0; i < size * 8; i++) {
+          if (!(bitmap[i / 8] & (1 << (i % 8))))
+            continue;
+
+          if (gst_rtp_rtx_receive_register_request (rtx,
+                  (guint16) (seqnum + i), ssrc)) {
+            accepted = TRUE;
           } else {
-          retransmit:
-            /* the request has not been already considered
-             * insert it for the first time */
-            g_hash_table_insert (rtx->seqnum_ssrc1_map,
-                GUINT_TO_POINTER (seqnum),
-                ssrc_assoc_new (ssrc, rtx->last_time));
+            bitmap[i / 8] &= ~(1 << (i % 8));
+            rejected = TRUE;
           }
         }
+        GST_OBJECT_UNLOCK (rtx);
 
-        GST_DEBUG_OBJECT (rtx, "packet number %u of master stream %X"
-            " needs to be retransmitted", seqnum, ssrc);
+        if (!accepted) {
+          /* do not forward the event as we are rejecting all the requests */
+          g_free (bitmap);
+          gst_event_unref (event);
+          return TRUE;
+        }
 
-        GST_OBJECT_UNLOCK (rtx);
+        if (rejected) {
+          GstStructure *ws;
+
+          /* only forward the requests that were not rejected */
+          bytes = g_bytes_new_take (bitmap, size);
+          event = gst_event_make_writable (event);
+          ws = gst_event_writable_structure (event);
+          gst_structure_set (ws, "bitmap", G_TYPE_BYTES, bytes, NULL);
+          g_bytes_unref (bytes);
+        } else {
+          g_free (bitmap);
+        }
       }
 
+    forward:
       /* Transfer event upstream so that the request can actually by translated
        * through gstrtpsession through the network */
       res = gst_pad_event_default (pad, parent, event);
@@ -199,6 +199,7 @@ enum
   SIGNAL_REQUEST_PT_MAP,
   SIGNAL_CLEAR_PT_MAP,
   SIGNAL_SEND_BYE,
+  SIGNAL_GET_STATS_SNAPSHOT,
 
   SIGNAL_ON_NEW_SSRC,
   SIGNAL_ON_SSRC_COLLISION,
@@ -367,6 +368,8 @@ static gboolean gst_rtp_session_setcaps_send_rtp (GstPad * pad,
 
 static void gst_rtp_session_clear_pt_map (GstRtpSession * rtpsession);
 static void gst_rtp_session_send_bye (GstRtpSession * rtpsession);
+static guint gst_rtp_session_get_stats_snapshot (GstRtpSession * rtpsession,
+    GArray * snapshots);
 
 static GstStructure *gst_rtp_session_create_stats (GstRtpSession * rtpsession);
 
@@ -558,6 +561,31 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
       G_STRUCT_OFFSET (GstRtpSessionClass, send_bye),
       NULL, NULL, g_cclosure_marshal_generic, G_TYPE_NONE, 0, G_TYPE_NONE);
 
+  /**
+   * GstRtpSession::get-stats-snapshot:
+   * @sess: the object which received the signal
+   * @snapshots: a #GArray of #GstRTPSourceStatsSnapshot
+   *
+   * Fill @snapshots with the statistics of all sources in the session, one
+   * #GstRTPSourceStatsSnapshot per source, in no particular order. The array
+   * is resized to the number of sources.
+   *
+   * This is a binary alternative to the "source-stats" of the
+   * #GstRtpSession:stats property that does not allocate when @snapshots is
+   * reused between calls and already large enough. The array should be
+   * created with an element size of sizeof (#GstRTPSourceStatsSnapshot).
+   *
+   * Returns: the number of sources in @snapshots
+   *
+   * Since: 1.22
+   */
+  gst_rtp_session_signals[SIGNAL_GET_STATS_SNAPSHOT] =
+      g_signal_new ("get-stats-snapshot", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_STRUCT_OFFSET (GstRtpSessionClass, get_stats_snapshot),
+      NULL, NULL, NULL, G_TYPE_UINT, 1,
+      G_TYPE_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   /**
    * GstRtpSession::on-new-ssrc:
    * @sess: the object which received the signal
@@ -846,6 +874,8 @@ gst_rtp_session_class_init (GstRtpSessionClass * klass)
 
   klass->clear_pt_map = GST_DEBUG_FUNCPTR (gst_rtp_session_clear_pt_map);
   klass->send_bye = GST_DEBUG_FUNCPTR (gst_rtp_session_send_bye);
+  klass->get_stats_snapshot =
+      GST_DEBUG_FUNCPTR (gst_rtp_session_get_stats_snapshot);
 
   /* sink pads */
   gst_element_class_add_static_pad_template (gstelement_class,
@@ -1409,6 +1439,14 @@ gst_rtp_session_send_bye (GstRtpSession * rtpsession)
   rtp_session_schedule_bye (rtpsession->priv->session, current_time);
 }
 
+static guint
+gst_rtp_session_get_stats_snapshot (GstRtpSession * rtpsession,
+    GArray * snapshots)
+{
+  return rtp_session_get_stats_snapshot (rtpsession->priv->session,
+      snapshots);
+}
+
 /* called when the session manager has an RTP packet ready to be pushed */
 static GstFlowReturn
 gst_rtp_session_process_rtp (RTPSession * sess, RTPSource * src,
@@ -1856,6 +1894,33 @@ gst_rtp_session_request_remote_key_unit (GstRtpSession * rtpsession,
   return FALSE;
 }
 
+/* The time left for a retransmission to arrive, from the fields of a
+ * GstRTPRetransmissionRequest(Batch) event */
+static GstClockTime
+get_nack_max_delay (const GstStructure * s)
+{
+  guint delay, deadline, max_delay, avg_rtt;
+
+  if (!gst_structure_get_uint (s, "delay", &delay))
+    delay = 0;
+  if (!gst_structure_get_uint (s, "deadline", &deadline))
+    deadline = 100;
+  if (!gst_structure_get_uint (s, "avg-rtt", &avg_rtt))
+    avg_rtt = 40;
+
+  /* remaining time to receive the packet */
+  max_delay = deadline;
+  if (max_delay > delay)
+    max_delay -= delay;
+  /* estimated RTT */
+  if (max_delay > avg_rtt)
+    max_delay -= avg_rtt;
+  else
+    max_delay = 0;
+
+  return max_delay * GST_MSECOND;
+}
+
 static gboolean
 gst_rtp_session_event_recv_rtp_src (GstPad * pad, GstObject * parent,
     GstEvent * event)
@@ -1889,7 +1954,7 @@ gst_rtp_session_event_recv_rtp_src (GstPad * pad, GstObject * parent,
         rtpsession->priv->key_unit_requests_count++;
         GST_RTP_SESSION_UNLOCK (rtpsession);
       } else if (gst_structure_has_name (s, "GstRTPRetransmissionRequest")) {
-        guint seqnum, delay, deadline, max_delay, avg_rtt;
+        guint seqnum;
 
         GST_RTP_SESSION_LOCK (rtpsession);
         rtpsession->priv->recv_rtx_req_count++;
@@ -1899,26 +1964,38 @@ gst_rtp_session_event_recv_rtp_src (GstPad * pad, GstObject * parent,
           ssrc = -1;
         if (!gst_structure_get_uint (s, "seqnum", &seqnum))
           seqnum = -1;
-        if (!gst_structure_get_uint (s, "delay", &delay))
-          delay = 0;
-        if (!gst_structure_get_uint (s, "deadline", &deadline))
-          deadline = 100;
-        if (!gst_structure_get_uint (s, "avg-rtt", &avg_rtt))
-          avg_rtt = 40;
-
-        /* remaining time to receive the packet */
-        max_delay = deadline;
-        if (max_delay > delay)
-          max_delay -= delay;
-        /* estimated RTT */
-        if (max_delay > avg_rtt)
-          max_delay -= avg_rtt;
-        else
-          max_delay = 0;
 
         if (rtp_session_request_nack (rtpsession->priv->session, ssrc, seqnum,
-                max_delay * GST_MSECOND))
+                get_nack_max_delay (s)))
+          forward = FALSE;
+      } else if (gst_structure_has_name (s,
+              "GstRTPRetransmissionRequestBatch")) {
+        guint seqnum, n_bits, i, count = 0;
+        const guint8 *bitmap;
+        GBytes *bytes = NULL;
+        gsize size;
+
+        if (!gst_structure_get_uint (s, "ssrc", &ssrc))
+          ssrc = -1;
+        if (!gst_structure_get_uint (s, "seqnum", &seqnum) ||
+            !gst_structure_get (s, "bitmap", G_TYPE_BYTES, &bytes, NULL))
+          break;
+
+        bitmap = g_bytes_get_data (bytes, &size);
+        n_bits = size * 8;
+        for (i = 0; i < n_bits; i++) {
+          if (bitmap[i / 8] & (1 << (i % 8)))
+            count++;
+        }
+
+        GST_RTP_SESSION_LOCK (rtpsession);
+        rtpsession->priv->recv_rtx_req_count += count;
+        GST_RTP_SESSION_UNLOCK (rtpsession);
+
+        if (rtp_session_request_nacks (rtpsession->priv->session, ssrc, seqnum,
+                bitmap, n_bits, get_nack_max_delay (s)))
           forward = FALSE;
+        g_bytes_unref (bytes);
       }
       break;
     default:
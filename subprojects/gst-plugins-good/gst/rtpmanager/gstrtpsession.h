@@ -65,6 +65,7 @@ struct _GstRtpSessionClass {
   GstCaps* (*request_pt_map) (GstRtpSession *sess, guint pt);
   void     (*clear_pt_map)   (GstRtpSession *sess);
   void     (*send_bye)       (GstRtpSession *sess);
+  guint    (*get_stats_snapshot) (GstRtpSession *sess, GArray *snapshots);
 
   void     (*on_new_ssrc)       (GstRtpSession *sess, guint32 ssrc);
   void     (*on_ssrc_collision) (GstRtpSession *sess, guint32 ssrc);
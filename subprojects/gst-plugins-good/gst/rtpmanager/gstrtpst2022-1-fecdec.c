@@ -87,6 +87,7 @@
 #include <gst/rtp/gstrtpbuffer.h>
 
 #include "gstrtpst2022-1-fecdec.h"
+#include "gstrtpst2022fecorc.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtpst_2022_1_fecdec_debug);
 #define GST_CAT_DEFAULT gst_rtpst_2022_1_fecdec_debug
@@ -370,24 +371,29 @@ done:
   return ret;
 }
 
+/* XORs @n sources of possibly different lengths into @dst. Four sources are
+ * folded per pass over their common length, so @dst is only loaded and
+ * stored once for every four packets. */
 static void
-_xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
+_xor_mem_multi (guint8 * dst, const guint8 ** srcs, const guint * lens,
+    guint n)
 {
-  guint i;
-
-  for (i = 0; i < (length / sizeof (guint64)); ++i) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    GST_WRITE_UINT64_LE (dst,
-        GST_READ_UINT64_LE (dst) ^ GST_READ_UINT64_LE (src));
-#else
-    GST_WRITE_UINT64_BE (dst,
-        GST_READ_UINT64_BE (dst) ^ GST_READ_UINT64_BE (src));
-#endif
-    dst += sizeof (guint64);
-    src += sizeof (guint64);
+  guint i, j;
+
+  for (i = 0; i + 4 <= n; i += 4) {
+    guint common = MIN (MIN (lens[i], lens[i + 1]),
+        MIN (lens[i + 2], lens[i + 3]));
+
+    gst_rtp_st_2022_fec_orc_xor4_u8 (dst, srcs[i], srcs[i + 1], srcs[i + 2],
+        srcs[i + 3], common);
+    for (j = i; j < i + 4; j++) {
+      if (lens[j] > common)
+        gst_rtp_st_2022_fec_orc_xor_u8 (dst + common, srcs[j] + common,
+            lens[j] - common);
+    }
   }
-  for (i = 0; i < (length % sizeof (guint64)); ++i)
-    dst[i] ^= src[i];
+  for (; i < n; i++)
+    gst_rtp_st_2022_fec_orc_xor_u8 (dst, srcs[i], lens[i]);
 }
 
 static GstFlowReturn
@@ -400,6 +406,12 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
   guint16 xored_payload_len;
   Item *item;
   GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstRTPBuffer *media_rtps;
+  const guint8 **srcs;
+  guint *lens;
+  guint n_packets = g_list_length (packets);
+  guint n_mapped = 0;
+  guint i;
   GList *tmp;
   GstFlowReturn ret = GST_FLOW_OK;
   GstBuffer *buffer;
@@ -407,15 +419,19 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
   gboolean xored_padding;
   gboolean xored_extension;
 
-  /* Figure out the recovered packet length first */
+  /* Map every protected packet once, they are all needed for figuring out
+   * the recovered packet length and then for XOR-ing the payloads */
+  media_rtps = g_new0 (GstRTPBuffer, n_packets);
+  srcs = g_new (const guint8 *, n_packets);
+  lens = g_new (guint, n_packets);
+
   xored_payload_len = fec->len;
-  for (tmp = packets; tmp; tmp = tmp->next) {
-    GstRTPBuffer media_rtp = GST_RTP_BUFFER_INIT;
+  for (tmp = packets, i = 0; tmp; tmp = tmp->next, i++) {
     Item *item = (Item *) tmp->data;
 
-    gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &media_rtp);
-    xored_payload_len ^= gst_rtp_buffer_get_payload_len (&media_rtp);
-    gst_rtp_buffer_unmap (&media_rtp);
+    gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &media_rtps[i]);
+    xored_payload_len ^= gst_rtp_buffer_get_payload_len (&media_rtps[i]);
+    n_mapped++;
   }
 
   if (xored_payload_len > fec->payload_len) {
@@ -437,21 +453,23 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
   xored_padding = fec->padding;
   xored_extension = fec->extension;
 
-  for (tmp = packets; tmp; tmp = tmp->next) {
-    GstRTPBuffer media_rtp = GST_RTP_BUFFER_INIT;
-    Item *item = (Item *) tmp->data;
-
-    gst_rtp_buffer_map (item->buffer, GST_MAP_READ, &media_rtp);
-    _xor_mem (xored, gst_rtp_buffer_get_payload (&media_rtp),
-        MIN (gst_rtp_buffer_get_payload_len (&media_rtp), xored_payload_len));
-    xored_timestamp ^= gst_rtp_buffer_get_timestamp (&media_rtp);
-    xored_pt ^= gst_rtp_buffer_get_payload_type (&media_rtp);
-    xored_marker ^= gst_rtp_buffer_get_marker (&media_rtp);
-    xored_padding ^= gst_rtp_buffer_get_padding (&media_rtp);
-    xored_extension ^= gst_rtp_buffer_get_extension (&media_rtp);
-
-    gst_rtp_buffer_unmap (&media_rtp);
+  for (i = 0; i < n_packets; i++) {
+    GstRTPBuffer *media_rtp = &media_rtps[i];
+
+    srcs[i] = gst_rtp_buffer_get_payload (media_rtp);
+    lens[i] = MIN (gst_rtp_buffer_get_payload_len (media_rtp),
+        xored_payload_len);
+    xored_timestamp ^= gst_rtp_buffer_get_timestamp (media_rtp);
+    xored_pt ^= gst_rtp_buffer_get_payload_type (media_rtp);
+    xored_marker ^= gst_rtp_buffer_get_marker (media_rtp);
+    xored_padding ^= gst_rtp_buffer_get_padding (media_rtp);
+    xored_extension ^= gst_rtp_buffer_get_extension (media_rtp);
   }
+  _xor_mem_multi (xored, srcs, lens, n_packets);
+
+  for (i = 0; i < n_mapped; i++)
+    gst_rtp_buffer_unmap (&media_rtps[i]);
+  n_mapped = 0;
 
   GST_DEBUG_OBJECT (dec,
       "Recovered buffer through %s FEC with seqnum %u, payload len %u and timestamp %u",
@@ -491,6 +509,12 @@ xor_items (GstRTPST_2022_1_FecDec * dec, Rtp2DFecHeader * fec, GList * packets,
   }
 
 done:
+  for (i = 0; i < n_mapped; i++)
+    gst_rtp_buffer_unmap (&media_rtps[i]);
+  g_free (media_rtps);
+  g_free (srcs);
+  g_free (lens);
+
   return ret;
 }
 
@@ -69,6 +69,7 @@
 #include <gst/rtp/gstrtpbuffer.h>
 
 #include "gstrtpst2022-1-fecenc.h"
+#include "gstrtpst2022fecorc.h"
 
 GST_DEBUG_CATEGORY_STATIC (gst_rtpst_2022_1_fecenc_debug);
 #define GST_CAT_DEFAULT gst_rtpst_2022_1_fecenc_debug
@@ -223,21 +224,7 @@ free_fec_packet (FecPacket * packet)
 static void
 _xor_mem (guint8 * restrict dst, const guint8 * restrict src, gsize length)
 {
-  guint i;
-
-  for (i = 0; i < (length / sizeof (guint64)); ++i) {
-#if G_BYTE_ORDER == G_LITTLE_ENDIAN
-    GST_WRITE_UINT64_LE (dst,
-        GST_READ_UINT64_LE (dst) ^ GST_READ_UINT64_LE (src));
-#else
-    GST_WRITE_UINT64_BE (dst,
-        GST_READ_UINT64_BE (dst) ^ GST_READ_UINT64_BE (src));
-#endif
-    dst += sizeof (guint64);
-    src += sizeof (guint64);
-  }
-  for (i = 0; i < (length % sizeof (guint64)); ++i)
-    dst[i] ^= src[i];
+  gst_rtp_st_2022_fec_orc_xor_u8 (dst, src, length);
 }
 
 static void
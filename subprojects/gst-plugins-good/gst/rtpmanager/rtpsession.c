@@ -40,6 +40,7 @@ enum
 {
   SIGNAL_GET_SOURCE_BY_SSRC,
   SIGNAL_GET_TWCC_WINDOWED_STATS,
+  SIGNAL_GET_STATS_SNAPSHOT,
   SIGNAL_ON_NEW_SSRC,
   SIGNAL_ON_SSRC_COLLISION,
   SIGNAL_ON_SSRC_VALIDATED,
@@ -236,6 +237,29 @@ rtp_session_class_init (RTPSessionClass * klass)
           get_twcc_windowed_stats), NULL, NULL, NULL,
       GST_TYPE_STRUCTURE, 2, GST_TYPE_CLOCK_TIME, GST_TYPE_CLOCK_TIME);
 
+  /**
+   * RTPSession::get-stats-snapshot:
+   * @session: the object which received the signal
+   * @snapshots: a #GArray of #GstRTPSourceStatsSnapshot
+   *
+   * Fill @snapshots with the statistics of all sources in @session, one
+   * #GstRTPSourceStatsSnapshot per source, in no particular order. The array
+   * is resized to the number of sources.
+   *
+   * This is a binary alternative to the "source-stats" of the
+   * #RTPSession:stats property that does not allocate when @snapshots is
+   * reused between calls and already large enough.
+   *
+   * Returns: the number of sources in @snapshots
+   *
+   * Since: 1.22
+   */
+  rtp_session_signals[SIGNAL_GET_STATS_SNAPSHOT] =
+      g_signal_new ("get-stats-snapshot", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION, G_STRUCT_OFFSET (RTPSessionClass,
+          get_stats_snapshot), NULL, NULL, NULL,
+      G_TYPE_UINT, 1, G_TYPE_ARRAY | G_SIGNAL_TYPE_STATIC_SCOPE);
+
   /**
    * RTPSession::on-new-ssrc:
    * @session: the object which received the signal
@@ -781,6 +805,8 @@ rtp_session_class_init (RTPSessionClass * klass)
   klass->nack_probe = GST_DEBUG_FUNCPTR (rtp_session_nack_probe);
   klass->get_twcc_windowed_stats =
       GST_DEBUG_FUNCPTR (rtp_session_get_twcc_windowed_stats);
+  klass->get_stats_snapshot =
+      GST_DEBUG_FUNCPTR (rtp_session_get_stats_snapshot);
 
   GST_DEBUG_CATEGORY_INIT (rtp_session_debug, "rtpsession", 0, "RTP Session");
 }
@@ -788,30 +814,18 @@ rtp_session_class_init (RTPSessionClass * klass)
 static void
 rtp_session_init (RTPSession * sess)
 {
-  gint i;
   gchar *str;
 
   g_mutex_init (&sess->lock);
-  sess->key = g_random_int ();
-  sess->mask_idx = 0;
-  sess->mask = 0;
-
-  /* TODO: We currently only use the first hash table but this is the
-   * beginning of an implementation for RFC2762
-   for (i = 0; i < 32; i++) {
-   */
-  for (i = 0; i < 1; i++) {
-    sess->ssrcs[i] =
-        g_hash_table_new_full (NULL, NULL, NULL,
-        (GDestroyNotify) g_object_unref);
-  }
+  g_rw_lock_init (&sess->ssrcs_lock);
+  sess->ssrcs = rtp_source_table_new ();
 
   rtp_stats_init_defaults (&sess->stats);
   INIT_AVG (sess->stats.avg_rtcp_packet_size, 100);
   rtp_stats_set_min_interval (&sess->stats,
       (gdouble) DEFAULT_RTCP_MIN_INTERVAL / GST_SECOND);
 
-  sess->recalc_bandwidth = TRUE;
+  g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
   sess->bandwidth = DEFAULT_BANDWIDTH;
   sess->rtcp_bandwidth = DEFAULT_RTCP_FRACTION;
   sess->rtcp_rr_bandwidth = DEFAULT_RTCP_RR_BANDWIDTH;
@@ -876,7 +890,6 @@ static void
 rtp_session_finalize (GObject * object)
 {
   RTPSession *sess;
-  gint i;
 
   sess = RTP_SESSION_CAST (object);
 
@@ -885,17 +898,14 @@ rtp_session_finalize (GObject * object)
   g_list_free_full (sess->conflicting_addresses,
       (GDestroyNotify) rtp_conflicting_address_free);
 
-  /* TODO: Change this again when implementing RFC 2762
-   * for (i = 0; i < 32; i++)
-   */
-  for (i = 0; i < 1; i++)
-    g_hash_table_destroy (sess->ssrcs[i]);
+  rtp_source_table_free (sess->ssrcs);
 
   g_object_unref (sess->twcc);
   if (sess->rtx_ssrc_map)
     gst_structure_free (sess->rtx_ssrc_map);
   g_hash_table_destroy (sess->rtx_ssrc_to_ssrc);
 
+  g_rw_lock_clear (&sess->ssrcs_lock);
   g_mutex_clear (&sess->lock);
 
   G_OBJECT_CLASS (rtp_session_parent_class)->finalize (object);
@@ -920,12 +930,12 @@ rtp_session_create_sources (RTPSession * sess)
 
   RTP_SESSION_LOCK (sess);
   /* get number of elements in the table */
-  size = g_hash_table_size (sess->ssrcs[sess->mask_idx]);
+  size = rtp_source_table_size (sess->ssrcs);
   /* create the result value array */
   res = g_value_array_new (size);
 
   /* and copy all values into the array */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx], (GHFunc) copy_source, res);
+  rtp_source_table_foreach (sess->ssrcs, (GHFunc) copy_source, res);
   RTP_SESSION_UNLOCK (sess);
 
   return res;
@@ -959,9 +969,9 @@ rtp_session_create_stats (RTPSession * sess)
       quark_sent_nack_count, G_TYPE_UINT, sess->stats.nacks_sent,
       quark_recv_nack_count, G_TYPE_UINT, sess->stats.nacks_received, NULL);
 
-  size = g_hash_table_size (sess->ssrcs[sess->mask_idx]);
+  size = rtp_source_table_size (sess->ssrcs);
   source_stats = g_value_array_new (size);
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) create_source_stats, source_stats);
   RTP_SESSION_UNLOCK (sess);
 
@@ -1010,25 +1020,25 @@ rtp_session_set_property (GObject * object, guint prop_id,
     case PROP_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->bandwidth = g_value_get_double (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_FRACTION:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_bandwidth = g_value_get_double (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_RR_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_rr_bandwidth = g_value_get_int (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_RS_BANDWIDTH:
       RTP_SESSION_LOCK (sess);
       sess->rtcp_rs_bandwidth = g_value_get_int (value);
-      sess->recalc_bandwidth = TRUE;
+      g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
       RTP_SESSION_UNLOCK (sess);
       break;
     case PROP_RTCP_MTU:
@@ -1347,7 +1357,9 @@ rtp_session_reset (RTPSession * sess)
   RTP_SESSION_LOCK (sess);
 
   /* remove all sources */
-  g_hash_table_remove_all (sess->ssrcs[sess->mask_idx]);
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
+  rtp_source_table_remove_all (sess->ssrcs);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
   sess->total_sources = 0;
   sess->stats.sender_sources = 0;
   sess->stats.internal_sender_sources = 0;
@@ -1720,7 +1732,7 @@ rtp_session_set_sdes_struct (RTPSession * sess, const GstStructure * sdes)
     gst_structure_free (sess->sdes);
   sess->sdes = gst_structure_copy (sdes);
 
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) source_set_sdes, sess->sdes);
   RTP_SESSION_UNLOCK (sess);
 }
@@ -2004,14 +2016,14 @@ session_update_ptp (RTPSession * sess)
    */
   data.is_doing_ptp = TRUE;
   data.new_addr = NULL;
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) compare_rtp_source_addr, (gpointer) & data);
   is_doing_rtp_ptp = data.is_doing_ptp;
 
   /* same but about rtcp */
   data.is_doing_ptp = TRUE;
   data.new_addr = NULL;
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) compare_rtcp_source_addr, (gpointer) & data);
   is_doing_rtcp_ptp = data.is_doing_ptp;
 
@@ -2025,8 +2037,9 @@ session_update_ptp (RTPSession * sess)
 static void
 add_source (RTPSession * sess, RTPSource * src)
 {
-  g_hash_table_insert (sess->ssrcs[sess->mask_idx],
-      GINT_TO_POINTER (src->ssrc), src);
+  g_rw_lock_writer_lock (&sess->ssrcs_lock);
+  rtp_source_table_insert (sess->ssrcs, src);
+  g_rw_lock_writer_unlock (&sess->ssrcs_lock);
   /* report the new source ASAP */
   src->generation = sess->generation;
   /* we have one more source now */
@@ -2050,8 +2063,7 @@ add_source (RTPSession * sess, RTPSource * src)
 static RTPSource *
 find_source (RTPSession * sess, guint32 ssrc)
 {
-  return g_hash_table_lookup (sess->ssrcs[sess->mask_idx],
-      GINT_TO_POINTER (ssrc));
+  return rtp_source_table_lookup (sess->ssrcs, ssrc);
 }
 
 /* must be called with the session lock, the returned source needs to be
@@ -2101,12 +2113,14 @@ obtain_source (RTPSession * sess, guint32 ssrc, gboolean * created,
       g_object_set (source, "probation", RTP_NO_PROBATION, NULL);
   }
   /* update last activity */
+  RTP_SOURCE_LOCK (source);
   source->last_activity = pinfo->current_time;
   if (rtp) {
     source->last_rtp_activity = pinfo->current_time;
     if (source->first_rtp_activity == GST_CLOCK_TIME_NONE)
       source->first_rtp_activity = pinfo->current_time;
   }
+  RTP_SOURCE_UNLOCK (source);
   g_object_ref (source);
 
   return source;
@@ -2277,6 +2291,48 @@ rtp_session_get_source_by_ssrc (RTPSession * sess, guint32 ssrc)
   return result;
 }
 
+/**
+ * rtp_session_get_stats_snapshot:
+ * @sess: a #RTPSession
+ * @snapshots: a #GArray with elements of #GstRTPSourceStatsSnapshot
+ *
+ * Resize @snapshots to the number of sources in @sess and fill it with their
+ * statistics. When the element size of @snapshots is smaller than
+ * #GstRTPSourceStatsSnapshot, only the fields that fit are filled in.
+ *
+ * Returns: the number of sources in @snapshots
+ *
+ * Since: 1.22
+ */
+guint
+rtp_session_get_stats_snapshot (RTPSession * sess, GArray * snapshots)
+{
+  GstRTPSourceStatsSnapshot snapshot;
+  guint i, n, elem_size, size;
+
+  g_return_val_if_fail (RTP_IS_SESSION (sess), 0);
+  g_return_val_if_fail (snapshots != NULL, 0);
+
+  /* arrays of applications built against an older version of the structure
+   * have a smaller element size, but always include the size field */
+  elem_size = g_array_get_element_size (snapshots);
+  g_return_val_if_fail (elem_size >= sizeof (snapshot.size), 0);
+  size = MIN (elem_size, sizeof (GstRTPSourceStatsSnapshot));
+
+  RTP_SESSION_LOCK (sess);
+  n = rtp_source_table_size (sess->ssrcs);
+  g_array_set_size (snapshots, n);
+  for (i = 0; i < n; i++) {
+    rtp_source_get_stats_snapshot (rtp_source_table_get (sess->ssrcs, i),
+        &snapshot);
+    snapshot.size = size;
+    memcpy (snapshots->data + i * elem_size, &snapshot, size);
+  }
+  RTP_SESSION_UNLOCK (sess);
+
+  return n;
+}
+
 static GstStructure *
 rtp_session_get_twcc_windowed_stats (RTPSession * sess,
     GstClockTime stats_window_size, GstClockTime stats_window_delay)
@@ -2318,7 +2374,17 @@ update_packet (GstBuffer ** buffer, guint idx, RTPPacketInfo * pinfo)
   pinfo->bytes += gst_buffer_get_size (*buffer) + pinfo->header_len;
   pinfo->packets++;
 
-  if (pinfo->rtp) {
+  if (pinfo->rtp && idx > 0 &&
+      (pinfo->ntp64_ext_id == 0 || !pinfo->send || pinfo->have_ntp64_ext)) {
+    GstRTPHeaderView view = GST_RTP_HEADER_VIEW_INIT;
+
+    /* nothing but the payload length is needed from the other buffers of a
+     * list, which doesn't require mapping and validating the whole packet */
+    if (!gst_rtp_header_view_init (&view, *buffer))
+      goto invalid_packet;
+
+    pinfo->payload_len += gst_rtp_header_view_get_payload_len (&view);
+  } else if (pinfo->rtp) {
     GstRTPBuffer rtp = { NULL };
 
     if (!gst_rtp_buffer_map (*buffer, GST_MAP_READ, &rtp))
@@ -2340,8 +2406,11 @@ update_packet (GstBuffer ** buffer, guint idx, RTPPacketInfo * pinfo)
         pinfo->csrcs[i] = gst_rtp_buffer_get_csrc (&rtp, i);
 
       /* RTP header extensions */
+      if (pinfo->header_ext)
+        g_bytes_unref (pinfo->header_ext);
       pinfo->header_ext = gst_rtp_buffer_get_extension_bytes (&rtp,
           &pinfo->header_ext_bit_pattern);
+      rtp_packet_info_parse_header_ext (pinfo);
 
       /* if RTX, store the original seqnum (OSN) and SSRC */
       if (GST_BUFFER_FLAG_IS_SET (*buffer, GST_RTP_BUFFER_FLAG_RETRANSMISSION)) {
@@ -2359,8 +2428,13 @@ update_packet (GstBuffer ** buffer, guint idx, RTPPacketInfo * pinfo)
       /* Remember here that there is a 64-bit NTP header extension on this buffer
        * or any of the other buffers in the buffer list.
        * Later we update this after making the buffer(list) writable.
+       * The first buffer has already been parsed into the table.
        */
-      if ((gst_rtp_buffer_get_extension_onebyte_header (&rtp,
+      if (idx == 0) {
+        if (rtp_packet_info_get_header_ext (pinfo, pinfo->ntp64_ext_id,
+                NULL, &size) && size == 8)
+          pinfo->have_ntp64_ext = TRUE;
+      } else if ((gst_rtp_buffer_get_extension_onebyte_header (&rtp,
                   pinfo->ntp64_ext_id, 0, (gpointer *) & data, &size)
               && size == 8)
           || (gst_rtp_buffer_get_extension_twobytes_header (&rtp, NULL,
@@ -2397,7 +2471,8 @@ invalid_packet:
 /* update the RTPPacketInfo structure with the current time and other bits
  * about the current buffer we are handling.
  * This function is typically called when a validated packet is received.
- * This function should be called with the RTP_SESSION_LOCK
+ * This function should be called with the RTP_SESSION_LOCK when sending, for
+ * received packets only the header length is taken from the session.
  */
 static gboolean
 update_packet_info (RTPSession * sess, RTPPacketInfo * pinfo,
@@ -2435,7 +2510,8 @@ update_packet_info (RTPSession * sess, RTPPacketInfo * pinfo,
     pinfo->arrival_time = GST_BUFFER_DTS (buffer);
   }
 
-  if (pinfo->rtx_osn != -1)
+  /* only needed to match the TWCC feedback of sent retransmissions */
+  if (send && pinfo->rtx_osn != -1)
     pinfo->rtx_ssrc =
         GPOINTER_TO_UINT (g_hash_table_lookup (sess->rtx_ssrc_to_ssrc,
             GUINT_TO_POINTER (pinfo->ssrc)));
@@ -2547,6 +2623,63 @@ rtp_session_process_nack_probe (RTPSession * sess, RTPSource * source,
   }
 }
 
+/* Handles @pinfo without the session lock when it is from a known remote
+ * sender and doesn't change anything in the session, which is the case for
+ * almost every packet. Only the lock of the one source is taken, so the
+ * receive path doesn't wait for RTCP generation, which goes over all the
+ * sources with the session lock held.
+ * Returns %FALSE when the packet has to be handled with the session lock. */
+static gboolean
+process_rtp_fast (RTPSession * sess, RTPPacketInfo * pinfo,
+    GstFlowReturn * result)
+{
+  RTPSource *source;
+  gboolean push, bitrate_changed;
+
+  /* CSRCs become sources of the session too */
+  if (pinfo->csrc_count > 0)
+    return FALSE;
+
+  g_rw_lock_reader_lock (&sess->ssrcs_lock);
+  source = find_source (sess, pinfo->ssrc);
+  if (source)
+    g_object_ref (source);
+  g_rw_lock_reader_unlock (&sess->ssrcs_lock);
+
+  if (source == NULL)
+    return FALSE;
+
+  if (source->ssrc == sess->nack_probe_ssrc ||
+      !rtp_source_try_process_rtp (source, pinfo, &push, &bitrate_changed)) {
+    g_object_unref (source);
+    return FALSE;
+  }
+
+  *result = GST_FLOW_OK;
+  if (push) {
+    GST_LOG ("source %08x pushed receiver RTP packet", source->ssrc);
+
+    if (sess->callbacks.process_rtp)
+      *result = sess->callbacks.process_rtp (sess, source,
+          GST_BUFFER_CAST (pinfo->data), sess->process_rtp_user_data);
+    else
+      gst_buffer_unref (GST_BUFFER_CAST (pinfo->data));
+    pinfo->data = NULL;
+  }
+
+  if (bitrate_changed)
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
+
+  /* the TWCC manager has its own lock for the received packets */
+  if (rtp_twcc_manager_recv_packet (sess->twcc, pinfo)) {
+    if (!rtp_session_send_rtcp (sess, 0))
+      GST_INFO ("Could not schedule TWCC straight away");
+  }
+  g_object_unref (source);
+
+  return TRUE;
+}
+
 /**
  * rtp_session_process_rtp:
  * @sess: and #RTPSession
@@ -2574,17 +2707,21 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   g_return_val_if_fail (RTP_IS_SESSION (sess), GST_FLOW_ERROR);
   g_return_val_if_fail (GST_IS_BUFFER (buffer), GST_FLOW_ERROR);
 
-  RTP_SESSION_LOCK (sess);
-
   /* update pinfo stats */
   if (!update_packet_info (sess, &pinfo, FALSE, TRUE, FALSE, buffer,
           current_time, running_time, ntpnstime)) {
     GST_DEBUG ("invalid RTP packet received");
-    RTP_SESSION_UNLOCK (sess);
     return rtp_session_process_rtcp (sess, buffer, current_time, running_time,
         ntpnstime);
   }
 
+  if (process_rtp_fast (sess, &pinfo, &result)) {
+    clean_packet_info (&pinfo);
+    return result;
+  }
+
+  RTP_SESSION_LOCK (sess);
+
   ssrc = pinfo.ssrc;
 
   source = obtain_source (sess, ssrc, &created, &pinfo, TRUE);
@@ -2611,7 +2748,7 @@ rtp_session_process_rtp (RTPSession * sess, GstBuffer * buffer,
   source_update_sender (sess, source, prevsender);
 
   if (oldrate != source->bitrate)
-    sess->recalc_bandwidth = TRUE;
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
 
 
   if (source->validated) {
@@ -3130,14 +3267,14 @@ rtp_session_process_fir (RTPSession * sess, guint32 sender_ssrc,
 
   /* Hack because Google fails to set the sender_ssrc correctly */
   if (!src && sender_ssrc == 1) {
-    GHashTableIter iter;
+    guint i;
 
     /* we can't find the source if there are multiple */
     if (sess->stats.sender_sources > sess->stats.internal_sender_sources + 1)
       return;
 
-    g_hash_table_iter_init (&iter, sess->ssrcs[sess->mask_idx]);
-    while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & src)) {
+    for (i = 0; i < rtp_source_table_size (sess->ssrcs); i++) {
+      src = rtp_source_table_get (sess->ssrcs, i);
       if (!src->internal && rtp_source_is_sender (src))
         break;
       src = NULL;
@@ -3748,7 +3885,7 @@ rtp_session_send_rtp (RTPSession * sess, gpointer data, gboolean is_list,
   source_update_sender (sess, source, prevsender);
 
   if (oldrate != source->bitrate)
-    sess->recalc_bandwidth = TRUE;
+    g_atomic_int_set (&sess->recalc_bandwidth, TRUE);
   RTP_SESSION_UNLOCK (sess);
 
   g_object_unref (source);
@@ -3777,7 +3914,9 @@ collision:
 static void
 add_bitrates (gpointer key, RTPSource * source, gdouble * bandwidth)
 {
+  RTP_SOURCE_LOCK (source);
   *bandwidth += source->bitrate;
+  RTP_SOURCE_UNLOCK (source);
 }
 
 /* must be called with session lock */
@@ -3788,8 +3927,9 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
   GstClockTime result;
   RTPSessionStats *stats;
 
-  /* recalculate bandwidth when it changed */
-  if (sess->recalc_bandwidth) {
+  /* recalculate bandwidth when it changed, the receive path can flag this
+   * without the session lock */
+  if (g_atomic_int_compare_and_exchange (&sess->recalc_bandwidth, TRUE, FALSE)) {
     gdouble bandwidth;
 
     if (sess->bandwidth > 0)
@@ -3798,7 +3938,7 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
       /* If it is <= 0, then try to estimate the actual bandwidth */
       bandwidth = 0;
 
-      g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+      rtp_source_table_foreach (sess->ssrcs,
           (GHFunc) add_bitrates, &bandwidth);
     }
     if (bandwidth < RTP_STATS_BANDWIDTH)
@@ -3806,8 +3946,6 @@ calculate_rtcp_interval (RTPSession * sess, gboolean deterministic,
 
     rtp_stats_set_bandwidths (&sess->stats, bandwidth,
         sess->rtcp_bandwidth, sess->rtcp_rs_bandwidth, sess->rtcp_rr_bandwidth);
-
-    sess->recalc_bandwidth = FALSE;
   }
 
   if (sess->scheduled_bye) {
@@ -3853,7 +3991,7 @@ rtp_session_mark_all_bye (RTPSession * sess, const gchar * reason)
   g_return_if_fail (RTP_IS_SESSION (sess));
 
   RTP_SESSION_LOCK (sess);
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) source_mark_bye, (gpointer) reason);
   RTP_SESSION_UNLOCK (sess);
 }
@@ -4226,7 +4364,7 @@ session_fir (RTPSession * sess, ReportData * data)
   gst_rtcp_packet_fb_set_sender_ssrc (packet, data->source->ssrc);
   gst_rtcp_packet_fb_set_media_ssrc (packet, 0);
 
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) session_add_fir, data);
 
   if (gst_rtcp_packet_fb_get_fci_length (packet) == 0)
@@ -4408,6 +4546,7 @@ update_source (const gchar * key, RTPSource * source, ReportData * data)
   RTPSession *sess = data->sess;
   GstClockTime interval, binterval;
   GstClockTime btime;
+  GstClockTime last_activity, last_rtp_activity;
 
   GST_DEBUG ("look at %08x, generation %u", source->ssrc, source->generation);
 
@@ -4453,6 +4592,12 @@ update_source (const gchar * key, RTPSource * source, ReportData * data)
   GST_LOG ("timeout base interval %" GST_TIME_FORMAT,
       GST_TIME_ARGS (binterval));
 
+  /* the receive path updates these with only the source lock */
+  RTP_SOURCE_LOCK (source);
+  last_activity = source->last_activity;
+  last_rtp_activity = source->last_rtp_activity;
+  RTP_SOURCE_UNLOCK (source);
+
   if (!source->internal && source->marked_bye) {
     /* if we received a BYE from the source, remove the source after some
      * time. */
@@ -4472,7 +4617,7 @@ update_source (const gchar * key, RTPSource * source, ReportData * data)
   /* sources that were inactive for more than 5 times the deterministic reporting
    * interval get timed out. the min timeout is 5 seconds. */
   /* mind old time that might pre-date last time going to PLAYING */
-  btime = MAX (source->last_activity, sess->start_time);
+  btime = MAX (last_activity, sess->start_time);
   if (data->current_time > btime) {
     interval = MAX (binterval * 5, 5 * GST_SECOND);
     if (data->current_time - btime > interval) {
@@ -4498,8 +4643,8 @@ update_source (const gchar * key, RTPSource * source, ReportData * data)
    * holds for our own sources. */
   if (is_sender) {
     /* mind old time that might pre-date last time going to PLAYING */
-    if (source->last_rtp_activity != GST_CLOCK_TIME_NONE)
-      btime = MAX (source->last_rtp_activity, sess->start_time);
+    if (last_rtp_activity != GST_CLOCK_TIME_NONE)
+      btime = MAX (last_rtp_activity, sess->start_time);
     else
       btime = sess->start_time;
     if (data->current_time > btime) {
@@ -4531,7 +4676,15 @@ update_source (const gchar * key, RTPSource * source, ReportData * data)
       on_timeout (sess, source);
   } else {
     if (sendertimeout) {
-      source->is_sender = FALSE;
+      /* a packet that arrived in the meantime keeps it a sender */
+      RTP_SOURCE_LOCK (source);
+      if (source->last_rtp_activity == last_rtp_activity)
+        source->is_sender = FALSE;
+      else
+        sendertimeout = FALSE;
+      RTP_SOURCE_UNLOCK (source);
+    }
+    if (sendertimeout) {
       sess->stats.sender_sources--;
       if (source->internal)
         sess->stats.internal_sender_sources--;
@@ -4744,9 +4897,9 @@ is_rtcp_time (RTPSession * sess, GstClockTime current_time, ReportData * data)
 }
 
 static void
-clone_ssrcs_hashtable (gchar * key, RTPSource * source, GHashTable * hash_table)
+clone_source (gpointer key, RTPSource * source, GPtrArray * sources)
 {
-  g_hash_table_insert (hash_table, key, g_object_ref (source));
+  g_ptr_array_add (sources, g_object_ref (source));
 }
 
 static gboolean
@@ -4840,7 +4993,7 @@ generate_rtcp (const gchar * key, RTPSource * source, ReportData * data)
     if (!data->is_early) {
       /* loop over all known sources and add report blocks. If we are early, we
        * just make a minimal RTCP packet and skip this step */
-      g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+      rtp_source_table_foreach (sess->ssrcs,
           (GHFunc) session_report_blocks, data);
     }
     /* Optionally add profile-specific extension */
@@ -4855,11 +5008,11 @@ generate_rtcp (const gchar * key, RTPSource * source, ReportData * data)
     session_fir (sess, data);
 
   if (data->have_pli)
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    rtp_source_table_foreach (sess->ssrcs,
         (GHFunc) session_pli, data);
 
   if (data->have_nack)
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    rtp_source_table_foreach (sess->ssrcs,
         (GHFunc) session_nack, data);
 
   gst_rtcp_buffer_unmap (&data->rtcpbuf);
@@ -4919,12 +5072,12 @@ schedule_remaining_nacks (const gchar * key, RTPSource * source,
 static gboolean
 rtp_session_are_all_sources_bye (RTPSession * sess)
 {
-  GHashTableIter iter;
   RTPSource *src;
+  guint i;
 
   RTP_SESSION_LOCK (sess);
-  g_hash_table_iter_init (&iter, sess->ssrcs[sess->mask_idx]);
-  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) & src)) {
+  for (i = 0; i < rtp_source_table_size (sess->ssrcs); i++) {
+    src = rtp_source_table_get (sess->ssrcs, i);
     if (src->internal && !src->sent_bye) {
       RTP_SESSION_UNLOCK (sess);
       return FALSE;
@@ -4985,7 +5138,8 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
 {
   GstFlowReturn result = GST_FLOW_OK;
   ReportData data = { GST_RTCP_BUFFER_INIT };
-  GHashTable *table_copy;
+  GPtrArray *sources_copy;
+  guint i;
   ReportOutput *output;
   gboolean all_empty = FALSE;
   gboolean twcc_only = FALSE;
@@ -5033,21 +5187,26 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
         timeout_conflicting_addresses (sess->conflicting_addresses,
         current_time);
 
-    /* Make a local copy of the hashtable. We need to do this because the
+    /* Make a local copy of the sources. We need to do this because the
      * update stage below releases the session lock. */
-    table_copy = g_hash_table_new_full (NULL, NULL, NULL,
+    sources_copy = g_ptr_array_new_full (rtp_source_table_size (sess->ssrcs),
         (GDestroyNotify) g_object_unref);
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
-        (GHFunc) clone_ssrcs_hashtable, table_copy);
+    rtp_source_table_foreach (sess->ssrcs, (GHFunc) clone_source,
+        sources_copy);
 
     /* Clean up the session, mark the source for removing and update clock-rate,
      * this might release the session lock. */
-    g_hash_table_foreach (table_copy, (GHFunc) update_source, &data);
-    g_hash_table_destroy (table_copy);
+    for (i = 0; i < sources_copy->len; i++) {
+      RTPSource *source = g_ptr_array_index (sources_copy, i);
+      update_source (NULL, source, &data);
+    }
+    g_ptr_array_unref (sources_copy);
 
     /* Now remove the marked sources */
-    g_hash_table_foreach_remove (sess->ssrcs[sess->mask_idx],
+    g_rw_lock_writer_lock (&sess->ssrcs_lock);
+    rtp_source_table_foreach_remove (sess->ssrcs,
         (GHRFunc) remove_closing_sources, &data);
+    g_rw_lock_writer_unlock (&sess->ssrcs_lock);
 
     /* update point-to-point status */
     session_update_ptp (sess);
@@ -5062,7 +5221,7 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
     if (GST_CLOCK_TIME_IS_VALID (sess->next_twcc_rtcp_time)
         && sess->next_twcc_rtcp_time <= current_time) {
       GST_DEBUG ("generating twcc");
-      g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+      rtp_source_table_foreach (sess->ssrcs,
           (GHFunc) generate_twcc, &data);
       sess->next_twcc_rtcp_time = GST_CLOCK_TIME_NONE;
     }
@@ -5083,19 +5242,19 @@ rtp_session_on_timeout (RTPSession * sess, GstClockTime current_time,
       sess->generation, data.num_to_report, data.is_early, data.may_suppress);
 
   /* generate RTCP for all internal sources */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) generate_rtcp, &data);
 
   /* add twcc feedback if not using interval-based feedback */
   if (!GST_CLOCK_TIME_IS_VALID (rtp_twcc_manager_get_feedback_interval
           (sess->twcc))) {
     GST_DEBUG ("generating irregular twcc");
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    rtp_source_table_foreach (sess->ssrcs,
         (GHFunc) generate_twcc, &data);
   }
 
   /* update the generation for all the sources that have been reported */
-  g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+  rtp_source_table_foreach (sess->ssrcs,
       (GHFunc) update_generation, &data);
 
   /* we keep track of the last report time in order to timeout inactive
@@ -5185,7 +5344,7 @@ done:
   if (!twcc_only) {
     /* schedule remaining nacks */
     RTP_SESSION_LOCK (sess);
-    g_hash_table_foreach (sess->ssrcs[sess->mask_idx],
+    rtp_source_table_foreach (sess->ssrcs,
         (GHFunc) schedule_remaining_nacks, &data);
     RTP_SESSION_UNLOCK (sess);
   }
@@ -5505,6 +5664,57 @@ no_source:
   }
 }
 
+/**
+ * rtp_session_request_nacks:
+ * @sess: a #RTPSession
+ * @ssrc: the SSRC
+ * @seqnum: the first missing seqnum
+ * @bitmap: bitmap of missing seqnums, bit N set for @seqnum + N
+ * @n_bits: the number of bits in @bitmap
+ * @max_delay: max delay to request NACK
+ *
+ * Request scheduling of a NACK feedback packet for all the seqnums set in
+ * @bitmap in @ssrc. The session lock is only taken once and at most one
+ * early RTCP packet is requested for the whole batch.
+ *
+ * Returns: %TRUE if the NACK feedback could be scheduled
+ */
+gboolean
+rtp_session_request_nacks (RTPSession * sess, guint32 ssrc, guint16 seqnum,
+    const guint8 * bitmap, guint n_bits, GstClockTime max_delay)
+{
+  RTPSource *source;
+  GstClockTime now;
+
+  if (!sess->callbacks.send_rtcp)
+    return FALSE;
+
+  now = sess->callbacks.request_time (sess, sess->request_time_user_data);
+
+  RTP_SESSION_LOCK (sess);
+  source = find_source (sess, ssrc);
+  if (source == NULL)
+    goto no_source;
+
+  GST_DEBUG ("request NACKs for SSRC %08x, #%u + %u, deadline %"
+      GST_TIME_FORMAT, ssrc, seqnum, n_bits, GST_TIME_ARGS (now + max_delay));
+  rtp_source_register_nacks (source, seqnum, bitmap, n_bits, now + max_delay);
+  RTP_SESSION_UNLOCK (sess);
+
+  if (!rtp_session_send_rtcp_internal (sess, now, 0)) {
+    GST_DEBUG ("NACKs not sent early, sending with next regular RTCP");
+  }
+
+  return TRUE;
+
+  /* ERRORS */
+no_source:
+  {
+    RTP_SESSION_UNLOCK (sess);
+    return FALSE;
+  }
+}
+
 /**
  * rtp_session_update_recv_caps_structure:
  * @sess: an #RTPSession
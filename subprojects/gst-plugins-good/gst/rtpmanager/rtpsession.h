@@ -23,6 +23,7 @@
 #include <gst/gst.h>
 
 #include "rtpsource.h"
+#include "rtpsourcetable.h"
 #include "rtptwcc.h"
 
 typedef struct _RTPSession RTPSession;
@@ -223,7 +224,7 @@ typedef struct {
  * RTPSession:
  * @lock: lock to protect the session
  * @source: the source of this session
- * @ssrcs: Hashtable of sources indexed by SSRC
+ * @ssrcs: Table of sources indexed by SSRC
  * @num_sources: the number of sources
  * @activecount: the number of active sources
  * @callbacks: callbacks
@@ -252,7 +253,7 @@ struct _RTPSession {
 
   gboolean      reduced_size_rtcp;
 
-  /* bandwidths */
+  /* bandwidths, recalc_bandwidth is only accessed atomically */
   gboolean     recalc_bandwidth;
   guint        bandwidth;
   gdouble      rtcp_bandwidth;
@@ -264,10 +265,11 @@ struct _RTPSession {
   gboolean      internal_ssrc_from_caps_or_property;
 
   /* for sender/receiver counting */
-  guint32       key;
-  guint32       mask_idx;
-  guint32       mask;
-  GHashTable   *ssrcs[32];
+  RTPSourceTable *ssrcs;
+  /* taken for writing, with the session lock, when the sources in @ssrcs
+   * change, so that the receive path can look up a source with just a
+   * read lock */
+  GRWLock       ssrcs_lock;
   guint         total_sources;
 
   guint16       generation;
@@ -344,6 +346,7 @@ struct _RTPSessionClass {
   void (*nack_probe)  (RTPSession *sess, guint ssrc, guint pct, GstClockTime duration);
   GstStructure* (*get_twcc_windowed_stats) (RTPSession *sess,
       GstClockTime stats_window_size, GstClockTime stats_window_delay);
+  guint (*get_stats_snapshot) (RTPSession *sess, GArray *snapshots);
 
   /* signals */
   void (*on_new_ssrc)       (RTPSession *sess, RTPSource *source);
@@ -418,6 +421,7 @@ gboolean        rtp_session_add_source             (RTPSession *sess, RTPSource
 guint           rtp_session_get_num_sources        (RTPSession *sess);
 guint           rtp_session_get_num_active_sources (RTPSession *sess);
 RTPSource*      rtp_session_get_source_by_ssrc     (RTPSession *sess, guint32 ssrc);
+guint           rtp_session_get_stats_snapshot     (RTPSession *sess, GArray *snapshots);
 
 /* processing packets from receivers */
 GstFlowReturn   rtp_session_process_rtp            (RTPSession *sess, GstBuffer *buffer,
@@ -457,6 +461,12 @@ gboolean        rtp_session_request_nack           (RTPSession * sess,
                                                     guint32 ssrc,
                                                     guint16 seqnum,
                                                     GstClockTime max_delay);
+gboolean        rtp_session_request_nacks          (RTPSession * sess,
+                                                    guint32 ssrc,
+                                                    guint16 seqnum,
+                                                    const guint8 * bitmap,
+                                                    guint n_bits,
+                                                    GstClockTime max_delay);
 
 void            rtp_session_update_recv_caps_structure (RTPSession * sess, const GstStructure * s);
 
@@ -415,6 +415,8 @@ rtp_source_reset (RTPSource * src)
 static void
 rtp_source_init (RTPSource * src)
 {
+  g_mutex_init (&src->lock);
+
   /* sources are initially on probation until we receive enough valid RTP
    * packets or a valid RTCP packet */
   src->validated = FALSE;
@@ -484,136 +486,210 @@ rtp_source_finalize (GObject * object)
 
   g_hash_table_unref (src->reported_in_sr_of);
 
+  g_mutex_clear (&src->lock);
+
   G_OBJECT_CLASS (rtp_source_parent_class)->finalize (object);
 }
 
+/* with the source lock */
+static void
+fill_stats_snapshot (RTPSource * src, GstRTPSourceStatsSnapshot * st)
+{
+  GstClockTime time;
+
+  memset (st, 0, sizeof (GstRTPSourceStatsSnapshot));
+  st->size = sizeof (GstRTPSourceStatsSnapshot);
+
+  /* common data for all types of sources */
+  st->ssrc = src->ssrc;
+  st->internal = src->internal;
+  st->validated = src->validated;
+  st->received_bye = src->marked_bye;
+  st->is_csrc = src->is_csrc;
+  st->is_sender = src->is_sender;
+  st->first_rtp_activity = src->first_rtp_activity;
+  st->last_rtp_activity = src->last_rtp_activity;
+  st->avg_frame_transmission_duration =
+      src->stats.avg_frame_transmission_duration;
+  st->max_frame_transmission_duration =
+      src->stats.max_frame_transmission_duration;
+
+  /* is_sender applies to internal sources you send with, but also
+     the equivalent source on the receiver side */
+  if (st->is_sender) {
+    st->clock_rate = src->clock_rate;
+    st->bitrate = src->bitrate;
+
+    if (st->internal) {
+      st->seqnum_base = src->seqnum_offset;
+      st->octets_sent = src->stats.octets_sent;
+      st->packets_sent = src->stats.packets_sent;
+      st->recv_pli_count = src->stats.recv_pli_count;
+      st->recv_fir_count = src->stats.recv_fir_count;
+      st->recv_nack_count = src->stats.recv_nack_count;
+    } else {
+      st->octets_received = src->stats.octets_received;
+      st->packets_received = src->stats.packets_received;
+      st->bytes_received = src->stats.bytes_received;
+      st->packets_lost = rtp_stats_get_packets_lost (&src->stats);
+      st->jitter = src->stats.jitter >> 4;
+      st->sent_pli_count = src->stats.sent_pli_count;
+      st->sent_fir_count = src->stats.sent_fir_count;
+      st->sent_nack_count = src->stats.sent_nack_count;
+      st->recv_packet_rate =
+          gst_rtp_packet_rate_ctx_get (&src->packet_rate_ctx);
+    }
+  }
+
+  /* get the last SR. */
+  st->have_sr = rtp_source_get_last_sr (src, &time, &st->sr_ntptime,
+      &st->sr_rtptime, &st->sr_packet_count, &st->sr_octet_count);
+
+  if (!st->internal) {
+    /* get the last RB we sent */
+    st->sent_rb = src->last_rr.is_valid;
+    if (st->sent_rb) {
+      st->sent_rb_fractionlost = src->last_rr.fractionlost;
+      st->sent_rb_packetslost = src->last_rr.packetslost;
+      st->sent_rb_exthighestseq = src->last_rr.exthighestseq;
+      st->sent_rb_jitter = src->last_rr.jitter;
+      st->sent_rb_lsr = src->last_rr.lsr;
+      st->sent_rb_dlsr = src->last_rr.dlsr;
+    }
+  } else {
+    /* get the last RB */
+    st->have_rb = rtp_source_get_last_rb (src, &st->rb_ssrc,
+        &st->rb_fractionlost, &st->rb_packetslost, &st->rb_exthighestseq,
+        &st->rb_jitter, &st->rb_lsr, &st->rb_dlsr, &st->rb_round_trip);
+  }
+}
+
+/**
+ * rtp_source_get_stats_snapshot:
+ * @src: an #RTPSource
+ * @snapshot: (out caller-allocates): the #GstRTPSourceStatsSnapshot to fill
+ *
+ * Fill @snapshot with the current statistics of @src. This is the
+ * allocation-free equivalent of the #RTPSource:stats property.
+ *
+ * Since: 1.22
+ */
+void
+rtp_source_get_stats_snapshot (RTPSource * src,
+    GstRTPSourceStatsSnapshot * snapshot)
+{
+  g_return_if_fail (RTP_IS_SOURCE (src));
+  g_return_if_fail (snapshot != NULL);
+
+  RTP_SOURCE_LOCK (src);
+  fill_stats_snapshot (src, snapshot);
+  RTP_SOURCE_UNLOCK (src);
+}
+
 static GstStructure *
 rtp_source_create_stats (RTPSource * src)
 {
   GstStructure *s;
-  gboolean is_sender = src->is_sender;
-  gboolean internal = src->internal;
-  gchar *address_str;
-  gboolean have_rb;
-  guint32 ssrc = 0;
-  guint8 fractionlost = 0;
-  gint32 packetslost = 0;
-  guint32 exthighestseq = 0;
-  guint32 jitter = 0;
-  guint32 lsr = 0;
-  guint32 dlsr = 0;
-  guint32 round_trip = 0;
-  gboolean have_sr;
-  GstClockTime time = 0;
-  guint64 ntptime = 0;
-  guint32 rtptime = 0;
-  guint32 packet_count = 0;
-  guint32 octet_count = 0;
+  GstRTPSourceStatsSnapshot st;
+  gchar *rtp_from = NULL, *rtcp_from = NULL;
+
+  RTP_SOURCE_LOCK (src);
+  fill_stats_snapshot (src, &st);
+  if (src->rtp_from)
+    rtp_from = __g_socket_address_to_string (src->rtp_from);
+  if (src->rtcp_from)
+    rtcp_from = __g_socket_address_to_string (src->rtcp_from);
+  RTP_SOURCE_UNLOCK (src);
 
   /* common data for all types of sources */
   s = gst_structure_new_id (quark_application_x_rtp_source_stats,
-      quark_ssrc, G_TYPE_UINT, (guint) src->ssrc,
-      quark_internal, G_TYPE_BOOLEAN, internal,
-      quark_validated, G_TYPE_BOOLEAN, src->validated,
-      quark_received_bye, G_TYPE_BOOLEAN, src->marked_bye,
-      quark_is_csrc, G_TYPE_BOOLEAN, src->is_csrc,
-      quark_is_sender, G_TYPE_BOOLEAN, is_sender,
-      quark_first_rtp_activity, G_TYPE_UINT64, src->first_rtp_activity,
-      quark_last_rtp_activity, G_TYPE_UINT64, src->last_rtp_activity,
+      quark_ssrc, G_TYPE_UINT, (guint) st.ssrc,
+      quark_internal, G_TYPE_BOOLEAN, st.internal,
+      quark_validated, G_TYPE_BOOLEAN, st.validated,
+      quark_received_bye, G_TYPE_BOOLEAN, st.received_bye,
+      quark_is_csrc, G_TYPE_BOOLEAN, st.is_csrc,
+      quark_is_sender, G_TYPE_BOOLEAN, st.is_sender,
+      quark_first_rtp_activity, G_TYPE_UINT64, st.first_rtp_activity,
+      quark_last_rtp_activity, G_TYPE_UINT64, st.last_rtp_activity,
       quark_avg_frame_transmission_duration, G_TYPE_UINT64,
-      src->stats.avg_frame_transmission_duration,
+      st.avg_frame_transmission_duration,
       quark_max_frame_transmission_duration, G_TYPE_UINT64,
-      src->stats.max_frame_transmission_duration, NULL);
+      st.max_frame_transmission_duration, NULL);
 
   /* add address and port */
-  if (src->rtp_from) {
-    address_str = __g_socket_address_to_string (src->rtp_from);
-    gst_structure_id_set (s, quark_rtp_from, G_TYPE_STRING, address_str, NULL);
-    g_free (address_str);
+  if (rtp_from) {
+    gst_structure_id_set (s, quark_rtp_from, G_TYPE_STRING, rtp_from, NULL);
+    g_free (rtp_from);
   }
-  if (src->rtcp_from) {
-    address_str = __g_socket_address_to_string (src->rtcp_from);
-    gst_structure_id_set (s, quark_rtcp_from, G_TYPE_STRING, address_str, NULL);
-    g_free (address_str);
+  if (rtcp_from) {
+    gst_structure_id_set (s, quark_rtcp_from, G_TYPE_STRING, rtcp_from, NULL);
+    g_free (rtcp_from);
   }
 
-  /* is_sender applies to internal sources you send with, but also
-     the equivalent source on the receiver side */
-  if (is_sender) {
+  if (st.is_sender) {
     gst_structure_id_set (s,
-        quark_clock_rate, G_TYPE_INT, src->clock_rate,
-        quark_bitrate, G_TYPE_UINT64, src->bitrate, NULL);
+        quark_clock_rate, G_TYPE_INT, st.clock_rate,
+        quark_bitrate, G_TYPE_UINT64, st.bitrate, NULL);
 
-    if (internal) {
+    if (st.internal) {
       gst_structure_id_set (s,
-          quark_seqnum_base, G_TYPE_INT, src->seqnum_offset,
-          quark_octets_sent, G_TYPE_UINT64, src->stats.octets_sent,
-          quark_packets_sent, G_TYPE_UINT64, src->stats.packets_sent,
-          quark_recv_pli_count, G_TYPE_UINT, src->stats.recv_pli_count,
-          quark_recv_fir_count, G_TYPE_UINT, src->stats.recv_fir_count,
-          quark_recv_nack_count, G_TYPE_UINT, src->stats.recv_nack_count, NULL);
+          quark_seqnum_base, G_TYPE_INT, st.seqnum_base,
+          quark_octets_sent, G_TYPE_UINT64, st.octets_sent,
+          quark_packets_sent, G_TYPE_UINT64, st.packets_sent,
+          quark_recv_pli_count, G_TYPE_UINT, st.recv_pli_count,
+          quark_recv_fir_count, G_TYPE_UINT, st.recv_fir_count,
+          quark_recv_nack_count, G_TYPE_UINT, st.recv_nack_count, NULL);
     } else {
       gst_structure_id_set (s,
-          quark_octets_received, G_TYPE_UINT64, src->stats.octets_received,
-          quark_packets_received, G_TYPE_UINT64, src->stats.packets_received,
-          quark_bytes_received, G_TYPE_UINT64, src->stats.bytes_received,
-          quark_packets_lost, G_TYPE_INT,
-          (gint) rtp_stats_get_packets_lost (&src->stats),
-          quark_jitter, G_TYPE_UINT,
-          (guint) (src->stats.jitter >> 4),
-          quark_sent_pli_count, G_TYPE_UINT, src->stats.sent_pli_count,
-          quark_sent_fir_count, G_TYPE_UINT, src->stats.sent_fir_count,
-          quark_sent_nack_count, G_TYPE_UINT, src->stats.sent_nack_count,
-          quark_recv_packet_rate, G_TYPE_UINT,
-          gst_rtp_packet_rate_ctx_get (&src->packet_rate_ctx), NULL);
+          quark_octets_received, G_TYPE_UINT64, st.octets_received,
+          quark_packets_received, G_TYPE_UINT64, st.packets_received,
+          quark_bytes_received, G_TYPE_UINT64, st.bytes_received,
+          quark_packets_lost, G_TYPE_INT, st.packets_lost,
+          quark_jitter, G_TYPE_UINT, st.jitter,
+          quark_sent_pli_count, G_TYPE_UINT, st.sent_pli_count,
+          quark_sent_fir_count, G_TYPE_UINT, st.sent_fir_count,
+          quark_sent_nack_count, G_TYPE_UINT, st.sent_nack_count,
+          quark_recv_packet_rate, G_TYPE_UINT, st.recv_packet_rate, NULL);
     }
   }
 
-  /* get the last SR. */
-  have_sr = rtp_source_get_last_sr (src, &time, &ntptime, &rtptime,
-      &packet_count, &octet_count);
-  gst_structure_id_set (s, quark_have_sr, G_TYPE_BOOLEAN, have_sr, NULL);
-  if (have_sr) {
+  gst_structure_id_set (s, quark_have_sr, G_TYPE_BOOLEAN, st.have_sr, NULL);
+  if (st.have_sr) {
     gst_structure_id_set (s,
-        quark_sr_ntptime, G_TYPE_UINT64, ntptime,
-        quark_sr_rtptime, G_TYPE_UINT, (guint) rtptime,
-        quark_sr_octet_count, G_TYPE_UINT, (guint) octet_count,
-        quark_sr_packet_count, G_TYPE_UINT, (guint) packet_count, NULL);
+        quark_sr_ntptime, G_TYPE_UINT64, st.sr_ntptime,
+        quark_sr_rtptime, G_TYPE_UINT, (guint) st.sr_rtptime,
+        quark_sr_octet_count, G_TYPE_UINT, (guint) st.sr_octet_count,
+        quark_sr_packet_count, G_TYPE_UINT, (guint) st.sr_packet_count, NULL);
   }
 
-  if (!internal) {
-    /* get the last RB we sent */
-    gst_structure_id_set (s,
-        quark_sent_rb, G_TYPE_BOOLEAN, src->last_rr.is_valid, NULL);
-    if (src->last_rr.is_valid) {
+  if (!st.internal) {
+    gst_structure_id_set (s, quark_sent_rb, G_TYPE_BOOLEAN, st.sent_rb, NULL);
+    if (st.sent_rb) {
       gst_structure_id_set (s,
           quark_sent_rb_fractionlost, G_TYPE_UINT,
-          (guint) src->last_rr.fractionlost,
+          (guint) st.sent_rb_fractionlost,
           quark_sent_rb_packetslost, G_TYPE_INT,
-          (gint) src->last_rr.packetslost,
+          (gint) st.sent_rb_packetslost,
           quark_sent_rb_exthighestseq, G_TYPE_UINT,
-          (guint) src->last_rr.exthighestseq,
+          (guint) st.sent_rb_exthighestseq,
           quark_sent_rb_jitter, G_TYPE_UINT,
-          (guint) src->last_rr.jitter,
+          (guint) st.sent_rb_jitter,
           quark_sent_rb_lsr, G_TYPE_UINT,
-          (guint) src->last_rr.lsr,
-          quark_sent_rb_dlsr, G_TYPE_UINT, (guint) src->last_rr.dlsr, NULL);
+          (guint) st.sent_rb_lsr,
+          quark_sent_rb_dlsr, G_TYPE_UINT, (guint) st.sent_rb_dlsr, NULL);
     }
   } else {
-    /* get the last RB */
-    have_rb = rtp_source_get_last_rb (src, &ssrc, &fractionlost,
-        &packetslost, &exthighestseq, &jitter, &lsr, &dlsr, &round_trip);
-    gst_structure_id_set (s, quark_have_rb, G_TYPE_BOOLEAN, have_rb, NULL);
-    if (have_rb) {
+    gst_structure_id_set (s, quark_have_rb, G_TYPE_BOOLEAN, st.have_rb, NULL);
+    if (st.have_rb) {
       gst_structure_id_set (s,
-          quark_rb_ssrc, G_TYPE_UINT, ssrc,
-          quark_rb_fractionlost, G_TYPE_UINT, (guint) fractionlost,
-          quark_rb_packetslost, G_TYPE_INT, (gint) packetslost,
-          quark_rb_exthighestseq, G_TYPE_UINT, (guint) exthighestseq,
-          quark_rb_jitter, G_TYPE_UINT, (guint) jitter,
-          quark_rb_lsr, G_TYPE_UINT, (guint) lsr,
-          quark_rb_dlsr, G_TYPE_UINT, (guint) dlsr,
-          quark_rb_round_trip, G_TYPE_UINT, (guint) round_trip, NULL);
+          quark_rb_ssrc, G_TYPE_UINT, st.rb_ssrc,
+          quark_rb_fractionlost, G_TYPE_UINT, (guint) st.rb_fractionlost,
+          quark_rb_packetslost, G_TYPE_INT, (gint) st.rb_packetslost,
+          quark_rb_exthighestseq, G_TYPE_UINT, (guint) st.rb_exthighestseq,
+          quark_rb_jitter, G_TYPE_UINT, (guint) st.rb_jitter,
+          quark_rb_lsr, G_TYPE_UINT, (guint) st.rb_lsr,
+          quark_rb_dlsr, G_TYPE_UINT, (guint) st.rb_dlsr,
+          quark_rb_round_trip, G_TYPE_UINT, (guint) st.rb_round_trip, NULL);
     }
   }
 
@@ -1039,9 +1115,11 @@ rtp_source_set_rtp_from (RTPSource * src, GSocketAddress * address)
 {
   g_return_if_fail (RTP_IS_SOURCE (src));
 
+  RTP_SOURCE_LOCK (src);
   if (src->rtp_from)
     g_object_unref (src->rtp_from);
   src->rtp_from = G_SOCKET_ADDRESS (g_object_ref (address));
+  RTP_SOURCE_UNLOCK (src);
 }
 
 /**
@@ -1063,13 +1141,13 @@ rtp_source_set_rtcp_from (RTPSource * src, GSocketAddress * address)
 }
 
 static GstFlowReturn
-push_packet (RTPSource * src, GstBuffer * buffer)
+push_packet (RTPSource * src, GQueue * queued, GstBuffer * buffer)
 {
   GstFlowReturn ret = GST_FLOW_OK;
 
   /* push queued packets first if any */
-  while (!g_queue_is_empty (src->packets)) {
-    GstBuffer *buffer = GST_BUFFER_CAST (g_queue_pop_head (src->packets));
+  while (!g_queue_is_empty (queued)) {
+    GstBuffer *buffer = GST_BUFFER_CAST (g_queue_pop_head (queued));
 
     GST_LOG ("pushing queued packet");
     if (src->callbacks.push_rtp)
@@ -1090,6 +1168,9 @@ push_packet (RTPSource * src, GstBuffer * buffer)
 static void
 fetch_caps_for_payload (RTPSource * src, guint8 payload)
 {
+  gboolean need_caps;
+
+  RTP_SOURCE_LOCK (src);
   if (src->payload == -1) {
     /* first payload received, nothing was in the caps, lock on to this payload */
     src->payload = payload;
@@ -1101,16 +1182,21 @@ fetch_caps_for_payload (RTPSource * src, guint8 payload)
     src->clock_rate = -1;
     src->stats.transit = -1;
   }
+  need_caps = src->clock_rate == -1 || !src->caps;
+  RTP_SOURCE_UNLOCK (src);
 
-  if (src->clock_rate == -1 || !src->caps) {
+  if (need_caps) {
     GstCaps *caps = NULL;
 
+    /* the callback can release the session lock, so it can't be called with
+     * our lock */
     if (src->callbacks.caps) {
       caps = src->callbacks.caps (src, payload, src->user_data);
     }
 
     GST_DEBUG ("got caps %" GST_PTR_FORMAT, caps);
 
+    RTP_SOURCE_LOCK (src);
     if (caps) {
       const GstStructure *s;
       gint clock_rate = -1;
@@ -1135,6 +1221,7 @@ fetch_caps_for_payload (RTPSource * src, guint8 payload)
     }
 
     gst_caps_replace (&src->caps, caps);
+    RTP_SOURCE_UNLOCK (src);
     gst_clear_caps (&caps);
   }
 }
@@ -1536,13 +1623,18 @@ rtp_source_process_rtp (RTPSource * src, RTPPacketInfo * pinfo)
 {
   GstFlowReturn result;
 
+  GQueue queued;
+
   g_return_val_if_fail (RTP_IS_SOURCE (src), GST_FLOW_ERROR);
   g_return_val_if_fail (pinfo != NULL, GST_FLOW_ERROR);
 
   fetch_caps_for_payload (src, pinfo->pt);
 
-  if (!update_receiver_stats (src, pinfo, TRUE))
+  RTP_SOURCE_LOCK (src);
+  if (!update_receiver_stats (src, pinfo, TRUE)) {
+    RTP_SOURCE_UNLOCK (src);
     return GST_FLOW_OK;
+  }
 
   /* the source that sent the packet must be a sender */
   src->is_sender = TRUE;
@@ -1553,13 +1645,83 @@ rtp_source_process_rtp (RTPSource * src, RTPPacketInfo * pinfo)
   /* calculate jitter for the stats */
   calculate_jitter (src, pinfo);
 
+  /* take the packets queued during probation, they are pushed without
+   * our lock */
+  queued = *src->packets;
+  g_queue_init (src->packets);
+  RTP_SOURCE_UNLOCK (src);
+
   /* we're ready to push the RTP packet now */
-  result = push_packet (src, pinfo->data);
+  result = push_packet (src, &queued, pinfo->data);
   pinfo->data = NULL;
 
   return result;
 }
 
+/**
+ * rtp_source_try_process_rtp:
+ * @src: an #RTPSource
+ * @pinfo: an #RTPPacketInfo
+ * @push: result location for whether the packet in @pinfo has to be pushed
+ * @bitrate_changed: result location for whether the bitrate estimation of
+ *   @src was updated
+ *
+ * Process an RTP packet from @src without the session lock. This only works
+ * for the common case of a validated sender that is receiving more of the
+ * same payload from the same address, where nothing in the session is
+ * affected by the packet. Only the lock of @src is taken.
+ *
+ * Unlike rtp_source_process_rtp() the packet is not pushed, when @push is
+ * set to %TRUE the caller has to push the data of @pinfo itself.
+ *
+ * Returns: %FALSE when the packet needs to be handled with
+ * rtp_source_process_rtp() instead, @pinfo is left untouched then.
+ */
+gboolean
+rtp_source_try_process_rtp (RTPSource * src, RTPPacketInfo * pinfo,
+    gboolean * push, gboolean * bitrate_changed)
+{
+  guint64 oldrate;
+
+  g_return_val_if_fail (RTP_IS_SOURCE (src), FALSE);
+  g_return_val_if_fail (pinfo != NULL, FALSE);
+
+  RTP_SOURCE_LOCK (src);
+  if (src->internal || !src->validated || !src->is_sender ||
+      src->curr_probation || !g_queue_is_empty (src->packets))
+    goto slow_path;
+
+  /* a new payload or a missing clock-rate needs the caps callback */
+  if (src->payload != pinfo->pt || src->clock_rate == -1 || !src->caps)
+    goto slow_path;
+
+  /* a new address needs the collision checks */
+  if (pinfo->address && (src->rtp_from == NULL ||
+          !__g_socket_address_equal (src->rtp_from, pinfo->address)))
+    goto slow_path;
+
+  /* update last activity */
+  src->last_activity = pinfo->current_time;
+  src->last_rtp_activity = pinfo->current_time;
+
+  oldrate = src->bitrate;
+  *push = update_receiver_stats (src, pinfo, TRUE);
+  if (*push) {
+    do_bitrate_estimation (src, pinfo->running_time, &src->bytes_received);
+    calculate_jitter (src, pinfo);
+  }
+  *bitrate_changed = oldrate != src->bitrate;
+  RTP_SOURCE_UNLOCK (src);
+
+  return TRUE;
+
+slow_path:
+  {
+    RTP_SOURCE_UNLOCK (src);
+    return FALSE;
+  }
+}
+
 /**
  * rtp_source_mark_bye:
  * @src: an #RTPSource
@@ -1888,6 +2050,8 @@ rtp_source_get_new_rb (RTPSource * src, GstClockTime time,
   guint32 fraction, LSR, DLSR;
   GstClockTime sr_time;
 
+  RTP_SOURCE_LOCK (src);
+
   stats = &src->stats;
 
   extended_max = stats->cycles + stats->max_seq;
@@ -1949,6 +2113,8 @@ rtp_source_get_new_rb (RTPSource * src, GstClockTime time,
   if (dlsr)
     *dlsr = DLSR;
 
+  RTP_SOURCE_UNLOCK (src);
+
   return TRUE;
 }
 
@@ -2272,6 +2438,30 @@ rtp_source_register_nack (RTPSource * src, guint16 seqnum,
   src->send_nack = TRUE;
 }
 
+/**
+ * rtp_source_register_nacks:
+ * @src: The #RTPSource
+ * @seqnum: the first seqnum
+ * @bitmap: bitmap of seqnums, bit N set for @seqnum + N
+ * @n_bits: the number of bits in @bitmap
+ * @deadline: the deadline before which RTX is still possible
+ *
+ * Register that the seqnums set in @bitmap have not been received from @src.
+ */
+void
+rtp_source_register_nacks (RTPSource * src, guint16 seqnum,
+    const guint8 * bitmap, guint n_bits, GstClockTime deadline)
+{
+  guint i;
+
+  /* the bits are in seqnum order, so every seqnum but the ones overlapping
+   * with already registered NACKs is appended */
+  for (i = 0; i < n_bits; i++) {
+    if (bitmap[i / 8] & (1 << (i % 8)))
+      rtp_source_register_nack (src, seqnum + i, deadline);
+  }
+}
+
 /**
  * rtp_source_get_nacks:
  * @src: The #RTPSource
@@ -46,6 +46,9 @@ typedef struct _RTPSourceClass RTPSourceClass;
 #define RTP_IS_SOURCE_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE((klass),RTP_TYPE_SOURCE))
 #define RTP_SOURCE_CAST(src)        ((RTPSource *)(src))
 
+#define RTP_SOURCE_LOCK(src)        (g_mutex_lock (&(src)->lock))
+#define RTP_SOURCE_UNLOCK(src)      (g_mutex_unlock (&(src)->lock))
+
 /**
  * RTP_SOURCE_IS_ACTIVE:
  * @src: an #RTPSource
@@ -129,12 +132,18 @@ typedef struct {
  *
  * A source in the #RTPSession
  *
+ * @lock: lock protecting the receiver state that is updated for every
+ *   incoming RTP packet (activity times, receiver statistics, jitter and
+ *   bitrate, the payload and the address the packets come from). It is
+ *   always taken after the session lock, never before it.
  * @conflicting_addresses: GList of conflicting addresses
  */
 struct _RTPSource {
   GObject       object;
 
   /*< private >*/
+  GMutex        lock;
+
   guint32       ssrc;
 
   /* If not -1 then this is the SSRC of the corresponding media RTPSource */
@@ -239,6 +248,8 @@ gchar *         rtp_source_get_bye_reason      (RTPSource *src);
 
 void            rtp_source_update_send_caps    (RTPSource *src, GstCaps *caps);
 
+void            rtp_source_get_stats_snapshot  (RTPSource *src, GstRTPSourceStatsSnapshot *snapshot);
+
 /* SDES info */
 const GstStructure *
                 rtp_source_get_sdes_struct     (RTPSource * src);
@@ -250,6 +261,8 @@ void            rtp_source_set_rtcp_from       (RTPSource *src, GSocketAddress *
 
 /* handling RTP */
 GstFlowReturn   rtp_source_process_rtp         (RTPSource *src, RTPPacketInfo *pinfo);
+gboolean        rtp_source_try_process_rtp     (RTPSource *src, RTPPacketInfo *pinfo,
+                                                gboolean *push, gboolean *bitrate_changed);
 
 GstFlowReturn   rtp_source_send_rtp            (RTPSource *src, RTPPacketInfo *pinfo);
 
@@ -313,6 +326,11 @@ gboolean        rtp_source_has_retained        (RTPSource * src,
 void            rtp_source_register_nack       (RTPSource * src,
                                                 guint16 seqnum,
                                                 GstClockTime deadline);
+void            rtp_source_register_nacks      (RTPSource * src,
+                                                guint16 seqnum,
+                                                const guint8 * bitmap,
+                                                guint n_bits,
+                                                GstClockTime deadline);
 guint16 *       rtp_source_get_nacks           (RTPSource * src, guint *n_nacks);
 GstClockTime *  rtp_source_get_nack_deadlines  (RTPSource * src, guint *n_nacks);
 void            rtp_source_clear_nacks         (RTPSource * src, guint n_nacks);
@@ -0,0 +1,306 @@
+/* GStreamer RTP Manager
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <string.h>
+
+#include "rtpsourcetable.h"
+
+#define MIN_SLOTS_BITS 4
+
+struct _RTPSourceTable
+{
+  /* dense, in no particular order */
+  RTPSource **sources;
+  guint32 *ssrcs;
+  guint n_sources;
+  guint n_alloc;
+
+  /* index + 1 into the dense arrays, 0 for an empty slot, linear probing.
+   * At most half of the slots are used. */
+  guint32 *slots;
+  guint slots_bits;
+};
+
+static inline guint
+slot_home (RTPSourceTable * table, guint32 ssrc)
+{
+  /* SSRCs are random, but not necessarily in the low bits when they are
+   * picked by hand, so spread them with a multiplicative hash */
+  return (ssrc * 0x9E3779B1u) >> (32 - table->slots_bits);
+}
+
+static inline guint
+slot_mask (RTPSourceTable * table)
+{
+  return (1u << table->slots_bits) - 1;
+}
+
+/* returns the slot holding @ssrc, or the empty slot where it would go */
+static guint
+find_slot (RTPSourceTable * table, guint32 ssrc)
+{
+  guint mask = slot_mask (table);
+  guint i = slot_home (table, ssrc);
+
+  while (table->slots[i] != 0 && table->ssrcs[table->slots[i] - 1] != ssrc)
+    i = (i + 1) & mask;
+
+  return i;
+}
+
+static void
+rebuild_slots (RTPSourceTable * table, guint bits)
+{
+  guint i;
+
+  g_free (table->slots);
+  table->slots_bits = bits;
+  table->slots = g_new0 (guint32, 1u << bits);
+
+  for (i = 0; i < table->n_sources; i++)
+    table->slots[find_slot (table, table->ssrcs[i])] = i + 1;
+}
+
+/* empties slot @i and moves later entries of the same probe sequence back
+ * so that no lookup hits a hole before reaching them */
+static void
+clear_slot (RTPSourceTable * table, guint i)
+{
+  guint mask = slot_mask (table);
+  guint j = i;
+
+  table->slots[i] = 0;
+
+  for (;;) {
+    guint home;
+
+    j = (j + 1) & mask;
+    if (table->slots[j] == 0)
+      break;
+
+    home = slot_home (table, table->ssrcs[table->slots[j] - 1]);
+    /* the entry in j may move to i when i lies between its home slot and j */
+    if (((j - home) & mask) >= ((j - i) & mask)) {
+      table->slots[i] = table->slots[j];
+      table->slots[j] = 0;
+      i = j;
+    }
+  }
+}
+
+/* removes the entry at dense index @idx and returns its source */
+static RTPSource *
+remove_index (RTPSourceTable * table, guint idx)
+{
+  RTPSource *src = table->sources[idx];
+  guint last = table->n_sources - 1;
+
+  clear_slot (table, find_slot (table, table->ssrcs[idx]));
+
+  if (idx != last) {
+    table->sources[idx] = table->sources[last];
+    table->ssrcs[idx] = table->ssrcs[last];
+    table->slots[find_slot (table, table->ssrcs[idx])] = idx + 1;
+  }
+  table->n_sources--;
+
+  return src;
+}
+
+/**
+ * rtp_source_table_new:
+ *
+ * Returns: a new, empty #RTPSourceTable. Free with rtp_source_table_free().
+ */
+RTPSourceTable *
+rtp_source_table_new (void)
+{
+  RTPSourceTable *table = g_new0 (RTPSourceTable, 1);
+
+  table->slots_bits = MIN_SLOTS_BITS;
+  table->slots = g_new0 (guint32, 1u << MIN_SLOTS_BITS);
+
+  return table;
+}
+
+/**
+ * rtp_source_table_free:
+ * @table: an #RTPSourceTable
+ *
+ * Unref all sources in @table and free it.
+ */
+void
+rtp_source_table_free (RTPSourceTable * table)
+{
+  rtp_source_table_remove_all (table);
+  g_free (table->sources);
+  g_free (table->ssrcs);
+  g_free (table->slots);
+  g_free (table);
+}
+
+/**
+ * rtp_source_table_size:
+ * @table: an #RTPSourceTable
+ *
+ * Returns: the number of sources in @table.
+ */
+guint
+rtp_source_table_size (RTPSourceTable * table)
+{
+  return table->n_sources;
+}
+
+/**
+ * rtp_source_table_get:
+ * @table: an #RTPSourceTable
+ * @idx: an index smaller than rtp_source_table_size()
+ *
+ * Get the source at @idx, for iterating over @table in a loop. Indexes are
+ * only stable as long as no source is removed.
+ *
+ * Returns: (transfer none): the source at @idx.
+ */
+RTPSource *
+rtp_source_table_get (RTPSourceTable * table, guint idx)
+{
+  g_return_val_if_fail (idx < table->n_sources, NULL);
+
+  return table->sources[idx];
+}
+
+/**
+ * rtp_source_table_lookup:
+ * @table: an #RTPSourceTable
+ * @ssrc: an SSRC
+ *
+ * Returns: (transfer none) (nullable): the source with @ssrc, or %NULL.
+ */
+RTPSource *
+rtp_source_table_lookup (RTPSourceTable * table, guint32 ssrc)
+{
+  guint32 slot = table->slots[find_slot (table, ssrc)];
+
+  return slot ? table->sources[slot - 1] : NULL;
+}
+
+/**
+ * rtp_source_table_insert:
+ * @table: an #RTPSourceTable
+ * @src: (transfer full): an #RTPSource
+ *
+ * Add @src to @table, replacing and unreffing any source with the same SSRC.
+ */
+void
+rtp_source_table_insert (RTPSourceTable * table, RTPSource * src)
+{
+  guint i = find_slot (table, src->ssrc);
+  RTPSource *old;
+
+  if (table->slots[i] != 0) {
+    old = table->sources[table->slots[i] - 1];
+    table->sources[table->slots[i] - 1] = src;
+    g_object_unref (old);
+    return;
+  }
+
+  if (table->n_sources == table->n_alloc) {
+    table->n_alloc = MAX (table->n_alloc * 2, 8);
+    table->sources = g_renew (RTPSource *, table->sources, table->n_alloc);
+    table->ssrcs = g_renew (guint32, table->ssrcs, table->n_alloc);
+  }
+
+  table->sources[table->n_sources] = src;
+  table->ssrcs[table->n_sources] = src->ssrc;
+  table->n_sources++;
+
+  if (table->n_sources * 2 > (1u << table->slots_bits))
+    rebuild_slots (table, table->slots_bits + 1);
+  else
+    table->slots[i] = table->n_sources;
+}
+
+/**
+ * rtp_source_table_remove_all:
+ * @table: an #RTPSourceTable
+ *
+ * Remove and unref all sources in @table.
+ */
+void
+rtp_source_table_remove_all (RTPSourceTable * table)
+{
+  guint i, n = table->n_sources;
+
+  table->n_sources = 0;
+  memset (table->slots, 0, sizeof (guint32) << table->slots_bits);
+
+  for (i = 0; i < n; i++)
+    g_object_unref (table->sources[i]);
+}
+
+/**
+ * rtp_source_table_foreach:
+ * @table: an #RTPSourceTable
+ * @func: the function to call for each source
+ * @user_data: user data to pass to @func
+ *
+ * Call @func for every source in @table, like g_hash_table_foreach() with
+ * the SSRC as key, passed with GUINT_TO_POINTER(). @func must not add or
+ * remove sources.
+ */
+void
+rtp_source_table_foreach (RTPSourceTable * table, GHFunc func,
+    gpointer user_data)
+{
+  guint i;
+
+  for (i = 0; i < table->n_sources; i++)
+    func (GUINT_TO_POINTER (table->ssrcs[i]), table->sources[i], user_data);
+}
+
+/**
+ * rtp_source_table_foreach_remove:
+ * @table: an #RTPSourceTable
+ * @func: the function to call for each source
+ * @user_data: user data to pass to @func
+ *
+ * Call @func for every source in @table, like g_hash_table_foreach_remove(),
+ * and remove and unref the sources for which it returns %TRUE.
+ *
+ * Returns: the number of removed sources.
+ */
+guint
+rtp_source_table_foreach_remove (RTPSourceTable * table, GHRFunc func,
+    gpointer user_data)
+{
+  guint i = 0, removed = 0;
+
+  while (i < table->n_sources) {
+    if (func (GUINT_TO_POINTER (table->ssrcs[i]), table->sources[i],
+            user_data)) {
+      /* the last source is moved into i, so look at i again */
+      g_object_unref (remove_index (table, i));
+      removed++;
+    } else {
+      i++;
+    }
+  }
+
+  return removed;
+}
@@ -0,0 +1,55 @@
+/* GStreamer RTP Manager
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __RTP_SOURCE_TABLE_H__
+#define __RTP_SOURCE_TABLE_H__
+
+#include "rtpsource.h"
+
+typedef struct _RTPSourceTable RTPSourceTable;
+
+/**
+ * RTPSourceTable:
+ *
+ * The sources of a session, indexed by SSRC.
+ *
+ * The sources are kept in a dense array that is walked when iterating, and
+ * an open-addressing index maps an SSRC to its position in that array. The
+ * order of the sources changes when sources are removed.
+ *
+ * The table is not locked, the caller serializes access.
+ */
+
+RTPSourceTable * rtp_source_table_new          (void);
+void             rtp_source_table_free         (RTPSourceTable *table);
+
+guint            rtp_source_table_size         (RTPSourceTable *table);
+RTPSource *      rtp_source_table_get          (RTPSourceTable *table, guint idx);
+RTPSource *      rtp_source_table_lookup       (RTPSourceTable *table, guint32 ssrc);
+
+void             rtp_source_table_insert       (RTPSourceTable *table, RTPSource *src);
+void             rtp_source_table_remove_all   (RTPSourceTable *table);
+
+void             rtp_source_table_foreach        (RTPSourceTable *table, GHFunc func,
+                                                  gpointer user_data);
+guint            rtp_source_table_foreach_remove (RTPSourceTable *table, GHRFunc func,
+                                                  gpointer user_data);
+
+#endif /* __RTP_SOURCE_TABLE_H__ */
@@ -416,6 +416,123 @@ rtp_stats_set_min_interval (RTPSessionStats * stats, gdouble min_interval)
   stats->min_interval = min_interval;
 }
 
+/**
+ * rtp_packet_info_parse_header_ext:
+ * @pinfo: an #RTPPacketInfo
+ *
+ * Walk the header extension block in @pinfo once and record where each
+ * element is, so that the different users of the header extensions can look
+ * them up by id with rtp_packet_info_get_header_ext() instead of each
+ * rescanning the block. Any elements of a previous packet are forgotten.
+ *
+ * Both the one-byte and the two-byte header forms are handled.
+ */
+void
+rtp_packet_info_parse_header_ext (RTPPacketInfo * pinfo)
+{
+  const guint8 *pdata;
+  gsize bytelen, offset = 0;
+  guint hdr_unit_bytes;
+  gboolean one_byte;
+
+  pinfo->n_header_exts = 0;
+
+  if (pinfo->header_ext == NULL)
+    return;
+
+  if (pinfo->header_ext_bit_pattern == 0xBEDE) {
+    one_byte = TRUE;
+    hdr_unit_bytes = 1;
+  } else if (pinfo->header_ext_bit_pattern >> 4 == 0x100) {
+    one_byte = FALSE;
+    hdr_unit_bytes = 2;
+  } else {
+    return;
+  }
+
+  pdata = g_bytes_get_data (pinfo->header_ext, &bytelen);
+
+  while (offset + hdr_unit_bytes < bytelen &&
+      pinfo->n_header_exts < RTP_PACKET_INFO_MAX_HEADER_EXTS) {
+    guint8 read_id, read_len;
+
+    if (one_byte) {
+      read_id = GST_READ_UINT8 (pdata + offset) >> 4;
+      read_len = (GST_READ_UINT8 (pdata + offset) & 0x0F) + 1;
+      offset += 1;
+
+      /* padding */
+      if (read_id == 0)
+        continue;
+
+      /* special id for possible future expansion */
+      if (read_id == 15)
+        break;
+    } else {
+      read_id = GST_READ_UINT8 (pdata + offset);
+      offset += 1;
+
+      /* padding */
+      if (read_id == 0)
+        continue;
+
+      read_len = GST_READ_UINT8 (pdata + offset);
+      offset += 1;
+    }
+
+    if (offset + read_len > bytelen)
+      break;
+
+    /* like the gst_rtp_buffer lookups, the first element of an id wins */
+    if (!rtp_packet_info_get_header_ext (pinfo, read_id, NULL, NULL)) {
+      RTPHeaderExt *ext = &pinfo->header_exts[pinfo->n_header_exts++];
+
+      ext->id = read_id;
+      ext->size = read_len;
+      ext->offset = offset;
+    }
+
+    offset += read_len;
+  }
+}
+
+/**
+ * rtp_packet_info_get_header_ext:
+ * @pinfo: an #RTPPacketInfo
+ * @id: the header extension id
+ * @data: (out) (optional): location for the extension data
+ * @size: (out) (optional): location for the size of @data
+ *
+ * Look up the header extension with @id in the table built by
+ * rtp_packet_info_parse_header_ext().
+ *
+ * Returns: %TRUE if @pinfo has a header extension with @id.
+ */
+gboolean
+rtp_packet_info_get_header_ext (const RTPPacketInfo * pinfo, guint8 id,
+    gpointer * data, guint * size)
+{
+  guint i;
+
+  /* there are only a few elements per packet, a linear search is cheaper
+   * than keeping (and clearing) a table indexed by id */
+  for (i = 0; i < pinfo->n_header_exts; i++) {
+    const RTPHeaderExt *ext = &pinfo->header_exts[i];
+
+    if (ext->id != id)
+      continue;
+
+    if (data)
+      *data = (guint8 *) g_bytes_get_data (pinfo->header_ext, NULL) +
+          ext->offset;
+    if (size)
+      *size = ext->size;
+    return TRUE;
+  }
+
+  return FALSE;
+}
+
 gboolean
 __g_socket_address_equal (GSocketAddress * a, GSocketAddress * b)
 {
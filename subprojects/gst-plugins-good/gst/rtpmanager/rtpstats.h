@@ -61,6 +61,22 @@ typedef struct {
   guint32 round_trip;
 } RTPReceiverReport;
 
+/**
+ * RTPHeaderExt:
+ * @id: the id of the header extension
+ * @size: the size of the header extension data
+ * @offset: the offset of the data in the header extension block
+ *
+ * Location of one header extension element, see RTPPacketInfo.
+ */
+typedef struct {
+  guint8        id;
+  guint8        size;
+  guint16       offset;
+} RTPHeaderExt;
+
+#define RTP_PACKET_INFO_MAX_HEADER_EXTS 16
+
 /**
  * RTPPacketInfo:
  * @send: if this is a packet for sending
@@ -83,6 +99,9 @@ typedef struct {
  * @csrcs: CSRCs
  * @header_ext: Header extension data
  * @header_ext_bit_pattern: Header extension bit pattern
+ * @n_header_exts: Number of parsed header extensions in @header_exts
+ * @header_exts: The header extension elements found in @header_ext, at most
+ *     one per id
  * @ntp64_ext_id: Extension header ID for RFC6051 64-bit NTP timestamp.
  * @have_ntp64_ext: If there is at least one 64-bit NTP timestamp header
  *     extension.
@@ -112,6 +131,8 @@ typedef struct {
   guint32       csrcs[16];
   GBytes        *header_ext;
   guint16       header_ext_bit_pattern;
+  guint         n_header_exts;
+  RTPHeaderExt  header_exts[RTP_PACKET_INFO_MAX_HEADER_EXTS];
   guint8        ntp64_ext_id;
   gboolean      have_ntp64_ext;
   gint32        rtx_osn;
@@ -282,6 +303,12 @@ void           rtp_stats_set_min_interval           (RTPSessionStats *stats,
                                                      gdouble min_interval);
 
 
+void           rtp_packet_info_parse_header_ext     (RTPPacketInfo *pinfo);
+gboolean       rtp_packet_info_get_header_ext       (const RTPPacketInfo *pinfo,
+                                                     guint8 id,
+                                                     gpointer *data,
+                                                     guint *size);
+
 gboolean __g_socket_address_equal (GSocketAddress *a, GSocketAddress *b);
 gchar * __g_socket_address_to_string (GSocketAddress * addr);
 
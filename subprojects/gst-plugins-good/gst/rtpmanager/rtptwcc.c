@@ -855,15 +855,16 @@ rtp_twcc_manager_get_feedback_interval (RTPTWCCManager * twcc)
   return twcc->feedback_interval;
 }
 
+/* the seqnum is accepted in both the one-byte and the two-byte header
+ * extension form (RFC 8285), the latter is what senders use when they
+ * mix in elements that do not fit in the one-byte form */
 static gboolean
 _get_twcc_seqnum_data (RTPPacketInfo * pinfo, guint8 ext_id, gpointer * data)
 {
   gboolean ret = FALSE;
   guint size;
 
-  if (pinfo->header_ext &&
-      gst_rtp_buffer_get_extension_onebyte_header_from_bytes (pinfo->header_ext,
-          pinfo->header_ext_bit_pattern, ext_id, 0, data, &size)) {
+  if (rtp_packet_info_get_header_ext (pinfo, ext_id, data, &size)) {
     if (size == 2)
       ret = TRUE;
   }
@@ -1070,6 +1070,118 @@ GST_START_TEST (test_recv_rtp_and_rtcp_simultaneously)
 
 GST_END_TEST;
 
+static void
+_count_jitterbuffers (GstElement * rtpbin, GstElement * jitterbuffer,
+    guint session, guint ssrc, guint * count)
+{
+  (*count)++;
+}
+
+GST_START_TEST (test_forward_only)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpbin",
+      "recv_rtp_sink_0", NULL);
+  GstHarness *h_rtcp;
+  GstCaps *caps = gst_caps_new_simple ("application/x-rtp",
+      "clock-rate", G_TYPE_INT, 8000,
+      "payload", G_TYPE_INT, 100, NULL);
+  guint jitterbuffers = 0;
+  GstPad *srcpad;
+  guint i;
+
+  g_object_set (h->element, "forward-only", TRUE, NULL);
+  g_signal_connect (h->element, "request-pt-map",
+      G_CALLBACK (_request_pt_map), caps);
+  g_signal_connect (h->element, "new-jitterbuffer",
+      G_CALLBACK (_count_jitterbuffers), &jitterbuffers);
+  g_signal_connect (h->element, "pad-added", G_CALLBACK (_pad_added), h);
+
+  gst_harness_set_src_caps (h, gst_caps_copy (caps));
+
+  for (i = 0; i < 10; i++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h,
+            generate_rtp_buffer (i * GST_MSECOND * 20, i, i * 160, 100,
+                1111)));
+  }
+
+  /* the packets come out as they go in, without a jitterbuffer */
+  fail_unless_equals_int (0, jitterbuffers);
+  srcpad = gst_element_get_static_pad (h->element, "recv_rtp_src_0_1111_255");
+  fail_unless (srcpad != NULL);
+  gst_object_unref (srcpad);
+
+  fail_unless_equals_int (10, gst_harness_buffers_received (h));
+  for (i = 0; i < 10; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *buf = gst_harness_pull (h);
+
+    fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (i, gst_rtp_buffer_get_seq (&rtp));
+    fail_unless_equals_int (1111, gst_rtp_buffer_get_ssrc (&rtp));
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (buf);
+  }
+
+  /* RTCP for the forwarded SSRC is still accepted */
+  h_rtcp = gst_harness_new_with_element (h->element, "recv_rtcp_sink_0", NULL);
+  gst_harness_set_src_caps (h_rtcp,
+      gst_caps_new_empty_simple ("application/x-rtcp"));
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h_rtcp, generate_rtcp_sr_buffer (1111)));
+
+  gst_caps_unref (caps);
+  gst_harness_teardown (h_rtcp);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static void
+_store_jitterbuffer (GstElement * rtpbin, GstElement * jitterbuffer,
+    guint session, guint ssrc, GstElement ** store)
+{
+  gboolean batch;
+
+  /* the rtpbin setting is applied before the signal is emitted */
+  g_object_get (jitterbuffer, "rtx-batch-requests", &batch, NULL);
+  fail_unless (batch);
+
+  *store = gst_object_ref (jitterbuffer);
+}
+
+GST_START_TEST (test_rtx_batch_requests)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpbin",
+      "recv_rtp_sink_0", NULL);
+  GstCaps *caps = gst_caps_new_simple ("application/x-rtp",
+      "clock-rate", G_TYPE_INT, 8000,
+      "payload", G_TYPE_INT, 100, NULL);
+  GstElement *jitterbuffer = NULL;
+  gboolean batch;
+
+  g_object_set (h->element, "rtx-batch-requests", TRUE, NULL);
+  g_signal_connect (h->element, "request-pt-map",
+      G_CALLBACK (_request_pt_map), caps);
+  g_signal_connect (h->element, "new-jitterbuffer",
+      G_CALLBACK (_store_jitterbuffer), &jitterbuffer);
+
+  gst_harness_set_src_caps (h, gst_caps_copy (caps));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h,
+          generate_rtp_buffer (0, 0, 0, 100, 1111)));
+  fail_unless (jitterbuffer != NULL);
+
+  /* changes are propagated to the existing jitterbuffers */
+  g_object_set (h->element, "rtx-batch-requests", FALSE, NULL);
+  g_object_get (jitterbuffer, "rtx-batch-requests", &batch, NULL);
+  fail_if (batch);
+
+  gst_object_unref (jitterbuffer);
+  gst_caps_unref (caps);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpbin_suite (void)
 {
@@ -1089,6 +1201,8 @@ rtpbin_suite (void)
   tcase_add_test (tc_chain, test_sender_eos);
   tcase_add_test (tc_chain, test_quick_shutdown);
   tcase_add_test (tc_chain, test_recv_rtp_and_rtcp_simultaneously);
+  tcase_add_test (tc_chain, test_forward_only);
+  tcase_add_test (tc_chain, test_rtx_batch_requests);
 
   return s;
 }
@@ -0,0 +1,269 @@
+/* GStreamer
+ *
+ * unit test for rtpdominantspeaker
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define CAPS_STR "application/x-rtp, media=audio, clock-rate=48000, " \
+    "encoding-name=OPUS, payload=111"
+#define CAPS_STR_EXTMAP CAPS_STR ", " \
+    "extmap-1=urn:ietf:params:rtp-hdrext:ssrc-audio-level"
+
+#define PACKET_DURATION (20 * GST_MSECOND)
+#define SILENCE 127
+
+#define SSRC_A 1111
+#define SSRC_B 2222
+#define SSRC_C 3333
+
+static GstBuffer *
+generate_rtp_buffer (guint32 ssrc, guint16 seq, GstClockTime pts,
+    guint8 ext_id, gint level)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (20, 0, 0);
+
+  GST_BUFFER_PTS (buf) = pts;
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 111);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, seq * 960);
+  if (level >= 0) {
+    guint8 data = (level < SILENCE ? 0x80 : 0x00) | level;
+    fail_unless (gst_rtp_buffer_add_extension_onebyte_header (&rtp, ext_id,
+            &data, 1));
+  }
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+typedef struct
+{
+  GstHarness *h;
+  GstBus *bus;
+  guint16 seq;
+  GstClockTime now;
+} TestContext;
+
+static void
+test_context_init (TestContext * ctx, const gchar * caps)
+{
+  ctx->h = gst_harness_new ("rtpdominantspeaker");
+  gst_harness_set_src_caps_str (ctx->h, caps);
+  ctx->bus = gst_bus_new ();
+  gst_element_set_bus (ctx->h->element, ctx->bus);
+  ctx->seq = 0;
+  ctx->now = 0;
+}
+
+static void
+test_context_clear (TestContext * ctx)
+{
+  gst_element_set_bus (ctx->h->element, NULL);
+  gst_object_unref (ctx->bus);
+  gst_harness_teardown (ctx->h);
+}
+
+/* pushes @duration worth of packets for three SSRCs with the given levels */
+static void
+push_levels (TestContext * ctx, GstClockTime duration, gint level_a,
+    gint level_b, gint level_c)
+{
+  GstClockTime end = ctx->now + duration;
+
+  for (; ctx->now < end; ctx->now += PACKET_DURATION, ctx->seq++) {
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (ctx->h,
+            generate_rtp_buffer (SSRC_A, ctx->seq, ctx->now, 1, level_a)));
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (ctx->h,
+            generate_rtp_buffer (SSRC_B, ctx->seq, ctx->now, 1, level_b)));
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (ctx->h,
+            generate_rtp_buffer (SSRC_C, ctx->seq, ctx->now, 1, level_c)));
+    gst_buffer_unref (gst_harness_pull (ctx->h));
+    gst_buffer_unref (gst_harness_pull (ctx->h));
+    gst_buffer_unref (gst_harness_pull (ctx->h));
+  }
+}
+
+/* returns the structure of the newest active speakers message, or NULL */
+static GstStructure *
+pop_last_active_speakers (TestContext * ctx)
+{
+  GstStructure *ret = NULL;
+  GstMessage *msg;
+
+  while ((msg = gst_bus_pop_filtered (ctx->bus, GST_MESSAGE_ELEMENT))) {
+    const GstStructure *s = gst_message_get_structure (msg);
+
+    if (gst_structure_has_name (s, "GstRTPActiveSpeakers")) {
+      if (ret)
+        gst_structure_free (ret);
+      ret = gst_structure_copy (s);
+    }
+    gst_message_unref (msg);
+  }
+
+  return ret;
+}
+
+static guint
+get_ssrc (const GstStructure * s, guint idx)
+{
+  const GValue *ssrcs = gst_structure_get_value (s, "ssrcs");
+
+  return g_value_get_uint (gst_value_array_get_value (ssrcs, idx));
+}
+
+static guint
+get_n_ssrcs (const GstStructure * s)
+{
+  return gst_value_array_get_size (gst_structure_get_value (s, "ssrcs"));
+}
+
+GST_START_TEST (test_rtpdominantspeaker_switch)
+{
+  TestContext ctx;
+  GstStructure *s;
+  guint dominant;
+
+  test_context_init (&ctx, CAPS_STR_EXTMAP);
+
+  /* A talks */
+  push_levels (&ctx, 2 * GST_SECOND, 20, SILENCE, SILENCE);
+  s = pop_last_active_speakers (&ctx);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_get_uint (s, "dominant-ssrc", &dominant));
+  fail_unless_equals_int (SSRC_A, dominant);
+  fail_unless_equals_int (1, get_n_ssrcs (s));
+  fail_unless_equals_int (SSRC_A, get_ssrc (s, 0));
+  gst_structure_free (s);
+
+  /* A keeps talking, nothing changes */
+  push_levels (&ctx, GST_SECOND, 20, SILENCE, SILENCE);
+  fail_unless (pop_last_active_speakers (&ctx) == NULL);
+
+  /* B takes over, a short interruption is not enough */
+  push_levels (&ctx, 100 * GST_MSECOND, SILENCE, 20, SILENCE);
+  push_levels (&ctx, GST_SECOND, 20, SILENCE, SILENCE);
+  s = pop_last_active_speakers (&ctx);
+  if (s) {
+    fail_unless (gst_structure_get_uint (s, "dominant-ssrc", &dominant));
+    fail_unless_equals_int (SSRC_A, dominant);
+    gst_structure_free (s);
+  }
+
+  push_levels (&ctx, 2 * GST_SECOND, SILENCE, 20, SILENCE);
+  s = pop_last_active_speakers (&ctx);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_get_uint (s, "dominant-ssrc", &dominant));
+  fail_unless_equals_int (SSRC_B, dominant);
+  fail_unless_equals_int (SSRC_B, get_ssrc (s, 0));
+  gst_structure_free (s);
+
+  /* everybody goes quiet */
+  push_levels (&ctx, 10 * GST_SECOND, SILENCE, SILENCE, SILENCE);
+  s = pop_last_active_speakers (&ctx);
+  fail_unless (s != NULL);
+  fail_if (gst_structure_has_field (s, "dominant-ssrc"));
+  fail_unless_equals_int (0, get_n_ssrcs (s));
+  gst_structure_free (s);
+
+  test_context_clear (&ctx);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtpdominantspeaker_top_n)
+{
+  TestContext ctx;
+  GstStructure *s;
+  guint dominant;
+
+  test_context_init (&ctx, CAPS_STR_EXTMAP);
+  g_object_set (ctx.h->element, "top-n", 2, NULL);
+
+  /* everybody talks, C the loudest and A the most quiet */
+  push_levels (&ctx, 3 * GST_SECOND, 60, 40, 10);
+  s = pop_last_active_speakers (&ctx);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_get_uint (s, "dominant-ssrc", &dominant));
+  fail_unless_equals_int (SSRC_C, dominant);
+  fail_unless_equals_int (2, get_n_ssrcs (s));
+  fail_unless_equals_int (SSRC_C, get_ssrc (s, 0));
+  fail_unless_equals_int (SSRC_B, get_ssrc (s, 1));
+  gst_structure_free (s);
+
+  test_context_clear (&ctx);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_rtpdominantspeaker_ext_id)
+{
+  TestContext ctx;
+  GstBuffer *buf;
+  GstStructure *s;
+  guint dominant;
+
+  /* no extmap in the caps, the levels are not found */
+  test_context_init (&ctx, CAPS_STR);
+  push_levels (&ctx, 2 * GST_SECOND, SILENCE, 20, SILENCE);
+  fail_unless (pop_last_active_speakers (&ctx) == NULL);
+
+  /* the packets pass through untouched */
+  buf = generate_rtp_buffer (SSRC_A, 0, ctx.now, 1, 20);
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (ctx.h,
+          gst_buffer_ref (buf)));
+  fail_unless (gst_harness_pull (ctx.h) == buf);
+  gst_buffer_unref (buf);
+  gst_buffer_unref (buf);
+
+  g_object_set (ctx.h->element, "audio-level-ext-id", 1, NULL);
+  push_levels (&ctx, 2 * GST_SECOND, SILENCE, 20, SILENCE);
+  s = pop_last_active_speakers (&ctx);
+  fail_unless (s != NULL);
+  fail_unless (gst_structure_get_uint (s, "dominant-ssrc", &dominant));
+  fail_unless_equals_int (SSRC_B, dominant);
+  gst_structure_free (s);
+
+  test_context_clear (&ctx);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpdominantspeaker_suite (void)
+{
+  Suite *s = suite_create ("rtpdominantspeaker");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_rtpdominantspeaker_switch);
+  tcase_add_test (tc_chain, test_rtpdominantspeaker_top_n);
+  tcase_add_test (tc_chain, test_rtpdominantspeaker_ext_id);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpdominantspeaker)
@@ -0,0 +1,331 @@
+/* GStreamer
+ *
+ * unit test for rtpfanout
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
+
+#define IN_SSRC 1111
+#define CAPS_STR "application/x-rtp, media=video, clock-rate=90000, " \
+    "encoding-name=VP8, payload=96, ssrc=(uint)1111"
+
+static GstBuffer *
+generate_rtp_buffer (guint32 ssrc, guint16 seq, guint32 ts, GstClockTime pts)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (100, 0, 0);
+
+  GST_BUFFER_PTS (buf) = pts;
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, ts);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+static GstHarness *
+add_receiver (GstHarness * h, const gchar * name, guint ssrc,
+    gint seqnum_offset, guint timestamp_offset)
+{
+  GstHarness *hr = gst_harness_new_with_element (h->element, NULL, name);
+  GstPad *pad = gst_element_get_static_pad (h->element, name);
+
+  g_object_set (pad, "ssrc", ssrc, "seqnum-offset", seqnum_offset,
+      "timestamp-offset", timestamp_offset, NULL);
+  gst_object_unref (pad);
+
+  return hr;
+}
+
+static void
+pull_and_check (GstHarness * h, guint32 ssrc, guint16 seq, guint32 ts)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_harness_pull (h);
+
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (96, gst_rtp_buffer_get_payload_type (&rtp));
+  fail_unless_equals_int (ssrc, gst_rtp_buffer_get_ssrc (&rtp));
+  fail_unless_equals_int (seq, gst_rtp_buffer_get_seq (&rtp));
+  fail_unless_equals_int (ts, gst_rtp_buffer_get_timestamp (&rtp));
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+static GstEvent *
+pull_custom_upstream_event (GstHarness * h)
+{
+  GstEvent *event;
+
+  while ((event = gst_harness_try_pull_upstream_event (h))) {
+    if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_UPSTREAM)
+      return event;
+    gst_event_unref (event);
+  }
+
+  return NULL;
+}
+
+GST_START_TEST (rtpfanout_rewrite_headers)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+  GstHarness *h1 = add_receiver (h, "src_1", 2000, 200, 20000);
+  GstStructure *s;
+  GstCaps *caps;
+  guint ssrc;
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  /* every receiver has caps with its own ssrc */
+  caps = gst_pad_get_current_caps (h0->sinkpad);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_uint (s, "ssrc", &ssrc));
+  fail_unless_equals_int (1000, ssrc);
+  fail_unless_equals_string ("VP8", gst_structure_get_string (s,
+          "encoding-name"));
+  gst_caps_unref (caps);
+  caps = gst_pad_get_current_caps (h1->sinkpad);
+  s = gst_caps_get_structure (caps, 0);
+  fail_unless (gst_structure_get_uint (s, "ssrc", &ssrc));
+  fail_unless_equals_int (2000, ssrc);
+  gst_caps_unref (caps);
+
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 5, 500, 0)));
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 6, 3500,
+              GST_SECOND / 30)));
+
+  pull_and_check (h0, 1000, 100, 10000);
+  pull_and_check (h0, 1000, 101, 13000);
+  pull_and_check (h1, 2000, 200, 20000);
+  pull_and_check (h1, 2000, 201, 23000);
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpfanout_payload_is_shared)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+  GstHarness *h1 = add_receiver (h, "src_1", 2000, 200, 20000);
+  GstBuffer *buf, *b0, *b1;
+  GstMemory *mem;
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  buf = generate_rtp_buffer (IN_SSRC, 5, 500, 0);
+  mem = gst_memory_ref (gst_buffer_peek_memory (buf, 0));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, buf));
+
+  b0 = gst_harness_pull (h0);
+  b1 = gst_harness_pull (h1);
+
+  /* a header of its own, followed by the payload of the input buffer */
+  fail_unless_equals_int (2, gst_buffer_n_memory (b0));
+  fail_unless_equals_int (2, gst_buffer_n_memory (b1));
+  fail_unless_equals_int (12, gst_buffer_peek_memory (b0, 0)->size);
+  fail_unless_equals_int (12, gst_buffer_peek_memory (b1, 0)->size);
+  fail_unless (gst_buffer_peek_memory (b0, 1)->parent == mem);
+  fail_unless (gst_buffer_peek_memory (b1, 1)->parent == mem);
+  fail_unless_equals_int (100, gst_buffer_peek_memory (b0, 1)->size);
+
+  /* and the headers of all receivers come from the same block */
+  fail_unless (gst_buffer_peek_memory (b0, 0)->parent ==
+      gst_buffer_peek_memory (b1, 0)->parent);
+
+  gst_buffer_unref (b0);
+  gst_buffer_unref (b1);
+  gst_memory_unref (mem);
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpfanout_buffer_list)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+  GstHarness *h1 = add_receiver (h, "src_1", 2000, 200, 20000);
+  GstBufferList *list = gst_buffer_list_new ();
+  guint i;
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  for (i = 0; i < 3; i++)
+    gst_buffer_list_add (list, generate_rtp_buffer (IN_SSRC, 5 + i, 500, 0));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push_list (h, list));
+
+  fail_unless_equals_int (3, gst_harness_buffers_received (h0));
+  fail_unless_equals_int (3, gst_harness_buffers_received (h1));
+  for (i = 0; i < 3; i++) {
+    pull_and_check (h0, 1000, 100 + i, 10000);
+    pull_and_check (h1, 2000, 200 + i, 20000);
+  }
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpfanout_input_ssrc_switch)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 5, 500, 0)));
+  pull_and_check (h0, 1000, 100, 10000);
+
+  /* a different input stream continues where the output left off, with
+   * the timestamp moving along with the PTS */
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (2222, 3000, 777777,
+              20 * GST_MSECOND)));
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (2222, 3001, 777777 + 900,
+              30 * GST_MSECOND)));
+  pull_and_check (h0, 1000, 101, 11800);
+  pull_and_check (h0, 1000, 102, 12700);
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpfanout_upstream_event_translation)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+  GstHarness *h1 = add_receiver (h, "src_1", 2000, 200, 20000);
+  const GstStructure *s;
+  GstEvent *event;
+  guint ssrc, seqnum;
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 5, 500, 0)));
+  gst_buffer_unref (gst_harness_pull (h0));
+  gst_buffer_unref (gst_harness_pull (h1));
+
+  /* drop latency and reconfigure events */
+  while ((event = gst_harness_try_pull_upstream_event (h)))
+    gst_event_unref (event);
+
+  /* a retransmission request from receiver 1 is for the input packet */
+  gst_harness_push_upstream_event (h1,
+      gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+          gst_structure_new ("GstRTPRetransmissionRequest",
+              "ssrc", G_TYPE_UINT, 2000, "seqnum", G_TYPE_UINT, 200, NULL)));
+  event = pull_custom_upstream_event (h);
+  fail_unless (event != NULL);
+  s = gst_event_get_structure (event);
+  fail_unless (gst_structure_has_name (s, "GstRTPRetransmissionRequest"));
+  fail_unless (gst_structure_get_uint (s, "ssrc", &ssrc));
+  fail_unless (gst_structure_get_uint (s, "seqnum", &seqnum));
+  fail_unless_equals_int (IN_SSRC, ssrc);
+  fail_unless_equals_int (5, seqnum);
+  gst_event_unref (event);
+
+  /* a key unit request from receiver 0 */
+  gst_harness_push_upstream_event (h0,
+      gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM,
+          gst_structure_new ("GstForceKeyUnit",
+              "ssrc", G_TYPE_UINT, 1000, NULL)));
+  event = pull_custom_upstream_event (h);
+  fail_unless (event != NULL);
+  s = gst_event_get_structure (event);
+  fail_unless (gst_structure_get_uint (s, "ssrc", &ssrc));
+  fail_unless_equals_int (IN_SSRC, ssrc);
+  gst_event_unref (event);
+
+  gst_harness_teardown (h0);
+  gst_harness_teardown (h1);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpfanout_release_pad)
+{
+  GstHarness *h = gst_harness_new_with_padnames ("rtpfanout", "sink", NULL);
+  GstHarness *h0 = add_receiver (h, "src_0", 1000, 100, 10000);
+  GstHarness *h1 = add_receiver (h, "src_1", 2000, 200, 20000);
+
+  gst_harness_set_src_caps_str (h, CAPS_STR);
+
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 5, 500, 0)));
+
+  /* the remaining receiver keeps getting packets */
+  gst_harness_teardown (h0);
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 6, 500, 0)));
+  pull_and_check (h1, 2000, 200, 20000);
+  pull_and_check (h1, 2000, 201, 20000);
+
+  gst_harness_teardown (h1);
+
+  /* without receivers the packets are dropped */
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, generate_rtp_buffer (IN_SSRC, 7, 500, 0)));
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpfanout_suite (void)
+{
+  Suite *s = suite_create ("rtpfanout");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, rtpfanout_rewrite_headers);
+  tcase_add_test (tc_chain, rtpfanout_payload_is_shared);
+  tcase_add_test (tc_chain, rtpfanout_buffer_list);
+  tcase_add_test (tc_chain, rtpfanout_input_ssrc_switch);
+  tcase_add_test (tc_chain, rtpfanout_upstream_event_translation);
+  tcase_add_test (tc_chain, rtpfanout_release_pad);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpfanout)
@@ -0,0 +1,382 @@
+/* GStreamer plugin for forward error correction
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include <config.h>
+#endif
+
+#include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/check/gstcheck.h>
+
+#define RTP_PACKET_DUR (10 * GST_MSECOND)
+#define MEDIA_PT 100
+#define FEC_PT 122
+#define FEC_SSRC 0xfecfecfe
+
+static GstBuffer *
+create_media_packet (guint32 ssrc, guint16 seq, guint idx)
+{
+  guint payload_len = 100 + (idx % 7) * 13;
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (payload_len, 0, 0);
+  guint8 *payload;
+  guint i;
+
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp));
+  gst_rtp_buffer_set_payload_type (&rtp, MEDIA_PT);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, idx * 3000);
+  gst_rtp_buffer_set_marker (&rtp, idx % 3 == 2);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < payload_len; i++)
+    payload[i] = (guint8) (seq + idx + i);
+  gst_rtp_buffer_unmap (&rtp);
+
+  GST_BUFFER_PTS (buf) = idx * RTP_PACKET_DUR;
+  GST_BUFFER_DTS (buf) = idx * RTP_PACKET_DUR;
+
+  return buf;
+}
+
+static GstHarness *
+harness_rtpflexfecenc (guint columns, guint rows)
+{
+  GstHarness *h = gst_harness_new ("rtpflexfecenc");
+
+  gst_harness_set (h, "rtpflexfecenc", "pt", FEC_PT, "ssrc", FEC_SSRC,
+      "columns", columns, "rows", rows, NULL);
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  return h;
+}
+
+/* Pushes @n_packets media packets, alternating between @ssrcs, and returns
+ * everything the encoder outputs */
+static GPtrArray *
+encode_packets (GstHarness * h, const guint32 * ssrcs, guint n_ssrcs,
+    guint n_packets)
+{
+  GPtrArray *out = g_ptr_array_new_with_free_func ((GDestroyNotify)
+      gst_buffer_unref);
+  GstBuffer *buf;
+  guint i;
+
+  for (i = 0; i < n_packets; i++) {
+    guint32 ssrc = ssrcs[i % n_ssrcs];
+    guint16 seq = 1000 + i / n_ssrcs;
+
+    fail_unless_equals_int (GST_FLOW_OK,
+        gst_harness_push (h, create_media_packet (ssrc, seq, i)));
+
+    while ((buf = gst_harness_try_pull (h)))
+      g_ptr_array_add (out, buf);
+  }
+
+  return out;
+}
+
+static gboolean
+buffer_is_fec (GstBuffer * buf)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  gboolean ret;
+
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  ret = gst_rtp_buffer_get_payload_type (&rtp) == FEC_PT;
+  gst_rtp_buffer_unmap (&rtp);
+
+  return ret;
+}
+
+static GstHarness *
+harness_rtpflexfecdec (guint32 ssrc)
+{
+  GstHarness *h = gst_harness_new_parse ("rtpstorage ! rtpflexfecdec");
+  GObject *internal_storage;
+  gchar *caps_str =
+      g_strdup_printf ("application/x-rtp,ssrc=(uint)%u,payload=(int)%u",
+      ssrc, MEDIA_PT);
+
+  gst_harness_set (h, "rtpstorage", "size-time", (guint64) 200 * RTP_PACKET_DUR,
+      NULL);
+  gst_harness_get (h, "rtpstorage", "internal-storage", &internal_storage,
+      NULL);
+  gst_harness_set (h, "rtpflexfecdec", "storage", internal_storage, "pt",
+      FEC_PT, NULL);
+  g_object_unref (internal_storage);
+
+  gst_harness_set_src_caps_str (h, caps_str);
+  g_free (caps_str);
+
+  return h;
+}
+
+static void
+push_lost_event (GstHarness * h, guint16 seqnum)
+{
+  fail_unless (gst_harness_push_event (h,
+          gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+              gst_structure_new ("GstRTPPacketLost",
+                  "seqnum", G_TYPE_UINT, (guint) seqnum,
+                  "timestamp", G_TYPE_UINT64, (guint64) 111111,
+                  "duration", G_TYPE_UINT64, (guint64) 222222, NULL))));
+}
+
+/* Feeds the encoder output, except the packets in @lost, to the decoder
+ * and checks the lost ones, which must all be from @ssrc, get recovered */
+static void
+decode_and_check_recovered (GPtrArray * packets, guint32 ssrc,
+    const guint * lost, guint n_lost)
+{
+  GstHarness *h = harness_rtpflexfecdec (ssrc);
+  guint recovered;
+  guint i, j;
+
+  for (i = 0; i < packets->len; i++) {
+    gboolean is_lost = FALSE;
+
+    for (j = 0; j < n_lost; j++)
+      is_lost |= (lost[j] == i);
+
+    if (!is_lost)
+      gst_buffer_unref (gst_harness_push_and_pull (h,
+              gst_buffer_ref (g_ptr_array_index (packets, i))));
+  }
+
+  for (j = 0; j < n_lost; j++) {
+    GstBuffer *expected = g_ptr_array_index (packets, lost[j]);
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstBuffer *bufout;
+    GstMapInfo map;
+
+    fail_unless (gst_rtp_buffer_map (expected, GST_MAP_READ, &rtp));
+    push_lost_event (h, gst_rtp_buffer_get_seq (&rtp));
+    gst_rtp_buffer_unmap (&rtp);
+
+    bufout = gst_harness_pull (h);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (bufout), 111111);
+    fail_unless (gst_buffer_map (expected, &map, GST_MAP_READ));
+    fail_unless_equals_int (gst_buffer_get_size (bufout), map.size);
+    fail_unless (gst_buffer_memcmp (bufout, 0, map.data, map.size) == 0);
+    gst_buffer_unmap (expected, &map);
+    gst_buffer_unref (bufout);
+  }
+
+  gst_harness_get (h, "rtpflexfecdec", "recovered", &recovered, NULL);
+  fail_unless_equals_int (recovered, n_lost);
+
+  gst_harness_teardown (h);
+}
+
+GST_START_TEST (rtpflexfecenc_row)
+{
+  GstHarness *h = harness_rtpflexfecenc (4, 1);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out = encode_packets (h, &ssrc, 1, 8);
+  guint protected;
+  guint i;
+
+  /* 4 media packets followed by a FEC packet, twice */
+  fail_unless_equals_int (out->len, 10);
+  for (i = 0; i < out->len; i++) {
+    GstBuffer *buf = g_ptr_array_index (out, i);
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+
+    fail_unless_equals_int (buffer_is_fec (buf), i % 5 == 4);
+    if (i % 5 != 4)
+      continue;
+
+    fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+    fail_unless_equals_int (gst_rtp_buffer_get_ssrc (&rtp), FEC_SSRC);
+    fail_unless_equals_int (gst_rtp_buffer_get_csrc_count (&rtp), 1);
+    fail_unless_equals_int (gst_rtp_buffer_get_csrc (&rtp, 0), ssrc);
+    fail_unless_equals_uint64 (GST_BUFFER_PTS (buf), (i - 1) / 5 * 4 *
+        RTP_PACKET_DUR + 3 * RTP_PACKET_DUR);
+    gst_rtp_buffer_unmap (&rtp);
+  }
+
+  gst_harness_get (h, "rtpflexfecenc", "protected", &protected, NULL);
+  fail_unless_equals_int (protected, 8);
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpflexfecenc_columns)
+{
+  GstHarness *h = harness_rtpflexfecenc (3, 2);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out = encode_packets (h, &ssrc, 1, 6);
+  guint n_fec = 0;
+  guint i;
+
+  /* 2 row FEC packets and 3 column FEC packets */
+  for (i = 0; i < out->len; i++)
+    n_fec += buffer_is_fec (g_ptr_array_index (out, i));
+  fail_unless_equals_int (out->len, 11);
+  fail_unless_equals_int (n_fec, 5);
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+/* A column FEC packet can't span more than 110 seqnums of a stream, so the
+ * rows are reduced to fit, whatever order the properties are set in */
+GST_START_TEST (rtpflexfecenc_columns_exceed_mask)
+{
+  GstHarness *h = harness_rtpflexfecenc (20, 10);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out;
+  guint protected, rows;
+  guint n_fec = 0;
+  guint i;
+
+  gst_harness_get (h, "rtpflexfecenc", "rows", &rows, NULL);
+  fail_unless_equals_int (rows, 6);
+
+  /* every media packet is protected by its row and its column */
+  out = encode_packets (h, &ssrc, 1, 120);
+  for (i = 0; i < out->len; i++)
+    n_fec += buffer_is_fec (g_ptr_array_index (out, i));
+  fail_unless_equals_int (n_fec, 6 + 20);
+  gst_harness_get (h, "rtpflexfecenc", "protected", &protected, NULL);
+  fail_unless_equals_int (protected, 2 * 120);
+
+  gst_harness_set (h, "rtpflexfecenc", "columns", 1, "rows", 10, NULL);
+  gst_harness_set (h, "rtpflexfecenc", "columns", 20, NULL);
+  gst_harness_get (h, "rtpflexfecenc", "rows", &rows, NULL);
+  fail_unless_equals_int (rows, 6);
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpflexfec_recover_row)
+{
+  GstHarness *h = harness_rtpflexfecenc (4, 1);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out = encode_packets (h, &ssrc, 1, 8);
+  /* second packet of the first row and last packet of the second row */
+  const guint lost[] = { 1, 8 };
+
+  decode_and_check_recovered (out, ssrc, lost, G_N_ELEMENTS (lost));
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpflexfec_recover_2d)
+{
+  GstHarness *h = harness_rtpflexfecenc (3, 3);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out = encode_packets (h, &ssrc, 1, 9);
+  /* Output is: m0 m1 m2 r0 m3 m4 m5 r1 m6 m7 m8 r2 c0 c1 c2
+   * Losing m0, m1 and m3 means neither the first row nor the first column
+   * can recover m0 on their own, m1 and m3 have to be recovered first */
+  const guint lost[] = { 0, 1, 4 };
+
+  decode_and_check_recovered (out, ssrc, lost, G_N_ELEMENTS (lost));
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpflexfec_recover_multi_ssrc)
+{
+  GstHarness *h = harness_rtpflexfecenc (4, 1);
+  const guint32 ssrcs[] = { 0x11111111, 0x22222222 };
+  GPtrArray *out = encode_packets (h, ssrcs, 2, 8);
+  GstBuffer *fec = g_ptr_array_index (out, 4);
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  /* Second packet of the second ssrc */
+  const guint lost[] = { 3 };
+
+  /* One FEC packet protects both streams */
+  fail_unless (buffer_is_fec (fec));
+  fail_unless (gst_rtp_buffer_map (fec, GST_MAP_READ, &rtp));
+  fail_unless_equals_int (gst_rtp_buffer_get_csrc_count (&rtp), 2);
+  fail_unless_equals_int (gst_rtp_buffer_get_csrc (&rtp, 0), ssrcs[0]);
+  fail_unless_equals_int (gst_rtp_buffer_get_csrc (&rtp, 1), ssrcs[1]);
+  gst_rtp_buffer_unmap (&rtp);
+
+  decode_and_check_recovered (out, ssrcs[1], lost, G_N_ELEMENTS (lost));
+
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpflexfec_unrecoverable)
+{
+  GstHarness *h = harness_rtpflexfecenc (4, 1);
+  guint32 ssrc = 0x12345678;
+  GPtrArray *out = encode_packets (h, &ssrc, 1, 4);
+  GstHarness *hdec = harness_rtpflexfecdec (ssrc);
+  guint unrecovered;
+  guint i;
+
+  /* Two packets lost in the same row */
+  for (i = 2; i < out->len; i++)
+    gst_buffer_unref (gst_harness_push_and_pull (hdec,
+            gst_buffer_ref (g_ptr_array_index (out, i))));
+
+  push_lost_event (hdec, 1000);
+  fail_unless_equals_int (gst_harness_buffers_in_queue (hdec), 0);
+
+  gst_harness_get (hdec, "rtpflexfecdec", "unrecovered", &unrecovered, NULL);
+  fail_unless_equals_int (unrecovered, 1);
+
+  gst_harness_teardown (hdec);
+  g_ptr_array_unref (out);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpflexfec_suite (void)
+{
+  Suite *s = suite_create ("rtpflexfec");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, rtpflexfecenc_row);
+  tcase_add_test (tc_chain, rtpflexfecenc_columns);
+  tcase_add_test (tc_chain, rtpflexfecenc_columns_exceed_mask);
+  tcase_add_test (tc_chain, rtpflexfec_recover_row);
+  tcase_add_test (tc_chain, rtpflexfec_recover_2d);
+  tcase_add_test (tc_chain, rtpflexfec_recover_multi_ssrc);
+  tcase_add_test (tc_chain, rtpflexfec_unrecoverable);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpflexfec)
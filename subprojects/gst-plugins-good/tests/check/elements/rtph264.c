@@ -542,6 +542,61 @@ GST_START_TEST (test_rtph264depay_fu_a)
 
 GST_END_TEST;
 
+static GstBuffer *
+depay_fu_a_access_unit (gboolean non_contiguous)
+{
+  GstHarness *h = gst_harness_new ("rtph264depay");
+  GstBuffer *buffer;
+
+  g_object_set (h->element, "non-contiguous-frames", non_contiguous, NULL);
+  gst_harness_set_caps_str (h,
+      "application/x-rtp,media=video,clock-rate=90000,encoding-name=H264",
+      "video/x-h264,alignment=au,stream-format=byte-stream");
+
+  fail_unless_equals_int (gst_harness_push (h,
+          wrap_static_buffer (rtp_h264_idr_fu_start,
+              sizeof (rtp_h264_idr_fu_start))), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h,
+          wrap_static_buffer (rtp_h264_idr_fu_middle,
+              sizeof (rtp_h264_idr_fu_middle))), GST_FLOW_OK);
+  fail_unless_equals_int (gst_harness_push (h,
+          wrap_static_buffer (rtp_h264_idr_fu_end,
+              sizeof (rtp_h264_idr_fu_end))), GST_FLOW_OK);
+
+  fail_unless_equals_int (gst_harness_buffers_in_queue (h), 1);
+  buffer = gst_harness_pull (h);
+
+  gst_harness_teardown (h);
+
+  return buffer;
+}
+
+GST_START_TEST (test_rtph264depay_fu_a_non_contiguous)
+{
+  GstBuffer *contiguous, *non_contiguous;
+  GstMapInfo map;
+
+  contiguous = depay_fu_a_access_unit (FALSE);
+  non_contiguous = depay_fu_a_access_unit (TRUE);
+
+  /* the fragments are handed out as they were received */
+  fail_unless_equals_int (gst_buffer_n_memory (contiguous), 1);
+  fail_unless (gst_buffer_n_memory (non_contiguous) > 1);
+  fail_unless (GST_BUFFER_FLAG_IS_SET (non_contiguous,
+          GST_BUFFER_FLAG_MARKER));
+
+  fail_unless (gst_buffer_map (contiguous, &map, GST_MAP_READ));
+  fail_unless_equals_int (gst_buffer_memcmp (non_contiguous, 0, map.data,
+          map.size), 0);
+  fail_unless_equals_int (gst_buffer_get_size (non_contiguous), map.size);
+  gst_buffer_unmap (contiguous, &map);
+
+  gst_buffer_unref (contiguous);
+  gst_buffer_unref (non_contiguous);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtph264depay_fu_a_missing_start)
 {
   GstHarness *h = gst_harness_new ("rtph264depay");
@@ -1468,6 +1523,7 @@ rtph264_suite (void)
   tcase_add_test (tc_chain, test_rtph264depay_marker_to_flag);
   tcase_add_test (tc_chain, test_rtph264depay_stap_a_marker);
   tcase_add_test (tc_chain, test_rtph264depay_fu_a);
+  tcase_add_test (tc_chain, test_rtph264depay_fu_a_non_contiguous);
   tcase_add_test (tc_chain, test_rtph264depay_fu_a_missing_start);
 
   tc_chain = tcase_create ("rtph264pay");
@@ -1759,6 +1759,66 @@ GST_START_TEST (test_rtx_two_missing)
 
 GST_END_TEST;
 
+static void
+verify_rtx_batch_event (GstHarness * h, guint exp_seq,
+    const guint8 * exp_bitmap, gsize exp_size)
+{
+  GstEvent *event;
+  const GstStructure *s;
+  GBytes *bitmap, *expected;
+  guint seq;
+
+  event = gst_harness_pull_upstream_event (h);
+  fail_unless (event != NULL);
+
+  s = gst_event_get_structure (event);
+  fail_unless (gst_structure_has_name (s, "GstRTPRetransmissionRequestBatch"));
+  fail_unless (gst_structure_get_uint (s, "seqnum", &seq));
+  fail_unless (gst_structure_get (s, "bitmap", G_TYPE_BYTES, &bitmap, NULL));
+  fail_unless_equals_int ((guint16) exp_seq, seq);
+  expected = g_bytes_new_static (exp_bitmap, exp_size);
+  fail_unless (g_bytes_equal (expected, bitmap));
+
+  g_bytes_unref (expected);
+  g_bytes_unref (bitmap);
+  gst_event_unref (event);
+}
+
+GST_START_TEST (test_rtx_batch_requests)
+{
+  GstHarness *h = gst_harness_new ("rtpjitterbuffer");
+  gint latency_ms = 200;
+  guint next_seqnum;
+  GstClockTime now;
+  const guint8 first[] = { 0x01 };
+  const guint8 all[] = { 0x07 };
+
+  g_object_set (h->element, "do-retransmission", TRUE,
+      "rtx-batch-requests", TRUE, NULL);
+  next_seqnum = construct_deterministic_initial_state (h, latency_ms);
+  fail_unless_equals_int (11, next_seqnum);
+
+  /* the first RTX for packet 11 happens at 230ms and is alone in its batch */
+  gst_harness_crank_single_clock_wait (h);
+  verify_rtx_batch_event (h, 11, first, sizeof (first));
+  gst_harness_wait_for_clock_id_waits (h, 1, 60);
+
+  /* packet 14 arrives at 280ms. The retry for 11 (270ms) and the first
+   * requests for 12 (250ms) and 13 (270ms) have all expired by then, so they
+   * are sent together */
+  now = 14 * TEST_BUF_DURATION;
+  gst_harness_set_time (h, now);
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h,
+          generate_test_buffer_full (now, 14, 14 * TEST_RTP_TS_DURATION)));
+
+  verify_rtx_batch_event (h, 11, all, sizeof (all));
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_rtx_buffer_arrives_just_in_time)
 {
   GstHarness *h = gst_harness_new ("rtpjitterbuffer");
@@ -4045,6 +4105,7 @@ rtpjitterbuffer_suite (void)
 
   tcase_add_test (tc_chain, test_rtx_next_seqnum_disabled);
   tcase_add_test (tc_chain, test_rtx_two_missing);
+  tcase_add_test (tc_chain, test_rtx_batch_requests);
   tcase_add_test (tc_chain, test_rtx_buffer_arrives_just_in_time);
   tcase_add_test (tc_chain, test_rtx_buffer_arrives_too_late);
   tcase_add_test (tc_chain, test_rtx_original_buffer_does_not_update_rtx_stats);
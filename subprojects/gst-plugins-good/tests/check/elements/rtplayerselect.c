@@ -0,0 +1,393 @@
+/* GStreamer
+ *
+ * unit test for rtpvp8layerselect and rtpvp9layerselect
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+#include <gst/check/gstcheck.h>
+#include <gst/check/gstharness.h>
+#include <gst/rtp/gstrtpbuffer.h>
+#include <gst/video/video.h>
+
+#define VP8_CAPS "application/x-rtp, media=video, clock-rate=90000, " \
+    "encoding-name=VP8"
+#define VP9_CAPS "application/x-rtp, media=video, clock-rate=90000, " \
+    "encoding-name=VP9"
+
+#define FRAME_DURATION (40 * GST_MSECOND)
+#define FRAME_TS_STEP 3600
+
+static GstBuffer *
+create_rtp_packet (guint32 ssrc, guint16 seq, guint frame, gboolean marker,
+    const guint8 * descriptor, guint descriptor_len)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_rtp_buffer_new_allocate (descriptor_len + 10, 0, 0);
+  guint8 *payload;
+
+  GST_BUFFER_PTS (buf) = frame * FRAME_DURATION;
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_seq (&rtp, seq);
+  gst_rtp_buffer_set_timestamp (&rtp, frame * FRAME_TS_STEP);
+  gst_rtp_buffer_set_marker (&rtp, marker);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  memcpy (payload, descriptor, descriptor_len);
+  memset (payload + descriptor_len, 0xaa, 10);
+  gst_rtp_buffer_unmap (&rtp);
+
+  return buf;
+}
+
+/* one packet per frame, with a 15 bit picture id, TL0PICIDX and TID */
+static GstBuffer *
+create_vp8_packet (guint32 ssrc, guint16 seq, guint frame, guint16 picture_id,
+    guint8 tl0picidx, guint8 tid, gboolean sync, gboolean keyframe)
+{
+  guint8 descriptor[] = {
+    0x90, 0xe0, 0x80 | (picture_id >> 8), picture_id & 0xff, tl0picidx,
+    (tid << 6) | (sync << 5),
+    /* VP8 frame tag, P bit */
+    keyframe ? 0x00 : 0x01,
+  };
+
+  return create_rtp_packet (ssrc, seq, frame, TRUE, descriptor,
+      sizeof (descriptor));
+}
+
+/* one packet per spatial layer frame, non-flexible mode */
+static GstBuffer *
+create_vp9_packet (guint32 ssrc, guint16 seq, guint frame, guint16 picture_id,
+    guint8 tl0picidx, guint8 sid, gboolean keyframe, gboolean marker)
+{
+  guint8 descriptor[] = {
+    0xac | (keyframe ? 0x00 : 0x40), 0x80 | (picture_id >> 8),
+    picture_id & 0xff, (sid << 1) | (sid > 0 ? 0x01 : 0x00), tl0picidx,
+  };
+
+  return create_rtp_packet (ssrc, seq, frame, marker, descriptor,
+      sizeof (descriptor));
+}
+
+typedef struct
+{
+  guint32 ssrc;
+  guint16 seq;
+  guint32 ts;
+  gboolean marker;
+  guint16 picture_id;
+  guint8 tl0picidx;
+} PacketInfo;
+
+static void
+pull_packet (GstHarness * h, gboolean vp9, PacketInfo * info)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf = gst_harness_pull (h);
+  guint8 *payload;
+
+  fail_unless (buf != NULL);
+  fail_unless (gst_rtp_buffer_map (buf, GST_MAP_READ, &rtp));
+  info->ssrc = gst_rtp_buffer_get_ssrc (&rtp);
+  info->seq = gst_rtp_buffer_get_seq (&rtp);
+  info->ts = gst_rtp_buffer_get_timestamp (&rtp);
+  info->marker = gst_rtp_buffer_get_marker (&rtp);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  /* the VP8 descriptor has the extension byte before the picture id */
+  info->picture_id = GST_READ_UINT16_BE (payload + (vp9 ? 1 : 2)) & 0x7fff;
+  info->tl0picidx = payload[4];
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (buf);
+}
+
+static const guint8 vp8_tids[] = { 0, 2, 1, 2 };
+
+/* frames of a stream with three temporal layers, tl0picidx counting the
+ * frames of layer 0 */
+static void
+push_vp8_frames (GstHarness * h, guint32 ssrc, guint16 seq, guint first,
+    guint n, guint16 picture_id, guint8 tl0picidx)
+{
+  guint i;
+
+  for (i = first; i < first + n; i++) {
+    guint8 tid = vp8_tids[i % 4];
+
+    fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h,
+            create_vp8_packet (ssrc, seq + i, i, picture_id + i,
+                tl0picidx + i / 4, tid, tid != 0, i == 0)));
+  }
+}
+
+GST_START_TEST (test_vp8_temporal_layer_drop)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  PacketInfo info;
+  guint i;
+  guint dropped;
+
+  g_object_set (h->element, "target-temporal-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  push_vp8_frames (h, 1234, 100, 0, 12, 1000, 50);
+
+  /* only the frames of layer 0, without gaps */
+  fail_unless_equals_int (3, gst_harness_buffers_in_queue (h));
+  for (i = 0; i < 3; i++) {
+    pull_packet (h, FALSE, &info);
+    fail_unless_equals_int (1234, info.ssrc);
+    fail_unless_equals_int (100 + i, info.seq);
+    fail_unless_equals_int (i * 4 * FRAME_TS_STEP, info.ts);
+    fail_unless_equals_int (1000 + i, info.picture_id);
+    fail_unless_equals_int (50 + i, info.tl0picidx);
+  }
+
+  g_object_get (h->element, "dropped", &dropped, NULL);
+  fail_unless_equals_int (9, dropped);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp8_all_layers_passthrough)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  GstBuffer *in, *out;
+
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  /* nothing to rewrite, so the packets go through untouched */
+  in = create_vp8_packet (1234, 100, 0, 1000, 50, 0, FALSE, TRUE);
+  gst_buffer_ref (in);
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, in));
+  out = gst_harness_pull (h);
+  fail_unless (out == in);
+  gst_buffer_unref (out);
+  gst_buffer_unref (in);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp8_payload_is_shared)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  GstBuffer *in, *out;
+  GstMemory *mem;
+
+  g_object_set (h->element, "target-temporal-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  push_vp8_frames (h, 1234, 100, 0, 4, 1000, 50);
+  gst_buffer_unref (gst_harness_pull (h));
+
+  /* the next layer 0 frame needs a new seqnum and picture id */
+  in = create_vp8_packet (1234, 104, 4, 1004, 51, 0, FALSE, FALSE);
+  mem = gst_memory_ref (gst_buffer_peek_memory (in, 0));
+  fail_unless_equals_int (GST_FLOW_OK, gst_harness_push (h, in));
+  out = gst_harness_pull (h);
+
+  /* RTP header, descriptor up to TL0PICIDX, then the rest of the input */
+  fail_unless_equals_int (2, gst_buffer_n_memory (out));
+  fail_unless_equals_int (12 + 5, gst_buffer_peek_memory (out, 0)->size);
+  fail_unless (gst_buffer_peek_memory (out, 1)->parent == mem);
+
+  gst_buffer_unref (out);
+  gst_memory_unref (mem);
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp8_temporal_layer_switch_up)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  PacketInfo info;
+
+  g_object_set (h->element, "target-temporal-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  push_vp8_frames (h, 1234, 100, 0, 4, 1000, 50);
+  fail_unless_equals_int (1, gst_harness_buffers_in_queue (h));
+
+  /* layer 1 is added at the next sync frame of layer 1 */
+  g_object_set (h->element, "target-temporal-layer", 1, NULL);
+  push_vp8_frames (h, 1234, 100, 4, 4, 1000, 50);
+  fail_unless_equals_int (3, gst_harness_buffers_in_queue (h));
+
+  pull_packet (h, FALSE, &info);
+  fail_unless_equals_int (100, info.seq);
+  fail_unless_equals_int (1000, info.picture_id);
+  pull_packet (h, FALSE, &info);
+  fail_unless_equals_int (101, info.seq);
+  fail_unless_equals_int (1001, info.picture_id);
+  fail_unless_equals_int (4 * FRAME_TS_STEP, info.ts);
+  pull_packet (h, FALSE, &info);
+  fail_unless_equals_int (102, info.seq);
+  fail_unless_equals_int (1002, info.picture_id);
+  fail_unless_equals_int (6 * FRAME_TS_STEP, info.ts);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp8_late_packet_after_drop)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  PacketInfo info;
+  guint dropped;
+
+  g_object_set (h->element, "target-temporal-layer", 1, NULL);
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  /* frames 1 and 3 of layer 2 are dropped, frame 2 of layer 1 arrives after
+   * them and would get the seqnum of frame 0 */
+  gst_harness_push (h, create_vp8_packet (1234, 100, 0, 1000, 50, 0, FALSE,
+          TRUE));
+  gst_harness_push (h, create_vp8_packet (1234, 101, 1, 1001, 50, 2, TRUE,
+          FALSE));
+  gst_harness_push (h, create_vp8_packet (1234, 103, 3, 1003, 50, 2, TRUE,
+          FALSE));
+  gst_harness_push (h, create_vp8_packet (1234, 102, 2, 1002, 50, 1, TRUE,
+          FALSE));
+  gst_harness_push (h, create_vp8_packet (1234, 104, 4, 1004, 51, 0, FALSE,
+          FALSE));
+
+  fail_unless_equals_int (2, gst_harness_buffers_in_queue (h));
+  pull_packet (h, FALSE, &info);
+  fail_unless_equals_int (100, info.seq);
+  pull_packet (h, FALSE, &info);
+  fail_unless_equals_int (102, info.seq);
+  fail_unless_equals_int (4 * FRAME_TS_STEP, info.ts);
+
+  g_object_get (h->element, "dropped", &dropped, NULL);
+  fail_unless_equals_int (3, dropped);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp8_ssrc_switch)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8layerselect");
+  const GstStructure *s;
+  PacketInfo info;
+  GstEvent *event;
+  guint ssrc;
+  guint i;
+
+  gst_harness_set_src_caps_str (h, VP8_CAPS);
+
+  for (i = 0; i < 3; i++)
+    gst_harness_push (h, create_vp8_packet (1111, 100 + i, i, 1000 + i, 50 + i,
+            0, FALSE, i == 0));
+
+  /* drain latency and reconfigure events */
+  while ((event = gst_harness_try_pull_upstream_event (h)))
+    gst_event_unref (event);
+
+  /* another stream starts without a key frame, ask for one */
+  gst_harness_push (h, create_vp8_packet (2222, 7000, 3, 20, 200, 0, FALSE,
+          FALSE));
+  event = gst_harness_pull_upstream_event (h);
+  fail_unless (gst_video_event_is_force_key_unit (event));
+  s = gst_event_get_structure (event);
+  fail_unless (gst_structure_get_uint (s, "ssrc", &ssrc));
+  fail_unless_equals_int (2222, ssrc);
+  gst_event_unref (event);
+
+  gst_harness_push (h, create_vp8_packet (2222, 7001, 4, 21, 201, 0, FALSE,
+          TRUE));
+  gst_harness_push (h, create_vp8_packet (2222, 7002, 5, 22, 202, 0, FALSE,
+          FALSE));
+
+  fail_unless_equals_int (5, gst_harness_buffers_in_queue (h));
+  for (i = 0; i < 3; i++)
+    pull_packet (h, FALSE, &info);
+
+  /* the new stream continues the old one */
+  for (i = 0; i < 2; i++) {
+    pull_packet (h, FALSE, &info);
+    fail_unless_equals_int (1111, info.ssrc);
+    fail_unless_equals_int (103 + i, info.seq);
+    fail_unless_equals_int (1003 + i, info.picture_id);
+    fail_unless_equals_int (53 + i, info.tl0picidx);
+    fail_unless_equals_int ((4 + i) * FRAME_TS_STEP, info.ts);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_vp9_spatial_layer_drop)
+{
+  GstHarness *h = gst_harness_new ("rtpvp9layerselect");
+  PacketInfo info;
+  guint i;
+
+  g_object_set (h->element, "target-spatial-layer", 0, NULL);
+  gst_harness_set_src_caps_str (h, VP9_CAPS);
+
+  /* two spatial layers, the marker is on the last one */
+  for (i = 0; i < 3; i++) {
+    gst_harness_push (h, create_vp9_packet (1234, 100 + i * 2, i, 500 + i,
+            10 + i, 0, i == 0, FALSE));
+    gst_harness_push (h, create_vp9_packet (1234, 101 + i * 2, i, 500 + i,
+            10 + i, 1, FALSE, TRUE));
+  }
+
+  fail_unless_equals_int (3, gst_harness_buffers_in_queue (h));
+  for (i = 0; i < 3; i++) {
+    pull_packet (h, TRUE, &info);
+    fail_unless_equals_int (100 + i, info.seq);
+    fail_unless_equals_int (500 + i, info.picture_id);
+    fail_unless_equals_int (10 + i, info.tl0picidx);
+    fail_unless (info.marker);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtplayerselect_suite (void)
+{
+  Suite *s = suite_create ("rtplayerselect");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+
+  tcase_add_test (tc_chain, test_vp8_temporal_layer_drop);
+  tcase_add_test (tc_chain, test_vp8_all_layers_passthrough);
+  tcase_add_test (tc_chain, test_vp8_payload_is_shared);
+  tcase_add_test (tc_chain, test_vp8_temporal_layer_switch_up);
+  tcase_add_test (tc_chain, test_vp8_late_packet_after_drop);
+  tcase_add_test (tc_chain, test_vp8_ssrc_switch);
+  tcase_add_test (tc_chain, test_vp9_spatial_layer_drop);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtplayerselect)
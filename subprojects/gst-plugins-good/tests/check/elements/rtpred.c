@@ -866,6 +866,121 @@ GST_START_TEST (rtpredenc_too_large_length)
 
 GST_END_TEST;
 
+static GstBuffer *
+_push_adaptive_packet (GstHarness * h, guint nth, guint payload_len)
+{
+  GstBuffer *bufinp =
+      _new_rtp_buffer (TRUE, 0, PT_MEDIA, nth, TIMESTAMP_NTH (nth), 0xabe2b0b,
+      payload_len);
+
+  GST_BUFFER_PTS (bufinp) = nth * 40 * GST_MSECOND;
+  return gst_harness_push_and_pull (h, bufinp);
+}
+
+/* checks a RED packet carries @n_blocks redundant blocks for the previous
+ * packets, the oldest first */
+static void
+_check_redundant_blocks (GstHarness * h, GstBuffer * bufout, guint n_blocks)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  guint8 *payload;
+  guint i, num_redundant_blocks;
+
+  g_object_get (h->element, "num-redundant-blocks", &num_redundant_blocks,
+      NULL);
+  fail_unless_equals_int (num_redundant_blocks, n_blocks);
+
+  fail_unless (gst_rtp_buffer_map (bufout, GST_MAP_READ, &rtp));
+  if (n_blocks == 0 &&
+      gst_rtp_buffer_get_payload_type (&rtp) == PT_MEDIA) {
+    gst_rtp_buffer_unmap (&rtp);
+    gst_buffer_unref (bufout);
+    return;
+  }
+
+  fail_unless_equals_int (gst_rtp_buffer_get_payload_type (&rtp), PT_RED);
+  payload = gst_rtp_buffer_get_payload (&rtp);
+  for (i = 0; i < n_blocks; i++) {
+    guint timestamp_offset = (payload[1] << 6) | (payload[2] >> 2);
+
+    fail_unless (payload[0] & 0x80);
+    fail_unless_equals_int (payload[0] & 0x7f, PT_MEDIA);
+    fail_unless_equals_int (timestamp_offset, (n_blocks - i) * TIMESTAMP_DIFF);
+    payload += 4;
+  }
+  /* Main block header */
+  fail_unless_equals_int (payload[0], PT_MEDIA);
+  gst_rtp_buffer_unmap (&rtp);
+  gst_buffer_unref (bufout);
+}
+
+GST_START_TEST (rtpredenc_adaptive)
+{
+  GstHarness *h = gst_harness_new ("rtpredenc");
+  guint nth = 0;
+
+  g_object_set (h->element, "pt", PT_RED, "allow-no-red-blocks", FALSE,
+      "adaptive", TRUE, "max-distance", 3, NULL);
+  gst_harness_set_src_caps_str (h, GST_RTP_RED_ENC_CAPS_STR);
+
+  /* No loss, no redundancy */
+  for (; nth < 4; nth++)
+    _check_redundant_blocks (h, _push_adaptive_packet (h, nth, 10), 0);
+
+  /* 5% * 5% is within the 1% target with one copy */
+  g_object_set (h->element, "packet-loss-percentage", 5.0, NULL);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, nth++, 10), 1);
+
+  /* 20% needs two */
+  g_object_set (h->element, "packet-loss-percentage", 20.0, NULL);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, nth++, 10), 2);
+
+  /* Never more than max-distance */
+  g_object_set (h->element, "packet-loss-percentage", 100.0, NULL);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, nth++, 10), 3);
+
+  /* A more relaxed target */
+  g_object_set (h->element, "packet-loss-percentage", 20.0,
+      "target-loss-percentage", 5.0, NULL);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, nth++, 10), 1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (rtpredenc_adaptive_bitrate_budget)
+{
+  GstHarness *h = gst_harness_new ("rtpredenc");
+  guint payload_len = 100;
+  /* exactly one redundant block per packet */
+  guint bitrate = (payload_len + 4) * 8 * 1000 / 40;
+  guint nth;
+
+  g_object_set (h->element, "pt", PT_RED, "allow-no-red-blocks", FALSE,
+      "adaptive", TRUE, "max-distance", 3, "packet-loss-percentage", 50.0,
+      "max-redundancy-bitrate", bitrate, NULL);
+  gst_harness_set_src_caps_str (h, GST_RTP_RED_ENC_CAPS_STR);
+
+  /* The saved up budget is spent first */
+  gst_buffer_unref (_push_adaptive_packet (h, 0, payload_len));
+  _check_redundant_blocks (h, _push_adaptive_packet (h, 1, payload_len), 1);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, 2, payload_len), 2);
+  _check_redundant_blocks (h, _push_adaptive_packet (h, 3, payload_len), 3);
+
+  for (nth = 4; nth < 20; nth++)
+    gst_buffer_unref (_push_adaptive_packet (h, nth, payload_len));
+
+  /* Then only the most recent packet fits */
+  for (; nth < 25; nth++)
+    _check_redundant_blocks (h, _push_adaptive_packet (h, nth, payload_len),
+        1);
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static Suite *
 rtpred_suite (void)
 {
@@ -888,6 +1003,8 @@ rtpred_suite (void)
   tcase_add_loop_test (tc_chain, rtpredenc_too_large_timestamp_offset, 0, 2);
   tcase_add_loop_test (tc_chain, rtpredenc_too_large_length, 0, 2);
   tcase_add_test (tc_chain, rtpredenc_transport_cc);
+  tcase_add_test (tc_chain, rtpredenc_adaptive);
+  tcase_add_test (tc_chain, rtpredenc_adaptive_bitrate_budget);
 
   return s;
 }
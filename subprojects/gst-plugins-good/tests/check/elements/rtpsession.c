@@ -32,6 +32,7 @@
 
 #include <gst/rtp/gstrtpbuffer.h>
 #include <gst/rtp/gstrtcpbuffer.h>
+#include <gst/rtp/gstrtpsourcestats.h>
 #include <gst/net/gstnet.h>
 #include <gst/net/gstnetaddressmeta.h>
 #include <gst/video/video.h>
@@ -459,6 +460,27 @@ session_harness_rtp_retransmission_request (SessionHarness * h,
       gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM, s));
 }
 
+static void
+session_harness_rtp_retransmission_request_batch (SessionHarness * h,
+    guint ssrc, guint seqnum, const guint8 * bitmap, gsize bitmap_len)
+{
+  GstClockTime running_time = GST_CLOCK_TIME_NONE;
+  GBytes *bytes = g_bytes_new (bitmap, bitmap_len);
+
+  GstStructure *s = gst_structure_new ("GstRTPRetransmissionRequestBatch",
+      "running-time", GST_TYPE_CLOCK_TIME, running_time,
+      "ssrc", G_TYPE_UINT, ssrc,
+      "seqnum", G_TYPE_UINT, seqnum,
+      "bitmap", G_TYPE_BYTES, bytes,
+      "delay", G_TYPE_UINT, 0,
+      "deadline", G_TYPE_UINT, 0,
+      "avg-rtt", G_TYPE_UINT, 0,
+      NULL);
+  g_bytes_unref (bytes);
+  gst_harness_push_upstream_event (h->recv_rtp_h,
+      gst_event_new_custom (GST_EVENT_CUSTOM_UPSTREAM, s));
+}
+
 static void
 _add_twcc_field_to_caps (GstCaps * caps, guint8 ext_id)
 {
@@ -567,6 +589,144 @@ GST_START_TEST (test_multiple_ssrc_rr)
 
 GST_END_TEST;
 
+/* Sources are indexed by SSRC, make sure that many SSRCs that only differ
+ * in their high bits can all be found and are all reported */
+GST_START_TEST (test_many_sources)
+{
+  SessionHarness *h = session_harness_new ();
+  GstStructure *stats;
+  GValueArray *stats_arr;
+  RTPSource *source;
+  guint n_remote = 0;
+  guint i;
+
+  for (i = 0; i < 300; i++) {
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (0,
+                (i << 20) | 0x1234)));
+  }
+
+  for (i = 0; i < 300; i++) {
+    g_signal_emit_by_name (h->internal_session, "get-source-by-ssrc",
+        (i << 20) | 0x1234, &source);
+    fail_unless (source != NULL);
+    g_object_unref (source);
+  }
+  g_signal_emit_by_name (h->internal_session, "get-source-by-ssrc", 0x1235,
+      &source);
+  fail_unless (source == NULL);
+
+  g_object_get (h->session, "stats", &stats, NULL);
+  stats_arr =
+      g_value_get_boxed (gst_structure_get_value (stats, "source-stats"));
+  for (i = 0; i < stats_arr->n_values; i++) {
+    const GstStructure *s =
+        g_value_get_boxed (g_value_array_get_nth (stats_arr, i));
+    gboolean internal;
+
+    fail_unless (gst_structure_get_boolean (s, "internal", &internal));
+    if (!internal)
+      n_remote++;
+  }
+  fail_unless_equals_int (300, n_remote);
+  gst_structure_free (stats);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_stats_snapshot)
+{
+  SessionHarness *h = session_harness_new ();
+  GArray *snapshots =
+      g_array_new (FALSE, FALSE, sizeof (GstRTPSourceStatsSnapshot));
+  GstStructure *stats;
+  GValueArray *stats_arr;
+  guint n, i, j;
+
+  /* one internal sender and two remote senders */
+  fail_unless_equals_int (GST_FLOW_OK,
+      session_harness_send_rtp (h, generate_test_buffer (0, 0xDEADBEEF)));
+  for (i = 0; i < 3; i++) {
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0x01BADBAD)));
+    fail_unless_equals_int (GST_FLOW_OK,
+        session_harness_recv_rtp (h, generate_test_buffer (i, 0x02BADBAD)));
+  }
+
+  g_signal_emit_by_name (h->session, "get-stats-snapshot", snapshots, &n);
+  fail_unless_equals_int (snapshots->len, n);
+
+  /* the snapshots must match the stats structures */
+  g_object_get (h->session, "stats", &stats, NULL);
+  stats_arr =
+      g_value_get_boxed (gst_structure_get_value (stats, "source-stats"));
+  fail_unless_equals_int (stats_arr->n_values, n);
+
+  for (i = 0; i < stats_arr->n_values; i++) {
+    const GstStructure *s =
+        g_value_get_boxed (g_value_array_get_nth (stats_arr, i));
+    GstRTPSourceStatsSnapshot *snapshot = NULL;
+    gboolean internal, is_sender;
+    guint ssrc;
+    guint64 packets;
+
+    fail_unless (gst_structure_get (s, "ssrc", G_TYPE_UINT, &ssrc,
+            "internal", G_TYPE_BOOLEAN, &internal,
+            "is-sender", G_TYPE_BOOLEAN, &is_sender, NULL));
+    for (j = 0; j < n; j++) {
+      GstRTPSourceStatsSnapshot *st =
+          &g_array_index (snapshots, GstRTPSourceStatsSnapshot, j);
+
+      if (st->ssrc == ssrc)
+        snapshot = st;
+    }
+    fail_unless (snapshot != NULL);
+    fail_unless_equals_int (snapshot->size, sizeof (GstRTPSourceStatsSnapshot));
+    fail_unless_equals_int (internal, snapshot->internal);
+    fail_unless_equals_int (is_sender, snapshot->is_sender);
+
+    if (is_sender && internal) {
+      fail_unless (gst_structure_get_uint64 (s, "packets-sent", &packets));
+      fail_unless_equals_uint64 (packets, snapshot->packets_sent);
+    } else if (is_sender) {
+      fail_unless (gst_structure_get_uint64 (s, "packets-received",
+              &packets));
+      fail_unless_equals_uint64 (packets, snapshot->packets_received);
+    }
+  }
+  gst_structure_free (stats);
+
+  /* a reused array is resized to the current number of sources */
+  g_array_set_size (snapshots, n + 10);
+  g_signal_emit_by_name (h->session, "get-stats-snapshot", snapshots, &j);
+  fail_unless_equals_int (n, j);
+  fail_unless_equals_int (n, snapshots->len);
+  g_array_unref (snapshots);
+
+  /* an array of an older, smaller version of the structure only gets the
+   * fields that fit */
+  snapshots = g_array_new (FALSE, FALSE,
+      G_STRUCT_OFFSET (GstRTPSourceStatsSnapshot, clock_rate));
+  g_signal_emit_by_name (h->session, "get-stats-snapshot", snapshots, &j);
+  fail_unless_equals_int (n, j);
+  for (i = 0; i < n; i++) {
+    GstRTPSourceStatsSnapshot *st = (GstRTPSourceStatsSnapshot *)
+        (snapshots->data + i * G_STRUCT_OFFSET (GstRTPSourceStatsSnapshot,
+            clock_rate));
+
+    fail_unless_equals_int (st->size,
+        G_STRUCT_OFFSET (GstRTPSourceStatsSnapshot, clock_rate));
+    fail_unless (st->ssrc == 0xDEADBEEF || st->ssrc == 0x01BADBAD ||
+        st->ssrc == 0x02BADBAD);
+  }
+  g_array_unref (snapshots);
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 /* This verifies that rtpsession will correctly place RBs round-robin
  * across multiple RRs when there are too many senders that their RBs
  * do not fit in one RR */
@@ -2129,6 +2289,95 @@ GST_START_TEST (test_feedback_rtcp_race)
 
 GST_END_TEST;
 
+#define RECV_RACE_N_SOURCES 10
+
+typedef struct
+{
+  SessionHarness *h;
+  gint stop;
+  gint pushed;
+  /* the next seqnum of each source, only used by the pushing thread */
+  guint seqnums[RECV_RACE_N_SOURCES];
+} RecvRaceData;
+
+static gpointer
+push_recv_rtp (RecvRaceData * data)
+{
+  guint i;
+
+  while (!g_atomic_int_get (&data->stop)) {
+    for (i = 0; i < RECV_RACE_N_SOURCES; i++) {
+      fail_unless_equals_int (GST_FLOW_OK, session_harness_recv_rtp (data->h,
+              generate_test_buffer (data->seqnums[i]++, 0x1000 + i)));
+    }
+    g_atomic_int_add (&data->pushed, RECV_RACE_N_SOURCES);
+  }
+
+  return NULL;
+}
+
+static guint64
+get_packets_received (SessionHarness * h, guint32 ssrc)
+{
+  RTPSource *source;
+  GstStructure *stats;
+  guint64 packets;
+
+  g_signal_emit_by_name (h->internal_session, "get-source-by-ssrc", ssrc,
+      &source);
+  fail_unless (source != NULL);
+  g_object_get (source, "stats", &stats, NULL);
+  fail_unless (gst_structure_get_uint64 (stats, "packets-received",
+          &packets));
+  gst_structure_free (stats);
+  g_object_unref (source);
+
+  return packets;
+}
+
+/* Packets of validated senders are received without the session lock, make
+ * sure none of them are lost for the statistics while RTCP is generated */
+GST_START_TEST (test_recv_rtp_while_sending_rtcp)
+{
+  SessionHarness *h = session_harness_new ();
+  RecvRaceData data = { h, FALSE, 0, {0,} };
+  guint64 base_packets[RECV_RACE_N_SOURCES];
+  guint total = 0;
+  GThread *thread;
+  guint i, j;
+
+  /* pass probation so that the following packets take the fast path */
+  for (j = 0; j < 3; j++) {
+    for (i = 0; i < RECV_RACE_N_SOURCES; i++) {
+      fail_unless_equals_int (GST_FLOW_OK, session_harness_recv_rtp (h,
+              generate_test_buffer (data.seqnums[i]++, 0x1000 + i)));
+    }
+  }
+  for (i = 0; i < RECV_RACE_N_SOURCES; i++)
+    base_packets[i] = get_packets_received (h, 0x1000 + i);
+
+  thread = g_thread_new ("push-recv-rtp", (GThreadFunc) push_recv_rtp, &data);
+  while (g_atomic_int_get (&data.pushed) == 0)
+    g_usleep (G_USEC_PER_SEC / 1000);
+
+  /* report on all the sources while packets keep coming in */
+  session_harness_produce_rtcp (h, 3);
+
+  g_atomic_int_set (&data.stop, TRUE);
+  g_thread_join (thread);
+
+  for (i = 0; i < RECV_RACE_N_SOURCES; i++) {
+    fail_unless_equals_uint64 (data.seqnums[i] - 3,
+        get_packets_received (h, 0x1000 + i) - base_packets[i]);
+    total += data.seqnums[i];
+  }
+  fail_unless_equals_int (total, gst_harness_buffers_received (h->recv_rtp_h));
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 GST_START_TEST (test_dont_send_rtcp_while_idle)
 {
   SessionHarness *h = session_harness_new ();
@@ -2344,6 +2593,68 @@ GST_START_TEST (test_request_nack)
 
 GST_END_TEST;
 
+GST_START_TEST (test_request_nack_batch)
+{
+  SessionHarness *h = session_harness_new ();
+  GstBuffer *buf;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket rtcp_packet;
+  guint8 *fci_data;
+  guint32 fci_length;
+  /* 1234, 1235, 1237 and 1250 */
+  const guint8 bitmap[] = { 0x0b, 0x00, 0x01 };
+
+  g_object_set (h->internal_session, "internal-ssrc", 0xDEADBEEF, NULL);
+
+  /* Receive a RTP buffer from the wire */
+  fail_unless_equals_int (GST_FLOW_OK,
+      session_harness_recv_rtp (h, generate_test_buffer (0, 0x12345678)));
+
+  /* Wait for first regular RTCP to be sent so that we are clear to send early RTCP */
+  session_harness_produce_rtcp (h, 1);
+  gst_buffer_unref (session_harness_pull_rtcp (h));
+
+  /* request all NACKs of the batch at once */
+  session_harness_rtp_retransmission_request_batch (h, 0x12345678, 1234,
+      bitmap, sizeof (bitmap));
+
+  /* a single early RTCP carries all of them */
+  buf = session_harness_pull_rtcp (h);
+
+  fail_unless (gst_rtcp_buffer_validate (buf));
+  gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+  fail_unless_equals_int (3, gst_rtcp_buffer_get_packet_count (&rtcp));
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &rtcp_packet));
+
+  fail_unless_equals_int (GST_RTCP_TYPE_RR,
+      gst_rtcp_packet_get_type (&rtcp_packet));
+  fail_unless (gst_rtcp_packet_move_to_next (&rtcp_packet));
+  fail_unless_equals_int (GST_RTCP_TYPE_SDES,
+      gst_rtcp_packet_get_type (&rtcp_packet));
+  fail_unless (gst_rtcp_packet_move_to_next (&rtcp_packet));
+  fail_unless_equals_int (GST_RTCP_TYPE_RTPFB,
+      gst_rtcp_packet_get_type (&rtcp_packet));
+  fail_unless_equals_int (GST_RTCP_RTPFB_TYPE_NACK,
+      gst_rtcp_packet_fb_get_type (&rtcp_packet));
+  fail_unless_equals_int (0x12345678,
+      gst_rtcp_packet_fb_get_media_ssrc (&rtcp_packet));
+
+  /* 1234 with 1235, 1237 and 1250 in the bitmask */
+  fci_data = gst_rtcp_packet_fb_get_fci (&rtcp_packet);
+  fci_length =
+      gst_rtcp_packet_fb_get_fci_length (&rtcp_packet) * sizeof (guint32);
+  fail_unless_equals_int (4, fci_length);
+  fail_unless_equals_int (GST_READ_UINT32_BE (fci_data),
+      (1234L << 16) | 0x8005);
+
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   gulong id;
@@ -3201,6 +3512,54 @@ GST_START_TEST (test_twcc_header_and_run_length)
 
 GST_END_TEST;
 
+GST_START_TEST (test_twcc_two_byte_header_ext)
+{
+  SessionHarness *h = session_harness_new ();
+  GstBuffer *buf;
+  GstRTCPBuffer rtcp = GST_RTCP_BUFFER_INIT;
+  GstRTCPPacket packet;
+  guint8 *fci_data;
+  guint i;
+
+  session_harness_set_twcc_recv_ext_id (h, TEST_TWCC_EXT_ID);
+
+  /* the twcc seqnum is also found in the two-byte header form */
+  for (i = 0; i < 5; i++) {
+    GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+    GstClockTime ts = i * TEST_BUF_DURATION;
+    guint8 twcc_seqnum_be[2];
+
+    gst_test_clock_set_time (h->testclock, ts);
+    buf = generate_test_buffer_full (ts, i, i * TEST_RTP_TS_DURATION,
+        TEST_BUF_SSRC, i == 4, TEST_BUF_PT, 0, 0);
+    gst_rtp_buffer_map (buf, GST_MAP_READWRITE, &rtp);
+    GST_WRITE_UINT16_BE (twcc_seqnum_be, 100 + i);
+    fail_unless (gst_rtp_buffer_add_extension_twobytes_header (&rtp, 0,
+            TEST_TWCC_EXT_ID, twcc_seqnum_be, sizeof (twcc_seqnum_be)));
+    gst_rtp_buffer_unmap (&rtp);
+
+    fail_unless_equals_int (GST_FLOW_OK, session_harness_recv_rtp (h, buf));
+  }
+
+  buf = session_harness_produce_twcc (h);
+  fail_unless (buf);
+
+  gst_rtcp_buffer_map (buf, GST_MAP_READ, &rtcp);
+  fail_unless (gst_rtcp_buffer_get_first_packet (&rtcp, &packet));
+  fci_data = gst_rtcp_packet_fb_get_fci (&packet);
+
+  /* base seqnum and packet count */
+  fail_unless_equals_int (100, GST_READ_UINT16_BE (&fci_data[0]));
+  fail_unless_equals_int (5, GST_READ_UINT16_BE (&fci_data[2]));
+
+  gst_rtcp_buffer_unmap (&rtcp);
+  gst_buffer_unref (buf);
+
+  session_harness_free (h);
+}
+
+GST_END_TEST;
+
 typedef struct
 {
   guint16 seqnum;
@@ -5849,6 +6208,8 @@ rtpsession_suite (void)
 
   suite_add_tcase (s, tc_chain);
   tcase_add_test (tc_chain, test_multiple_ssrc_rr);
+  tcase_add_test (tc_chain, test_many_sources);
+  tcase_add_test (tc_chain, test_stats_snapshot);
   tcase_add_test (tc_chain, test_multiple_senders_roundrobin_rbs);
   tcase_add_test (tc_chain, test_no_rbs_for_internal_senders);
   tcase_add_test (tc_chain, test_internal_sources_timeout);
@@ -5869,11 +6230,13 @@ rtpsession_suite (void)
   tcase_add_test (tc_chain, test_request_pli);
   tcase_add_test (tc_chain, test_request_fir_after_pli_in_caps);
   tcase_add_test (tc_chain, test_request_nack);
+  tcase_add_test (tc_chain, test_request_nack_batch);
   tcase_add_test (tc_chain, test_request_nack_surplus);
   tcase_add_test (tc_chain, test_request_nack_packing);
   tcase_add_test (tc_chain, test_illegal_rtcp_fb_packet);
   tcase_add_test (tc_chain, test_illegal_rtcp_type_packet);
   tcase_add_test (tc_chain, test_feedback_rtcp_race);
+  tcase_add_test (tc_chain, test_recv_rtp_while_sending_rtcp);
   tcase_add_test (tc_chain, test_receive_regular_pli);
   tcase_add_test (tc_chain, test_receive_pli_no_sender_ssrc);
   tcase_add_test (tc_chain, test_dont_send_rtcp_while_idle);
@@ -5891,6 +6254,7 @@ rtpsession_suite (void)
   /* twcc */
   tcase_add_loop_test (tc_chain, test_twcc_header_and_run_length,
       0, G_N_ELEMENTS (twcc_header_and_run_length_test_data));
+  tcase_add_test (tc_chain, test_twcc_two_byte_header_ext);
   tcase_add_test (tc_chain, test_twcc_run_length_max);
   tcase_add_test (tc_chain, test_twcc_run_length_min);
   tcase_add_test (tc_chain, test_twcc_1_bit_status_vector);
@@ -0,0 +1,187 @@
+/* GStreamer
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include <gst/check/gstcheck.h>
+#include "gst/rtpmanager/rtpstats.h"
+
+static void
+set_header_ext (RTPPacketInfo * pinfo, guint16 bit_pattern,
+    const guint8 * data, gsize size)
+{
+  if (pinfo->header_ext)
+    g_bytes_unref (pinfo->header_ext);
+  pinfo->header_ext = g_bytes_new (data, size);
+  pinfo->header_ext_bit_pattern = bit_pattern;
+  rtp_packet_info_parse_header_ext (pinfo);
+}
+
+static void
+check_header_ext (RTPPacketInfo * pinfo, guint8 id, guint size,
+    const guint8 * expected)
+{
+  gpointer data;
+  guint ext_size;
+
+  fail_unless (rtp_packet_info_get_header_ext (pinfo, id, &data, &ext_size));
+  fail_unless_equals_int (size, ext_size);
+  fail_unless_equals_int (0, memcmp (expected, data, size));
+}
+
+GST_START_TEST (test_parse_header_ext_one_byte)
+{
+  RTPPacketInfo pinfo = { 0, };
+  const guint8 block[] = {
+    0x10, 0xaa,                 /* id 1, 1 byte */
+    0x00,                       /* padding */
+    0x21, 0xbb, 0xcc,           /* id 2, 2 bytes */
+    0x10, 0xdd,                 /* id 1 again, ignored */
+    0xf0,                       /* id 15, stops parsing */
+    0x30, 0xee,                 /* id 3, never reached */
+    0x00,
+  };
+  const guint8 ext1[] = { 0xaa };
+  const guint8 ext2[] = { 0xbb, 0xcc };
+
+  set_header_ext (&pinfo, 0xBEDE, block, sizeof (block));
+
+  fail_unless_equals_int (2, pinfo.n_header_exts);
+  check_header_ext (&pinfo, 1, sizeof (ext1), ext1);
+  check_header_ext (&pinfo, 2, sizeof (ext2), ext2);
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 3, NULL, NULL));
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 15, NULL, NULL));
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 0, NULL, NULL));
+
+  g_bytes_unref (pinfo.header_ext);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_header_ext_two_byte)
+{
+  RTPPacketInfo pinfo = { 0, };
+  const guint8 block[] = {
+    0x01, 0x01, 0xaa,           /* id 1, 1 byte */
+    0x00,                       /* padding */
+    0x16, 0x02, 0xbb, 0xcc,     /* id 22, 2 bytes */
+    0x01, 0x01, 0xdd,           /* id 1 again, ignored */
+    0x0f, 0x01, 0xee,           /* id 15 is a regular id here */
+    0x00, 0x00,
+  };
+  const guint8 ext1[] = { 0xaa };
+  const guint8 ext22[] = { 0xbb, 0xcc };
+  const guint8 ext15[] = { 0xee };
+
+  set_header_ext (&pinfo, 0x1000, block, sizeof (block));
+
+  fail_unless_equals_int (3, pinfo.n_header_exts);
+  check_header_ext (&pinfo, 1, sizeof (ext1), ext1);
+  check_header_ext (&pinfo, 22, sizeof (ext22), ext22);
+  check_header_ext (&pinfo, 15, sizeof (ext15), ext15);
+
+  g_bytes_unref (pinfo.header_ext);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_header_ext_truncated)
+{
+  RTPPacketInfo pinfo = { 0, };
+  const guint8 one_byte[] = {
+    0x10, 0xaa,                 /* id 1, 1 byte */
+    0x2f, 0x01, 0x02, 0x03,     /* id 2, 16 bytes, but only 5 left */
+    0x04, 0x05,
+  };
+  const guint8 two_byte[] = {
+    0x05, 0x10, 0x01, 0x02,     /* id 5, 16 bytes, but only 2 left */
+  };
+  const guint8 ext1[] = { 0xaa };
+
+  set_header_ext (&pinfo, 0xBEDE, one_byte, sizeof (one_byte));
+  fail_unless_equals_int (1, pinfo.n_header_exts);
+  check_header_ext (&pinfo, 1, sizeof (ext1), ext1);
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 2, NULL, NULL));
+
+  /* the elements of the previous packet are forgotten */
+  set_header_ext (&pinfo, 0x1000, two_byte, sizeof (two_byte));
+  fail_unless_equals_int (0, pinfo.n_header_exts);
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 1, NULL, NULL));
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 5, NULL, NULL));
+
+  g_bytes_unref (pinfo.header_ext);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_header_ext_unknown_pattern)
+{
+  RTPPacketInfo pinfo = { 0, };
+  const guint8 block[] = { 0x10, 0xaa, 0x00, 0x00 };
+
+  set_header_ext (&pinfo, 0x1234, block, sizeof (block));
+  fail_unless_equals_int (0, pinfo.n_header_exts);
+  fail_if (rtp_packet_info_get_header_ext (&pinfo, 1, NULL, NULL));
+
+  g_bytes_unref (pinfo.header_ext);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_parse_header_ext_max_elements)
+{
+  RTPPacketInfo pinfo = { 0, };
+  guint8 block[3 * (RTP_PACKET_INFO_MAX_HEADER_EXTS + 4)];
+  guint i;
+
+  for (i = 0; i < RTP_PACKET_INFO_MAX_HEADER_EXTS + 4; i++) {
+    block[i * 3] = i + 1;
+    block[i * 3 + 1] = 1;
+    block[i * 3 + 2] = i;
+  }
+
+  set_header_ext (&pinfo, 0x1000, block, sizeof (block));
+  fail_unless_equals_int (RTP_PACKET_INFO_MAX_HEADER_EXTS,
+      pinfo.n_header_exts);
+  fail_unless (rtp_packet_info_get_header_ext (&pinfo,
+          RTP_PACKET_INFO_MAX_HEADER_EXTS, NULL, NULL));
+  fail_if (rtp_packet_info_get_header_ext (&pinfo,
+          RTP_PACKET_INFO_MAX_HEADER_EXTS + 1, NULL, NULL));
+
+  g_bytes_unref (pinfo.header_ext);
+}
+
+GST_END_TEST;
+
+static Suite *
+rtpstats_suite (void)
+{
+  Suite *s = suite_create ("rtpstats");
+  TCase *tc_chain = tcase_create ("general");
+
+  suite_add_tcase (s, tc_chain);
+  tcase_add_test (tc_chain, test_parse_header_ext_one_byte);
+  tcase_add_test (tc_chain, test_parse_header_ext_two_byte);
+  tcase_add_test (tc_chain, test_parse_header_ext_truncated);
+  tcase_add_test (tc_chain, test_parse_header_ext_unknown_pattern);
+  tcase_add_test (tc_chain, test_parse_header_ext_max_elements);
+
+  return s;
+}
+
+GST_CHECK_MAIN (rtpstats);
@@ -261,6 +261,44 @@ GST_START_TEST (test_rtpstorage_put_recovered_packet)
 GST_END_TEST;
 
 
+GST_START_TEST (rtpstorage_burst)
+{
+  GstBuffer *bufs[200];
+  GstBufferList *bufs_out;
+  guint i;
+  GstHarness *h = gst_harness_new ("rtpstorage");
+  g_object_set (h->element, "size-time", (guint64) 10 * RTP_PACKET_DUR, NULL);
+  gst_harness_set_src_caps_str (h, "application/x-rtp");
+
+  /* Many more packets arrive at once than the storage was sized for, all of
+   * them are kept */
+  for (i = 0; i < G_N_ELEMENTS (bufs); ++i) {
+    bufs[i] = create_rtp_packet (96, 0xabe2b0b, RTP_TSTAMP (0), i);
+    GST_BUFFER_DTS (bufs[i]) = GST_TSTAMP (0);
+    gst_buffer_unref (gst_harness_push_and_pull (h, gst_buffer_ref (bufs[i])));
+  }
+
+  for (i = 0; i < G_N_ELEMENTS (bufs); ++i) {
+    bufs_out = get_packets_for_recovery (h, 100, 0xabe2b0b, i);
+    fail_unless (NULL != bufs_out);
+    fail_unless_equals_int (1, gst_buffer_list_length (bufs_out));
+    fail_unless (gst_buffer_list_get (bufs_out, 0) == bufs[i]);
+    gst_buffer_list_unref (bufs_out);
+  }
+
+  /* Only once they are old they go */
+  gst_buffer_unref (gst_harness_push_and_pull (h, create_rtp_packet (96,
+              0xabe2b0b, RTP_TSTAMP (1), G_N_ELEMENTS (bufs))));
+  for (i = 0; i < G_N_ELEMENTS (bufs); ++i) {
+    fail_unless (gst_buffer_is_writable (bufs[i]));
+    gst_buffer_unref (bufs[i]);
+  }
+
+  gst_harness_teardown (h);
+}
+
+GST_END_TEST;
+
 static void
 _single_ssrc_test (GstHarness * h, guint32 ssrc,
     guint16 seq_start, guint16 nth_to_loose,
@@ -542,6 +580,7 @@ rtpstorage_suite (void)
   tcase_add_test (tc_chain, rtpstorage_loss_pattern8);
   tcase_add_test (tc_chain, rtpstorage_loss_pattern9);
   tcase_add_test (tc_chain, test_rtpstorage_put_recovered_packet);
+  tcase_add_test (tc_chain, rtpstorage_burst);
   tcase_add_test (tc_chain, rtpstorage_stress);
 
   return s;
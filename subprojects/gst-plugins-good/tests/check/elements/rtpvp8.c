@@ -806,6 +806,56 @@ GST_START_TEST (test_depay_no_gap_event_when_partial_frames_with_no_picid_gap)
 
 GST_END_TEST;
 
+static GstBuffer *
+depay_two_packet_frame (gboolean non_contiguous)
+{
+  GstHarness *h = gst_harness_new ("rtpvp8depay");
+  GstBuffer *buffer;
+
+  g_object_set (h->element, "non-contiguous-frames", non_contiguous, NULL);
+  gst_harness_set_src_caps_str (h, RTP_VP8_CAPS_STR);
+
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, create_rtp_vp8_buffer_full (100, 24,
+              7, 0, TRUE, FALSE)));
+  fail_unless_equals_int (GST_FLOW_OK,
+      gst_harness_push (h, create_rtp_vp8_buffer_full (101, 24,
+              7, 0, FALSE, TRUE)));
+  fail_unless_equals_int (1, gst_harness_buffers_received (h));
+  buffer = gst_harness_pull (h);
+
+  gst_harness_teardown (h);
+
+  return buffer;
+}
+
+GST_START_TEST (test_depay_non_contiguous_frames)
+{
+  GstBuffer *contiguous, *non_contiguous;
+  GstMapInfo map;
+
+  contiguous = depay_two_packet_frame (FALSE);
+  non_contiguous = depay_two_packet_frame (TRUE);
+
+  /* one memory per packet instead of a copy of the whole frame */
+  fail_unless_equals_int (gst_buffer_n_memory (contiguous), 1);
+  fail_unless_equals_int (gst_buffer_n_memory (non_contiguous), 2);
+
+  fail_unless (gst_buffer_map (contiguous, &map, GST_MAP_READ));
+  fail_unless_equals_int (gst_buffer_get_size (non_contiguous), map.size);
+  fail_unless_equals_int (gst_buffer_memcmp (non_contiguous, 0, map.data,
+          map.size), 0);
+  gst_buffer_unmap (contiguous, &map);
+
+  fail_unless (!GST_BUFFER_FLAG_IS_SET (non_contiguous,
+          GST_BUFFER_FLAG_DELTA_UNIT));
+
+  gst_buffer_unref (contiguous);
+  gst_buffer_unref (non_contiguous);
+}
+
+GST_END_TEST;
+
 /* Packet loss + lost picture ids */
 static const DepayGapEventTestData resend_gap_event_test_data[][2] = {
   /* 7bit picture ids */
@@ -861,6 +911,7 @@ rtpvp8_suite (void)
       test_depay_send_gap_event_when_marker_bit_missing_and_no_picid_gap);
   tcase_add_test (tc_chain,
       test_depay_no_gap_event_when_partial_frames_with_no_picid_gap);
+  tcase_add_test (tc_chain, test_depay_non_contiguous_frames);
 
   return s;
 }
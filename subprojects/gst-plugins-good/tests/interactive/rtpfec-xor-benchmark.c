@@ -0,0 +1,238 @@
+/* GStreamer FEC XOR kernel benchmark
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Compares the throughput of the XOR kernels used by the ULPFEC, FlexFEC
+ * and ST 2022-1 elements. The Orc programs are the same as in
+ * gstrtpfecorc.orc, compiled for every Orc target and instruction set
+ * level that is executable on this machine, next to the plain C loops the
+ * elements used before. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gst/gst.h>
+#include <orc/orc.h>
+
+#define PACKET_SIZE 1400
+#define N_PACKETS 10
+#define N_ROUNDS 100000
+
+typedef struct
+{
+  const gchar *name;
+  const gchar *target;
+  guint clear_flags;
+} IsaLevel;
+
+static const IsaLevel levels[] = {
+  {"sse2", "sse", ORC_TARGET_SSE_SSE3 | ORC_TARGET_SSE_SSSE3 |
+        ORC_TARGET_SSE_SSE4_1 | ORC_TARGET_SSE_SSE4_2},
+  {"ssse3", "sse", ORC_TARGET_SSE_SSE4_1 | ORC_TARGET_SSE_SSE4_2},
+  {"sse4.2", "sse", 0},
+  {"avx", "avx", 0},
+  {"neon", "neon", 0},
+};
+
+static guint8 *packets[N_PACKETS];
+static guint8 *dst;
+
+static void
+xor_u64 (guint8 * restrict d, const guint8 * restrict s, gsize length)
+{
+  guint i;
+
+  for (i = 0; i < (length / sizeof (guint64)); ++i) {
+    GST_WRITE_UINT64_LE (d, GST_READ_UINT64_LE (d) ^ GST_READ_UINT64_LE (s));
+    d += sizeof (guint64);
+    s += sizeof (guint64);
+  }
+  for (i = 0; i < (length % sizeof (guint64)); ++i)
+    d[i] ^= s[i];
+}
+
+static void
+xor_u8 (guint8 * restrict d, const guint8 * restrict s, gsize length)
+{
+  gsize i;
+
+  for (i = 0; i < length; ++i)
+    d[i] ^= s[i];
+}
+
+static void
+report (const gchar * name, gint64 elapsed)
+{
+  gdouble bytes = (gdouble) N_ROUNDS * N_PACKETS * PACKET_SIZE;
+
+  g_print ("%-24s %10.3f s %10.1f MB/s\n", name,
+      elapsed / (gdouble) G_USEC_PER_SEC, bytes / elapsed);
+}
+
+static void
+bench_c (const gchar * name, void (*func) (guint8 *, const guint8 *, gsize))
+{
+  gint64 start;
+  guint i, j;
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ROUNDS; i++) {
+    for (j = 0; j < N_PACKETS; j++)
+      func (dst, packets[j], PACKET_SIZE);
+  }
+  report (name, g_get_monotonic_time () - start);
+}
+
+static OrcProgram *
+make_program (gboolean fold)
+{
+  OrcProgram *p = orc_program_new ();
+
+  orc_program_add_destination (p, 1, "d1");
+  orc_program_add_source (p, 1, "s1");
+  if (fold) {
+    orc_program_set_name (p, "xor4_u8");
+    orc_program_add_source (p, 1, "s2");
+    orc_program_add_source (p, 1, "s3");
+    orc_program_add_source (p, 1, "s4");
+    orc_program_add_temporary (p, 1, "t1");
+    orc_program_append_str (p, "xorb", "t1", "s1", "s2");
+    orc_program_append_str (p, "xorb", "t1", "t1", "s3");
+    orc_program_append_str (p, "xorb", "t1", "t1", "s4");
+    orc_program_append_str (p, "xorb", "d1", "d1", "t1");
+  } else {
+    orc_program_set_name (p, "xor_u8");
+    orc_program_append_str (p, "xorb", "d1", "d1", "s1");
+  }
+
+  return p;
+}
+
+static OrcExecutor *
+compile_program (const IsaLevel * level, OrcTarget * target, gboolean fold)
+{
+  OrcProgram *p = make_program (fold);
+  OrcCompileResult result;
+  OrcExecutor *ex;
+
+  result = orc_program_compile_full (p, target,
+      orc_target_get_default_flags (target) & ~level->clear_flags);
+  if (!ORC_COMPILE_RESULT_IS_SUCCESSFUL (result)) {
+    orc_program_free (p);
+    return NULL;
+  }
+
+  ex = orc_executor_new (p);
+  orc_executor_set_array_str (ex, "d1", dst);
+  return ex;
+}
+
+static void
+free_executor (OrcExecutor * ex)
+{
+  OrcProgram *p = ex->program;
+
+  orc_executor_free (ex);
+  orc_program_free (p);
+}
+
+static void
+bench_orc (const IsaLevel * level, gboolean fold)
+{
+  OrcTarget *target = orc_target_get_by_name (level->target);
+  OrcExecutor *ex1 = NULL, *ex4 = NULL;
+  gchar *name;
+  gint64 start;
+  guint i, j;
+
+  name = g_strdup_printf ("orc %s%s", level->name, fold ? " (4-way)" : "");
+
+  if (target == NULL || !target->executable) {
+    g_print ("%-24s not available\n", name);
+    goto done;
+  }
+
+  ex1 = compile_program (level, target, FALSE);
+  if (fold)
+    ex4 = compile_program (level, target, TRUE);
+  if (ex1 == NULL || (fold && ex4 == NULL)) {
+    g_print ("%-24s failed to compile\n", name);
+    goto done;
+  }
+
+  start = g_get_monotonic_time ();
+  for (i = 0; i < N_ROUNDS; i++) {
+    j = 0;
+    /* Same folding as _xor_mem_multi(): four packets per pass over the
+     * destination, then the remaining ones one by one */
+    for (; fold && j + 4 <= N_PACKETS; j += 4) {
+      orc_executor_set_n (ex4, PACKET_SIZE);
+      orc_executor_set_array_str (ex4, "s1", packets[j]);
+      orc_executor_set_array_str (ex4, "s2", packets[j + 1]);
+      orc_executor_set_array_str (ex4, "s3", packets[j + 2]);
+      orc_executor_set_array_str (ex4, "s4", packets[j + 3]);
+      orc_executor_run (ex4);
+    }
+    for (; j < N_PACKETS; j++) {
+      orc_executor_set_n (ex1, PACKET_SIZE);
+      orc_executor_set_array_str (ex1, "s1", packets[j]);
+      orc_executor_run (ex1);
+    }
+  }
+  report (name, g_get_monotonic_time () - start);
+
+done:
+  if (ex1)
+    free_executor (ex1);
+  if (ex4)
+    free_executor (ex4);
+  g_free (name);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint i, j;
+
+  orc_init ();
+
+  for (i = 0; i < N_PACKETS; i++) {
+    packets[i] = g_malloc (PACKET_SIZE);
+    for (j = 0; j < PACKET_SIZE; j++)
+      packets[i][j] = g_random_int_range (0, 256);
+  }
+  dst = g_malloc0 (PACKET_SIZE);
+
+  g_print ("XOR-ing %u packets of %u bytes, %u rounds\n", N_PACKETS,
+      PACKET_SIZE, N_ROUNDS);
+
+  bench_c ("c u8", xor_u8);
+  bench_c ("c u64", xor_u64);
+  for (i = 0; i < G_N_ELEMENTS (levels); i++) {
+    bench_orc (&levels[i], FALSE);
+    bench_orc (&levels[i], TRUE);
+  }
+
+  for (i = 0; i < N_PACKETS; i++)
+    g_free (packets[i]);
+  g_free (dst);
+
+  return 0;
+}
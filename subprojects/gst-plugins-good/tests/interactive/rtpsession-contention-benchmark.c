@@ -0,0 +1,171 @@
+/* GStreamer RTP session receive path contention benchmark
+ *
+ * Copyright (C) 2022 Pexip
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Pushes RTP packets of many remote sources into an rtpsession while its
+ * RTCP thread reports on all of them every 20 ms, and prints how long the
+ * pushes took. Time spent waiting for RTCP generation shows up in the tail
+ * of the distribution. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+#include <gst/gst.h>
+#include <gst/rtp/rtp.h>
+
+#define N_SOURCES 500
+#define N_ROUNDS 1000
+#define PAYLOAD_SIZE 100
+#define RTCP_INTERVAL (20 * GST_MSECOND)
+
+static gint rtcp_packets;
+
+static GstPadProbeReturn
+count_rtcp (GstPad * pad, GstPadProbeInfo * info, gpointer user_data)
+{
+  g_atomic_int_inc (&rtcp_packets);
+  return GST_PAD_PROBE_OK;
+}
+
+static GstBuffer *
+make_packet (GstElement * pipeline, guint32 ssrc, guint16 seqnum,
+    guint32 rtptime)
+{
+  GstRTPBuffer rtp = GST_RTP_BUFFER_INIT;
+  GstBuffer *buf;
+  GstClock *clock;
+
+  buf = gst_rtp_buffer_new_allocate (PAYLOAD_SIZE, 0, 0);
+  gst_rtp_buffer_map (buf, GST_MAP_WRITE, &rtp);
+  gst_rtp_buffer_set_payload_type (&rtp, 96);
+  gst_rtp_buffer_set_ssrc (&rtp, ssrc);
+  gst_rtp_buffer_set_seq (&rtp, seqnum);
+  gst_rtp_buffer_set_timestamp (&rtp, rtptime);
+  gst_rtp_buffer_unmap (&rtp);
+
+  clock = gst_element_get_clock (pipeline);
+  GST_BUFFER_DTS (buf) = gst_clock_get_time (clock) -
+      gst_element_get_base_time (pipeline);
+  gst_object_unref (clock);
+
+  return buf;
+}
+
+static int
+compare_times (gconstpointer a, gconstpointer b)
+{
+  GstClockTime ta = *(const GstClockTime *) a;
+  GstClockTime tb = *(const GstClockTime *) b;
+
+  return ta < tb ? -1 : ta > tb;
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstElement *pipeline, *session, *rtp_sink, *rtcp_sink;
+  GstPad *src, *pad;
+  GstSegment segment;
+  GstCaps *caps;
+  GstClockTime *times, total = 0, start, elapsed;
+  guint n = N_SOURCES * N_ROUNDS;
+  guint i, j;
+
+  gst_init (&argc, &argv);
+
+  pipeline = gst_pipeline_new (NULL);
+  session = gst_element_factory_make ("rtpsession", NULL);
+  rtp_sink = gst_element_factory_make ("fakesink", NULL);
+  rtcp_sink = gst_element_factory_make ("fakesink", NULL);
+  if (!session || !rtp_sink || !rtcp_sink) {
+    g_printerr ("rtpsession or fakesink element missing\n");
+    return 1;
+  }
+
+  /* make sure the minimum interval is what paces RTCP, not the bandwidth
+   * share of 500 members */
+  g_object_set (session, "bandwidth", 1e9, "rtcp-fraction", 0.5,
+      "rtcp-min-interval", (guint64) RTCP_INTERVAL, NULL);
+  g_object_set (rtp_sink, "sync", FALSE, "async", FALSE, NULL);
+  g_object_set (rtcp_sink, "sync", FALSE, "async", FALSE, NULL);
+  gst_bin_add_many (GST_BIN (pipeline), session, rtp_sink, rtcp_sink, NULL);
+
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  pad = gst_element_request_pad_simple (session, "recv_rtp_sink");
+  gst_pad_link (src, pad);
+  gst_object_unref (pad);
+  gst_element_link_pads (session, "recv_rtp_src", rtp_sink, "sink");
+
+  pad = gst_element_request_pad_simple (session, "send_rtcp_src");
+  gst_object_unref (pad);
+  gst_element_link_pads (session, "send_rtcp_src", rtcp_sink, "sink");
+  pad = gst_element_get_static_pad (rtcp_sink, "sink");
+  gst_pad_add_probe (pad, GST_PAD_PROBE_TYPE_BUFFER, count_rtcp, NULL, NULL);
+  gst_object_unref (pad);
+
+  gst_element_set_state (pipeline, GST_STATE_PLAYING);
+  gst_element_get_state (pipeline, NULL, NULL, GST_CLOCK_TIME_NONE);
+
+  gst_pad_set_active (src, TRUE);
+  gst_pad_push_event (src, gst_event_new_stream_start ("contention"));
+  caps = gst_caps_new_simple ("application/x-rtp",
+      "media", G_TYPE_STRING, "video",
+      "clock-rate", G_TYPE_INT, 90000,
+      "encoding-name", G_TYPE_STRING, "H264",
+      "payload", G_TYPE_INT, 96, NULL);
+  gst_pad_push_event (src, gst_event_new_caps (caps));
+  gst_caps_unref (caps);
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (src, gst_event_new_segment (&segment));
+
+  g_print ("%u sources, %u packets, RTCP every %" GST_TIME_FORMAT "\n",
+      N_SOURCES, n, GST_TIME_ARGS (RTCP_INTERVAL));
+
+  times = g_new (GstClockTime, n);
+  for (i = 0; i < N_ROUNDS; i++) {
+    for (j = 0; j < N_SOURCES; j++) {
+      GstBuffer *buf = make_packet (pipeline, 0x10000 + j, i, i * 3000);
+
+      start = gst_util_get_timestamp ();
+      gst_pad_push (src, buf);
+      elapsed = gst_util_get_timestamp () - start;
+
+      times[i * N_SOURCES + j] = elapsed;
+      total += elapsed;
+    }
+  }
+
+  gst_element_set_state (pipeline, GST_STATE_NULL);
+
+  qsort (times, n, sizeof (GstClockTime), compare_times);
+  g_print ("RTCP packets sent: %d\n", g_atomic_int_get (&rtcp_packets));
+  g_print ("push time avg %" G_GUINT64_FORMAT " ns, p50 %" G_GUINT64_FORMAT
+      " ns, p99 %" G_GUINT64_FORMAT " ns, p99.9 %" G_GUINT64_FORMAT
+      " ns, max %" G_GUINT64_FORMAT " ns\n", total / n, times[n / 2],
+      times[n / 100 * 99], times[n / 1000 * 999], times[n - 1]);
+
+  g_free (times);
+  gst_object_unref (src);
+  gst_object_unref (pipeline);
+
+  return 0;
+}
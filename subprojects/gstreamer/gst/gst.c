@@ -185,7 +185,8 @@ enum
   ARG_PLUGIN_LOAD,
   ARG_SEGTRAP_DISABLE,
   ARG_REGISTRY_UPDATE_DISABLE,
-  ARG_REGISTRY_FORK_DISABLE
+  ARG_REGISTRY_FORK_DISABLE,
+  ARG_SLAB_ALLOCATOR_ENABLE
 };
 
 /* debug-spec ::= category-spec [, category-spec]*
@@ -297,6 +298,11 @@ gst_init_get_option_group (void)
           (gpointer) parse_goption_arg,
           N_("Disable spawning a helper process while scanning the registry"),
         NULL},
+    {"gst-enable-slab-allocator", 0, G_OPTION_FLAG_NO_ARG,
+          G_OPTION_ARG_CALLBACK,
+          (gpointer) parse_goption_arg,
+          N_("Allocate small buffers and metadata from a slab allocator"),
+        NULL},
     {NULL}
   };
 
@@ -664,6 +670,7 @@ init_post (GOptionContext * context, GOptionGroup * group, gpointer data,
     return TRUE;
   }
 
+  _priv_gst_slab_initialize ();
   _priv_gst_mini_object_initialize ();
   _priv_gst_quarks_initialize ();
   _priv_gst_allocator_initialize ();
@@ -1015,6 +1022,9 @@ parse_one_option (gint opt, const gchar * arg, GError ** err)
     case ARG_REGISTRY_FORK_DISABLE:
       gst_registry_fork_set_enabled (FALSE);
       break;
+    case ARG_SLAB_ALLOCATOR_ENABLE:
+      _priv_gst_slab_set_enabled (TRUE);
+      break;
     default:
       g_set_error (err, G_OPTION_ERROR, G_OPTION_ERROR_UNKNOWN_OPTION,
           _("Unknown option"));
@@ -1053,6 +1063,7 @@ parse_goption_arg (const gchar * opt,
     "--gst-disable-segtrap", ARG_SEGTRAP_DISABLE}, {
     "--gst-disable-registry-update", ARG_REGISTRY_UPDATE_DISABLE}, {
     "--gst-disable-registry-fork", ARG_REGISTRY_FORK_DISABLE}, {
+    "--gst-enable-slab-allocator", ARG_SLAB_ALLOCATOR_ENABLE}, {
     NULL}
   };
   gint val = 0, n;
@@ -1242,6 +1253,8 @@ gst_deinit (void)
   g_type_class_unref (g_type_class_peek (gst_stack_trace_flags_get_type ()));
   g_type_class_unref (g_type_class_peek (gst_promise_result_get_type ()));
 
+  _priv_gst_slab_cleanup ();
+
   gst_deinitialized = TRUE;
   GST_INFO ("deinitialized GStreamer");
   g_rec_mutex_unlock (&init_lock);
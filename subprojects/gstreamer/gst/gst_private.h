@@ -136,6 +136,7 @@ G_GNUC_INTERNAL  void  _priv_gst_context_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_toc_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_date_time_initialize (void);
 G_GNUC_INTERNAL  void  _priv_gst_plugin_feature_rank_initialize (void);
+G_GNUC_INTERNAL  void  _priv_gst_slab_initialize (void);
 
 /* cleanup functions called from gst_deinit(). */
 G_GNUC_INTERNAL  void  _priv_gst_allocator_cleanup (void);
@@ -143,6 +144,20 @@ G_GNUC_INTERNAL  void  _priv_gst_caps_features_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_caps_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_debug_cleanup (void);
 G_GNUC_INTERNAL  void  _priv_gst_meta_cleanup (void);
+G_GNUC_INTERNAL  void  _priv_gst_slab_cleanup (void);
+
+/* compact index of meta APIs for quick lookups on buffers */
+#define PRIV_GST_META_API_INDEX_MAX       64
+#define PRIV_GST_META_API_TAG_MEMORY           (1 << 0)
+#define PRIV_GST_META_API_TAG_MEMORY_REFERENCE (1 << 1)
+
+G_GNUC_INTERNAL  gint  _priv_gst_meta_api_type_get_index (GType api, guint * tags);
+
+/* slab allocator for small objects, see gstslab.c */
+G_GNUC_INTERNAL  void      _priv_gst_slab_set_enabled (gboolean enabled);
+G_GNUC_INTERNAL  gpointer  _priv_gst_slab_alloc (gsize size);
+G_GNUC_INTERNAL  gpointer  _priv_gst_slab_alloc0 (gsize size);
+G_GNUC_INTERNAL  void      _priv_gst_slab_free (gsize size, gpointer mem);
 
 /* called from gst_task_cleanup_all(). */
 G_GNUC_INTERNAL  void  _priv_gst_element_cleanup (void);
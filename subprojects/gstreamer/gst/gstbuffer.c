@@ -152,6 +152,10 @@ GType _gst_buffer_type = 0;
 #define GST_BUFFER_BUFMEM(b)       (((GstBufferImpl *)(b))->bufmem)
 #define GST_BUFFER_META(b)         (((GstBufferImpl *)(b))->item)
 #define GST_BUFFER_TAIL_META(b)    (((GstBufferImpl *)(b))->tail_item)
+#define GST_BUFFER_META_MASK(b)    (((GstBufferImpl *)(b))->meta_mask)
+#define GST_BUFFER_META_CACHE(b)   (((GstBufferImpl *)(b))->meta_cache)
+
+#define GST_BUFFER_META_CACHE_SIZE 4
 
 typedef struct
 {
@@ -170,6 +174,11 @@ typedef struct
    * GstBufferImpl */
   GstMetaItem *item;
   GstMetaItem *tail_item;
+
+  /* the indexes of the meta APIs on the buffer and the first meta of some of
+   * them, see _priv_gst_meta_api_type_get_index() */
+  guint64 meta_mask;
+  GstMetaItem *meta_cache[GST_BUFFER_META_CACHE_SIZE];
 } GstBufferImpl;
 
 static gint64 meta_seq;         /* 0 *//* ATOMIC */
@@ -522,6 +531,44 @@ gst_buffer_get_max_memory (void)
   return GST_BUFFER_MEM_MAX;
 }
 
+static inline guint64
+_meta_index_bit (gint index)
+{
+  return G_GUINT64_CONSTANT (1) << index;
+}
+
+static void
+_meta_index_add (GstBuffer * buffer, GstMetaItem * item)
+{
+  gint index;
+  guint64 bit;
+
+  index = _priv_gst_meta_api_type_get_index (item->meta.info->api, NULL);
+  if (index < 0)
+    return;
+
+  bit = _meta_index_bit (index);
+  /* remember the first meta of an API, it's what gst_buffer_get_meta()
+   * returns */
+  if (!(GST_BUFFER_META_MASK (buffer) & bit)) {
+    GST_BUFFER_META_MASK (buffer) |= bit;
+    GST_BUFFER_META_CACHE (buffer)[index % GST_BUFFER_META_CACHE_SIZE] = item;
+  }
+}
+
+static void
+_meta_index_rebuild (GstBuffer * buffer)
+{
+  GstMetaItem *walk;
+
+  GST_BUFFER_META_MASK (buffer) = 0;
+  memset (GST_BUFFER_META_CACHE (buffer), 0,
+      sizeof (GST_BUFFER_META_CACHE (buffer)));
+
+  for (walk = GST_BUFFER_META (buffer); walk; walk = walk->next)
+    _meta_index_add (buffer, walk);
+}
+
 /**
  * gst_buffer_copy_into:
  * @dest: a destination #GstBuffer
@@ -677,19 +724,31 @@ gst_buffer_copy_into (GstBuffer * dest, GstBuffer * src,
     for (walk = GST_BUFFER_META (src); walk; walk = walk->next) {
       GstMeta *meta = &walk->meta;
       const GstMetaInfo *info = meta->info;
+      gboolean is_memory, is_memory_reference;
+      guint tags;
+
+      /* indexed APIs have their tags at hand, avoid the type lookups */
+      if (_priv_gst_meta_api_type_get_index (info->api, &tags) >= 0) {
+        is_memory = (tags & PRIV_GST_META_API_TAG_MEMORY) != 0;
+        is_memory_reference =
+            (tags & PRIV_GST_META_API_TAG_MEMORY_REFERENCE) != 0;
+      } else {
+        is_memory = gst_meta_api_type_has_tag (info->api,
+            _gst_meta_tag_memory);
+        is_memory_reference = gst_meta_api_type_has_tag (info->api,
+            _gst_meta_tag_memory_reference);
+      }
 
       /* Don't copy memory metas if we only copied part of the buffer, didn't
        * copy memories or merged memories. In all these cases the memory
        * structure has changed and the memory meta becomes meaningless.
        */
       if ((region || !(flags & GST_BUFFER_COPY_MEMORY)
-              || (flags & GST_BUFFER_COPY_MERGE))
-          && gst_meta_api_type_has_tag (info->api, _gst_meta_tag_memory)) {
+              || (flags & GST_BUFFER_COPY_MERGE)) && is_memory) {
         GST_CAT_DEBUG (GST_CAT_BUFFER,
             "don't copy memory meta %p of API type %s", meta,
             g_type_name (info->api));
-      } else if (deep && gst_meta_api_type_has_tag (info->api,
-              _gst_meta_tag_memory_reference)) {
+      } else if (deep && is_memory_reference) {
         GST_CAT_DEBUG (GST_CAT_BUFFER,
             "don't copy meta with memory references %" GST_PTR_FORMAT, meta);
       } else if (info->transform_func) {
@@ -799,7 +858,7 @@ _gst_buffer_free (GstBuffer * buffer)
 
     next = walk->next;
     /* and free the slice */
-    g_slice_free1 (ITEM_SIZE (info), walk);
+    _priv_gst_slab_free (ITEM_SIZE (info), walk);
   }
 
   /* get the size, when unreffing the memory, we could also unref the buffer
@@ -820,7 +879,7 @@ _gst_buffer_free (GstBuffer * buffer)
 #ifdef USE_POISONING
     memset (buffer, 0xff, msize);
 #endif
-    g_slice_free1 (msize, buffer);
+    _priv_gst_slab_free (msize, buffer);
   } else {
     gst_memory_unref (GST_BUFFER_BUFMEM (buffer));
   }
@@ -845,6 +904,9 @@ gst_buffer_init (GstBufferImpl * buffer, gsize size)
 
   GST_BUFFER_MEM_LEN (buffer) = 0;
   GST_BUFFER_META (buffer) = NULL;
+  GST_BUFFER_META_MASK (buffer) = 0;
+  memset (GST_BUFFER_META_CACHE (buffer), 0,
+      sizeof (GST_BUFFER_META_CACHE (buffer)));
 }
 
 /**
@@ -859,7 +921,7 @@ gst_buffer_new (void)
 {
   GstBufferImpl *newbuf;
 
-  newbuf = g_slice_new (GstBufferImpl);
+  newbuf = _priv_gst_slab_alloc (sizeof (GstBufferImpl));
   GST_CAT_LOG (GST_CAT_BUFFER, "new %p", newbuf);
 
   gst_buffer_init (newbuf, sizeof (GstBufferImpl));
@@ -2245,10 +2307,21 @@ gst_buffer_get_meta (GstBuffer * buffer, GType api)
 {
   GstMetaItem *item;
   GstMeta *result = NULL;
+  gint index;
 
   g_return_val_if_fail (buffer != NULL, NULL);
   g_return_val_if_fail (api != 0, NULL);
 
+  index = _priv_gst_meta_api_type_get_index (api, NULL);
+  if (index >= 0) {
+    if (!(GST_BUFFER_META_MASK (buffer) & _meta_index_bit (index)))
+      return NULL;
+
+    item = GST_BUFFER_META_CACHE (buffer)[index % GST_BUFFER_META_CACHE_SIZE];
+    if (item && item->meta.info->api == api)
+      return &item->meta;
+  }
+
   /* find GstMeta of the requested API */
   for (item = GST_BUFFER_META (buffer); item; item = item->next) {
     GstMeta *meta = &item->meta;
@@ -2311,9 +2384,9 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
    * uninitialized memory
    */
   if (!info->init_func)
-    item = g_slice_alloc0 (size);
+    item = _priv_gst_slab_alloc0 (size);
   else
-    item = g_slice_alloc (size);
+    item = _priv_gst_slab_alloc (size);
   result = &item->meta;
   result->info = info;
   result->flags = GST_META_FLAG_NONE;
@@ -2336,12 +2409,13 @@ gst_buffer_add_meta (GstBuffer * buffer, const GstMetaInfo * info,
     GST_BUFFER_TAIL_META (buffer)->next = item;
     GST_BUFFER_TAIL_META (buffer) = item;
   }
+  _meta_index_add (buffer, item);
 
   return result;
 
 init_failed:
   {
-    g_slice_free1 (size, item);
+    _priv_gst_slab_free (size, item);
     return NULL;
   }
 }
@@ -2386,13 +2460,14 @@ gst_buffer_remove_meta (GstBuffer * buffer, GstMeta * meta)
         GST_BUFFER_META (buffer) = walk->next;
       else
         prev->next = walk->next;
+      _meta_index_rebuild (buffer);
 
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _priv_gst_slab_free (ITEM_SIZE (info), walk);
       break;
     }
     prev = walk;
@@ -2462,12 +2537,20 @@ gst_buffer_iterate_meta_filtered (GstBuffer * buffer, gpointer * state,
   g_return_val_if_fail (state != NULL, NULL);
 
   meta = (GstMetaItem **) state;
-  if (*meta == NULL)
+  if (*meta == NULL) {
+    gint index = _priv_gst_meta_api_type_get_index (meta_api_type, NULL);
+
+    /* nothing to iterate when the API is not on the buffer */
+    if (index >= 0
+        && !(GST_BUFFER_META_MASK (buffer) & _meta_index_bit (index)))
+      return NULL;
+
     /* state NULL, move to first item */
     *meta = GST_BUFFER_META (buffer);
-  else
+  } else {
     /* state !NULL, move to next item in list */
     *meta = (*meta)->next;
+  }
 
   while (*meta != NULL && (*meta)->meta.info->api != meta_api_type)
     *meta = (*meta)->next;
@@ -2534,13 +2617,14 @@ gst_buffer_foreach_meta (GstBuffer * buffer, GstBufferForeachMetaFunc func,
         prev = GST_BUFFER_META (buffer) = next;
       else
         prev->next = next;
+      _meta_index_rebuild (buffer);
 
       /* call free_func if any */
       if (info->free_func)
         info->free_func (m, buffer);
 
       /* and free the slice */
-      g_slice_free1 (ITEM_SIZE (info), walk);
+      _priv_gst_slab_free (ITEM_SIZE (info), walk);
     } else {
       prev = walk;
     }
@@ -59,6 +59,14 @@
  * The bufferpool can be deactivated again with gst_buffer_pool_set_active().
  * All further gst_buffer_pool_acquire_buffer() calls will return an error. When
  * all buffers are returned to the pool they will be freed.
+ *
+ * Pools that are acquired from and released to by many threads can enable
+ * small per-thread caches of free buffers with
+ * gst_buffer_pool_config_set_thread_cache_size(). Buffers released by a thread
+ * are then kept in the cache of that thread and handed out again to the same
+ * thread without going through the shared queue of the pool. The caches are
+ * emptied when the pool is deactivated. gst_buffer_pool_get_stats() can be
+ * used to check how effective the caches are.
  */
 
 #include "gst_private.h"
@@ -90,6 +98,29 @@ GST_DEBUG_CATEGORY_STATIC (gst_buffer_pool_debug);
 #define GST_BUFFER_POOL_LOCK(pool)   (g_rec_mutex_lock(&pool->priv->rec_lock))
 #define GST_BUFFER_POOL_UNLOCK(pool) (g_rec_mutex_unlock(&pool->priv->rec_lock))
 
+#define MIN_MAGAZINES 4
+#define MAX_MAGAZINES 64
+#define MAX_THREAD_CACHE_SIZE 1024
+#define CACHE_LINE_SIZE 64
+
+/* a small stack of free buffers owned by one thread, or shared by a few when
+ * there are more threads than magazines. The lock is only contended when a
+ * thread waiting for a buffer steals from the magazines of other threads. */
+typedef struct
+{
+  guint64 hits;
+  guint64 misses;
+  GstBuffer **buffers;
+  gint lock;
+  guint n_buffers;
+  /* keep the magazines of different threads on separate cache lines, the
+   * array of magazines is aligned to a cache line */
+  gchar _padding[CACHE_LINE_SIZE - 2 * sizeof (guint64) - 2 * sizeof (gint) -
+      sizeof (gpointer)];
+} GstBufferPoolMagazine;
+
+G_STATIC_ASSERT (sizeof (GstBufferPoolMagazine) == CACHE_LINE_SIZE);
+
 struct _GstBufferPoolPrivate
 {
   GstAtomicQueue *queue;
@@ -110,6 +141,19 @@ struct _GstBufferPoolPrivate
   guint cur_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+
+  /* per-thread caches in front of the queue, magazines points into
+   * magazines_mem */
+  gpointer magazines_mem;
+  GstBufferPoolMagazine *magazines;
+  guint n_magazines;
+  guint thread_cache_size;
+  gint waiters;                 /* number of threads waiting for a release */
+
+  /* stats, only updated on slow paths so a lock is cheap enough */
+  GMutex stats_lock;
+  guint64 misses;               /* contended magazine lookups */
+  guint64 waits;
 };
 
 static void gst_buffer_pool_dispose (GObject * object);
@@ -128,6 +172,11 @@ static GstFlowReturn default_acquire_buffer (GstBufferPool * pool,
 static void default_reset_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_free_buffer (GstBufferPool * pool, GstBuffer * buffer);
 static void default_release_buffer (GstBufferPool * pool, GstBuffer * buffer);
+static void do_free_buffer (GstBufferPool * pool, GstBuffer * buffer);
+
+/* every thread gets a small index that is used to pick its magazine */
+static GPrivate magazine_index = G_PRIVATE_INIT (NULL);
+static gint magazine_n_threads = 0;
 
 static void
 gst_buffer_pool_class_init (GstBufferPoolClass * klass)
@@ -158,6 +207,7 @@ gst_buffer_pool_init (GstBufferPool * pool)
   priv = pool->priv = gst_buffer_pool_get_instance_private (pool);
 
   g_rec_mutex_init (&priv->rec_lock);
+  g_mutex_init (&priv->stats_lock);
 
   priv->poll = gst_poll_new_timer ();
   priv->queue = gst_atomic_queue_new (16);
@@ -179,6 +229,153 @@ gst_buffer_pool_init (GstBufferPool * pool)
   GST_DEBUG_OBJECT (pool, "created");
 }
 
+static inline GstBufferPoolMagazine *
+magazine_get (GstBufferPoolPrivate * priv)
+{
+  guint idx;
+
+  idx = GPOINTER_TO_UINT (g_private_get (&magazine_index));
+  if (G_UNLIKELY (idx == 0)) {
+    idx = (guint) g_atomic_int_add (&magazine_n_threads, 1) + 1;
+    g_private_set (&magazine_index, GUINT_TO_POINTER (idx));
+  }
+  return &priv->magazines[(idx - 1) & (priv->n_magazines - 1)];
+}
+
+static inline gboolean
+magazine_trylock (GstBufferPoolMagazine * mag)
+{
+  return g_atomic_int_compare_and_exchange (&mag->lock, 0, 1);
+}
+
+static inline void
+magazine_lock (GstBufferPoolMagazine * mag)
+{
+  while (!magazine_trylock (mag))
+    g_thread_yield ();
+}
+
+static inline void
+magazine_unlock (GstBufferPoolMagazine * mag)
+{
+  g_atomic_int_set (&mag->lock, 0);
+}
+
+/* takes a buffer from the magazine of the current thread */
+static GstBuffer *
+magazine_pop (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag;
+  GstBuffer *buffer = NULL;
+
+  mag = magazine_get (priv);
+  if (G_UNLIKELY (!magazine_trylock (mag))) {
+    g_mutex_lock (&priv->stats_lock);
+    priv->misses++;
+    g_mutex_unlock (&priv->stats_lock);
+    return NULL;
+  }
+  if (G_LIKELY (mag->n_buffers > 0)) {
+    buffer = mag->buffers[--mag->n_buffers];
+    mag->hits++;
+  } else {
+    mag->misses++;
+  }
+  magazine_unlock (mag);
+
+  return buffer;
+}
+
+/* puts a buffer in the magazine of the current thread, returns FALSE when it
+ * needs to go to the queue instead */
+static gboolean
+magazine_push (GstBufferPool * pool, GstBuffer * buffer)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBufferPoolMagazine *mag;
+  gboolean res = FALSE;
+
+  mag = magazine_get (priv);
+  if (G_UNLIKELY (!magazine_trylock (mag)))
+    return FALSE;
+  /* waiters are only woken up by buffers released to the queue. This check is
+   * done with the magazine locked so that a waiter either sees this buffer
+   * when stealing or we see the waiter here */
+  if (mag->n_buffers < priv->thread_cache_size
+      && g_atomic_int_get (&priv->waiters) == 0) {
+    mag->buffers[mag->n_buffers++] = buffer;
+    res = TRUE;
+  }
+  magazine_unlock (mag);
+
+  return res;
+}
+
+/* takes a buffer from any magazine */
+static GstBuffer *
+magazine_steal (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer = NULL;
+  guint i;
+
+  for (i = 0; i < priv->n_magazines && !buffer; i++) {
+    GstBufferPoolMagazine *mag = &priv->magazines[i];
+
+    magazine_lock (mag);
+    if (mag->n_buffers > 0)
+      buffer = mag->buffers[--mag->n_buffers];
+    magazine_unlock (mag);
+  }
+  return buffer;
+}
+
+static void
+magazines_alloc (GstBufferPool * pool, guint size)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  guint i, n;
+
+  n = MIN_MAGAZINES;
+  while (n < MAX_MAGAZINES && n < 2 * g_get_num_processors ())
+    n <<= 1;
+
+  /* g_malloc() only guarantees the alignment of the basic types */
+  priv->magazines_mem = g_malloc0 ((n + 1) * sizeof (GstBufferPoolMagazine));
+  priv->magazines = (GstBufferPoolMagazine *)
+      GSIZE_TO_POINTER ((GPOINTER_TO_SIZE (priv->magazines_mem) +
+          CACHE_LINE_SIZE - 1) & ~((gsize) CACHE_LINE_SIZE - 1));
+  priv->n_magazines = n;
+  priv->thread_cache_size = size;
+  for (i = 0; i < n; i++)
+    priv->magazines[i].buffers = g_new (GstBuffer *, size);
+
+  GST_DEBUG_OBJECT (pool, "using %u thread caches of %u buffers", n, size);
+}
+
+static void
+magazines_free (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv = pool->priv;
+  GstBuffer *buffer;
+  guint i;
+
+  if (!priv->magazines)
+    return;
+
+  while ((buffer = magazine_steal (pool)))
+    do_free_buffer (pool, buffer);
+
+  for (i = 0; i < priv->n_magazines; i++)
+    g_free (priv->magazines[i].buffers);
+  g_free (priv->magazines_mem);
+  priv->magazines_mem = NULL;
+  priv->magazines = NULL;
+  priv->n_magazines = 0;
+  priv->thread_cache_size = 0;
+}
+
 static void
 gst_buffer_pool_dispose (GObject * object)
 {
@@ -207,10 +404,12 @@ gst_buffer_pool_finalize (GObject * object)
 
   GST_DEBUG_OBJECT (pool, "%p finalize", pool);
 
+  magazines_free (pool);
   gst_atomic_queue_unref (priv->queue);
   gst_poll_free (priv->poll);
   gst_structure_free (priv->config);
   g_rec_mutex_clear (&priv->rec_lock);
+  g_mutex_clear (&priv->stats_lock);
 
   G_OBJECT_CLASS (gst_buffer_pool_parent_class)->finalize (object);
 }
@@ -406,6 +605,12 @@ default_stop (GstBufferPool * pool)
   GstBufferPoolPrivate *priv = pool->priv;
   GstBuffer *buffer;
 
+  /* clear the thread caches, the buffers in there have no control token */
+  if (priv->magazines) {
+    while ((buffer = magazine_steal (pool)))
+      do_free_buffer (pool, buffer);
+  }
+
   /* clear the pool */
   while ((buffer = gst_atomic_queue_pop (priv->queue))) {
     while (!gst_poll_read_control (priv->poll)) {
@@ -610,6 +815,7 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   guint size, min_buffers, max_buffers;
   GstAllocator *allocator;
   GstAllocationParams params;
+  guint thread_cache_size;
 
   /* parse the config and keep around */
   if (!gst_buffer_pool_config_get_params (config, &caps, &size, &min_buffers,
@@ -619,6 +825,10 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
   if (!gst_buffer_pool_config_get_allocator (config, &allocator, &params))
     goto wrong_config;
 
+  if (!gst_buffer_pool_config_get_thread_cache_size (config,
+          &thread_cache_size))
+    thread_cache_size = 0;
+
   GST_DEBUG_OBJECT (pool, "config %" GST_PTR_FORMAT, config);
 
   priv->size = size;
@@ -632,6 +842,12 @@ default_set_config (GstBufferPool * pool, GstStructure * config)
     gst_object_ref (allocator);
   priv->params = params;
 
+  if (thread_cache_size != priv->thread_cache_size) {
+    magazines_free (pool);
+    if (thread_cache_size > 0)
+      magazines_alloc (pool, thread_cache_size);
+  }
+
   return TRUE;
 
 wrong_config:
@@ -1065,6 +1281,59 @@ gst_buffer_pool_config_get_allocator (GstStructure * config,
   return TRUE;
 }
 
+/**
+ * gst_buffer_pool_config_set_thread_cache_size:
+ * @config: a #GstBufferPool configuration
+ * @size: the maximum number of free buffers to cache per thread, or 0 to
+ *     disable the caches
+ *
+ * Configures per-thread caches of free buffers in front of the shared queue
+ * of the pool. A buffer released by a thread is kept in the cache of that
+ * thread, up to @size buffers, and is handed out again to the next acquire
+ * from the same thread without any contention with other threads.
+ *
+ * When the pool runs out of buffers, threads waiting in
+ * gst_buffer_pool_acquire_buffer() take buffers from the caches of the other
+ * threads, so the caches never hold on to buffers that are needed elsewhere.
+ *
+ * This is only supported by pools that use the default acquire and release
+ * implementation of #GstBufferPool.
+ *
+ * Since: 1.22
+ */
+void
+gst_buffer_pool_config_set_thread_cache_size (GstStructure * config,
+    guint size)
+{
+  g_return_if_fail (config != NULL);
+  g_return_if_fail (size <= MAX_THREAD_CACHE_SIZE);
+
+  gst_structure_id_set (config,
+      GST_QUARK (THREAD_CACHE_SIZE), G_TYPE_UINT, size, NULL);
+}
+
+/**
+ * gst_buffer_pool_config_get_thread_cache_size:
+ * @config: (transfer none): a #GstBufferPool configuration
+ * @size: (out): the maximum number of free buffers cached per thread
+ *
+ * Gets the per-thread cache size from @config.
+ *
+ * Returns: %TRUE if the cache size was set in @config.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_buffer_pool_config_get_thread_cache_size (GstStructure * config,
+    guint * size)
+{
+  g_return_val_if_fail (config != NULL, FALSE);
+  g_return_val_if_fail (size != NULL, FALSE);
+
+  return gst_structure_id_get (config,
+      GST_QUARK (THREAD_CACHE_SIZE), G_TYPE_UINT, size, NULL);
+}
+
 /**
  * gst_buffer_pool_config_validate_params:
  * @config: (transfer none): a #GstBufferPool configuration
@@ -1116,6 +1385,13 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
     if (G_UNLIKELY (GST_BUFFER_POOL_IS_FLUSHING (pool)))
       goto flushing;
 
+    /* try the cache of this thread first */
+    if (priv->magazines && (*buffer = magazine_pop (pool))) {
+      result = GST_FLOW_OK;
+      GST_LOG_OBJECT (pool, "acquired buffer %p from thread cache", *buffer);
+      break;
+    }
+
     /* try to get a buffer from the queue */
     *buffer = gst_atomic_queue_pop (priv->queue);
     if (G_LIKELY (*buffer)) {
@@ -1146,12 +1422,28 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       /* something went wrong, return error */
       break;
 
+    /* from now on released buffers go to the queue so that we are woken up,
+     * then look for buffers that are kept in the caches of other threads */
+    g_atomic_int_inc (&priv->waiters);
+    if (priv->magazines && (*buffer = magazine_steal (pool))) {
+      g_atomic_int_add (&priv->waiters, -1);
+      result = GST_FLOW_OK;
+      GST_LOG_OBJECT (pool, "acquired buffer %p from other thread cache",
+          *buffer);
+      break;
+    }
+
     /* check if we need to wait */
     if (params && (params->flags & GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT)) {
+      g_atomic_int_add (&priv->waiters, -1);
       GST_LOG_OBJECT (pool, "no more buffers");
       break;
     }
 
+    g_mutex_lock (&priv->stats_lock);
+    priv->waits++;
+    g_mutex_unlock (&priv->stats_lock);
+
     /* now we release the control socket, we wait for a buffer release or
      * flushing */
     if (!gst_poll_read_control (pool->priv->poll)) {
@@ -1165,6 +1457,7 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
         gst_poll_wait (priv->poll, GST_CLOCK_TIME_NONE);
       } else {
         /* This is a critical error, GstPoll already gave a warning */
+        g_atomic_int_add (&priv->waiters, -1);
         result = GST_FLOW_ERROR;
         break;
       }
@@ -1181,6 +1474,7 @@ default_acquire_buffer (GstBufferPool * pool, GstBuffer ** buffer,
       }
       gst_poll_write_control (pool->priv->poll);
     }
+    g_atomic_int_add (&priv->waiters, -1);
   }
 
   return result;
@@ -1322,7 +1616,11 @@ default_release_buffer (GstBufferPool * pool, GstBuffer * buffer)
   if (G_UNLIKELY (!gst_buffer_is_all_memory_writable (buffer)))
     goto not_writable;
 
-  /* keep it around in our queue */
+  /* keep it around in the cache of this thread */
+  if (pool->priv->magazines && magazine_push (pool, buffer))
+    return;
+
+  /* or in our queue */
   gst_atomic_queue_push (pool->priv->queue, buffer);
   gst_poll_write_control (pool->priv->poll);
 
@@ -1427,3 +1725,53 @@ gst_buffer_pool_set_flushing (GstBufferPool * pool, gboolean flushing)
 done:
   GST_BUFFER_POOL_UNLOCK (pool);
 }
+
+/**
+ * gst_buffer_pool_get_stats:
+ * @pool: a #GstBufferPool
+ *
+ * Gets statistics about the buffers acquired from @pool. The returned
+ * structure contains the following #guint64 fields:
+ *
+ *  * "thread-cache-hits": acquires served from the cache of the calling thread
+ *  * "thread-cache-misses": acquires that had to go to the shared queue
+ *  * "waits": acquires that had to wait for a buffer to be released
+ *
+ * The thread cache counters are only updated when the caches are enabled with
+ * gst_buffer_pool_config_set_thread_cache_size().
+ *
+ * Returns: (transfer full): a #GstStructure with the statistics of @pool.
+ *
+ * Since: 1.22
+ */
+GstStructure *
+gst_buffer_pool_get_stats (GstBufferPool * pool)
+{
+  GstBufferPoolPrivate *priv;
+  guint64 hits = 0, misses, waits;
+  guint i;
+
+  g_return_val_if_fail (GST_IS_BUFFER_POOL (pool), NULL);
+
+  priv = pool->priv;
+
+  GST_BUFFER_POOL_LOCK (pool);
+  g_mutex_lock (&priv->stats_lock);
+  misses = priv->misses;
+  waits = priv->waits;
+  g_mutex_unlock (&priv->stats_lock);
+  for (i = 0; i < priv->n_magazines; i++) {
+    GstBufferPoolMagazine *mag = &priv->magazines[i];
+
+    magazine_lock (mag);
+    hits += mag->hits;
+    misses += mag->misses;
+    magazine_unlock (mag);
+  }
+  GST_BUFFER_POOL_UNLOCK (pool);
+
+  return gst_structure_new ("GstBufferPoolStats",
+      "thread-cache-hits", G_TYPE_UINT64, hits,
+      "thread-cache-misses", G_TYPE_UINT64, misses,
+      "waits", G_TYPE_UINT64, waits, NULL);
+}
@@ -318,6 +318,12 @@ GST_API
 gboolean         gst_buffer_pool_config_get_allocator (GstStructure *config, GstAllocator **allocator,
                                                        GstAllocationParams *params);
 
+GST_API
+void             gst_buffer_pool_config_set_thread_cache_size (GstStructure *config, guint size);
+
+GST_API
+gboolean         gst_buffer_pool_config_get_thread_cache_size (GstStructure *config, guint *size);
+
 /* options */
 
 GST_API
@@ -345,6 +351,11 @@ GstFlowReturn    gst_buffer_pool_acquire_buffer  (GstBufferPool *pool, GstBuffer
 GST_API
 void             gst_buffer_pool_release_buffer  (GstBufferPool *pool, GstBuffer *buffer);
 
+/* statistics */
+
+GST_API
+GstStructure *   gst_buffer_pool_get_stats       (GstBufferPool *pool);
+
 G_END_DECLS
 
 #endif /* __GST_BUFFER_POOL_H__ */
@@ -68,8 +68,8 @@
  *
  * It is possible to perform a blocking wait on the same #GstClockID from
  * multiple threads. However, registering the same #GstClockID for multiple
- * async notifications is not possible, the callback will only be called for
- * the thread registering the entry last.
+ * async notifications is not possible, the callback will only be called once,
+ * for the thread registering the entry last.
  *
  * None of the wait operations unref the #GstClockID, the owner is responsible
  * for unreffing the ids itself. This holds for both periodic and single shot
@@ -553,12 +553,16 @@ gst_clock_id_wait (GstClockID id, GstClockTimeDiff * jitter)
   if (G_UNLIKELY (cclass->wait == NULL))
     goto not_supported;
 
+  GST_TRACER_CLOCK_WAIT_PRE (clock, id);
+
   res = cclass->wait (clock, entry, jitter);
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
       "done waiting entry %p, res: %d (%s)", id, res,
       gst_clock_return_get_name (res));
 
+  GST_TRACER_CLOCK_WAIT_POST (clock, id, res, jitter ? *jitter : 0);
+
   if (entry->type == GST_CLOCK_ENTRY_PERIODIC)
     entry->time = requested + entry->interval;
 
@@ -599,6 +603,9 @@ invalid_entry:
  * The callback @func can be invoked from any thread, either provided by the
  * core or from a streaming thread. The application should be prepared for this.
  *
+ * Calling this function again on an @id that is still pending replaces @func
+ * and @user_data of the previous call, the callback is only called once.
+ *
  * Returns: the result of the non blocking wait.
  */
 GstClockReturn
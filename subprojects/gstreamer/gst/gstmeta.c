@@ -55,6 +55,23 @@
 static GHashTable *metainfo = NULL;
 static GRWLock lock;
 
+/* The first PRIV_GST_META_API_INDEX_MAX registered APIs get a small index that
+ * buffers use for quick lookups. The index of an API is found in an open
+ * addressing table that is read without locking, entries are only ever
+ * added. */
+#define META_INDEX_TABLE_SIZE (4 * PRIV_GST_META_API_INDEX_MAX)
+
+typedef struct
+{
+  gpointer api;                 /* the GType, set last */
+  guint index;
+  guint tags;
+} MetaIndexEntry;
+
+static MetaIndexEntry meta_index_table[META_INDEX_TABLE_SIZE];
+static guint meta_index_n_apis = 0;
+G_LOCK_DEFINE_STATIC (meta_index);
+
 GQuark _gst_meta_transform_copy;
 GQuark _gst_meta_tag_memory;
 GQuark _gst_meta_tag_memory_reference;
@@ -81,6 +98,53 @@ free_info (gpointer data)
   g_slice_free (GstMetaInfoImpl, data);
 }
 
+static inline guint
+meta_index_hash (GType api)
+{
+  return (((guint) (api >> 2) * 2654435761u) >> 24) % META_INDEX_TABLE_SIZE;
+}
+
+static void
+meta_index_add (GType api, guint tags)
+{
+  guint h;
+
+  G_LOCK (meta_index);
+  if (meta_index_n_apis < PRIV_GST_META_API_INDEX_MAX) {
+    h = meta_index_hash (api);
+    while (meta_index_table[h].api)
+      h = (h + 1) % META_INDEX_TABLE_SIZE;
+
+    meta_index_table[h].index = meta_index_n_apis++;
+    meta_index_table[h].tags = tags;
+    g_atomic_pointer_set (&meta_index_table[h].api, GSIZE_TO_POINTER (api));
+
+    GST_CAT_DEBUG (GST_CAT_META, "API %s has index %u", g_type_name (api),
+        meta_index_table[h].index);
+  }
+  G_UNLOCK (meta_index);
+}
+
+/* returns the index of @api or -1 when it has none, @tags is set to the
+ * PRIV_GST_META_API_TAG flags of @api */
+gint
+_priv_gst_meta_api_type_get_index (GType api, guint * tags)
+{
+  guint h;
+  gpointer entry;
+
+  for (h = meta_index_hash (api);
+      (entry = g_atomic_pointer_get (&meta_index_table[h].api));
+      h = (h + 1) % META_INDEX_TABLE_SIZE) {
+    if (entry == GSIZE_TO_POINTER (api)) {
+      if (tags)
+        *tags = meta_index_table[h].tags;
+      return meta_index_table[h].index;
+    }
+  }
+  return -1;
+}
+
 void
 _priv_gst_meta_initialize (void)
 {
@@ -137,13 +201,21 @@ gst_meta_api_type_register (const gchar * api, const gchar ** tags)
   type = g_pointer_type_register_static (api);
 
   if (type != 0) {
+    guint index_tags = 0;
     gint i;
 
     for (i = 0; tags[i]; i++) {
+      GQuark tag = g_quark_from_string (tags[i]);
+
       GST_CAT_DEBUG (GST_CAT_META, "  adding tag \"%s\"", tags[i]);
-      g_type_set_qdata (type, g_quark_from_string (tags[i]),
-          GINT_TO_POINTER (TRUE));
+      g_type_set_qdata (type, tag, GINT_TO_POINTER (TRUE));
+
+      if (tag == _gst_meta_tag_memory)
+        index_tags |= PRIV_GST_META_API_TAG_MEMORY;
+      else if (tag == _gst_meta_tag_memory_reference)
+        index_tags |= PRIV_GST_META_API_TAG_MEMORY_REFERENCE;
     }
+    meta_index_add (type, index_tags);
   }
 
   g_type_set_qdata (type, GST_QUARK (TAGS), g_strdupv ((gchar **) tags));
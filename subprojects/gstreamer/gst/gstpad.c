@@ -137,6 +137,8 @@ struct _GstPadPrivate
   GArray *events;
   guint last_cookie;
 
+  /* number of data flows in progress through the pad, atomic because pushes
+   * on the fast path don't take the object lock */
   gint using;
   guint probe_list_cookie;
 
@@ -151,6 +153,12 @@ struct _GstPadPrivate
   gboolean in_activation;
 
   gboolean warned_unlinked;
+
+  /* set when buffers can be pushed without the checks of the slow path, see
+   * update_fast_path(). fast_peek counts the pushes that are between checking
+   * fast_path and taking their ref to the peer, both atomic */
+  gint fast_path;
+  gint fast_peek;
 };
 
 typedef struct
@@ -712,6 +720,44 @@ get_pad_caps (GstPad * pad)
   return caps;
 }
 
+/* the flags that make a push on the fast path take the slow path. They are
+ * checked on every push instead of disabling the fast path */
+#define FAST_PATH_FLAGS (GST_PAD_FLAG_FLUSHING | GST_PAD_FLAG_EOS | \
+    GST_PAD_FLAG_PENDING_EVENTS | GST_PAD_FLAG_BLOCKED)
+
+/* should be called with the OBJECT_LOCK after a push went through the slow
+ * path. Enables the fast path when the following pushes don't need any of
+ * its checks, until disable_fast_path() is called */
+static void
+update_fast_path (GstPad * pad)
+{
+  if (pad->num_probes != 0 || GST_PAD_IS_RUNNING_IDLE_PROBE (pad))
+    return;
+
+  if (GST_PAD_PEER (pad) == NULL || GST_PAD_MODE (pad) != GST_PAD_MODE_PUSH)
+    return;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "enabling fast path");
+  g_atomic_int_set (&pad->priv->fast_path, TRUE);
+}
+
+/* should be called with the OBJECT_LOCK when adding probes, unlinking,
+ * flushing or deactivating the pad */
+static void
+disable_fast_path (GstPad * pad)
+{
+  if (!g_atomic_int_get (&pad->priv->fast_path))
+    return;
+
+  GST_CAT_LOG_OBJECT (GST_CAT_SCHEDULING, pad, "disabling fast path");
+  g_atomic_int_set (&pad->priv->fast_path, FALSE);
+
+  /* pushes that saw the fast path enabled might still be about to ref the
+   * peer. This never takes longer than a few instructions */
+  while (g_atomic_int_get (&pad->priv->fast_peek) > 0)
+    g_thread_yield ();
+}
+
 static void
 gst_pad_dispose (GObject * object)
 {
@@ -996,6 +1042,7 @@ pre_activate (GstPad * pad, GstPadMode new_mode)
       pad->priv->in_activation = TRUE;
       GST_DEBUG_OBJECT (pad, "setting PAD_MODE NONE, set flushing");
       GST_PAD_SET_FLUSHING (pad);
+      disable_fast_path (pad);
       pad->ABI.abi.last_flowret = GST_FLOW_FLUSHING;
       GST_PAD_MODE (pad) = new_mode;
       /* unlock blocked pads so element can resume and stop */
@@ -1471,6 +1518,8 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
   /* add the probe */
   g_hook_append (&pad->probes, hook);
   pad->num_probes++;
+  /* pushes have to go through the probes from now on */
+  disable_fast_path (pad);
   /* incremenent cookie so that the new hook gets called */
   pad->priv->probe_list_cookie++;
 
@@ -1493,7 +1542,7 @@ gst_pad_add_probe (GstPad * pad, GstPadProbeType mask,
 
   /* call the callback if we need to be called for idle callbacks */
   if ((mask & GST_PAD_PROBE_TYPE_IDLE) && (callback != NULL)) {
-    if (pad->priv->using > 0) {
+    if (g_atomic_int_get (&pad->priv->using) > 0) {
       /* the pad is in use, we can't signal the idle callback yet. Since we set the
        * flag above, the last thread to leave the push will do the callback. New
        * threads going into the push will block. */
@@ -2191,6 +2240,8 @@ no_src_parent:
   }
 no_sink_parent:
 
+  disable_fast_path (srcpad);
+
   /* first clear peers */
   GST_PAD_PEER (srcpad) = NULL;
   GST_PAD_PEER (sinkpad) = NULL;
@@ -4684,6 +4735,55 @@ gst_pad_chain_list (GstPad * pad, GstBufferList * list)
       GST_PAD_PROBE_TYPE_BUFFER_LIST | GST_PAD_PROBE_TYPE_PUSH, list);
 }
 
+/* the last push on the fast path is done after the fast path was disabled,
+ * run the idle probes that were added in the meantime */
+static void
+gst_pad_push_data_fast_idle (GstPad * pad)
+{
+  GstFlowReturn ret;
+
+  GST_OBJECT_LOCK (pad);
+  if (g_atomic_int_get (&pad->priv->using) == 0) {
+    PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
+        done, GST_FLOW_OK);
+  }
+done:
+  GST_OBJECT_UNLOCK (pad);
+}
+
+/* pushes @data to the peer without taking the object lock of @pad. This is
+ * only possible while update_fast_path() has found that none of the checks
+ * of gst_pad_push_data() are needed. Returns FALSE when @data has to take the
+ * slow path, @data is still owned by the caller then. */
+static inline gboolean
+gst_pad_push_data_fast (GstPad * pad, GstPadProbeType type, void *data,
+    GstFlowReturn * ret)
+{
+  GstPadPrivate *priv = pad->priv;
+  GstPad *peer = NULL;
+
+  g_atomic_int_inc (&priv->using);
+
+  g_atomic_int_inc (&priv->fast_peek);
+  if (G_LIKELY (g_atomic_int_get (&priv->fast_path)
+          && (GST_OBJECT_FLAGS (pad) & FAST_PATH_FLAGS) == 0))
+    peer = gst_object_ref (GST_PAD_PEER (pad));
+  g_atomic_int_add (&priv->fast_peek, -1);
+
+  if (G_LIKELY (peer != NULL)) {
+    *ret = gst_pad_chain_data_unchecked (peer, type, data);
+    gst_object_unref (peer);
+
+    pad->ABI.abi.last_flowret = *ret;
+  }
+
+  if (g_atomic_int_dec_and_test (&priv->using)
+      && G_UNLIKELY (!g_atomic_int_get (&priv->fast_path)))
+    gst_pad_push_data_fast_idle (pad);
+
+  return peer != NULL;
+}
+
 static GstFlowReturn
 gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 {
@@ -4691,6 +4791,12 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   GstFlowReturn ret;
   gboolean handled = FALSE;
 
+#ifndef GST_ENABLE_EXTRA_CHECKS
+  if (G_LIKELY (g_atomic_int_get (&pad->priv->fast_path))
+      && gst_pad_push_data_fast (pad, type, data, &ret))
+    return ret;
+#endif
+
   GST_OBJECT_LOCK (pad);
   if (G_UNLIKELY (GST_PAD_IS_FLUSHING (pad)))
     goto flushing;
@@ -4738,9 +4844,12 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
   if (G_UNLIKELY ((peer = GST_PAD_PEER (pad)) == NULL))
     goto not_linked;
 
+  if (G_UNLIKELY (!g_atomic_int_get (&pad->priv->fast_path)))
+    update_fast_path (pad);
+
   /* take ref to peer pad before releasing the lock */
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_chain_data_unchecked (peer, type, data);
@@ -4750,8 +4859,7 @@ gst_pad_push_data (GstPad * pad, GstPadProbeType type, void *data)
 
   GST_OBJECT_LOCK (pad);
   pad->ABI.abi.last_flowret = ret;
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped, ret);
@@ -5196,7 +5304,7 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
     goto not_linked;
 
   gst_object_ref (peer);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   ret = gst_pad_get_range_unchecked (peer, offset, size, &res_buf);
@@ -5204,9 +5312,8 @@ gst_pad_pull_range (GstPad * pad, guint64 offset, guint size,
   gst_object_unref (peer);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
   pad->ABI.abi.last_flowret = ret;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PULL | GST_PAD_PROBE_TYPE_IDLE,
         probe_stopped_unref, ret);
@@ -5488,6 +5595,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   switch (event_type) {
     case GST_EVENT_FLUSH_START:
       GST_PAD_SET_FLUSHING (pad);
+      disable_fast_path (pad);
 
       GST_PAD_BLOCK_BROADCAST (pad);
       type |= GST_PAD_PROBE_TYPE_EVENT_FLUSH;
@@ -5573,7 +5681,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
     goto not_linked;
 
   gst_object_ref (peerpad);
-  pad->priv->using++;
+  g_atomic_int_inc (&pad->priv->using);
   GST_OBJECT_UNLOCK (pad);
 
   GST_LOG_OBJECT (pad, "sending event %p (%s) to peerpad %" GST_PTR_FORMAT,
@@ -5590,8 +5698,7 @@ gst_pad_push_event_unchecked (GstPad * pad, GstEvent * event,
   gst_object_unref (peerpad);
 
   GST_OBJECT_LOCK (pad);
-  pad->priv->using--;
-  if (pad->priv->using == 0) {
+  if (g_atomic_int_dec_and_test (&pad->priv->using)) {
     /* pad is not active anymore, trigger idle callbacks */
     PROBE_NO_DATA (pad, GST_PAD_PROBE_TYPE_PUSH | GST_PAD_PROBE_TYPE_IDLE,
         idle_probe_stopped, ret);
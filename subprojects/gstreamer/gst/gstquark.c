@@ -80,7 +80,8 @@ static const gchar *_quark_strings[] = {
   "GstEventInstantRateChange",
   "GstEventInstantRateSyncTime", "GstMessageInstantRateRequest",
   "upstream-running-time", "base", "offset", "plugin-api", "plugin-api-flags",
-  "gap-flags", "GstQuerySelectable", "selectable", "latency-changed"
+  "gap-flags", "GstQuerySelectable", "selectable", "latency-changed",
+  "thread-cache-size"
 };
 
 GQuark _priv_gst_quark_table[GST_QUARK_MAX];
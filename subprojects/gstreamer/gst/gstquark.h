@@ -234,7 +234,8 @@ typedef enum _GstQuarkId
   GST_QUARK_QUERY_SELECTABLE = 203,
   GST_QUARK_SELECTABLE = 204,
   GST_QUARK_EVENT_LATENCY_CHANGED = 205,
-  GST_QUARK_MAX = 206
+  GST_QUARK_THREAD_CACHE_SIZE = 206,
+  GST_QUARK_MAX = 207
 } GstQuarkId;
 
 extern GQuark _priv_gst_quark_table[GST_QUARK_MAX];
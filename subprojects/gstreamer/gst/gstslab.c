@@ -0,0 +1,311 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstslab.c: slab allocator for small core objects
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* The slab allocator hands out the small fixed size objects that are created
+ * and destroyed for every buffer: the GstBuffer itself, the GstMemory of the
+ * system allocator together with small payloads and the GstMeta items.
+ *
+ * Objects are grouped in power of two size classes. Every thread keeps a short
+ * free list per size class that is used without any locking. When a free list
+ * runs empty or grows too long, a batch of objects is moved from or to a depot
+ * that is shared between all threads. The depot carves new objects out of
+ * large blocks. These are only released again in gst_deinit() when all of
+ * their objects are back in the depot, otherwise they are left to the exit of
+ * the process.
+ *
+ * The slab allocator is disabled by default and is enabled with the
+ * GST_SLAB_ALLOCATOR=yes environment variable or the
+ * --gst-enable-slab-allocator option. It can't be changed after gst_init()
+ * because objects must be freed by the allocator they came from. When
+ * disabled, all calls go directly to g_slice.
+ */
+
+#include "gst_private.h"
+
+#include <string.h>
+
+#include "gstinfo.h"
+
+/* size classes of 32, 64, ... 4096 bytes */
+#define SLAB_MIN_SHIFT 5
+#define SLAB_N_CLASSES 8
+#define SLAB_MAX_SIZE (1 << (SLAB_MIN_SHIFT + SLAB_N_CLASSES - 1))
+
+/* the size of the blocks the objects are carved out of */
+#define SLAB_BLOCK_SIZE (64 * 1024)
+
+/* objects moved between a thread and the depot at once, a thread keeps at
+ * most two batches per size class */
+#define SLAB_BATCH 32
+#define SLAB_CACHE_MAX (2 * SLAB_BATCH)
+
+typedef struct _SlabObject SlabObject;
+
+struct _SlabObject
+{
+  SlabObject *next;
+};
+
+typedef struct
+{
+  GMutex lock;
+  SlabObject *head;
+  guint n_free;
+  guint n_objects;              /* carved out of the blocks */
+  GSList *blocks;
+} SlabDepot;
+
+typedef struct
+{
+  SlabObject *head;
+  guint n_free;
+} SlabFreeList;
+
+typedef struct
+{
+  SlabFreeList lists[SLAB_N_CLASSES];
+} SlabThreadCache;
+
+static void slab_thread_cache_free (gpointer data);
+
+static gboolean slab_enabled = FALSE;
+static gboolean slab_initialized = FALSE;
+static SlabDepot slab_depots[SLAB_N_CLASSES];
+static GPrivate slab_thread_cache = G_PRIVATE_INIT (slab_thread_cache_free);
+
+static inline guint
+slab_size_class (gsize size)
+{
+  if (size <= (1 << SLAB_MIN_SHIFT))
+    return 0;
+  return g_bit_storage (size - 1) - SLAB_MIN_SHIFT;
+}
+
+/* must be called with the depot lock */
+static void
+slab_depot_grow (SlabDepot * depot, gsize obj_size)
+{
+  guint8 *block, *obj;
+
+  block = g_malloc (SLAB_BLOCK_SIZE);
+  depot->blocks = g_slist_prepend (depot->blocks, block);
+
+  for (obj = block; obj + obj_size <= block + SLAB_BLOCK_SIZE;
+      obj += obj_size) {
+    ((SlabObject *) obj)->next = depot->head;
+    depot->head = (SlabObject *) obj;
+    depot->n_free++;
+    depot->n_objects++;
+  }
+}
+
+/* moves a batch of objects from the depot to the free list of a thread */
+static void
+slab_refill (SlabFreeList * list, guint cls)
+{
+  SlabDepot *depot = &slab_depots[cls];
+  gsize obj_size = (gsize) 1 << (cls + SLAB_MIN_SHIFT);
+  SlabObject *tail;
+  guint i;
+
+  g_mutex_lock (&depot->lock);
+  while (depot->n_free < SLAB_BATCH)
+    slab_depot_grow (depot, obj_size);
+
+  list->head = tail = depot->head;
+  for (i = 1; i < SLAB_BATCH; i++)
+    tail = tail->next;
+  depot->head = tail->next;
+  depot->n_free -= SLAB_BATCH;
+  g_mutex_unlock (&depot->lock);
+
+  tail->next = NULL;
+  list->n_free = SLAB_BATCH;
+}
+
+/* moves @n objects from the free list of a thread to the depot */
+static void
+slab_drain (SlabFreeList * list, guint cls, guint n)
+{
+  SlabDepot *depot = &slab_depots[cls];
+  SlabObject *head, *tail;
+  guint i;
+
+  if (n == 0)
+    return;
+
+  head = tail = list->head;
+  for (i = 1; i < n; i++)
+    tail = tail->next;
+  list->head = tail->next;
+  list->n_free -= n;
+
+  g_mutex_lock (&depot->lock);
+  tail->next = depot->head;
+  depot->head = head;
+  depot->n_free += n;
+  g_mutex_unlock (&depot->lock);
+}
+
+static void
+slab_thread_cache_free (gpointer data)
+{
+  SlabThreadCache *cache = data;
+  guint i;
+
+  for (i = 0; i < SLAB_N_CLASSES; i++)
+    slab_drain (&cache->lists[i], i, cache->lists[i].n_free);
+  g_free (cache);
+}
+
+static inline SlabThreadCache *
+slab_get_thread_cache (void)
+{
+  SlabThreadCache *cache;
+
+  cache = g_private_get (&slab_thread_cache);
+  if (G_UNLIKELY (cache == NULL)) {
+    cache = g_new0 (SlabThreadCache, 1);
+    g_private_set (&slab_thread_cache, cache);
+  }
+  return cache;
+}
+
+/* allocates an object of @size bytes, like g_slice_alloc(). The object must be
+ * freed with _priv_gst_slab_free() with the same @size */
+gpointer
+_priv_gst_slab_alloc (gsize size)
+{
+  SlabFreeList *list;
+  SlabObject *obj;
+  guint cls;
+
+  if (!slab_enabled || size > SLAB_MAX_SIZE)
+    return g_slice_alloc (size);
+
+  cls = slab_size_class (size);
+  list = &slab_get_thread_cache ()->lists[cls];
+  if (G_UNLIKELY (list->head == NULL))
+    slab_refill (list, cls);
+
+  obj = list->head;
+  list->head = obj->next;
+  list->n_free--;
+
+  return obj;
+}
+
+/* like _priv_gst_slab_alloc() but the object is cleared */
+gpointer
+_priv_gst_slab_alloc0 (gsize size)
+{
+  gpointer mem;
+
+  if (!slab_enabled || size > SLAB_MAX_SIZE)
+    return g_slice_alloc0 (size);
+
+  mem = _priv_gst_slab_alloc (size);
+  memset (mem, 0, size);
+
+  return mem;
+}
+
+/* frees an object allocated with _priv_gst_slab_alloc() */
+void
+_priv_gst_slab_free (gsize size, gpointer mem)
+{
+  SlabFreeList *list;
+  SlabObject *obj = mem;
+  guint cls;
+
+  if (!slab_enabled || size > SLAB_MAX_SIZE) {
+    g_slice_free1 (size, mem);
+    return;
+  }
+
+  cls = slab_size_class (size);
+  list = &slab_get_thread_cache ()->lists[cls];
+
+  obj->next = list->head;
+  list->head = obj;
+  if (G_UNLIKELY (++list->n_free > SLAB_CACHE_MAX))
+    slab_drain (list, cls, SLAB_BATCH);
+}
+
+/* called before any object is allocated, options have been parsed by now */
+void
+_priv_gst_slab_initialize (void)
+{
+  const gchar *env;
+  guint i;
+
+  if ((env = g_getenv ("GST_SLAB_ALLOCATOR")))
+    slab_enabled |= (strcmp (env, "yes") == 0);
+
+  for (i = 0; i < SLAB_N_CLASSES; i++)
+    g_mutex_init (&slab_depots[i].lock);
+
+  slab_initialized = TRUE;
+
+  GST_CAT_INFO (GST_CAT_MEMORY, "slab allocator %s",
+      slab_enabled ? "enabled" : "disabled");
+}
+
+/* can only be enabled before gst_init() is done */
+void
+_priv_gst_slab_set_enabled (gboolean enabled)
+{
+  g_return_if_fail (!slab_initialized);
+
+  slab_enabled = enabled;
+}
+
+void
+_priv_gst_slab_cleanup (void)
+{
+  guint i;
+
+  if (!slab_enabled)
+    return;
+
+  /* return the objects of this thread to the depot, the other threads do the
+   * same when they exit */
+  g_private_replace (&slab_thread_cache, NULL);
+
+  /* objects that are still alive or cached by another thread point into the
+   * blocks, only release the blocks of a size class when none are left */
+  for (i = 0; i < SLAB_N_CLASSES; i++) {
+    SlabDepot *depot = &slab_depots[i];
+
+    g_mutex_lock (&depot->lock);
+    if (depot->n_free == depot->n_objects) {
+      g_slist_free_full (depot->blocks, g_free);
+      depot->blocks = NULL;
+      depot->head = NULL;
+      depot->n_free = 0;
+      depot->n_objects = 0;
+    } else {
+      GST_CAT_DEBUG (GST_CAT_MEMORY, "%u slab objects of %u bytes still in use",
+          depot->n_objects - depot->n_free, 1 << (i + SLAB_MIN_SHIFT));
+    }
+    g_mutex_unlock (&depot->lock);
+  }
+}
@@ -103,6 +103,7 @@ struct _GstClockEntryFutex
   GDestroyNotify destroy_entry;
 
   gboolean initialized;
+  guint heap_pos;
 
   GMutex lock;
   guint cond_val;
@@ -176,6 +177,7 @@ struct _GstClockEntryPThread
   GDestroyNotify destroy_entry;
 
   gboolean initialized;
+  guint heap_pos;
 
   pthread_cond_t cond;
   pthread_mutex_t lock;
@@ -308,6 +310,7 @@ struct _GstClockEntryGLib
   GDestroyNotify destroy_entry;
 
   gboolean initialized;
+  guint heap_pos;
 
   GMutex lock;
   GCond cond;
@@ -344,15 +347,29 @@ ensure_entry_initialized (GstClockEntryImpl * entry_impl)
   }
 }
 
+/* An async entry in the heap of the system clock. Entries with the same time
+ * are ordered by seq so that they fire in the order they were added. */
+typedef struct
+{
+  GstClockEntry *entry;
+  guint64 seq;
+} AsyncEntry;
+
 struct _GstSystemClockPrivate
 {
   GThread *thread;              /* thread for async notify */
   gboolean stopping;
 
-  GList *entries;
+  /* binary min-heap of the pending async entries, the position of an entry is
+   * kept in its heap_pos (index + 1, 0 when not in the heap) */
+  AsyncEntry *entries;
+  guint n_entries;
+  guint entries_size;
+  guint64 entries_seq;
   GCond entries_changed;
 
   GstClockType clock_type;
+  GstClockTime coalesce_tolerance;
 
 #ifdef G_OS_WIN32
   LARGE_INTEGER frequency;
@@ -372,10 +389,13 @@ struct _GstSystemClockPrivate
 #define DEFAULT_CLOCK_TYPE GST_CLOCK_TYPE_MONOTONIC
 #endif
 
+#define DEFAULT_COALESCE_TOLERANCE 0
+
 enum
 {
   PROP_0,
   PROP_CLOCK_TYPE,
+  PROP_COALESCE_TOLERANCE,
   /* FILL ME */
 };
 
@@ -399,7 +419,7 @@ static GstClockReturn gst_system_clock_id_wait_jitter (GstClock * clock,
     GstClockEntry * entry, GstClockTimeDiff * jitter);
 static GstClockReturn gst_system_clock_id_wait_jitter_unlocked
     (GstClock * clock, GstClockEntry * entry, GstClockTimeDiff * jitter,
-    gboolean restart);
+    gboolean restart, GstClockTime min_wait);
 static GstClockReturn gst_system_clock_id_wait_async (GstClock * clock,
     GstClockEntry * entry);
 static void gst_system_clock_id_unschedule (GstClock * clock,
@@ -433,6 +453,23 @@ gst_system_clock_class_init (GstSystemClockClass * klass)
           GST_TYPE_CLOCK_TYPE, DEFAULT_CLOCK_TYPE,
           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
 
+  /**
+   * GstSystemClock:coalesce-tolerance:
+   *
+   * Asynchronous waits that are due within this time are considered to have
+   * timed out already. When many async waits are scheduled close to each
+   * other, their callbacks are then called in one go instead of waking up the
+   * async thread separately for each of them, at the cost of calling them up
+   * to this much too early.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_COALESCE_TOLERANCE,
+      g_param_spec_uint64 ("coalesce-tolerance", "Coalesce tolerance",
+          "Fire async waits that are due within this time right away (in ns)",
+          0, G_MAXINT64, DEFAULT_COALESCE_TOLERANCE,
+          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
   gstclock_class->get_internal_time = gst_system_clock_get_internal_time;
   gstclock_class->get_resolution = gst_system_clock_get_resolution;
   gstclock_class->wait = gst_system_clock_id_wait_jitter;
@@ -454,8 +491,11 @@ gst_system_clock_init (GstSystemClock * clock)
   clock->priv = priv = gst_system_clock_get_instance_private (clock);
 
   priv->clock_type = DEFAULT_CLOCK_TYPE;
+  priv->coalesce_tolerance = DEFAULT_COALESCE_TOLERANCE;
 
   priv->entries = NULL;
+  priv->n_entries = 0;
+  priv->entries_size = 0;
   g_cond_init (&priv->entries_changed);
 
 #ifdef G_OS_WIN32
@@ -480,14 +520,14 @@ gst_system_clock_dispose (GObject * object)
   GstClock *clock = (GstClock *) object;
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
-  GList *entries;
+  guint i;
 
   /* else we have to stop the thread */
   GST_SYSTEM_CLOCK_LOCK (clock);
   priv->stopping = TRUE;
   /* unschedule all entries */
-  for (entries = priv->entries; entries; entries = g_list_next (entries)) {
-    GstClockEntryImpl *entry = (GstClockEntryImpl *) entries->data;
+  for (i = 0; i < priv->n_entries; i++) {
+    GstClockEntryImpl *entry = (GstClockEntryImpl *) priv->entries[i].entry;
 
     /* We don't need to take the entry lock here because the async thread
      * would only ever look at the head entry, which is locked below and only
@@ -499,9 +539,9 @@ gst_system_clock_dispose (GObject * object)
      * this one, not all of them. Once the head entry is unscheduled it tries
      * to get the system clock lock (which we hold here) and then look for the
      * next entry. Once it gets the lock it will notice that all further
-     * entries are unscheduled, would remove them one by one from the list and
+     * entries are unscheduled, would remove them one by one from the heap and
      * then shut down. */
-    if (!entries->prev) {
+    if (i == 0) {
       /* it was initialized before adding to the list */
       g_assert (entry->initialized);
 
@@ -520,9 +560,13 @@ gst_system_clock_dispose (GObject * object)
   priv->thread = NULL;
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "joined thread");
 
-  g_list_foreach (priv->entries, (GFunc) gst_clock_id_unref, NULL);
-  g_list_free (priv->entries);
+  for (i = 0; i < priv->n_entries; i++) {
+    ((GstClockEntryImpl *) priv->entries[i].entry)->heap_pos = 0;
+    gst_clock_id_unref ((GstClockID) priv->entries[i].entry);
+  }
+  g_free (priv->entries);
   priv->entries = NULL;
+  priv->n_entries = priv->entries_size = 0;
 
   g_cond_clear (&priv->entries_changed);
 
@@ -546,6 +590,11 @@ gst_system_clock_set_property (GObject * object, guint prop_id,
       GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, sysclock, "clock-type set to %d",
           sysclock->priv->clock_type);
       break;
+    case PROP_COALESCE_TOLERANCE:
+      GST_SYSTEM_CLOCK_LOCK (sysclock);
+      sysclock->priv->coalesce_tolerance = g_value_get_uint64 (value);
+      GST_SYSTEM_CLOCK_UNLOCK (sysclock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -562,6 +611,11 @@ gst_system_clock_get_property (GObject * object, guint prop_id, GValue * value,
     case PROP_CLOCK_TYPE:
       g_value_set_enum (value, sysclock->priv->clock_type);
       break;
+    case PROP_COALESCE_TOLERANCE:
+      GST_SYSTEM_CLOCK_LOCK (sysclock);
+      g_value_set_uint64 (value, sysclock->priv->coalesce_tolerance);
+      GST_SYSTEM_CLOCK_UNLOCK (sysclock);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -647,6 +701,106 @@ gst_system_clock_obtain (void)
   return clock;
 }
 
+static inline gboolean
+async_entry_before (const AsyncEntry * a, const AsyncEntry * b)
+{
+  GstClockTime ta = GST_CLOCK_ENTRY_TIME (a->entry);
+  GstClockTime tb = GST_CLOCK_ENTRY_TIME (b->entry);
+
+  return ta < tb || (ta == tb && a->seq < b->seq);
+}
+
+static inline void
+entries_set (GstSystemClockPrivate * priv, guint i, AsyncEntry * aentry)
+{
+  priv->entries[i] = *aentry;
+  ((GstClockEntryImpl *) aentry->entry)->heap_pos = i + 1;
+}
+
+static void
+entries_sift_up (GstSystemClockPrivate * priv, guint i)
+{
+  AsyncEntry aentry = priv->entries[i];
+
+  while (i > 0) {
+    guint parent = (i - 1) / 2;
+
+    if (!async_entry_before (&aentry, &priv->entries[parent]))
+      break;
+    entries_set (priv, i, &priv->entries[parent]);
+    i = parent;
+  }
+  entries_set (priv, i, &aentry);
+}
+
+static void
+entries_sift_down (GstSystemClockPrivate * priv, guint i)
+{
+  AsyncEntry aentry = priv->entries[i];
+
+  for (;;) {
+    guint child = 2 * i + 1;
+
+    if (child >= priv->n_entries)
+      break;
+    if (child + 1 < priv->n_entries &&
+        async_entry_before (&priv->entries[child + 1], &priv->entries[child]))
+      child++;
+    if (!async_entry_before (&priv->entries[child], &aentry))
+      break;
+    entries_set (priv, i, &priv->entries[child]);
+    i = child;
+  }
+  entries_set (priv, i, &aentry);
+}
+
+/* Must be called with the clock lock, takes ownership of a ref */
+static void
+entries_push (GstSystemClockPrivate * priv, GstClockEntry * entry)
+{
+  if (priv->n_entries == priv->entries_size) {
+    priv->entries_size = MAX (16, priv->entries_size * 2);
+    priv->entries = g_renew (AsyncEntry, priv->entries, priv->entries_size);
+  }
+
+  priv->entries[priv->n_entries].entry = entry;
+  priv->entries[priv->n_entries].seq = priv->entries_seq++;
+  priv->n_entries++;
+  entries_sift_up (priv, priv->n_entries - 1);
+}
+
+/* Must be called with the clock lock. Reorders @entry after its time was
+ * changed, behind the other entries with the same time */
+static void
+entries_update (GstSystemClockPrivate * priv, GstClockEntry * entry)
+{
+  guint i = ((GstClockEntryImpl *) entry)->heap_pos - 1;
+
+  priv->entries[i].seq = priv->entries_seq++;
+  entries_sift_up (priv, i);
+  entries_sift_down (priv, ((GstClockEntryImpl *) entry)->heap_pos - 1);
+}
+
+/* Must be called with the clock lock, the ref of the heap is transferred to
+ * the caller */
+static void
+entries_remove (GstSystemClockPrivate * priv, GstClockEntry * entry)
+{
+  guint i = ((GstClockEntryImpl *) entry)->heap_pos - 1;
+  GstClockEntryImpl *last;
+
+  ((GstClockEntryImpl *) entry)->heap_pos = 0;
+  priv->n_entries--;
+  if (i == priv->n_entries)
+    return;
+
+  /* move the last entry into the hole and restore the heap order */
+  last = (GstClockEntryImpl *) priv->entries[priv->n_entries].entry;
+  entries_set (priv, i, &priv->entries[priv->n_entries]);
+  entries_sift_up (priv, i);
+  entries_sift_down (priv, last->heap_pos - 1);
+}
+
 /* this thread reads the sorted clock entries from the queue.
  *
  * It waits on each of them and fires the callback when the timeout occurs.
@@ -665,6 +819,7 @@ gst_system_clock_async_thread (GstClock * clock)
   GstSystemClock *sysclock = GST_SYSTEM_CLOCK_CAST (clock);
   GstSystemClockPrivate *priv = sysclock->priv;
   GstClockReturn status;
+  GstClockTime min_wait;
   gboolean entry_needs_unlock = FALSE;
 
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "enter system clock thread");
@@ -678,7 +833,7 @@ gst_system_clock_async_thread (GstClock * clock)
     GstClockReturn res;
 
     /* check if something to be done */
-    while (priv->entries == NULL) {
+    while (priv->n_entries == 0) {
       GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
           "no clock entries, waiting..");
       /* wait for work to do */
@@ -690,7 +845,7 @@ gst_system_clock_async_thread (GstClock * clock)
     }
 
     /* pick the next entry */
-    entry = priv->entries->data;
+    entry = priv->entries[0].entry;
 
     /* it was initialized before adding to the list */
     g_assert (((GstClockEntryImpl *) entry)->initialized);
@@ -720,6 +875,7 @@ gst_system_clock_async_thread (GstClock * clock)
     GST_CLOCK_ENTRY_STATUS (entry) = GST_CLOCK_BUSY;
 
     requested = entry->time;
+    min_wait = MAX (CLOCK_MIN_WAIT_TIME, priv->coalesce_tolerance);
 
     /* needs to be locked again before the next loop iteration, and we only
      * unlock it here so that gst_system_clock_id_wait_async() is guaranteed
@@ -732,7 +888,7 @@ gst_system_clock_async_thread (GstClock * clock)
     /* now wait for the entry */
     res =
         gst_system_clock_id_wait_jitter_unlocked (clock, (GstClockID) entry,
-        NULL, FALSE);
+        NULL, FALSE, min_wait);
 
     switch (res) {
       case GST_CLOCK_UNSCHEDULED:
@@ -761,9 +917,8 @@ gst_system_clock_async_thread (GstClock * clock)
           GST_SYSTEM_CLOCK_LOCK (clock);
           /* adjust time now */
           entry->time = requested + entry->interval;
-          /* and resort the list now */
-          priv->entries =
-              g_list_sort (priv->entries, gst_clock_id_compare_func);
+          /* and move it to its new place in the heap */
+          entries_update (priv, entry);
           /* and restart */
           continue;
         } else {
@@ -799,7 +954,7 @@ gst_system_clock_async_thread (GstClock * clock)
     GST_SYSTEM_CLOCK_LOCK (clock);
 
     /* we remove the current entry and unref it */
-    priv->entries = g_list_remove (priv->entries, entry);
+    entries_remove (priv, entry);
     gst_clock_id_unref ((GstClockID) entry);
   }
 exit:
@@ -948,7 +1103,8 @@ gst_system_clock_get_resolution (GstClock * clock)
  */
 static GstClockReturn
 gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
-    GstClockEntry * entry, GstClockTimeDiff * jitter, gboolean restart)
+    GstClockEntry * entry, GstClockTimeDiff * jitter, gboolean restart,
+    GstClockTime min_wait)
 {
   GstClockTime entryt, now;
   GstClockTimeDiff diff;
@@ -980,7 +1136,7 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
       " diff (time-now) %" G_GINT64_FORMAT,
       entry, GST_TIME_ARGS (entryt), GST_TIME_ARGS (now), diff);
 
-  if (G_LIKELY (diff > CLOCK_MIN_WAIT_TIME)) {
+  if (G_LIKELY (diff > (GstClockTimeDiff) min_wait)) {
 #ifdef WAIT_DEBUGGING
     GstClockTime final;
 #endif
@@ -1058,7 +1214,7 @@ gst_system_clock_id_wait_jitter_unlocked (GstClock * clock,
         now = gst_clock_get_time (clock);
         diff = GST_CLOCK_DIFF (now, entryt);
 
-        if (diff <= CLOCK_MIN_WAIT_TIME) {
+        if (diff <= (GstClockTimeDiff) min_wait) {
           /* timeout, this is fine, we can report success now */
           GST_CLOCK_ENTRY_STATUS (entry) = status = GST_CLOCK_OK;
           GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
@@ -1125,7 +1281,8 @@ gst_system_clock_id_wait_jitter (GstClock * clock, GstClockEntry * entry,
   GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "waiting on entry %p", entry);
 
   status =
-      gst_system_clock_id_wait_jitter_unlocked (clock, entry, jitter, TRUE);
+      gst_system_clock_id_wait_jitter_unlocked (clock, entry, jitter, TRUE,
+      CLOCK_MIN_WAIT_TIME);
 
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK (entry_impl);
 
@@ -1193,22 +1350,28 @@ gst_system_clock_id_wait_async (GstClock * clock, GstClockEntry * entry)
     goto was_unscheduled;
   GST_SYSTEM_CLOCK_ENTRY_UNLOCK ((GstClockEntryImpl *) entry);
 
-  if (priv->entries)
-    head = priv->entries->data;
+  if (priv->n_entries)
+    head = priv->entries[0].entry;
   else
     head = NULL;
 
-  /* need to take a ref */
-  gst_clock_id_ref ((GstClockID) entry);
+  if (G_UNLIKELY (((GstClockEntryImpl *) entry)->heap_pos != 0)) {
+    /* already pending: the entry is in the heap only once, so waiting on it
+     * again only replaces its callback, which is still called once */
+    GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock, "async entry %p already "
+        "pending", entry);
+  } else {
+    /* need to take a ref */
+    gst_clock_id_ref ((GstClockID) entry);
 
-  /* insert the entry in sorted order */
-  priv->entries = g_list_insert_sorted (priv->entries, entry,
-      gst_clock_id_compare_func);
+    /* insert the entry in sorted order */
+    entries_push (priv, entry);
+  }
 
   /* only need to send the signal if the entry was added to the
    * front, else the thread is just waiting for another entry and
    * will get to this entry automatically. */
-  if (priv->entries->data == entry) {
+  if (priv->entries[0].entry == entry && head != entry) {
     GST_CAT_DEBUG_OBJECT (GST_CAT_CLOCK, clock,
         "async entry added to head %p", head);
     if (head == NULL) {
@@ -65,6 +65,13 @@
  * name on Linux. Please note that the object name should be configured before the
  * task is started; changing the object name after the task has been started, has
  * no effect on the thread name.
+ *
+ * Since 1.22 a task can be made cooperative with gst_task_set_cooperative().
+ * Instead of a dedicated thread, every iteration of a cooperative task is then
+ * run as a separate job on a #GstWorkStealingTaskPool that is shared with other
+ * cooperative tasks. The task function must not block for long. When it has
+ * nothing to do it calls gst_task_sleep() and returns, and the task is not run
+ * again until gst_task_wakeup() is called, for example when new data arrives.
  */
 
 #include "gst_private.h"
@@ -106,6 +113,14 @@ struct _GstTaskPrivate
   /* remember the pool and id that is currently running. */
   gpointer id;
   GstTaskPool *pool_id;
+
+  /* cooperative scheduling, protected by the object lock */
+  gboolean cooperative;
+  gboolean coop_active;         /* running as jobs on a work-stealing pool */
+  gboolean scheduled;           /* a job is queued or running */
+  gboolean sleeping;            /* gst_task_sleep() called in this iteration */
+  gboolean wakeup;              /* gst_task_wakeup() called while scheduled */
+  gboolean entered;             /* enter_func called for the cooperative run */
 };
 
 #ifdef _MSC_VER
@@ -198,10 +213,13 @@ gst_task_win32_set_thread_name (const gchar * name)
 static void gst_task_finalize (GObject * object);
 
 static void gst_task_func (GstTask * task);
+static void gst_task_func_cooperative (GstTask * task);
+static gboolean schedule_cooperative (GstTask * task);
 
 static GMutex pool_lock;
 
 static GstTaskPool *_global_task_pool = NULL;
+static GstTaskPool *_cooperative_task_pool = NULL;
 
 #define _do_init \
 { \
@@ -351,6 +369,7 @@ gst_task_func (GstTask * task)
   GRecMutex *lock;
   GThread *tself;
   GstTaskPrivate *priv;
+  gboolean cooperative = FALSE;
 
   priv = task->priv;
 
@@ -402,6 +421,15 @@ gst_task_func (GstTask * task)
     }
 
     task->func (task->user_data);
+
+    /* the task was made cooperative, continue on the shared workers */
+    if (G_UNLIKELY (priv->cooperative)) {
+      GST_OBJECT_LOCK (task);
+      cooperative = priv->cooperative;
+      GST_OBJECT_UNLOCK (task);
+      if (cooperative)
+        break;
+    }
   }
 
   g_rec_mutex_unlock (lock);
@@ -417,6 +445,16 @@ exit:
     priv->leave_func (task, tself, priv->leave_user_data);
     GST_OBJECT_LOCK (task);
   }
+  if (cooperative) {
+    /* the jobs take over our ref and handle the current state */
+    GST_DEBUG ("Task %p continues cooperatively, thread %p", task, tself);
+    priv->coop_active = TRUE;
+    if (schedule_cooperative (task)) {
+      GST_OBJECT_UNLOCK (task);
+      return;
+    }
+    priv->coop_active = FALSE;
+  }
   /* now we allow messing with the lock again by setting the running flag to
    * %FALSE. Together with the SIGNAL this is the sign for the _join() to
    * complete.
@@ -440,6 +478,197 @@ no_lock:
   }
 }
 
+/* Called with the task LOCK */
+static GstTaskPool *
+get_cooperative_pool (GstTask * task)
+{
+  GstTaskPool *pool;
+
+  if (GST_IS_WORK_STEALING_TASK_POOL (task->priv->pool))
+    return gst_object_ref (task->priv->pool);
+
+  g_mutex_lock (&pool_lock);
+  if (_cooperative_task_pool == NULL) {
+    _cooperative_task_pool = gst_work_stealing_task_pool_new ();
+    gst_task_pool_prepare (_cooperative_task_pool, NULL);
+
+    /* only released in gst_task_cleanup_all() */
+    GST_OBJECT_FLAG_SET (_cooperative_task_pool,
+        GST_OBJECT_FLAG_MAY_BE_LEAKED);
+  }
+  pool = gst_object_ref (_cooperative_task_pool);
+  g_mutex_unlock (&pool_lock);
+
+  return pool;
+}
+
+/* queue one iteration of a cooperative task. Called with the task LOCK */
+static gboolean
+push_cooperative (GstTask * task)
+{
+  GstTaskPool *pool;
+  GError *error = NULL;
+  gpointer id;
+
+  pool = get_cooperative_pool (task);
+  id = gst_task_pool_push (pool,
+      (GstTaskPoolFunction) gst_task_func_cooperative, task, &error);
+  if (id)
+    gst_task_pool_dispose_handle (pool, id);
+  gst_object_unref (pool);
+
+  if (error != NULL) {
+    g_warning ("failed to schedule task: %s", error->message);
+    g_error_free (error);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* make sure a cooperative task runs at least once more. Called with the
+ * task LOCK */
+static gboolean
+schedule_cooperative (GstTask * task)
+{
+  GstTaskPrivate *priv = task->priv;
+
+  if (priv->scheduled)
+    return TRUE;
+
+  priv->scheduled = TRUE;
+  if (!push_cooperative (task)) {
+    priv->scheduled = FALSE;
+    return FALSE;
+  }
+  return TRUE;
+}
+
+/* one iteration of a cooperative task, run as a job on a work-stealing pool.
+ * The job owns the ref that start_task() took while the task is running. */
+static void
+gst_task_func_cooperative (GstTask * task)
+{
+  GRecMutex *lock;
+  GThread *tself;
+  GstTaskPrivate *priv;
+
+  priv = task->priv;
+
+  tself = g_thread_self ();
+
+  GST_OBJECT_LOCK (task);
+  switch (GET_TASK_STATE (task)) {
+    case GST_TASK_STOPPED:
+      goto exit;
+    case GST_TASK_PAUSED:
+      /* we are scheduled again when the state changes */
+      GST_INFO_OBJECT (task, "Task going to paused");
+      priv->scheduled = FALSE;
+      GST_TASK_SIGNAL (task);
+      GST_OBJECT_UNLOCK (task);
+      return;
+    case GST_TASK_STARTED:
+      break;
+  }
+
+  if (G_UNLIKELY (!priv->cooperative))
+    goto not_cooperative;
+
+  if (G_UNLIKELY (!priv->entered)) {
+    priv->entered = TRUE;
+    if (priv->enter_func) {
+      GST_OBJECT_UNLOCK (task);
+      priv->enter_func (task, tself, priv->enter_user_data);
+      GST_OBJECT_LOCK (task);
+    }
+  }
+  lock = GST_TASK_GET_LOCK (task);
+  priv->sleeping = FALSE;
+  priv->wakeup = FALSE;
+  task->thread = tself;
+  GST_OBJECT_UNLOCK (task);
+
+  g_rec_mutex_lock (lock);
+  /* the state might have changed while we waited for the lock */
+  if (G_LIKELY (GET_TASK_STATE (task) == GST_TASK_STARTED))
+    task->func (task->user_data);
+  g_rec_mutex_unlock (lock);
+
+  GST_OBJECT_LOCK (task);
+  task->thread = NULL;
+  if (priv->sleeping && !priv->wakeup && priv->cooperative &&
+      GET_TASK_STATE (task) == GST_TASK_STARTED) {
+    GST_LOG_OBJECT (task, "Task sleeping");
+    priv->scheduled = FALSE;
+    GST_OBJECT_UNLOCK (task);
+    return;
+  }
+
+  /* queue the next iteration behind the jobs that are already waiting */
+  if (G_UNLIKELY (!push_cooperative (task)))
+    goto exit;
+  GST_OBJECT_UNLOCK (task);
+
+  return;
+
+not_cooperative:
+  {
+    GError *error = NULL;
+
+    GST_DEBUG_OBJECT (task, "Task is not cooperative anymore");
+    /* nothing schedules jobs anymore, hand over our ref to a new thread */
+    priv->coop_active = FALSE;
+    priv->scheduled = FALSE;
+    if (priv->entered) {
+      priv->entered = FALSE;
+      if (priv->leave_func) {
+        GST_OBJECT_UNLOCK (task);
+        priv->leave_func (task, tself, priv->leave_user_data);
+        GST_OBJECT_LOCK (task);
+      }
+    }
+
+    if (priv->pool_id) {
+      if (priv->id)
+        gst_task_pool_dispose_handle (priv->pool_id, priv->id);
+      gst_object_unref (priv->pool_id);
+    }
+    priv->pool_id = gst_object_ref (priv->pool);
+    priv->id =
+        gst_task_pool_push (priv->pool_id, (GstTaskPoolFunction) gst_task_func,
+        task, &error);
+    if (error == NULL) {
+      GST_OBJECT_UNLOCK (task);
+      return;
+    }
+    g_warning ("failed to create thread: %s", error->message);
+    g_error_free (error);
+    goto exit;
+  }
+exit:
+  {
+    /* keep scheduled set while the lock is released below so that no new job
+     * is queued */
+    priv->coop_active = FALSE;
+    if (priv->entered) {
+      priv->entered = FALSE;
+      if (priv->leave_func) {
+        GST_OBJECT_UNLOCK (task);
+        priv->leave_func (task, tself, priv->leave_user_data);
+        GST_OBJECT_LOCK (task);
+      }
+    }
+    priv->scheduled = FALSE;
+    task->running = FALSE;
+    GST_TASK_SIGNAL (task);
+    GST_OBJECT_UNLOCK (task);
+
+    GST_DEBUG ("Exit cooperative task %p, thread %p", task, tself);
+
+    gst_object_unref (task);
+  }
+}
+
 /**
  * gst_task_cleanup_all:
  *
@@ -464,6 +693,14 @@ gst_task_cleanup_all (void)
     }
   }
 
+  g_mutex_lock (&pool_lock);
+  if (_cooperative_task_pool) {
+    gst_task_pool_cleanup (_cooperative_task_pool);
+    gst_object_unref (_cooperative_task_pool);
+    _cooperative_task_pool = NULL;
+  }
+  g_mutex_unlock (&pool_lock);
+
   /* GstElement owns a GThreadPool */
   _priv_gst_element_cleanup ();
 }
@@ -725,6 +962,11 @@ start_task (GstTask * task)
    * and exit the task function. */
   task->running = TRUE;
 
+  if (priv->cooperative) {
+    priv->coop_active = TRUE;
+    return schedule_cooperative (task);
+  }
+
   /* push on the thread pool, we remember the original pool because the user
    * could change it later on and then we join to the wrong pool. */
   priv->pool_id = gst_object_ref (priv->pool);
@@ -772,6 +1014,10 @@ gst_task_set_state_unlocked (GstTask * task, GstTaskState state)
          * iteration. */
         break;
     }
+    /* a paused or sleeping cooperative task is not scheduled, it has to
+     * run to go to the new state */
+    if (task->priv->coop_active && state != GST_TASK_PAUSED)
+      res = schedule_cooperative (task);
   }
 
   return res;
@@ -936,6 +1182,9 @@ gst_task_join (GstTask * task)
   SET_TASK_STATE (task, GST_TASK_STOPPED);
   /* signal the state change for when it was blocked in PAUSED. */
   GST_TASK_SIGNAL (task);
+  /* cooperative tasks have to be scheduled to notice */
+  if (priv->coop_active)
+    schedule_cooperative (task);
   /* we set the running flag when pushing the task on the thread pool.
    * This means that the task function might not be called when we try
    * to join it here. */
@@ -972,3 +1221,126 @@ joining_self:
     return FALSE;
   }
 }
+
+/**
+ * gst_task_set_cooperative:
+ * @task: a #GstTask
+ * @cooperative: whether @task is cooperative
+ *
+ * Make @task cooperative. Instead of a dedicated thread from the pool of
+ * @task, every call of the task function is then run as a separate job on a
+ * #GstWorkStealingTaskPool: the pool of @task if it is one, or a pool that is
+ * shared by all cooperative tasks otherwise. Other tasks run on the same
+ * worker threads, so the task function must return instead of blocking. When
+ * it has nothing to do, it calls gst_task_sleep() before returning.
+ *
+ * The enter and leave callbacks are called when the task starts and stops
+ * running cooperatively, with the worker thread that is used at that point.
+ *
+ * When @task is running, the change takes effect after the current call of
+ * the task function.
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+void
+gst_task_set_cooperative (GstTask * task, gboolean cooperative)
+{
+  GstTaskPrivate *priv;
+
+  g_return_if_fail (GST_IS_TASK (task));
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  priv->cooperative = cooperative;
+  /* a sleeping task has to run to hand over to a thread */
+  if (!cooperative && priv->coop_active)
+    schedule_cooperative (task);
+  GST_OBJECT_UNLOCK (task);
+}
+
+/**
+ * gst_task_get_cooperative:
+ * @task: a #GstTask
+ *
+ * Returns: %TRUE if @task is cooperative
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_task_get_cooperative (GstTask * task)
+{
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  GST_OBJECT_LOCK (task);
+  res = task->priv->cooperative;
+  GST_OBJECT_UNLOCK (task);
+
+  return res;
+}
+
+/**
+ * gst_task_sleep:
+ * @task: a #GstTask
+ *
+ * Called from the task function of a cooperative @task to not have it called
+ * again after it returns, until gst_task_wakeup() is called or the state of
+ * @task changes. Calls of gst_task_wakeup() that happen before the task
+ * function returns are not lost.
+ *
+ * Returns: %TRUE if @task will sleep, %FALSE if @task is not cooperative, in
+ * which case the task function has to wait as usual.
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+gboolean
+gst_task_sleep (GstTask * task)
+{
+  gboolean res;
+
+  g_return_val_if_fail (GST_IS_TASK (task), FALSE);
+
+  GST_OBJECT_LOCK (task);
+  res = task->priv->cooperative;
+  if (res)
+    task->priv->sleeping = TRUE;
+  GST_OBJECT_UNLOCK (task);
+
+  return res;
+}
+
+/**
+ * gst_task_wakeup:
+ * @task: a #GstTask
+ *
+ * Schedule the task function of a cooperative @task that went to sleep with
+ * gst_task_sleep(). This does nothing for tasks that are not cooperative.
+ *
+ * MT safe.
+ *
+ * Since: 1.22
+ */
+void
+gst_task_wakeup (GstTask * task)
+{
+  GstTaskPrivate *priv;
+
+  g_return_if_fail (GST_IS_TASK (task));
+
+  priv = task->priv;
+
+  GST_OBJECT_LOCK (task);
+  if (priv->scheduled)
+    priv->wakeup = TRUE;
+  else if (priv->coop_active && GET_TASK_STATE (task) == GST_TASK_STARTED)
+    schedule_cooperative (task);
+  GST_OBJECT_UNLOCK (task);
+}
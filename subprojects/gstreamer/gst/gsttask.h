@@ -214,6 +214,18 @@ gboolean        gst_task_resume         (GstTask *task);
 GST_API
 gboolean        gst_task_join           (GstTask *task);
 
+GST_API
+void            gst_task_set_cooperative (GstTask *task, gboolean cooperative);
+
+GST_API
+gboolean        gst_task_get_cooperative (GstTask *task);
+
+GST_API
+gboolean        gst_task_sleep          (GstTask *task);
+
+GST_API
+void            gst_task_wakeup         (GstTask *task);
+
 GST_API
 void            gst_task_class_set_default_task_pool_type (GType type);
 
@@ -28,6 +28,10 @@
  * This object provides an abstraction for creating threads. The default
  * implementation uses a regular GThreadPool to start tasks.
  *
+ * #GstSharedTaskPool runs the tasks on a limited number of threads and
+ * #GstWorkStealingTaskPool runs short, non-blocking jobs such as the
+ * iterations of cooperative #GstTask on one worker thread per processor.
+ *
  * Subclasses can be made to create custom threads.
  */
 
@@ -547,3 +551,358 @@ gst_shared_task_pool_new (void)
 
   return pool;
 }
+
+/* One set of worker threads, created in prepare and freed in cleanup */
+typedef struct _WorkerGroup WorkerGroup;
+
+typedef struct
+{
+  WorkerGroup *group;
+  guint index;
+  GThread *thread;
+
+  GMutex lock;
+  GQueue jobs;                  /* TaskData, protected by lock */
+} Worker;
+
+struct _WorkerGroup
+{
+  Worker *workers;
+  guint n_workers;
+
+  gint n_pending;               /* atomic, jobs queued on all workers */
+  gint n_idle;                  /* atomic, workers waiting for jobs */
+  gint next;                    /* atomic, round robin for foreign pushes */
+
+  GMutex idle_lock;
+  GCond idle_cond;
+  gboolean shutdown;            /* protected by idle_lock */
+};
+
+struct _GstWorkStealingTaskPoolPrivate
+{
+  guint n_threads;
+
+  /* protected by the object lock */
+  WorkerGroup *group;
+};
+
+#define GST_WORK_STEALING_TASK_POOL_CAST(pool) ((GstWorkStealingTaskPool*)(pool))
+
+G_DEFINE_TYPE_WITH_PRIVATE (GstWorkStealingTaskPool,
+    gst_work_stealing_task_pool, GST_TYPE_TASK_POOL);
+
+/* the worker running in the current thread, if any */
+static GPrivate current_worker;
+
+static TaskData *
+work_stealing_pop (Worker * self)
+{
+  WorkerGroup *group = self->group;
+  TaskData *tdata;
+  guint i;
+
+  g_mutex_lock (&self->lock);
+  tdata = g_queue_pop_head (&self->jobs);
+  g_mutex_unlock (&self->lock);
+
+  /* nothing to do here, take the oldest job of one of the other workers */
+  for (i = 1; tdata == NULL && i < group->n_workers; i++) {
+    Worker *victim = &group->workers[(self->index + i) % group->n_workers];
+
+    g_mutex_lock (&victim->lock);
+    tdata = g_queue_pop_head (&victim->jobs);
+    g_mutex_unlock (&victim->lock);
+  }
+
+  if (tdata)
+    g_atomic_int_add (&group->n_pending, -1);
+
+  return tdata;
+}
+
+static gpointer
+work_stealing_worker_func (Worker * self)
+{
+  WorkerGroup *group = self->group;
+  TaskData *tdata;
+
+  g_private_set (&current_worker, self);
+
+  for (;;) {
+    if ((tdata = work_stealing_pop (self))) {
+      default_func (tdata, NULL);
+      continue;
+    }
+
+    /* n_pending is incremented before n_idle is checked in push, so either
+     * we see the new job here or the pusher sees us idle and signals */
+    g_mutex_lock (&group->idle_lock);
+    g_atomic_int_inc (&group->n_idle);
+    while (g_atomic_int_get (&group->n_pending) == 0 && !group->shutdown)
+      g_cond_wait (&group->idle_cond, &group->idle_lock);
+    g_atomic_int_add (&group->n_idle, -1);
+    if (group->shutdown && g_atomic_int_get (&group->n_pending) == 0) {
+      g_mutex_unlock (&group->idle_lock);
+      break;
+    }
+    g_mutex_unlock (&group->idle_lock);
+  }
+
+  g_private_set (&current_worker, NULL);
+
+  return NULL;
+}
+
+static void
+worker_group_free (WorkerGroup * group)
+{
+  guint i;
+
+  for (i = 0; i < group->n_workers; i++) {
+    Worker *worker = &group->workers[i];
+
+    /* the workers only exit when all queued jobs ran */
+    g_warn_if_fail (g_queue_is_empty (&worker->jobs));
+    g_mutex_clear (&worker->lock);
+  }
+  g_mutex_clear (&group->idle_lock);
+  g_cond_clear (&group->idle_cond);
+  g_free (group->workers);
+  g_free (group);
+}
+
+static void
+work_stealing_prepare (GstTaskPool * pool, GError ** error)
+{
+  GstWorkStealingTaskPool *ws_pool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  WorkerGroup *group;
+  guint i, n_threads;
+
+  GST_OBJECT_LOCK (pool);
+  if (ws_pool->priv->group) {
+    GST_OBJECT_UNLOCK (pool);
+    return;
+  }
+
+  n_threads = ws_pool->priv->n_threads;
+  if (n_threads == 0)
+    n_threads = g_get_num_processors ();
+
+  group = g_new0 (WorkerGroup, 1);
+  group->workers = g_new0 (Worker, n_threads);
+  group->n_workers = n_threads;
+  g_mutex_init (&group->idle_lock);
+  g_cond_init (&group->idle_cond);
+
+  for (i = 0; i < n_threads; i++) {
+    Worker *worker = &group->workers[i];
+
+    worker->group = group;
+    worker->index = i;
+    g_mutex_init (&worker->lock);
+    g_queue_init (&worker->jobs);
+  }
+
+  for (i = 0; i < n_threads; i++) {
+    Worker *worker = &group->workers[i];
+    gchar *name = g_strdup_printf ("gstworker%u", i);
+
+    worker->thread = g_thread_try_new (name,
+        (GThreadFunc) work_stealing_worker_func, worker, error);
+    g_free (name);
+    if (worker->thread == NULL)
+      break;
+  }
+
+  if (i < n_threads) {
+    GST_WARNING_OBJECT (pool, "could only start %u of %u workers", i,
+        n_threads);
+
+    g_mutex_lock (&group->idle_lock);
+    group->shutdown = TRUE;
+    g_cond_broadcast (&group->idle_cond);
+    g_mutex_unlock (&group->idle_lock);
+
+    while (i > 0)
+      g_thread_join (group->workers[--i].thread);
+    worker_group_free (group);
+    group = NULL;
+  } else {
+    GST_DEBUG_OBJECT (pool, "started %u workers", n_threads);
+  }
+
+  ws_pool->priv->group = group;
+  GST_OBJECT_UNLOCK (pool);
+}
+
+static void
+work_stealing_cleanup (GstTaskPool * pool)
+{
+  GstWorkStealingTaskPool *ws_pool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  WorkerGroup *group;
+  guint i;
+
+  GST_OBJECT_LOCK (pool);
+  group = ws_pool->priv->group;
+  ws_pool->priv->group = NULL;
+  GST_OBJECT_UNLOCK (pool);
+
+  if (group == NULL)
+    return;
+
+  /* like the default pool, the jobs that are already queued still run */
+  g_mutex_lock (&group->idle_lock);
+  group->shutdown = TRUE;
+  g_cond_broadcast (&group->idle_cond);
+  g_mutex_unlock (&group->idle_lock);
+
+  for (i = 0; i < group->n_workers; i++)
+    g_thread_join (group->workers[i].thread);
+
+  worker_group_free (group);
+}
+
+static gpointer
+work_stealing_push (GstTaskPool * pool, GstTaskPoolFunction func,
+    gpointer user_data, GError ** error)
+{
+  GstWorkStealingTaskPool *ws_pool = GST_WORK_STEALING_TASK_POOL_CAST (pool);
+  WorkerGroup *group;
+  Worker *worker;
+  TaskData *tdata;
+  gboolean wake;
+
+  GST_OBJECT_LOCK (pool);
+  group = ws_pool->priv->group;
+  if (group == NULL) {
+    GST_OBJECT_UNLOCK (pool);
+    g_set_error_literal (error, GST_CORE_ERROR, GST_CORE_ERROR_FAILED,
+        "No thread pool");
+    return NULL;
+  }
+
+  tdata = g_slice_new (TaskData);
+  tdata->func = func;
+  tdata->user_data = user_data;
+
+  /* jobs pushed from a worker stay with it, it runs them as soon as the
+   * current job returns. There is no need to wake up anyone else unless the
+   * worker has a backlog. */
+  worker = g_private_get (&current_worker);
+  if (worker == NULL || worker->group != group) {
+    guint next = (guint) g_atomic_int_add (&group->next, 1);
+
+    worker = &group->workers[next % group->n_workers];
+    wake = TRUE;
+  } else {
+    wake = FALSE;
+  }
+
+  g_atomic_int_inc (&group->n_pending);
+  g_mutex_lock (&worker->lock);
+  if (!g_queue_is_empty (&worker->jobs))
+    wake = TRUE;
+  g_queue_push_tail (&worker->jobs, tdata);
+  g_mutex_unlock (&worker->lock);
+
+  if (wake && g_atomic_int_get (&group->n_idle) > 0) {
+    g_mutex_lock (&group->idle_lock);
+    g_cond_signal (&group->idle_cond);
+    g_mutex_unlock (&group->idle_lock);
+  }
+  GST_OBJECT_UNLOCK (pool);
+
+  return NULL;
+}
+
+static void
+gst_work_stealing_task_pool_class_init (GstWorkStealingTaskPoolClass * klass)
+{
+  GstTaskPoolClass *taskpoolclass = GST_TASK_POOL_CLASS (klass);
+
+  taskpoolclass->prepare = work_stealing_prepare;
+  taskpoolclass->cleanup = work_stealing_cleanup;
+  taskpoolclass->push = work_stealing_push;
+}
+
+static void
+gst_work_stealing_task_pool_init (GstWorkStealingTaskPool * pool)
+{
+  pool->priv = gst_work_stealing_task_pool_get_instance_private (pool);
+}
+
+/**
+ * gst_work_stealing_task_pool_set_n_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ * @n_threads: the number of worker threads, 0 for one per processor
+ *
+ * Set the number of worker threads @pool starts. This only takes effect on
+ * the next gst_task_pool_prepare().
+ *
+ * Since: 1.22
+ */
+void
+gst_work_stealing_task_pool_set_n_threads (GstWorkStealingTaskPool * pool,
+    guint n_threads)
+{
+  g_return_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool));
+
+  GST_OBJECT_LOCK (pool);
+  pool->priv->n_threads = n_threads;
+  GST_OBJECT_UNLOCK (pool);
+}
+
+/**
+ * gst_work_stealing_task_pool_get_n_threads:
+ * @pool: a #GstWorkStealingTaskPool
+ *
+ * Returns: the number of worker threads @pool is configured to start, 0
+ * meaning one per processor
+ *
+ * Since: 1.22
+ */
+guint
+gst_work_stealing_task_pool_get_n_threads (GstWorkStealingTaskPool * pool)
+{
+  guint ret;
+
+  g_return_val_if_fail (GST_IS_WORK_STEALING_TASK_POOL (pool), 0);
+
+  GST_OBJECT_LOCK (pool);
+  ret = pool->priv->n_threads;
+  GST_OBJECT_UNLOCK (pool);
+
+  return ret;
+}
+
+/**
+ * gst_work_stealing_task_pool_new:
+ *
+ * Create a new work-stealing task pool. The pool runs the pushed functions on
+ * a fixed set of worker threads, one per processor by default. Every worker
+ * has its own queue of jobs: functions pushed from a worker are queued on that
+ * worker and idle workers take jobs from the others.
+ *
+ * The pushed functions must not block, as they hold up all other jobs of the
+ * worker until they return. This pool is meant for cooperative tasks, see
+ * gst_task_set_cooperative(). gst_task_pool_push() always returns %NULL and
+ * joining is not supported.
+ *
+ * Returns: (transfer full): a new #GstWorkStealingTaskPool. gst_object_unref()
+ * after usage.
+ *
+ * Since: 1.22
+ */
+GstTaskPool *
+gst_work_stealing_task_pool_new (void)
+{
+  GstTaskPool *pool;
+
+  pool = g_object_new (GST_TYPE_WORK_STEALING_TASK_POOL, NULL);
+
+  /* clear floating flag */
+  gst_object_ref_sink (pool);
+
+  return pool;
+}
@@ -56,7 +56,7 @@ static const gchar *_quark_strings[] = {
   "object-destroyed", "mini-object-reffed", "mini-object-unreffed",
   "object-reffed", "object-unreffed", "plugin-feature-loaded",
   "pad-chain-pre", "pad-chain-post", "pad-chain-list-pre",
-  "pad-chain-list-post",
+  "pad-chain-list-post", "clock-wait-pre", "clock-wait-post",
 };
 
 GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
@@ -66,6 +66,18 @@ GQuark _priv_gst_tracer_quark_table[GST_TRACER_QUARK_MAX];
 gboolean _priv_tracer_enabled = FALSE;
 GHashTable *_priv_tracers = NULL;
 
+/* the hook arrays that are dispatched from, a hook without tracers points to
+ * the shared empty array */
+G_STATIC_ASSERT (GST_TRACER_QUARK_MAX <= 64);
+static GstTracerHook *_no_hooks[1] = { NULL };
+
+GstTracerHook **_priv_tracer_hooks[GST_TRACER_QUARK_MAX];
+guint64 _priv_tracer_enabled_hooks = 0;
+
+/* arrays that were replaced while a hook might still be dispatching from them,
+ * they are freed in _priv_gst_tracing_deinit() */
+static GSList *_retired_hooks = NULL;
+
 /* Initialize the tracing system */
 void
 _priv_gst_tracing_init (void)
@@ -78,6 +90,8 @@ _priv_gst_tracing_init (void)
    * so that external tools can use it anyway */
   GST_DEBUG ("Initializing GstTracer");
   _priv_tracers = g_hash_table_new (NULL, NULL);
+  for (i = 0; i < GST_TRACER_QUARK_MAX; i++)
+    _priv_tracer_hooks[i] = _no_hooks;
 
   if (G_N_ELEMENTS (_quark_strings) != GST_TRACER_QUARK_MAX)
     g_warning ("the quark table is not consistent! %d != %d",
@@ -144,11 +158,21 @@ _priv_gst_tracing_deinit (void)
 {
   GList *h_list, *h_node, *t_node;
   GstTracerHook *hook;
+  gint i;
 
   _priv_tracer_enabled = FALSE;
+  _priv_tracer_enabled_hooks = 0;
   if (!_priv_tracers)
     return;
 
+  for (i = 0; i < GST_TRACER_QUARK_MAX; i++) {
+    if (_priv_tracer_hooks[i] != _no_hooks)
+      g_free (_priv_tracer_hooks[i]);
+    _priv_tracer_hooks[i] = _no_hooks;
+  }
+  g_slist_free_full (_retired_hooks, g_free);
+  _retired_hooks = NULL;
+
   /* shutdown tracers for final reports */
   h_list = g_hash_table_get_values (_priv_tracers);
   for (h_node = h_list; h_node; h_node = g_list_next (h_node)) {
@@ -164,12 +188,47 @@ _priv_gst_tracing_deinit (void)
   _priv_tracers = NULL;
 }
 
+/* rebuilds the dispatch array of hook @id from the hooks registered for it
+ * and the hooks registered for all details */
+static void
+gst_tracing_update_hooks (gint id)
+{
+  GList *list, *all, *node;
+  GstTracerHook **hooks, **old;
+  guint n = 0;
+
+  list = g_hash_table_lookup (_priv_tracers,
+      GINT_TO_POINTER (_priv_gst_tracer_quark_table[id]));
+  all = g_hash_table_lookup (_priv_tracers, NULL);
+
+  hooks = g_new (GstTracerHook *, g_list_length (list) + g_list_length (all)
+      + 1);
+  for (node = list; node; node = g_list_next (node))
+    hooks[n++] = node->data;
+  for (node = all; node; node = g_list_next (node))
+    hooks[n++] = node->data;
+  hooks[n] = NULL;
+
+  /* a hook might be running from the old array in another thread */
+  old = _priv_tracer_hooks[id];
+  g_atomic_pointer_set (&_priv_tracer_hooks[id], hooks);
+  if (old != _no_hooks)
+    _retired_hooks = g_slist_prepend (_retired_hooks, old);
+
+  if (n > 0)
+    _priv_tracer_enabled_hooks |= G_GUINT64_CONSTANT (1) << id;
+}
+
 static void
 gst_tracing_register_hook_id (GstTracer * tracer, GQuark detail, GCallback func)
 {
   gpointer key = GINT_TO_POINTER (detail);
-  GList *list = g_hash_table_lookup (_priv_tracers, key);
-  GstTracerHook *hook = g_slice_new0 (GstTracerHook);
+  GList *list;
+  GstTracerHook *hook;
+  gint i, id = -1;
+
+  list = g_hash_table_lookup (_priv_tracers, key);
+  hook = g_slice_new0 (GstTracerHook);
   hook->tracer = gst_object_ref (tracer);
   hook->func = func;
 
@@ -177,6 +236,22 @@ gst_tracing_register_hook_id (GstTracer * tracer, GQuark detail, GCallback func)
   g_hash_table_replace (_priv_tracers, key, list);
   GST_DEBUG ("registering tracer for '%s', list.len=%d",
       (detail ? g_quark_to_string (detail) : "*"), g_list_length (list));
+
+  if (detail) {
+    for (i = 0; i < GST_TRACER_QUARK_MAX; i++) {
+      if (_priv_gst_tracer_quark_table[i] == detail) {
+        id = i;
+        break;
+      }
+    }
+    if (id != -1)
+      gst_tracing_update_hooks (id);
+    else
+      GST_DEBUG ("no hook named '%s'", g_quark_to_string (detail));
+  } else {
+    for (i = 0; i < GST_TRACER_QUARK_MAX; i++)
+      gst_tracing_update_hooks (i);
+  }
   _priv_tracer_enabled = TRUE;
 }
 
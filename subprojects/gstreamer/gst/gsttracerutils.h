@@ -84,6 +84,8 @@ typedef enum /*< skip >*/
   GST_TRACER_QUARK_HOOK_PAD_CHAIN_POST,
   GST_TRACER_QUARK_HOOK_PAD_CHAIN_LIST_PRE,
   GST_TRACER_QUARK_HOOK_PAD_CHAIN_LIST_POST,
+  GST_TRACER_QUARK_HOOK_CLOCK_WAIT_PRE,
+  GST_TRACER_QUARK_HOOK_CLOCK_WAIT_POST,
   GST_TRACER_QUARK_MAX
 } GstTracerQuarkId;
 
@@ -101,28 +103,29 @@ typedef struct {
 extern gboolean _priv_tracer_enabled;
 /* key are hook-id quarks, values are GstTracerHook */
 extern GHashTable *_priv_tracers;
+/* %NULL terminated arrays of the hooks to call for each GstTracerQuarkId,
+ * rebuilt from _priv_tracers when a hook is registered */
+extern GstTracerHook **_priv_tracer_hooks[GST_TRACER_QUARK_MAX];
+/* bit per GstTracerQuarkId that has hooks */
+extern guint64 _priv_tracer_enabled_hooks;
 
 #define GST_TRACER_IS_ENABLED (_priv_tracer_enabled)
 
+#define GST_TRACER_HOOK_IS_ENABLED(id) \
+  G_UNLIKELY (_priv_tracer_enabled_hooks & (G_GUINT64_CONSTANT (1) << (id)))
+
 #define GST_TRACER_TS \
   GST_CLOCK_DIFF (_priv_gst_start_time, gst_util_get_timestamp ())
 
 /* tracing hooks */
 
 #define GST_TRACER_ARGS h->tracer, ts
-#define GST_TRACER_DISPATCH(key,type,args) G_STMT_START{ \
-  if (GST_TRACER_IS_ENABLED) {                                         \
+#define GST_TRACER_DISPATCH(id,type,args) G_STMT_START{ \
+  if (GST_TRACER_HOOK_IS_ENABLED (id)) {                               \
     GstClockTime ts = GST_TRACER_TS;                                   \
-    GList *__l, *__n;                                                  \
-    GstTracerHook *h;                                                  \
-    __l = g_hash_table_lookup (_priv_tracers, GINT_TO_POINTER (key));  \
-    for (__n = __l; __n; __n = g_list_next (__n)) {                    \
-      h = (GstTracerHook *) __n->data;                                 \
-      ((type)(h->func)) args;                                          \
-    }                                                                  \
-    __l = g_hash_table_lookup (_priv_tracers, NULL);                   \
-    for (__n = __l; __n; __n = g_list_next (__n)) {                    \
-      h = (GstTracerHook *) __n->data;                                 \
+    GstTracerHook **__h, *h;                                           \
+    __h = g_atomic_pointer_get (&_priv_tracer_hooks[id]);              \
+    for (; (h = *__h); __h++) {                                        \
       ((type)(h->func)) args;                                          \
     }                                                                  \
   }                                                                    \
@@ -140,7 +143,7 @@ extern GHashTable *_priv_tracers;
 typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer);
 #define GST_TRACER_PAD_PUSH_PRE(pad, buffer) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_PRE, \
     GstTracerHookPadPushPre, (GST_TRACER_ARGS, pad, buffer)); \
 }G_STMT_END
 
@@ -156,7 +159,7 @@ typedef void (*GstTracerHookPadPushPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
     GstPad *pad, GstFlowReturn res);
 #define GST_TRACER_PAD_PUSH_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_POST, \
     GstTracerHookPadPushPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -172,7 +175,7 @@ typedef void (*GstTracerHookPadPushPost) (GObject * self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushListPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBufferList *list);
 #define GST_TRACER_PAD_PUSH_LIST_PRE(pad, list) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_LIST_PRE, \
     GstTracerHookPadPushListPre, (GST_TRACER_ARGS, pad, list)); \
 }G_STMT_END
 
@@ -189,7 +192,7 @@ typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
     GstPad *pad,
     GstFlowReturn res);
 #define GST_TRACER_PAD_PUSH_LIST_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_LIST_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_LIST_POST, \
     GstTracerHookPadPushListPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -206,7 +209,7 @@ typedef void (*GstTracerHookPadPushListPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
     GstPad *pad, guint64 offset, guint size);
 #define GST_TRACER_PAD_PULL_RANGE_PRE(pad, offset, size) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PULL_RANGE_PRE, \
     GstTracerHookPadPullRangePre, (GST_TRACER_ARGS, pad, offset, size)); \
 }G_STMT_END
 
@@ -223,7 +226,7 @@ typedef void (*GstTracerHookPadPullRangePre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPullRangePost) (GObject *self, GstClockTime ts,
     GstPad *pad, GstBuffer *buffer, GstFlowReturn res);
 #define GST_TRACER_PAD_PULL_RANGE_POST(pad, buffer, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PULL_RANGE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PULL_RANGE_POST, \
     GstTracerHookPadPullRangePost, (GST_TRACER_ARGS, pad, buffer, res)); \
 }G_STMT_END
 
@@ -239,7 +242,7 @@ typedef void (*GstTracerHookPadPullRangePost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushEventPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstEvent *event);
 #define GST_TRACER_PAD_PUSH_EVENT_PRE(pad, event) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_EVENT_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_EVENT_PRE, \
     GstTracerHookPadPushEventPre, (GST_TRACER_ARGS, pad, event)); \
 }G_STMT_END
 
@@ -255,7 +258,7 @@ typedef void (*GstTracerHookPadPushEventPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadPushEventPost) (GObject *self, GstClockTime ts,
     GstPad *pad, gboolean res);
 #define GST_TRACER_PAD_PUSH_EVENT_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_PUSH_EVENT_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_PUSH_EVENT_POST, \
     GstTracerHookPadPushEventPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -271,7 +274,7 @@ typedef void (*GstTracerHookPadPushEventPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadQueryPre) (GObject *self, GstClockTime ts,
     GstPad *pad, GstQuery *query);
 #define GST_TRACER_PAD_QUERY_PRE(pad, query) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_QUERY_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_QUERY_PRE, \
     GstTracerHookPadQueryPre, (GST_TRACER_ARGS, pad, query)); \
 }G_STMT_END
 
@@ -288,7 +291,7 @@ typedef void (*GstTracerHookPadQueryPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadQueryPost) (GObject *self, GstClockTime ts,
     GstPad *pad, GstQuery *query, gboolean res);
 #define GST_TRACER_PAD_QUERY_POST(pad, query, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_QUERY_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_QUERY_POST, \
     GstTracerHookPadQueryPost, (GST_TRACER_ARGS, pad, query, res)); \
 }G_STMT_END
 
@@ -304,7 +307,7 @@ typedef void (*GstTracerHookPadQueryPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementPostMessagePre) (GObject *self,
     GstClockTime ts, GstElement *element, GstMessage *message);
 #define GST_TRACER_ELEMENT_POST_MESSAGE_PRE(element, message) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_POST_MESSAGE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_POST_MESSAGE_PRE, \
     GstTracerHookElementPostMessagePre, (GST_TRACER_ARGS, element, message)); \
 }G_STMT_END
 
@@ -320,7 +323,7 @@ typedef void (*GstTracerHookElementPostMessagePre) (GObject *self,
 typedef void (*GstTracerHookElementPostMessagePost) (GObject *self,
     GstClockTime ts, GstElement *element, gboolean res);
 #define GST_TRACER_ELEMENT_POST_MESSAGE_POST(element, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_POST_MESSAGE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_POST_MESSAGE_POST, \
     GstTracerHookElementPostMessagePost, (GST_TRACER_ARGS, element, res)); \
 }G_STMT_END
 
@@ -336,7 +339,7 @@ typedef void (*GstTracerHookElementPostMessagePost) (GObject *self,
 typedef void (*GstTracerHookElementQueryPre) (GObject *self, GstClockTime ts,
     GstElement *element, GstQuery *query);
 #define GST_TRACER_ELEMENT_QUERY_PRE(element, query) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_QUERY_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_QUERY_PRE, \
     GstTracerHookElementQueryPre, (GST_TRACER_ARGS, element, query)); \
 }G_STMT_END
 
@@ -353,7 +356,7 @@ typedef void (*GstTracerHookElementQueryPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementQueryPost) (GObject *self, GstClockTime ts,
     GstElement *element, GstQuery *query, gboolean res);
 #define GST_TRACER_ELEMENT_QUERY_POST(element, query, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_QUERY_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_QUERY_POST, \
     GstTracerHookElementQueryPost, (GST_TRACER_ARGS, element, query, res)); \
 }G_STMT_END
 
@@ -368,7 +371,7 @@ typedef void (*GstTracerHookElementQueryPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementNew) (GObject *self, GstClockTime ts,
     GstElement *element);
 #define GST_TRACER_ELEMENT_NEW(element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_NEW), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_NEW, \
     GstTracerHookElementNew, (GST_TRACER_ARGS, element)); \
 }G_STMT_END
 
@@ -384,7 +387,7 @@ typedef void (*GstTracerHookElementNew) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementAddPad) (GObject *self, GstClockTime ts,
     GstElement *element, GstPad *pad);
 #define GST_TRACER_ELEMENT_ADD_PAD(element, pad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_ADD_PAD), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_ADD_PAD, \
     GstTracerHookElementAddPad, (GST_TRACER_ARGS, element, pad)); \
 }G_STMT_END
 
@@ -400,7 +403,7 @@ typedef void (*GstTracerHookElementAddPad) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementRemovePad) (GObject *self, GstClockTime ts,
     GstElement *element, GstPad *pad);
 #define GST_TRACER_ELEMENT_REMOVE_PAD(element, pad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_REMOVE_PAD), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_REMOVE_PAD, \
     GstTracerHookElementRemovePad, (GST_TRACER_ARGS, element, pad)); \
 }G_STMT_END
 
@@ -416,7 +419,7 @@ typedef void (*GstTracerHookElementRemovePad) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookElementChangeStatePre) (GObject *self,
     GstClockTime ts, GstElement *element, GstStateChange transition);
 #define GST_TRACER_ELEMENT_CHANGE_STATE_PRE(element, transition) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_CHANGE_STATE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_PRE, \
     GstTracerHookElementChangeStatePre, (GST_TRACER_ARGS, element, transition)); \
 }G_STMT_END
 
@@ -434,7 +437,7 @@ typedef void (*GstTracerHookElementChangeStatePost) (GObject *self,
     GstClockTime ts, GstElement *element, GstStateChange transition,
     GstStateChangeReturn result);
 #define GST_TRACER_ELEMENT_CHANGE_STATE_POST(element, transition, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_ELEMENT_CHANGE_STATE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_ELEMENT_CHANGE_STATE_POST, \
     GstTracerHookElementChangeStatePost, (GST_TRACER_ARGS, element, transition, result)); \
 }G_STMT_END
 
@@ -450,7 +453,7 @@ typedef void (*GstTracerHookElementChangeStatePost) (GObject *self,
 typedef void (*GstTracerHookBinAddPre) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element);
 #define GST_TRACER_BIN_ADD_PRE(bin, element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_ADD_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_ADD_PRE, \
     GstTracerHookBinAddPre, (GST_TRACER_ARGS, bin, element)); \
 }G_STMT_END
 
@@ -467,7 +470,7 @@ typedef void (*GstTracerHookBinAddPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinAddPost) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element, gboolean result);
 #define GST_TRACER_BIN_ADD_POST(bin, element, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_ADD_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_ADD_POST, \
     GstTracerHookBinAddPost, (GST_TRACER_ARGS, bin, element, result)); \
 }G_STMT_END
 
@@ -483,7 +486,7 @@ typedef void (*GstTracerHookBinAddPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinRemovePre) (GObject *self, GstClockTime ts,
     GstBin *bin, GstElement *element);
 #define GST_TRACER_BIN_REMOVE_PRE(bin, element) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_REMOVE_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_REMOVE_PRE, \
     GstTracerHookBinRemovePre, (GST_TRACER_ARGS, bin, element)); \
 }G_STMT_END
 
@@ -499,7 +502,7 @@ typedef void (*GstTracerHookBinRemovePre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookBinRemovePost) (GObject *self, GstClockTime ts,
     GstBin *bin, gboolean result);
 #define GST_TRACER_BIN_REMOVE_POST(bin, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_BIN_REMOVE_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_BIN_REMOVE_POST, \
     GstTracerHookBinRemovePost, (GST_TRACER_ARGS, bin, result)); \
 }G_STMT_END
 
@@ -515,7 +518,7 @@ typedef void (*GstTracerHookBinRemovePost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadLinkPre) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad);
 #define GST_TRACER_PAD_LINK_PRE(srcpad, sinkpad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_LINK_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_LINK_PRE, \
     GstTracerHookPadLinkPre, (GST_TRACER_ARGS, srcpad, sinkpad)); \
 }G_STMT_END
 
@@ -532,7 +535,7 @@ typedef void (*GstTracerHookPadLinkPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadLinkPost) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad, GstPadLinkReturn result);
 #define GST_TRACER_PAD_LINK_POST(srcpad, sinkpad, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_LINK_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_LINK_POST, \
     GstTracerHookPadLinkPost, (GST_TRACER_ARGS, srcpad, sinkpad, result)); \
 }G_STMT_END
 
@@ -548,7 +551,7 @@ typedef void (*GstTracerHookPadLinkPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadUnlinkPre) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad);
 #define GST_TRACER_PAD_UNLINK_PRE(srcpad, sinkpad) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_UNLINK_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_UNLINK_PRE, \
     GstTracerHookPadUnlinkPre, (GST_TRACER_ARGS, srcpad, sinkpad)); \
 }G_STMT_END
 
@@ -565,7 +568,7 @@ typedef void (*GstTracerHookPadUnlinkPre) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookPadUnlinkPost) (GObject *self, GstClockTime ts,
     GstPad *srcpad, GstPad *sinkpad, gboolean result);
 #define GST_TRACER_PAD_UNLINK_POST(srcpad, sinkpad, result) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_UNLINK_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_UNLINK_POST, \
     GstTracerHookPadUnlinkPost, (GST_TRACER_ARGS, srcpad, sinkpad, result)); \
 }G_STMT_END
 
@@ -580,7 +583,7 @@ typedef void (*GstTracerHookPadUnlinkPost) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookMiniObjectCreated) (GObject *self, GstClockTime ts,
     GstMiniObject *object);
 #define GST_TRACER_MINI_OBJECT_CREATED(object) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_MINI_OBJECT_CREATED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_CREATED, \
     GstTracerHookMiniObjectCreated, (GST_TRACER_ARGS, object)); \
 }G_STMT_END
 
@@ -596,7 +599,7 @@ typedef void (*GstTracerHookMiniObjectCreated) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookMiniObjectDestroyed) (GObject *self, GstClockTime ts,
     GstMiniObject *object);
 #define GST_TRACER_MINI_OBJECT_DESTROYED(object) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_MINI_OBJECT_DESTROYED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_DESTROYED, \
     GstTracerHookMiniObjectDestroyed, (GST_TRACER_ARGS, object)); \
 }G_STMT_END
 
@@ -613,7 +616,7 @@ typedef void (*GstTracerHookMiniObjectDestroyed) (GObject *self, GstClockTime ts
 typedef void (*GstTracerHookObjectUnreffed) (GObject *self, GstClockTime ts,
     GstObject *object, gint new_refcount);
 #define GST_TRACER_OBJECT_UNREFFED(object, new_refcount) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_OBJECT_UNREFFED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_OBJECT_UNREFFED, \
     GstTracerHookObjectUnreffed, (GST_TRACER_ARGS, object, new_refcount)); \
 }G_STMT_END
 
@@ -630,7 +633,7 @@ typedef void (*GstTracerHookObjectUnreffed) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookObjectReffed) (GObject *self, GstClockTime ts,
     GstObject *object, gint new_refcount);
 #define GST_TRACER_OBJECT_REFFED(object, new_refcount) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_OBJECT_REFFED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_OBJECT_REFFED, \
     GstTracerHookObjectReffed, (GST_TRACER_ARGS, object, new_refcount)); \
 }G_STMT_END
 
@@ -647,7 +650,7 @@ typedef void (*GstTracerHookObjectReffed) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookMiniObjectUnreffed) (GObject *self, GstClockTime ts,
     GstMiniObject *object, gint new_refcount);
 #define GST_TRACER_MINI_OBJECT_UNREFFED(object, new_refcount) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_MINI_OBJECT_UNREFFED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_UNREFFED, \
     GstTracerHookMiniObjectUnreffed, (GST_TRACER_ARGS, object, new_refcount)); \
 }G_STMT_END
 
@@ -664,7 +667,7 @@ typedef void (*GstTracerHookMiniObjectUnreffed) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookMiniObjectReffed) (GObject *self, GstClockTime ts,
     GstMiniObject *object, gint new_refcount);
 #define GST_TRACER_MINI_OBJECT_REFFED(object, new_refcount) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_MINI_OBJECT_REFFED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_MINI_OBJECT_REFFED, \
     GstTracerHookMiniObjectReffed, (GST_TRACER_ARGS, object, new_refcount)); \
 }G_STMT_END
 
@@ -679,7 +682,7 @@ typedef void (*GstTracerHookMiniObjectReffed) (GObject *self, GstClockTime ts,
 typedef void (*GstTracerHookObjectCreated) (GObject *self, GstClockTime ts,
     GstObject *object);
 #define GST_TRACER_OBJECT_CREATED(object) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_OBJECT_CREATED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_OBJECT_CREATED, \
     GstTracerHookObjectCreated, (GST_TRACER_ARGS, object)); \
 }G_STMT_END
 
@@ -696,7 +699,7 @@ typedef void (*GstTracerHookObjectDestroyed) (GObject *self, GstClockTime ts,
     GstObject *object);
 
 #define GST_TRACER_OBJECT_DESTROYED(object) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_OBJECT_DESTROYED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_OBJECT_DESTROYED, \
     GstTracerHookObjectDestroyed, (GST_TRACER_ARGS, object)); \
 }G_STMT_END
 
@@ -722,7 +725,7 @@ typedef void (*GstTracerHookPluginFeatureLoaded) (GObject *self, GstClockTime ts
  * Since: 1.20
  */
 #define GST_TRACER_PLUGIN_FEATURE_LOADED(feature) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PLUGIN_FEATURE_LOADED), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PLUGIN_FEATURE_LOADED, \
     GstTracerHookPluginFeatureLoaded, (GST_TRACER_ARGS, feature)); \
 }G_STMT_END
 
@@ -750,7 +753,7 @@ typedef void (*GstTracerHookPadChainPre) (GObject *self, GstClockTime ts,
  * Since: 1.22
  */
 #define GST_TRACER_PAD_CHAIN_PRE(pad, buffer) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_CHAIN_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_CHAIN_PRE, \
     GstTracerHookPadChainPre, (GST_TRACER_ARGS, pad, buffer)); \
 }G_STMT_END
 
@@ -778,7 +781,7 @@ typedef void (*GstTracerHookPadChainPost) (GObject * self, GstClockTime ts,
  * Since: 1.22
  */
 #define GST_TRACER_PAD_CHAIN_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_CHAIN_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_CHAIN_POST, \
     GstTracerHookPadChainPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
@@ -806,7 +809,7 @@ typedef void (*GstTracerHookPadChainListPre) (GObject *self, GstClockTime ts,
  * Since: 1.22
  */
 #define GST_TRACER_PAD_CHAIN_LIST_PRE(pad, list) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_CHAIN_LIST_PRE), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_CHAIN_LIST_PRE, \
     GstTracerHookPadChainListPre, (GST_TRACER_ARGS, pad, list)); \
 }G_STMT_END
 
@@ -835,10 +838,71 @@ typedef void (*GstTracerHookPadChainListPost) (GObject *self, GstClockTime ts,
  * Since: 1.22
  */
 #define GST_TRACER_PAD_CHAIN_LIST_POST(pad, res) G_STMT_START{ \
-  GST_TRACER_DISPATCH(GST_TRACER_QUARK(HOOK_PAD_CHAIN_LIST_POST), \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_PAD_CHAIN_LIST_POST, \
     GstTracerHookPadChainListPost, (GST_TRACER_ARGS, pad, res)); \
 }G_STMT_END
 
+/**
+ * GstTracerHookClockWaitPre:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @clock: the clock
+ * @id: the clock id that is waited on
+ *
+ * Pre-hook for gst_clock_id_wait() named "clock-wait-pre".
+ *
+ * Since: 1.22
+ */
+typedef void (*GstTracerHookClockWaitPre) (GObject *self, GstClockTime ts,
+    GstClock *clock, GstClockID id);
+
+/**
+ * GST_TRACER_CLOCK_WAIT_PRE:
+ * @clock: a %GstClock
+ * @id: a %GstClockID
+ *
+ * Dispatches the "clock-wait-pre" hook.
+ *
+ * Since: 1.22
+ */
+#define GST_TRACER_CLOCK_WAIT_PRE(clock, id) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_CLOCK_WAIT_PRE, \
+    GstTracerHookClockWaitPre, (GST_TRACER_ARGS, clock, id)); \
+}G_STMT_END
+
+/**
+ * GstTracerHookClockWaitPost:
+ * @self: the tracer instance
+ * @ts: the current timestamp
+ * @clock: the clock
+ * @id: the clock id that was waited on
+ * @res: the result of gst_clock_id_wait()
+ * @jitter: the jitter of the wait
+ *
+ * Post-hook for gst_clock_id_wait() named "clock-wait-post".
+ *
+ * Since: 1.22
+ */
+typedef void (*GstTracerHookClockWaitPost) (GObject *self, GstClockTime ts,
+    GstClock *clock, GstClockID id, GstClockReturn res,
+    GstClockTimeDiff jitter);
+
+/**
+ * GST_TRACER_CLOCK_WAIT_POST:
+ * @clock: a %GstClock
+ * @id: a %GstClockID
+ * @res: a %GstClockReturn
+ * @jitter: a %GstClockTimeDiff
+ *
+ * Dispatches the "clock-wait-post" hook.
+ *
+ * Since: 1.22
+ */
+#define GST_TRACER_CLOCK_WAIT_POST(clock, id, res, jitter) G_STMT_START{ \
+  GST_TRACER_DISPATCH(GST_TRACER_QUARK_HOOK_CLOCK_WAIT_POST, \
+    GstTracerHookClockWaitPost, (GST_TRACER_ARGS, clock, id, res, jitter)); \
+}G_STMT_END
+
 #else /* !GST_DISABLE_GST_TRACER_HOOKS */
 
 static inline void
@@ -892,6 +956,8 @@ _priv_gst_tracing_deinit (void)
 #define GST_TRACER_PAD_CHAIN_POST(pad, res)
 #define GST_TRACER_PAD_CHAIN_LIST_PRE(pad, list)
 #define GST_TRACER_PAD_CHAIN_LIST_POST(pad, res)
+#define GST_TRACER_CLOCK_WAIT_PRE(clock, id)
+#define GST_TRACER_CLOCK_WAIT_POST(clock, id, res, jitter)
 
 #endif /* GST_DISABLE_GST_TRACER_HOOKS */
 
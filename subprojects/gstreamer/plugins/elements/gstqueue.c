@@ -122,7 +122,9 @@ enum
   PROP_MIN_THRESHOLD_TIME,
   PROP_LEAKY,
   PROP_SILENT,
-  PROP_FLUSH_ON_EOS
+  PROP_FLUSH_ON_EOS,
+  PROP_COOPERATIVE,
+  PROP_LOCK_FREE
 };
 
 /* default property values */
@@ -130,6 +132,9 @@ enum
 #define DEFAULT_MAX_SIZE_BYTES    (10 * 1024 * 1024)    /* 10 MB       */
 #define DEFAULT_MAX_SIZE_TIME     GST_SECOND    /* 1 second    */
 
+/* larger buffer limits use the locked queue, see queue:lock-free */
+#define MAX_RING_SIZE             (1 << 20)
+
 #define GST_QUEUE_MUTEX_LOCK(q) G_STMT_START {                          \
   g_mutex_lock (&q->qlock);                                              \
 } G_STMT_END
@@ -179,6 +184,9 @@ enum
   if (q->waiting_add) {                                                 \
     STATUS (q, q->sinkpad, "signal ADD");                               \
     g_cond_signal (&q->item_add);                                        \
+  } else if (q->sleeping_add) {                                         \
+    STATUS (q, q->sinkpad, "wake up for ADD");                          \
+    gst_queue_wake_task (q);                                            \
   }                                                                     \
 } G_STMT_END
 
@@ -202,6 +210,12 @@ static GstFlowReturn gst_queue_chain_list (GstPad * pad, GstObject * parent,
     GstBufferList * buffer_list);
 static GstFlowReturn gst_queue_push_one (GstQueue * queue);
 static void gst_queue_loop (GstPad * pad);
+static gboolean gst_queue_start_task (GstQueue * queue);
+static void gst_queue_wake_task (GstQueue * queue);
+static void gst_queue_pause_task_unlock (GstQueue * queue);
+
+static GstStateChangeReturn gst_queue_change_state (GstElement * element,
+    GstStateChange transition);
 
 static GstFlowReturn gst_queue_handle_sink_event (GstPad * pad,
     GstObject * parent, GstEvent * event);
@@ -229,8 +243,49 @@ typedef struct
   GstMiniObject *item;
   gsize size;
   gboolean is_query;
+  guint ring_pos;               /* ring position to push this item at */
 } GstQueueItem;
 
+typedef struct
+{
+  GstMiniObject *item;
+  gsize size;
+} GstQueueRingSlot;
+
+#define RING_CACHE_LINE 64
+
+/* A bounded single producer, single consumer ring for the buffers and buffer
+ * lists of a lock-free queue. The producer is the streaming thread of the
+ * sinkpad and the consumer the task of the srcpad. Each side only writes its
+ * own position, the waiting flags tell the other side that it has to take
+ * the queue lock to wake it up.
+ *
+ * Serialized events and queries still go to the locked queue, with the tail
+ * position of the ring at the time they arrived. The consumer pushes them
+ * once it reaches that position. */
+struct _GstQueueRing
+{
+  /* constant */
+  GstQueueRingSlot *slots;
+  guint mask;
+  guint capacity;
+
+  /* number of items in the locked queue */
+  guint n_serialized;
+  guint8 _pad0[RING_CACHE_LINE - sizeof (gpointer) - 3 * sizeof (guint)];
+
+  /* written by the producer */
+  guint tail;
+  guint bytes_in;
+  guint producer_waiting;
+  guint8 _pad1[RING_CACHE_LINE - 3 * sizeof (guint)];
+
+  /* written by the consumer */
+  guint head;
+  guint bytes_out;
+  guint consumer_waiting;
+};
+
 #define GST_TYPE_QUEUE_LEAKY (queue_leaky_get_type ())
 
 static GType
@@ -405,8 +460,56 @@ gst_queue_class_init (GstQueueClass * klass)
           G_PARAM_READWRITE | GST_PARAM_MUTABLE_PLAYING |
           G_PARAM_STATIC_STRINGS));
 
+  /**
+   * queue:cooperative:
+   *
+   * Push the data downstream from a cooperative #GstTask instead of from a
+   * dedicated streaming thread. The task runs on worker threads that are
+   * shared with the other cooperative tasks and returns to them when the queue
+   * is empty, see gst_task_set_cooperative().
+   *
+   * This saves a thread per queue in applications that run many pipelines,
+   * but everything downstream of the queue then runs on the shared workers
+   * and must not block for long, for example by synchronising on the clock or
+   * by pushing into a full queue.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_COOPERATIVE,
+      g_param_spec_boolean ("cooperative", "Cooperative",
+          "Run the streaming thread as a cooperative task on shared workers",
+          FALSE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
+  /**
+   * queue:lock-free:
+   *
+   * Hand over buffers and buffer lists from the upstream thread to the
+   * streaming thread of the queue through a lock-free ring buffer. The two
+   * threads then only synchronise when the queue is empty or full, which
+   * makes the handoff a lot cheaper when many small buffers are passed.
+   * Serialized events and queries are still kept in order with the data.
+   *
+   * In this mode the queue is only limited by #GstQueue:max-size-buffers as
+   * configured when going to PAUSED, and a buffer list counts as one buffer.
+   * The byte and time limits, the minimum thresholds and the queue signals
+   * don't apply, #GstQueue:current-level-time stays 0 and position queries in
+   * time format are not answered. The mode is not used when the queue is
+   * leaky, flushes on EOS or has no buffer limit.
+   *
+   * Since: 1.22
+   */
+  g_object_class_install_property (gobject_class, PROP_LOCK_FREE,
+      g_param_spec_boolean ("lock-free", "Lock-free",
+          "Hand over buffers through a lock-free ring buffer", FALSE,
+          G_PARAM_READWRITE | GST_PARAM_MUTABLE_READY |
+          G_PARAM_STATIC_STRINGS));
+
   gobject_class->finalize = gst_queue_finalize;
 
+  gstelement_class->change_state = gst_queue_change_state;
+
   gst_element_class_set_static_metadata (gstelement_class,
       "Queue",
       "Generic", "Simple data queue", "Erik Walthinsen <omega@cse.ogi.edu>");
@@ -421,6 +524,7 @@ gst_queue_class_init (GstQueueClass * klass)
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_handle_src_query);
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_chain);
   GST_DEBUG_REGISTER_FUNCPTR (gst_queue_chain_list);
+  GST_DEBUG_REGISTER_FUNCPTR (gst_queue_change_state);
 
   gst_type_mark_as_plugin_api (GST_TYPE_QUEUE_LEAKY, 0);
 }
@@ -482,6 +586,74 @@ gst_queue_init (GstQueue * queue)
       "initialized queue's not_empty & not_full conditions");
 }
 
+static GstQueueRing *
+gst_queue_ring_new (guint capacity)
+{
+  GstQueueRing *ring = g_new0 (GstQueueRing, 1);
+  guint size = 1;
+
+  while (size < capacity)
+    size <<= 1;
+
+  ring->slots = g_new0 (GstQueueRingSlot, size);
+  ring->mask = size - 1;
+  ring->capacity = capacity;
+
+  return ring;
+}
+
+static inline gboolean
+gst_queue_ring_is_empty (GstQueueRing * ring)
+{
+  return ring->head == (guint) g_atomic_int_get (&ring->tail);
+}
+
+/* the number of bytes in the ring, can be called from any thread */
+static inline guint
+gst_queue_ring_bytes (GstQueueRing * ring)
+{
+  return (guint) g_atomic_int_get (&ring->bytes_in) -
+      (guint) g_atomic_int_get (&ring->bytes_out);
+}
+
+/* whether nothing is queued, neither in the queue nor in the ring. Called
+ * with the queue lock from either thread */
+static inline gboolean
+gst_queue_locked_is_empty (GstQueue * queue)
+{
+  if (!gst_queue_array_is_empty (queue->queue))
+    return FALSE;
+
+  return queue->ring == NULL ||
+      g_atomic_int_get (&queue->ring->head) ==
+      g_atomic_int_get (&queue->ring->tail);
+}
+
+/* only called by the consumer, or when the consumer is not running */
+static GstMiniObject *
+gst_queue_ring_pop (GstQueueRing * ring)
+{
+  GstQueueRingSlot *slot = &ring->slots[ring->head & ring->mask];
+  GstMiniObject *item = slot->item;
+
+  slot->item = NULL;
+  g_atomic_int_set (&ring->bytes_out, ring->bytes_out + (guint) slot->size);
+  /* gives the slot back to the producer */
+  g_atomic_int_set (&ring->head, ring->head + 1);
+
+  return item;
+}
+
+static void
+gst_queue_ring_free (GstQueueRing * ring)
+{
+  while (!gst_queue_ring_is_empty (ring))
+    gst_mini_object_unref (gst_queue_ring_pop (ring));
+
+  g_free (ring->slots);
+  g_free (ring);
+}
+
 /* called only once, as opposed to dispose */
 static void
 gst_queue_finalize (GObject * object)
@@ -498,6 +670,9 @@ gst_queue_finalize (GObject * object)
   }
   gst_queue_array_free (queue->queue);
 
+  if (queue->ring)
+    gst_queue_ring_free (queue->ring);
+
   g_mutex_clear (&queue->qlock);
   g_cond_clear (&queue->item_add);
   g_cond_clear (&queue->item_del);
@@ -716,6 +891,12 @@ gst_queue_locked_flush (GstQueue * queue, gboolean full)
       gst_mini_object_unref (qitem->item);
     memset (qitem, 0, sizeof (GstQueueItem));
   }
+  if (queue->ring) {
+    /* the streaming thread either flushes itself or is stopped here */
+    while (!gst_queue_ring_is_empty (queue->ring))
+      gst_mini_object_unref (gst_queue_ring_pop (queue->ring));
+    g_atomic_int_set (&queue->ring->n_serialized, 0);
+  }
   queue->last_query = FALSE;
   g_cond_signal (&queue->query_handled);
   GST_QUEUE_CLEAR_LEVEL (queue->cur_level);
@@ -774,6 +955,21 @@ gst_queue_locked_enqueue_buffer_list (GstQueue * queue, gpointer item)
   GST_QUEUE_SIGNAL_ADD (queue);
 }
 
+/* enqueue a serialized event or query behind the data that is in the queue
+ * now, with QUEUE_LOCK */
+static inline void
+gst_queue_locked_enqueue_serialized (GstQueue * queue, GstQueueItem * qitem)
+{
+  qitem->ring_pos = 0;
+  if (queue->ring) {
+    /* only the streaming thread of the sinkpad moves the tail */
+    qitem->ring_pos = queue->ring->tail;
+    g_atomic_int_inc (&queue->ring->n_serialized);
+  }
+  gst_queue_array_push_tail_struct (queue->queue, qitem);
+  GST_QUEUE_SIGNAL_ADD (queue);
+}
+
 static inline void
 gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
 {
@@ -795,7 +991,7 @@ gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
     case GST_EVENT_SEGMENT:
       apply_segment (queue, event, &queue->sink_segment, TRUE);
       /* if the queue is empty, apply sink segment on the source */
-      if (gst_queue_array_is_empty (queue->queue)) {
+      if (gst_queue_locked_is_empty (queue)) {
         GST_CAT_LOG_OBJECT (queue_dataflow, queue, "Apply segment on srcpad");
         apply_segment (queue, event, &queue->src_segment, FALSE);
         queue->newseg_applied_to_src = TRUE;
@@ -814,8 +1010,7 @@ gst_queue_locked_enqueue_event (GstQueue * queue, gpointer item)
   qitem.item = item;
   qitem.is_query = FALSE;
   qitem.size = 0;
-  gst_queue_array_push_tail_struct (queue->queue, &qitem);
-  GST_QUEUE_SIGNAL_ADD (queue);
+  gst_queue_locked_enqueue_serialized (queue, &qitem);
 }
 
 /* dequeue an item from the queue and update level stats, with QUEUE_LOCK */
@@ -833,6 +1028,9 @@ gst_queue_locked_dequeue (GstQueue * queue)
   item = qitem->item;
   bufsize = qitem->size;
 
+  if (queue->ring)
+    g_atomic_int_add (&queue->ring->n_serialized, -1);
+
   if (GST_IS_BUFFER (item)) {
     GstBuffer *buffer = GST_BUFFER_CAST (item);
 
@@ -954,8 +1152,7 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
       queue->eos = FALSE;
       queue->unexpected = FALSE;
       if (gst_pad_is_active (queue->srcpad)) {
-        gst_pad_start_task (queue->srcpad, (GstTaskFunction) gst_queue_loop,
-            queue->srcpad, NULL);
+        gst_queue_start_task (queue);
       } else {
         GST_INFO_OBJECT (queue->srcpad, "not re-starting task on srcpad, "
             "pad not active any longer");
@@ -1007,8 +1204,7 @@ gst_queue_handle_sink_event (GstPad * pad, GstObject * parent, GstEvent * event)
                 queue->srcresult = GST_FLOW_OK;
                 queue->eos = FALSE;
                 queue->unexpected = FALSE;
-                gst_pad_start_task (queue->srcpad,
-                    (GstTaskFunction) gst_queue_loop, queue->srcpad, NULL);
+                gst_queue_start_task (queue);
               } else {
                 queue->eos = FALSE;
                 queue->unexpected = FALSE;
@@ -1069,8 +1265,7 @@ gst_queue_handle_sink_query (GstPad * pad, GstObject * parent, GstQuery * query)
         qitem.item = GST_MINI_OBJECT_CAST (query);
         qitem.is_query = TRUE;
         qitem.size = 0;
-        gst_queue_array_push_tail_struct (queue->queue, &qitem);
-        GST_QUEUE_SIGNAL_ADD (queue);
+        gst_queue_locked_enqueue_serialized (queue, &qitem);
         while (queue->srcresult == GST_FLOW_OK &&
             queue->last_handled_query != query)
           g_cond_wait (&queue->query_handled, &queue->qlock);
@@ -1178,6 +1373,64 @@ discont_first_buffer (GstBuffer ** buffer, guint i, gpointer user_data)
   return FALSE;
 }
 
+/* add a buffer or buffer list to the ring, called without the lock from the
+ * streaming thread of the sinkpad */
+static GstFlowReturn
+gst_queue_ring_enqueue (GstQueue * queue, GstMiniObject * obj, gboolean is_list)
+{
+  GstQueueRing *ring = queue->ring;
+  GstQueueRingSlot *slot;
+  guint tail = ring->tail;
+  gsize size;
+
+  if (G_UNLIKELY (tail - (guint) g_atomic_int_get (&ring->head) >=
+          ring->capacity)) {
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    /* the streaming thread takes the lock to wake us up once it sees this,
+     * check again after setting it so that we don't miss that */
+    g_atomic_int_set (&ring->producer_waiting, 1);
+    while (tail - (guint) g_atomic_int_get (&ring->head) >= ring->capacity) {
+      GST_QUEUE_WAIT_DEL_CHECK (queue, out_flushing);
+    }
+    g_atomic_int_set (&ring->producer_waiting, 0);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  if (is_list)
+    size = gst_buffer_list_calculate_size (GST_BUFFER_LIST_CAST (obj));
+  else
+    size = gst_buffer_get_size (GST_BUFFER_CAST (obj));
+
+  slot = &ring->slots[tail & ring->mask];
+  slot->item = obj;
+  slot->size = size;
+  g_atomic_int_set (&ring->bytes_in, ring->bytes_in + (guint) size);
+  /* hands the slot over to the streaming thread */
+  g_atomic_int_set (&ring->tail, tail + 1);
+
+  if (G_UNLIKELY (g_atomic_int_get (&ring->consumer_waiting))) {
+    GST_QUEUE_MUTEX_LOCK (queue);
+    GST_QUEUE_SIGNAL_ADD (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  return GST_FLOW_OK;
+
+  /* special conditions */
+out_flushing:
+  {
+    GstFlowReturn ret = queue->srcresult;
+
+    g_atomic_int_set (&ring->producer_waiting, 0);
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+        "exit because task paused, reason: %s", gst_flow_get_name (ret));
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    gst_mini_object_unref (obj);
+
+    return ret;
+  }
+}
+
 static GstFlowReturn
 gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
     GstMiniObject * obj, gboolean is_list)
@@ -1186,6 +1439,13 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
 
   queue = GST_QUEUE_CAST (parent);
 
+  /* these only change with the lock, seeing an old value here is the same as
+   * the data arriving a bit earlier. Everything else takes the lock below to
+   * return the right flow return. */
+  if (queue->ring && G_LIKELY (queue->srcresult == GST_FLOW_OK &&
+          !queue->eos && !queue->unexpected))
+    return gst_queue_ring_enqueue (queue, obj, is_list);
+
   /* we have to lock the queue since we span threads */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
   /* when we received EOS, we refuse any more data */
@@ -1194,6 +1454,11 @@ gst_queue_chain_buffer_or_list (GstPad * pad, GstObject * parent,
   if (queue->unexpected)
     goto out_unexpected;
 
+  if (queue->ring) {
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    return gst_queue_ring_enqueue (queue, obj, is_list);
+  }
+
   if (!is_list) {
     GstClockTime duration, timestamp;
     GstBuffer *buffer = GST_BUFFER_CAST (obj);
@@ -1505,6 +1770,151 @@ out_flushing_query:
   }
 }
 
+/* called with the queue lock after downstream returned EOS for data from the
+ * ring. Like gst_queue_push_one(), drop everything up to the next item that
+ * can be pushed again. */
+static void
+gst_queue_ring_drop_eos (GstQueue * queue)
+{
+  GstQueueRing *ring = queue->ring;
+  GstQueueItem *qitem;
+  GstMiniObject *data;
+
+  for (;;) {
+    qitem = gst_queue_array_peek_head_struct (queue->queue);
+
+    if (qitem && qitem->ring_pos == ring->head) {
+      if (GST_IS_EVENT (qitem->item)) {
+        GstEventType type = GST_EVENT_TYPE (qitem->item);
+
+        if (type == GST_EVENT_EOS || type == GST_EVENT_SEGMENT
+            || type == GST_EVENT_STREAM_START) {
+          /* leave it for the next iteration of the loop */
+          GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+              "pushing pushable event %s after EOS",
+              GST_EVENT_TYPE_NAME (qitem->item));
+          break;
+        }
+      }
+
+      data = gst_queue_locked_dequeue (queue);
+      if (data && GST_IS_QUERY (data)) {
+        GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+            "dropping query %p because of EOS", data);
+        queue->last_query = FALSE;
+        g_cond_signal (&queue->query_handled);
+      } else if (data) {
+        GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+            "dropping EOS event %p", data);
+        gst_mini_object_unref (data);
+      }
+    } else if (!gst_queue_ring_is_empty (ring)) {
+      data = gst_queue_ring_pop (ring);
+      GST_CAT_LOG_OBJECT (queue_dataflow, queue, "dropping EOS buffer %p",
+          data);
+      gst_mini_object_unref (data);
+    } else {
+      /* make upstream refuse more buffers, see gst_queue_push_one() */
+      queue->unexpected = TRUE;
+      break;
+    }
+  }
+  GST_QUEUE_SIGNAL_DEL (queue);
+}
+
+/* the loop of a lock-free queue, the lock is only taken for events and
+ * queries and when the ring is empty */
+static void
+gst_queue_ring_loop (GstQueue * queue)
+{
+  GstQueueRing *ring = queue->ring;
+  GstMiniObject *data;
+  GstFlowReturn ret;
+  guint tail;
+
+  if (G_UNLIKELY (queue->sleeping_add)) {
+    /* woken up again, see below */
+    GST_QUEUE_MUTEX_LOCK (queue);
+    queue->sleeping_add = FALSE;
+    g_atomic_int_set (&ring->consumer_waiting, 0);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  /* read the tail first, an event that arrived before the last buffer we see
+   * is then also counted in n_serialized */
+  tail = g_atomic_int_get (&ring->tail);
+
+  if (G_UNLIKELY (g_atomic_int_get (&ring->n_serialized) > 0)) {
+    GstQueueItem *qitem;
+
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    qitem = gst_queue_array_peek_head_struct (queue->queue);
+    if (qitem && qitem->ring_pos == ring->head) {
+      ret = gst_queue_push_one (queue);
+      queue->srcresult = ret;
+      if (ret != GST_FLOW_OK)
+        goto out_flushing;
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+      return;
+    }
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  if (ring->head == tail)
+    goto empty;
+
+  data = gst_queue_ring_pop (ring);
+  if (G_UNLIKELY (g_atomic_int_get (&ring->producer_waiting))) {
+    GST_QUEUE_MUTEX_LOCK (queue);
+    GST_QUEUE_SIGNAL_DEL (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+
+  if (GST_IS_BUFFER_LIST (data))
+    ret = gst_pad_push_list (queue->srcpad, GST_BUFFER_LIST_CAST (data));
+  else
+    ret = gst_pad_push (queue->srcpad, GST_BUFFER_CAST (data));
+
+  if (G_UNLIKELY (ret != GST_FLOW_OK)) {
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    if (ret != GST_FLOW_EOS) {
+      queue->srcresult = ret;
+      goto out_flushing;
+    }
+    GST_CAT_LOG_OBJECT (queue_dataflow, queue, "got EOS from downstream");
+    gst_queue_ring_drop_eos (queue);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+  }
+  return;
+
+empty:
+  {
+    GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+    /* the upstream thread takes the lock to wake us up once it sees this,
+     * check again after setting it so that we don't miss that */
+    g_atomic_int_set (&ring->consumer_waiting, 1);
+    while (gst_queue_ring_is_empty (ring)
+        && g_atomic_int_get (&ring->n_serialized) == 0) {
+      if (queue->cooperative && gst_task_sleep (GST_PAD_TASK (queue->srcpad))) {
+        STATUS (queue, queue->srcpad, "sleep for ADD");
+        queue->sleeping_add = TRUE;
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        return;
+      }
+      GST_QUEUE_WAIT_ADD_CHECK (queue, out_flushing);
+    }
+    g_atomic_int_set (&ring->consumer_waiting, 0);
+    GST_QUEUE_MUTEX_UNLOCK (queue);
+    return;
+  }
+out_flushing:
+  {
+    g_atomic_int_set (&ring->consumer_waiting, 0);
+    gst_queue_pause_task_unlock (queue);
+    return;
+  }
+}
+
 static void
 gst_queue_loop (GstPad * pad)
 {
@@ -1513,21 +1923,38 @@ gst_queue_loop (GstPad * pad)
 
   queue = (GstQueue *) GST_PAD_PARENT (pad);
 
+  if (queue->ring) {
+    gst_queue_ring_loop (queue);
+    return;
+  }
+
   /* have to lock for thread-safety */
   GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
 
-  while (gst_queue_is_empty (queue)) {
-    GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
-    if (!queue->silent) {
-      GST_QUEUE_MUTEX_UNLOCK (queue);
-      g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
-      GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+  /* when we slept, the underrun was already signalled before */
+  while (gst_queue_is_empty (queue) || G_UNLIKELY (queue->sleeping_add)) {
+    if (!queue->sleeping_add) {
+      GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is empty");
+      if (!queue->silent) {
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        g_signal_emit (queue, gst_queue_signals[SIGNAL_UNDERRUN], 0);
+        GST_QUEUE_MUTEX_LOCK_CHECK (queue, out_flushing);
+      }
     }
 
     /* we recheck, the signal could have changed the thresholds */
     while (gst_queue_is_empty (queue)) {
+      /* a cooperative task returns to the workers, GST_QUEUE_SIGNAL_ADD
+       * schedules it again */
+      if (queue->cooperative && gst_task_sleep (GST_PAD_TASK (pad))) {
+        STATUS (queue, queue->srcpad, "sleep for ADD");
+        queue->sleeping_add = TRUE;
+        GST_QUEUE_MUTEX_UNLOCK (queue);
+        return;
+      }
       GST_QUEUE_WAIT_ADD_CHECK (queue, out_flushing);
     }
+    queue->sleeping_add = FALSE;
 
     GST_CAT_DEBUG_OBJECT (queue_dataflow, queue, "queue is not empty");
     if (!queue->silent) {
@@ -1550,30 +1977,72 @@ gst_queue_loop (GstPad * pad)
   /* ERRORS */
 out_flushing:
   {
-    gboolean eos = queue->eos;
-    GstFlowReturn ret = queue->srcresult;
-
-    gst_pad_pause_task (queue->srcpad);
-    GST_CAT_LOG_OBJECT (queue_dataflow, queue,
-        "pause task, reason:  %s", gst_flow_get_name (ret));
-    if (ret == GST_FLOW_FLUSHING) {
-      gst_queue_locked_flush (queue, FALSE);
-    } else {
-      GST_QUEUE_SIGNAL_DEL (queue);
-      queue->last_query = FALSE;
-      g_cond_signal (&queue->query_handled);
-    }
-    GST_QUEUE_MUTEX_UNLOCK (queue);
-    /* let app know about us giving up if upstream is not expected to do so */
-    /* EOS is already taken care of elsewhere */
-    if (eos && (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS)) {
-      GST_ELEMENT_FLOW_ERROR (queue, ret);
-      gst_pad_push_event (queue->srcpad, gst_event_new_eos ());
-    }
+    gst_queue_pause_task_unlock (queue);
     return;
   }
 }
 
+/* called from the loop with the queue lock when it stops because of
+ * srcresult, releases the lock */
+static void
+gst_queue_pause_task_unlock (GstQueue * queue)
+{
+  gboolean eos = queue->eos;
+  GstFlowReturn ret = queue->srcresult;
+
+  queue->sleeping_add = FALSE;
+  gst_pad_pause_task (queue->srcpad);
+  GST_CAT_LOG_OBJECT (queue_dataflow, queue,
+      "pause task, reason:  %s", gst_flow_get_name (ret));
+  if (ret == GST_FLOW_FLUSHING) {
+    gst_queue_locked_flush (queue, FALSE);
+  } else {
+    GST_QUEUE_SIGNAL_DEL (queue);
+    queue->last_query = FALSE;
+    g_cond_signal (&queue->query_handled);
+  }
+  GST_QUEUE_MUTEX_UNLOCK (queue);
+  /* let app know about us giving up if upstream is not expected to do so */
+  /* EOS is already taken care of elsewhere */
+  if (eos && (ret == GST_FLOW_NOT_LINKED || ret < GST_FLOW_EOS)) {
+    GST_ELEMENT_FLOW_ERROR (queue, ret);
+    gst_pad_push_event (queue->srcpad, gst_event_new_eos ());
+  }
+}
+
+/* called with the queue lock */
+static gboolean
+gst_queue_start_task (GstQueue * queue)
+{
+  GstTask *task;
+  gboolean res;
+
+  res = gst_pad_start_task (queue->srcpad, (GstTaskFunction) gst_queue_loop,
+      queue->srcpad, NULL);
+
+  /* when the task was just created, it switches to the shared workers after
+   * its first iteration. That one can't see the property change as it waits
+   * for the queue lock. */
+  GST_OBJECT_LOCK (queue->srcpad);
+  if ((task = GST_PAD_TASK (queue->srcpad)))
+    gst_task_set_cooperative (task, queue->cooperative);
+  GST_OBJECT_UNLOCK (queue->srcpad);
+
+  return res;
+}
+
+/* called with the queue lock */
+static void
+gst_queue_wake_task (GstQueue * queue)
+{
+  GstTask *task;
+
+  GST_OBJECT_LOCK (queue->srcpad);
+  if ((task = GST_PAD_TASK (queue->srcpad)))
+    gst_task_wakeup (task);
+  GST_OBJECT_UNLOCK (queue->srcpad);
+}
+
 static gboolean
 gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
 {
@@ -1592,7 +2061,7 @@ gst_queue_handle_src_event (GstPad * pad, GstObject * parent, GstEvent * event)
         /* when we got not linked, assume downstream is linked again now and we
          * can try to start pushing again */
         queue->srcresult = GST_FLOW_OK;
-        gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad, NULL);
+        gst_queue_start_task (queue);
       }
       GST_QUEUE_MUTEX_UNLOCK (queue);
 
@@ -1631,20 +2100,34 @@ gst_queue_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
   switch (GST_QUERY_TYPE (query)) {
     case GST_QUERY_POSITION:
     {
-      gint64 peer_pos;
+      gint64 peer_pos, level_bytes;
+      gboolean lock_free;
       GstFormat format;
 
       /* get peer position */
       gst_query_parse_position (query, &format, &peer_pos);
 
+      GST_QUEUE_MUTEX_LOCK (queue);
+      lock_free = queue->ring != NULL;
+      level_bytes = queue->cur_level.bytes;
+      if (lock_free)
+        level_bytes += gst_queue_ring_bytes (queue->ring);
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+
       /* FIXME: this code assumes that there's no discont in the queue */
       switch (format) {
         case GST_FORMAT_BYTES:
-          peer_pos -= queue->cur_level.bytes;
+          peer_pos -= level_bytes;
           if (peer_pos < 0)     /* Clamp result to 0 */
             peer_pos = 0;
           break;
         case GST_FORMAT_TIME:
+          /* a lock-free queue does not know how much time it holds */
+          if (lock_free) {
+            GST_DEBUG_OBJECT (queue, "Can't adjust query in time format in "
+                "lock-free mode");
+            return FALSE;
+          }
           peer_pos -= queue->cur_level.time;
           if (peer_pos < 0)     /* Clamp result to 0 */
             peer_pos = 0;
@@ -1661,26 +2144,29 @@ gst_queue_handle_src_query (GstPad * pad, GstObject * parent, GstQuery * query)
     case GST_QUERY_LATENCY:
     {
       gboolean live;
-      GstClockTime min, max;
+      GstClockTime min, max, max_time, min_time;
 
       gst_query_parse_latency (query, &live, &min, &max);
 
+      /* a lock-free queue has no time limit or threshold */
+      max_time = queue->ring ? 0 : queue->max_size.time;
+      min_time = queue->ring ? 0 : queue->min_threshold.time;
+
       /* we can delay up to the limit of the queue in time. If we have no time
        * limit, the best thing we can do is to return an infinite delay. In
        * reality a better estimate would be the byte/buffer rate but that is not
        * possible right now. */
       /* TODO: Use CONVERT query? */
-      if (queue->max_size.time > 0 && max != -1
-          && queue->leaky == GST_QUEUE_NO_LEAK)
-        max += queue->max_size.time;
-      else if (queue->max_size.time > 0 && queue->leaky != GST_QUEUE_NO_LEAK)
-        max = MAX (queue->max_size.time, max);
+      if (max_time > 0 && max != -1 && queue->leaky == GST_QUEUE_NO_LEAK)
+        max += max_time;
+      else if (max_time > 0 && queue->leaky != GST_QUEUE_NO_LEAK)
+        max = MAX (max_time, max);
       else
         max = -1;
 
       /* adjust for min-threshold */
-      if (queue->min_threshold.time > 0)
-        min += queue->min_threshold.time;
+      if (min_time > 0)
+        min += min_time;
 
       gst_query_set_latency (query, live, min, max);
       break;
@@ -1750,9 +2236,7 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
         queue->srcresult = GST_FLOW_OK;
         queue->eos = FALSE;
         queue->unexpected = FALSE;
-        result =
-            gst_pad_start_task (pad, (GstTaskFunction) gst_queue_loop, pad,
-            NULL);
+        result = gst_queue_start_task (queue);
         GST_QUEUE_MUTEX_UNLOCK (queue);
       } else {
         /* step 1, unblock loop function */
@@ -1777,10 +2261,52 @@ gst_queue_src_activate_mode (GstPad * pad, GstObject * parent, GstPadMode mode,
   return result;
 }
 
+static GstStateChangeReturn
+gst_queue_change_state (GstElement * element, GstStateChange transition)
+{
+  GstQueue *queue = GST_QUEUE (element);
+  GstStateChangeReturn ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_READY_TO_PAUSED:
+      /* the pads are not active yet, so neither thread uses the ring */
+      GST_QUEUE_MUTEX_LOCK (queue);
+      g_clear_pointer (&queue->ring, gst_queue_ring_free);
+      if (queue->lock_free && queue->leaky == GST_QUEUE_NO_LEAK
+          && !queue->flush_on_eos && queue->max_size.buffers > 0
+          && queue->max_size.buffers <= MAX_RING_SIZE) {
+        GST_DEBUG_OBJECT (queue, "using a lock-free ring of %u buffers",
+            queue->max_size.buffers);
+        queue->ring = gst_queue_ring_new (queue->max_size.buffers);
+      }
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+      break;
+    default:
+      break;
+  }
+
+  ret = GST_ELEMENT_CLASS (parent_class)->change_state (element, transition);
+  if (ret == GST_STATE_CHANGE_FAILURE)
+    return ret;
+
+  switch (transition) {
+    case GST_STATE_CHANGE_PAUSED_TO_READY:
+      GST_QUEUE_MUTEX_LOCK (queue);
+      g_clear_pointer (&queue->ring, gst_queue_ring_free);
+      GST_QUEUE_MUTEX_UNLOCK (queue);
+      break;
+    default:
+      break;
+  }
+
+  return ret;
+}
+
 static void
 queue_capacity_change (GstQueue * queue)
 {
-  if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM) {
+  /* the ring keeps the limits it was created with */
+  if (queue->leaky == GST_QUEUE_LEAK_DOWNSTREAM && !queue->ring) {
     gst_queue_leak_downstream (queue);
   }
 
@@ -1844,6 +2370,12 @@ gst_queue_set_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       queue->flush_on_eos = g_value_get_boolean (value);
       break;
+    case PROP_COOPERATIVE:
+      queue->cooperative = g_value_get_boolean (value);
+      break;
+    case PROP_LOCK_FREE:
+      queue->lock_free = g_value_get_boolean (value);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -1862,13 +2394,20 @@ gst_queue_get_property (GObject * object,
 
   switch (prop_id) {
     case PROP_CUR_LEVEL_BYTES:
-      g_value_set_uint (value, queue->cur_level.bytes);
+      if (queue->ring)
+        g_value_set_uint (value, gst_queue_ring_bytes (queue->ring));
+      else
+        g_value_set_uint (value, queue->cur_level.bytes);
       break;
     case PROP_CUR_LEVEL_BUFFERS:
-      g_value_set_uint (value, queue->cur_level.buffers);
+      if (queue->ring)
+        g_value_set_uint (value, (guint) g_atomic_int_get (&queue->ring->tail)
+            - (guint) g_atomic_int_get (&queue->ring->head));
+      else
+        g_value_set_uint (value, queue->cur_level.buffers);
       break;
     case PROP_CUR_LEVEL_TIME:
-      g_value_set_uint64 (value, queue->cur_level.time);
+      g_value_set_uint64 (value, queue->ring ? 0 : queue->cur_level.time);
       break;
     case PROP_MAX_SIZE_BYTES:
       g_value_set_uint (value, queue->max_size.bytes);
@@ -1897,6 +2436,12 @@ gst_queue_get_property (GObject * object,
     case PROP_FLUSH_ON_EOS:
       g_value_set_boolean (value, queue->flush_on_eos);
       break;
+    case PROP_COOPERATIVE:
+      g_value_set_boolean (value, queue->cooperative);
+      break;
+    case PROP_LOCK_FREE:
+      g_value_set_boolean (value, queue->lock_free);
+      break;
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -44,6 +44,7 @@ G_BEGIN_DECLS
 
 typedef struct _GstQueue GstQueue;
 typedef struct _GstQueueSize GstQueueSize;
+typedef struct _GstQueueRing GstQueueRing;
 typedef enum _GstQueueLeaky GstQueueLeaky;
 typedef struct _GstQueueClass GstQueueClass;
 
@@ -121,6 +122,7 @@ struct _GstQueue {
 
   GMutex qlock;        /* lock for queue (vs object lock) */
   gboolean waiting_add;
+  gboolean sleeping_add; /* cooperative task sleeps until buffers are added */
   GCond item_add;      /* signals buffers now available for reading */
   gboolean waiting_del;
   GCond item_del;      /* signals space now available for writing */
@@ -138,6 +140,11 @@ struct _GstQueue {
   GstQuery *last_handled_query;
 
   gboolean flush_on_eos; /* flush on EOS */
+
+  gboolean cooperative; /* run the srcpad task on the shared workers */
+
+  gboolean lock_free;   /* hand over buffers through the ring */
+  GstQueueRing *ring;   /* set between READY and PAUSED when lock_free applies */
 };
 
 struct _GstQueueClass {
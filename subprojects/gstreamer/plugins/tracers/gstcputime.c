@@ -0,0 +1,605 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstcputime.c: tracing module that logs the cpu time spent per element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:tracer-cputime
+ * @short_description: log the cpu time spent per element
+ *
+ * A tracing module that measures the cpu time of the streaming threads with
+ * `CLOCK_THREAD_CPUTIME_ID` and attributes it to the element that is running.
+ * Every thread keeps a stack of the chain functions it is in, the time between
+ * two chain boundaries is charged to the element on top of the stack, so
+ * elements are only charged for their own (exclusive) time. In threads that
+ * are not in a chain function, like the threads of sources and queues, the
+ * time between two buffer pushes is charged to the pushing element.
+ *
+ * The cpu time, the number of buffers and bytes handled and the cpu load in
+ * the last period are logged for each element every period and when an
+ * element is destroyed.
+ *
+ * The tracer accepts these params:
+ * 1. period: (uint) the time between logs in milliseconds, 1000 by default
+ * 2. name: (string) set a name for the tracer object itself
+ *
+ * Example:
+ * ```
+ * GST_TRACERS='cputime(period=5000)' GST_DEBUG=GST_TRACER:7
+ * ```
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <string.h>
+#include <time.h>
+
+#include "gstcputime.h"
+
+GST_DEBUG_CATEGORY_STATIC (gst_cpu_time_debug);
+#define GST_CAT_DEFAULT gst_cpu_time_debug
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_cpu_time_debug, "cputime", 0, \
+        "cputime tracer");
+#define gst_cpu_time_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstCpuTimeTracer, gst_cpu_time_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+#define DEFAULT_PERIOD 1000
+
+/* chain functions deeper than this are charged to the innermost element that
+ * fits on the stack */
+#define MAX_DEPTH 32
+
+static GstTracerRecord *tr_element;
+
+typedef struct
+{
+  guint64 time;
+  guint64 calls;
+  guint64 bytes;
+} GstCpuTimeStats;
+
+typedef struct
+{
+  gchar *name;
+  GstCpuTimeStats stats;
+  guint64 logged_time;
+} GstCpuTimeTotals;
+
+typedef struct
+{
+  /* protected by the threads lock */
+  GstCpuTimeTracer *self;
+  gboolean exited;
+
+  /* taken by the owning thread and when collecting */
+  GMutex lock;
+  GHashTable *stats;            /* GstElement -> GstCpuTimeStats */
+
+  /* only used by the owning thread */
+  GstElement *stack[MAX_DEPTH];
+  guint depth;
+  GstElement *owner;
+  GstClockTime last;
+} GstCpuTimeThread;
+
+static void thread_exit (gpointer data);
+
+G_LOCK_DEFINE_STATIC (threads);
+static GPrivate thread_key = G_PRIVATE_INIT (thread_exit);
+
+/* data helpers */
+
+static void
+thread_free (GstCpuTimeThread * thread)
+{
+  g_hash_table_unref (thread->stats);
+  g_mutex_clear (&thread->lock);
+  g_free (thread);
+}
+
+static void
+thread_exit (gpointer data)
+{
+  GstCpuTimeThread *thread = data;
+
+  /* the tracer frees the thread when it collects its stats the next time */
+  G_LOCK (threads);
+  if (thread->self)
+    thread->exited = TRUE;
+  else
+    thread_free (thread);
+  G_UNLOCK (threads);
+}
+
+static GstCpuTimeThread *
+get_thread (GstCpuTimeTracer * self)
+{
+  GstCpuTimeThread *thread = g_private_get (&thread_key);
+
+  if (G_LIKELY (thread && thread->self == self))
+    return thread;
+
+  thread = g_new0 (GstCpuTimeThread, 1);
+  thread->self = self;
+  thread->last = GST_CLOCK_TIME_NONE;
+  g_mutex_init (&thread->lock);
+  thread->stats = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  GST_OBJECT_LOCK (self);
+  self->threads = g_list_prepend (self->threads, thread);
+  GST_OBJECT_UNLOCK (self);
+
+  g_private_replace (&thread_key, thread);
+
+  return thread;
+}
+
+static inline GstClockTime
+get_thread_time (void)
+{
+  struct timespec now;
+
+  if (G_UNLIKELY (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &now)))
+    return GST_CLOCK_TIME_NONE;
+  return GST_TIMESPEC_TO_TIME (now);
+}
+
+/* must be called with the thread lock */
+static inline GstCpuTimeStats *
+get_stats (GstCpuTimeThread * thread, GstElement * element)
+{
+  GstCpuTimeStats *stats = g_hash_table_lookup (thread->stats, element);
+
+  if (G_UNLIKELY (stats == NULL)) {
+    stats = g_new0 (GstCpuTimeStats, 1);
+    g_hash_table_insert (thread->stats, element, stats);
+  }
+  return stats;
+}
+
+/* charges the time since the last boundary to @element and counts a call of
+ * @counted */
+static void
+charge (GstCpuTimeThread * thread, GstClockTime now, GstElement * element,
+    GstElement * counted, guint64 bytes)
+{
+  g_mutex_lock (&thread->lock);
+  if (element && GST_CLOCK_TIME_IS_VALID (thread->last) &&
+      GST_CLOCK_TIME_IS_VALID (now) && now > thread->last)
+    get_stats (thread, element)->time += now - thread->last;
+  if (counted) {
+    GstCpuTimeStats *stats = get_stats (thread, counted);
+
+    stats->calls++;
+    stats->bytes += bytes;
+  }
+  g_mutex_unlock (&thread->lock);
+
+  thread->last = now;
+}
+
+static inline GstElement *
+get_top (GstCpuTimeThread * thread)
+{
+  if (thread->depth == 0)
+    return NULL;
+  return thread->stack[MIN (thread->depth, MAX_DEPTH) - 1];
+}
+
+static inline GstElement *
+get_pad_element (GstPad * pad)
+{
+  GstObject *parent = GST_OBJECT_PARENT (pad);
+
+  return (parent && GST_IS_ELEMENT (parent)) ? GST_ELEMENT_CAST (parent) : NULL;
+}
+
+/* logging */
+
+/* moves the stats of all threads into the totals, must be called with the
+ * object lock */
+static void
+collect (GstCpuTimeTracer * self)
+{
+  GList *node, *next;
+  GHashTableIter iter;
+  gpointer key, value;
+
+  for (node = self->threads; node; node = next) {
+    GstCpuTimeThread *thread = node->data;
+    gboolean exited;
+
+    next = node->next;
+
+    g_mutex_lock (&thread->lock);
+    g_hash_table_iter_init (&iter, thread->stats);
+    while (g_hash_table_iter_next (&iter, &key, &value)) {
+      GstCpuTimeStats *stats = value;
+      GstCpuTimeTotals *totals = g_hash_table_lookup (self->elements, key);
+
+      if (totals == NULL) {
+        totals = g_new0 (GstCpuTimeTotals, 1);
+        totals->name = gst_object_get_name (GST_OBJECT_CAST (key));
+        g_hash_table_insert (self->elements, key, totals);
+      }
+      totals->stats.time += stats->time;
+      totals->stats.calls += stats->calls;
+      totals->stats.bytes += stats->bytes;
+      memset (stats, 0, sizeof (GstCpuTimeStats));
+    }
+    g_mutex_unlock (&thread->lock);
+
+    G_LOCK (threads);
+    exited = thread->exited;
+    G_UNLOCK (threads);
+    if (exited) {
+      self->threads = g_list_delete_link (self->threads, node);
+      thread_free (thread);
+    }
+  }
+}
+
+static void
+log_totals (GstElement * element, GstCpuTimeTotals * totals, GstClockTime ts,
+    GstClockTime period)
+{
+  guint cpuload = 0;
+
+  if (period > 0)
+    cpuload = (guint) gst_util_uint64_scale (totals->stats.time -
+        totals->logged_time, G_GINT64_CONSTANT (1000), period);
+  totals->logged_time = totals->stats.time;
+
+  gst_tracer_record_log (tr_element, (guint64) (guintptr) element,
+      totals->name, ts, totals->stats.time, totals->stats.calls,
+      totals->stats.bytes, MIN (cpuload, 1000));
+}
+
+static void
+maybe_log (GstCpuTimeTracer * self, GstClockTime ts)
+{
+  GHashTableIter iter;
+  gpointer key, value;
+
+  if (G_LIKELY (ts < self->next_log))
+    return;
+
+  GST_OBJECT_LOCK (self);
+  if (ts >= self->next_log) {
+    self->next_log = ts + self->period;
+    collect (self);
+
+    g_hash_table_iter_init (&iter, self->elements);
+    while (g_hash_table_iter_next (&iter, &key, &value))
+      log_totals (key, value, ts, ts - self->last_log);
+    self->last_log = ts;
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* hooks */
+
+static void
+do_chain_pre (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    guint64 bytes)
+{
+  GstCpuTimeThread *thread = get_thread (self);
+  GstElement *element = get_pad_element (pad);
+  GstElement *top = get_top (thread);
+  GstClockTime now = get_thread_time ();
+
+  charge (thread, now, top ? top : thread->owner, element, bytes);
+
+  /* chain functions of pads that are not on an element, like the proxy pads
+   * of ghost pads, are charged to the enclosing element */
+  if (thread->depth < MAX_DEPTH)
+    thread->stack[thread->depth] = element ? element : top;
+  thread->depth++;
+
+  maybe_log (self, ts);
+}
+
+static void
+do_chain_post (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad)
+{
+  GstCpuTimeThread *thread = get_thread (self);
+  GstElement *top;
+
+  /* started tracing in the middle of a chain function */
+  if (thread->depth == 0)
+    return;
+
+  top = get_top (thread);
+  thread->depth--;
+  charge (thread, get_thread_time (), top, NULL, 0);
+}
+
+static void
+do_push_pre (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    guint64 bytes)
+{
+  GstCpuTimeThread *thread = get_thread (self);
+  GstElement *element;
+
+  /* pushes from within a chain function are covered by the chain hooks */
+  if (thread->depth > 0)
+    return;
+
+  element = get_pad_element (pad);
+  if (element == NULL)
+    return;
+
+  /* the time since the last push of the same element is the time it took to
+   * produce this buffer, only count buffers of elements that don't get them
+   * from a chain function */
+  charge (thread, get_thread_time (),
+      thread->owner == element ? element : NULL,
+      element->numsinkpads == 0 ? element : NULL, bytes);
+  thread->owner = element;
+
+  maybe_log (self, ts);
+}
+
+static void
+do_push_post (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad)
+{
+  GstCpuTimeThread *thread = get_thread (self);
+  GstElement *element;
+
+  if (thread->depth > 0)
+    return;
+
+  element = get_pad_element (pad);
+  if (element == NULL)
+    return;
+
+  charge (thread, get_thread_time (),
+      thread->owner == element ? element : NULL, NULL, 0);
+  thread->owner = element;
+}
+
+static void
+do_chain_buffer_pre (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  do_chain_pre (self, ts, pad, gst_buffer_get_size (buffer));
+}
+
+static void
+do_chain_buffer_post (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  do_chain_post (self, ts, pad);
+}
+
+static void
+do_chain_buffer_list_pre (GstCpuTimeTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  do_chain_pre (self, ts, pad, gst_buffer_list_calculate_size (list));
+}
+
+static void
+do_push_buffer_pre (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  do_push_pre (self, ts, pad, gst_buffer_get_size (buffer));
+}
+
+static void
+do_push_buffer_post (GstCpuTimeTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  do_push_post (self, ts, pad);
+}
+
+static void
+do_push_buffer_list_pre (GstCpuTimeTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  do_push_pre (self, ts, pad, gst_buffer_list_calculate_size (list));
+}
+
+static void
+do_object_destroyed (GstCpuTimeTracer * self, GstClockTime ts,
+    GstObject * object)
+{
+  GstCpuTimeTotals *totals;
+  GList *node;
+
+  if (!GST_IS_ELEMENT (object))
+    return;
+
+  GST_OBJECT_LOCK (self);
+  collect (self);
+
+  for (node = self->threads; node; node = node->next) {
+    GstCpuTimeThread *thread = node->data;
+
+    g_mutex_lock (&thread->lock);
+    g_hash_table_remove (thread->stats, object);
+    g_mutex_unlock (&thread->lock);
+  }
+
+  /* log the final stats as another element might get the same address */
+  totals = g_hash_table_lookup (self->elements, object);
+  if (totals) {
+    log_totals (GST_ELEMENT_CAST (object), totals, ts, ts - self->last_log);
+    g_hash_table_remove (self->elements, object);
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* tracer class */
+
+static void
+totals_free (GstCpuTimeTotals * totals)
+{
+  g_free (totals->name);
+  g_free (totals);
+}
+
+static void
+gst_cpu_time_tracer_constructed (GObject * object)
+{
+  GstCpuTimeTracer *self = GST_CPU_TIME_TRACER (object);
+  gchar *params, *tmp;
+  const gchar *name;
+  GstStructure *params_struct = NULL;
+  guint period;
+
+  g_object_get (self, "params", &params, NULL);
+
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("cputime,%s", params);
+  g_free (params);
+  params_struct = gst_structure_from_string (tmp, NULL);
+  g_free (tmp);
+  if (!params_struct)
+    return;
+
+  if (gst_structure_get_uint (params_struct, "period", &period) && period > 0)
+    self->period = period * GST_MSECOND;
+
+  /* Set the name if assigned */
+  name = gst_structure_get_string (params_struct, "name");
+  if (name)
+    gst_object_set_name (GST_OBJECT (self), name);
+  gst_structure_free (params_struct);
+
+  self->next_log = self->period;
+}
+
+static void
+gst_cpu_time_tracer_finalize (GObject * obj)
+{
+  GstCpuTimeTracer *self = GST_CPU_TIME_TRACER (obj);
+  GList *node;
+
+  /* threads that are still running free their data when they exit */
+  G_LOCK (threads);
+  for (node = self->threads; node; node = node->next) {
+    GstCpuTimeThread *thread = node->data;
+
+    if (thread->exited)
+      thread_free (thread);
+    else
+      thread->self = NULL;
+  }
+  G_UNLOCK (threads);
+  g_list_free (self->threads);
+
+  g_hash_table_unref (self->elements);
+
+  G_OBJECT_CLASS (parent_class)->finalize (obj);
+}
+
+static void
+gst_cpu_time_tracer_class_init (GstCpuTimeTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_cpu_time_tracer_constructed;
+  gobject_class->finalize = gst_cpu_time_tracer_finalize;
+
+  /* announce trace formats */
+  /* *INDENT-OFF* */
+  tr_element = gst_tracer_record_new ("element-cputime.class",
+      "element-id", GST_TYPE_STRUCTURE, gst_structure_new ("scope",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "related-to", GST_TYPE_TRACER_VALUE_SCOPE, GST_TRACER_VALUE_SCOPE_ELEMENT,
+          NULL),
+      "name", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_STRING,
+          "description", G_TYPE_STRING, "name of the element",
+          NULL),
+      "ts", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "event ts",
+          NULL),
+      "time", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "cpu time spent in the element in ns",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      "calls", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of buffers and buffer lists handled",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      "bytes", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT64,
+          "description", G_TYPE_STRING, "number of bytes handled",
+          "flags", GST_TYPE_TRACER_VALUE_FLAGS, GST_TRACER_VALUE_FLAGS_AGGREGATED,
+          "min", G_TYPE_UINT64, G_GUINT64_CONSTANT (0),
+          "max", G_TYPE_UINT64, G_MAXUINT64,
+          NULL),
+      "cpuload", GST_TYPE_STRUCTURE, gst_structure_new ("value",
+          "type", G_TYPE_GTYPE, G_TYPE_UINT,
+          "description", G_TYPE_STRING, "cpu usage of the element in the last period in ‰",
+          "min", G_TYPE_UINT, 0,
+          "max", G_TYPE_UINT, 1000,
+          NULL),
+      NULL);
+  /* *INDENT-ON* */
+
+  GST_OBJECT_FLAG_SET (tr_element, GST_OBJECT_FLAG_MAY_BE_LEAKED);
+}
+
+static void
+gst_cpu_time_tracer_init (GstCpuTimeTracer * self)
+{
+  GstTracer *tracer = GST_TRACER (self);
+
+  self->period = DEFAULT_PERIOD * GST_MSECOND;
+  self->next_log = self->period;
+  self->elements = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) totals_free);
+
+  gst_tracing_register_hook (tracer, "pad-chain-pre",
+      G_CALLBACK (do_chain_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-chain-post",
+      G_CALLBACK (do_chain_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-chain-list-pre",
+      G_CALLBACK (do_chain_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-chain-list-post",
+      G_CALLBACK (do_chain_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "object-destroyed",
+      G_CALLBACK (do_object_destroyed));
+}
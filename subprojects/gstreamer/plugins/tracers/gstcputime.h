@@ -0,0 +1,71 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstcputime.h: tracing module that logs the cpu time spent per element
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_CPU_TIME_TRACER_H__
+#define __GST_CPU_TIME_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_CPU_TIME_TRACER \
+  (gst_cpu_time_tracer_get_type())
+#define GST_CPU_TIME_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_CPU_TIME_TRACER,GstCpuTimeTracer))
+#define GST_CPU_TIME_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_CPU_TIME_TRACER,GstCpuTimeTracerClass))
+#define GST_IS_CPU_TIME_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_CPU_TIME_TRACER))
+#define GST_IS_CPU_TIME_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_CPU_TIME_TRACER))
+#define GST_CPU_TIME_TRACER_CAST(obj) ((GstCpuTimeTracer *)(obj))
+
+typedef struct _GstCpuTimeTracer GstCpuTimeTracer;
+typedef struct _GstCpuTimeTracerClass GstCpuTimeTracerClass;
+
+/**
+ * GstCpuTimeTracer:
+ *
+ * Opaque #GstCpuTimeTracer data structure
+ */
+struct _GstCpuTimeTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  GstClockTime period;
+
+  /* protected by the object lock, next_log is checked without it */
+  GstClockTime next_log;
+  GstClockTime last_log;
+  GList *threads;               /* GstCpuTimeThread */
+  GHashTable *elements;         /* GstElement -> GstCpuTimeTotals */
+};
+
+struct _GstCpuTimeTracerClass {
+  GstTracerClass parent_class;
+};
+
+G_GNUC_INTERNAL GType gst_cpu_time_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_CPU_TIME_TRACER_H__ */
@@ -0,0 +1,891 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstflightrecorder.c: tracing module that records events in ring buffers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+/**
+ * SECTION:tracer-flightrecorder
+ * @short_description: record pipeline activity in binary ring buffers
+ *
+ * A tracing module that records buffer pushes, chain calls, queue levels and
+ * clock waits as compact binary records. Every thread writes into its own
+ * ring buffer without taking any locks or formatting any text, so the tracer
+ * is cheap enough to be left enabled. Queue levels are sampled periodically
+ * from a separate thread instead of on every buffer. The ring buffers only
+ * keep the most recent records, and the ring buffer of a thread that exited
+ * is reused by the next new thread. They are written to a file when
+ * requested:
+ *
+ * * by emitting the "dump" action signal on the tracer, which can be found
+ *   with gst_tracing_get_active_tracers()
+ * * by sending `SIGUSR2` to the process when the dump-on-signal param is set
+ * * on gst_deinit() when the dump-on-deinit param is set
+ *
+ * The dump can be converted to the Chrome JSON trace format that is opened
+ * by Perfetto (https://ui.perfetto.dev) and chrome://tracing with the
+ * `gst-flight-recorder-convert.py` script in the scripts directory.
+ *
+ * The tracer accepts these params:
+ * 1. file: (string) the file to dump to, `gstflightrecorder.gstfr` in the
+ *    temporary directory by default
+ * 2. buffer-size: (uint) the number of records kept per thread, rounded up
+ *    to a power of two, 16384 by default
+ * 3. dump-on-deinit: (boolean) dump on gst_deinit(), "false" by default
+ * 4. dump-on-signal: (boolean) dump on `SIGUSR2`, "false" by default
+ * 5. sample-interval: (uint) the interval in milliseconds at which queue
+ *    levels are sampled, 10 by default
+ *
+ * Only one instance of this tracer records at a time.
+ *
+ * Example:
+ * ```
+ * GST_TRACERS='flightrecorder(file=/tmp/stall.gstfr,dump-on-signal=true)'
+ * ```
+ *
+ * Since: 1.22
+ */
+
+#ifdef HAVE_CONFIG_H
+#  include "config.h"
+#endif
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <glib/gstdio.h>
+
+#include "gstflightrecorder.h"
+
+#ifdef G_OS_UNIX
+#include <glib-unix.h>
+#include <signal.h>
+#endif /* G_OS_UNIX */
+
+GST_DEBUG_CATEGORY_STATIC (gst_flight_recorder_debug);
+#define GST_CAT_DEFAULT gst_flight_recorder_debug
+
+enum
+{
+  /* actions */
+  SIGNAL_DUMP,
+
+  LAST_SIGNAL
+};
+
+static guint gst_flight_recorder_tracer_signals[LAST_SIGNAL] = { 0 };
+
+#define _do_init \
+    GST_DEBUG_CATEGORY_INIT (gst_flight_recorder_debug, "flightrecorder", 0, \
+        "flight recorder tracer");
+#define gst_flight_recorder_tracer_parent_class parent_class
+G_DEFINE_TYPE_WITH_CODE (GstFlightRecorderTracer, gst_flight_recorder_tracer,
+    GST_TYPE_TRACER, _do_init);
+
+#define DEFAULT_FILE "gstflightrecorder.gstfr"
+#define DEFAULT_BUFFER_SIZE 16384
+#define DEFAULT_SAMPLE_INTERVAL 10
+
+/* dump file format, all fields in host byte order:
+ *
+ * header:  char magic[8], guint32 byte_order, guint32 version,
+ *          guint32 record_size, guint32 n_rings, guint32 n_names,
+ *          guint32 reserved
+ * n_rings: guint32 thread_index, guint32 n_records, guint64 thread,
+ *          FlightRecord records[n_records], oldest first
+ * n_names: guint64 id, guint64 parent_id, guint32 kind, guint32 length,
+ *          gchar name[length]
+ */
+#define DUMP_MAGIC "GSTFLREC"
+#define DUMP_BYTE_ORDER 0x01020304
+#define DUMP_VERSION 1
+
+typedef enum
+{
+  RECORD_PAD_PUSH_PRE = 1,
+  RECORD_PAD_PUSH_POST,
+  RECORD_PAD_PUSH_LIST_PRE,
+  RECORD_PAD_PUSH_LIST_POST,
+  RECORD_PAD_CHAIN_PRE,
+  RECORD_PAD_CHAIN_POST,
+  RECORD_PAD_CHAIN_LIST_PRE,
+  RECORD_PAD_CHAIN_LIST_POST,
+  RECORD_QUEUE_LEVEL,
+  RECORD_CLOCK_WAIT_PRE,
+  RECORD_CLOCK_WAIT_POST,
+} FlightRecordType;
+
+typedef enum
+{
+  NAME_ELEMENT = 0,
+  NAME_PAD,
+} FlightNameKind;
+
+/* @value is the buffer size, list length, flow return, queue level in bytes,
+ * clock time or jitter and @extra the queue level in buffers or the clock
+ * return, depending on @type */
+typedef struct
+{
+  guint64 ts;
+  guint64 object;
+  guint64 value;
+  guint16 type;
+  guint16 reserved;
+  guint32 extra;
+} FlightRecord;
+
+G_STATIC_ASSERT (sizeof (FlightRecord) == 32);
+
+typedef struct
+{
+  /* only written by the thread that owns the ring, read when dumping */
+  gint head;
+  guint mask;
+  guint index;
+  /* protected by the object lock */
+  gboolean unused;
+  guint64 thread;
+  FlightRecord records[1];
+} FlightRing;
+
+typedef struct
+{
+  guint generation;
+  FlightRing *ring;
+} FlightThreadState;
+
+typedef struct
+{
+  guint64 parent;
+  FlightNameKind kind;
+  gchar *name;
+} FlightName;
+
+static void flight_thread_state_free (FlightThreadState * state);
+
+/* the instance that is recording */
+static GstFlightRecorderTracer *recorder = NULL;
+static gint generation_counter = 0;
+static GPrivate thread_state =
+G_PRIVATE_INIT ((GDestroyNotify) flight_thread_state_free);
+
+static void
+flight_name_free (FlightName * name)
+{
+  g_free (name->name);
+  g_slice_free (FlightName, name);
+}
+
+static void
+flight_weak_ref_free (GWeakRef * ref)
+{
+  g_weak_ref_clear (ref);
+  g_slice_free (GWeakRef, ref);
+}
+
+/* called when a thread exits, hands its ring back to the recorder so that
+ * the next new thread reuses it. Tracers are only finalized in gst_deinit()
+ * so the recorder outlives the threads that record into it */
+static void
+flight_thread_state_free (FlightThreadState * state)
+{
+  GstFlightRecorderTracer *self = g_atomic_pointer_get (&recorder);
+
+  if (self && state->ring && state->generation == self->generation) {
+    GST_OBJECT_LOCK (self);
+    state->ring->unused = TRUE;
+    GST_OBJECT_UNLOCK (self);
+  }
+  g_free (state);
+}
+
+static FlightRing *
+flight_ring_new (GstFlightRecorderTracer * self)
+{
+  FlightRing *ring;
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  for (i = 0; i < self->rings->len; i++) {
+    ring = g_ptr_array_index (self->rings, i);
+    if (ring->unused) {
+      /* the records of the exited thread are dropped */
+      ring->unused = FALSE;
+      ring->thread = (guint64) (guintptr) g_thread_self ();
+      g_atomic_int_set (&ring->head, 0);
+      GST_OBJECT_UNLOCK (self);
+
+      GST_DEBUG_OBJECT (self, "reusing ring %u for thread %p", ring->index,
+          g_thread_self ());
+      return ring;
+    }
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  ring = g_malloc0 (sizeof (FlightRing) +
+      (self->ring_size - 1) * sizeof (FlightRecord));
+  ring->mask = self->ring_size - 1;
+  ring->thread = (guint64) (guintptr) g_thread_self ();
+
+  GST_OBJECT_LOCK (self);
+  ring->index = self->rings->len;
+  g_ptr_array_add (self->rings, ring);
+  GST_OBJECT_UNLOCK (self);
+
+  GST_DEBUG_OBJECT (self, "new ring %u for thread %p", ring->index,
+      g_thread_self ());
+
+  return ring;
+}
+
+static inline FlightRing *
+get_ring (GstFlightRecorderTracer * self)
+{
+  FlightThreadState *state = g_private_get (&thread_state);
+
+  if (G_UNLIKELY (state == NULL)) {
+    state = g_new0 (FlightThreadState, 1);
+    g_private_set (&thread_state, state);
+  }
+  if (G_UNLIKELY (state->generation != self->generation)) {
+    state->ring = flight_ring_new (self);
+    state->generation = self->generation;
+  }
+  return state->ring;
+}
+
+static inline void
+record (GstFlightRecorderTracer * self, GstClockTime ts, FlightRecordType type,
+    gpointer object, guint64 value, guint32 extra)
+{
+  FlightRing *ring = get_ring (self);
+  guint head = (guint) ring->head;
+  FlightRecord *r = &ring->records[head & ring->mask];
+
+  r->ts = ts;
+  r->object = (guint64) (guintptr) object;
+  r->value = value;
+  r->type = type;
+  r->extra = extra;
+
+  /* publish the record to a concurrent dump */
+  g_atomic_int_set (&ring->head, (gint) (head + 1));
+}
+
+/* names */
+
+static void
+set_name (GstFlightRecorderTracer * self, gpointer object, gpointer parent,
+    FlightNameKind kind)
+{
+  FlightName *name = g_slice_new (FlightName);
+
+  name->parent = (guint64) (guintptr) parent;
+  name->kind = kind;
+  name->name = gst_object_get_name (GST_OBJECT_CAST (object));
+
+  GST_OBJECT_LOCK (self);
+  g_hash_table_replace (self->names, object, name);
+  GST_OBJECT_UNLOCK (self);
+}
+
+/* queue levels */
+
+/* remembers @element to sample its levels if it has the level properties of
+ * queue, queue2 or multiqueue */
+static void
+track_queue (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstElement * element)
+{
+  GObjectClass *klass = G_OBJECT_GET_CLASS (element);
+  GWeakRef *ref;
+
+  if (!g_object_class_find_property (klass, "current-level-buffers") ||
+      !g_object_class_find_property (klass, "current-level-bytes"))
+    return;
+
+  GST_OBJECT_LOCK (self);
+  if (!g_hash_table_contains (self->queues, element)) {
+    GST_DEBUG_OBJECT (self, "sampling levels of %s",
+        GST_OBJECT_NAME (element));
+    /* the hook timestamps are relative to gst_init(), which is not exposed
+     * to plugins, take the offset from the first hook that adds a queue */
+    if (self->ts_offset == 0)
+      self->ts_offset = GST_CLOCK_DIFF (ts, gst_util_get_timestamp ());
+    ref = g_slice_new (GWeakRef);
+    g_weak_ref_init (ref, element);
+    g_hash_table_insert (self->queues, element, ref);
+  }
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+sample_queues (GstFlightRecorderTracer * self, GPtrArray * queues)
+{
+  GHashTableIter iter;
+  gpointer value;
+  GstClockTime ts;
+  guint i;
+
+  GST_OBJECT_LOCK (self);
+  g_hash_table_iter_init (&iter, self->queues);
+  while (g_hash_table_iter_next (&iter, NULL, &value)) {
+    GstElement *queue = g_weak_ref_get (value);
+
+    if (queue)
+      g_ptr_array_add (queues, queue);
+  }
+  ts = GST_CLOCK_DIFF (self->ts_offset, gst_util_get_timestamp ());
+  GST_OBJECT_UNLOCK (self);
+
+  for (i = 0; i < queues->len; i++) {
+    GstElement *queue = g_ptr_array_index (queues, i);
+    guint buffers = 0, bytes = 0;
+
+    g_object_get (queue, "current-level-buffers", &buffers,
+        "current-level-bytes", &bytes, NULL);
+    record (self, ts, RECORD_QUEUE_LEVEL, queue, bytes, buffers);
+  }
+
+  /* drops the references outside of the object lock, the last one runs the
+   * object-destroyed hook */
+  g_ptr_array_set_size (queues, 0);
+}
+
+static gpointer
+gst_flight_recorder_tracer_sample_thread (GstFlightRecorderTracer * self)
+{
+  GPtrArray *queues = g_ptr_array_new_with_free_func (gst_object_unref);
+  gint64 end_time;
+
+  g_mutex_lock (&self->sample_lock);
+  end_time = g_get_monotonic_time () +
+      self->sample_interval * G_TIME_SPAN_MILLISECOND;
+  while (self->sampling) {
+    if (g_cond_wait_until (&self->sample_cond, &self->sample_lock, end_time))
+      continue;
+
+    g_mutex_unlock (&self->sample_lock);
+    sample_queues (self, queues);
+    g_mutex_lock (&self->sample_lock);
+
+    end_time = g_get_monotonic_time () +
+        self->sample_interval * G_TIME_SPAN_MILLISECOND;
+  }
+  g_mutex_unlock (&self->sample_lock);
+
+  g_ptr_array_unref (queues);
+
+  return NULL;
+}
+
+static void
+gst_flight_recorder_tracer_start_sampling (GstFlightRecorderTracer * self)
+{
+  GST_INFO_OBJECT (self, "sampling queue levels every %u ms",
+      self->sample_interval);
+  self->sampling = TRUE;
+  self->sample_thread = g_thread_new ("gstflightrec-sample",
+      (GThreadFunc) gst_flight_recorder_tracer_sample_thread, self);
+}
+
+static void
+gst_flight_recorder_tracer_stop_sampling (GstFlightRecorderTracer * self)
+{
+  if (!self->sample_thread)
+    return;
+
+  g_mutex_lock (&self->sample_lock);
+  self->sampling = FALSE;
+  g_cond_signal (&self->sample_cond);
+  g_mutex_unlock (&self->sample_lock);
+  g_thread_join (self->sample_thread);
+  self->sample_thread = NULL;
+}
+
+/* hooks */
+
+static void
+do_element_add_pad (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstElement * element, GstPad * pad)
+{
+  set_name (self, element, GST_OBJECT_PARENT (element), NAME_ELEMENT);
+  set_name (self, pad, element, NAME_PAD);
+  track_queue (self, ts, element);
+}
+
+static void
+do_bin_add_post (GstFlightRecorderTracer * self, GstClockTime ts, GstBin * bin,
+    GstElement * element, gboolean result)
+{
+  if (!result)
+    return;
+
+  set_name (self, element, bin, NAME_ELEMENT);
+  track_queue (self, ts, element);
+}
+
+static void
+do_object_destroyed (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstObject * object)
+{
+  GST_OBJECT_LOCK (self);
+  g_hash_table_remove (self->names, object);
+  g_hash_table_remove (self->queues, object);
+  GST_OBJECT_UNLOCK (self);
+}
+
+static void
+do_push_buffer_pre (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstBuffer * buffer)
+{
+  record (self, ts, RECORD_PAD_PUSH_PRE, pad, gst_buffer_get_size (buffer), 0);
+}
+
+static void
+do_push_buffer_post (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstFlowReturn res)
+{
+  record (self, ts, RECORD_PAD_PUSH_POST, pad, (guint64) (gint64) res, 0);
+}
+
+static void
+do_push_buffer_list_pre (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  record (self, ts, RECORD_PAD_PUSH_LIST_PRE, pad,
+      gst_buffer_list_length (list), 0);
+}
+
+static void
+do_push_buffer_list_post (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstFlowReturn res)
+{
+  record (self, ts, RECORD_PAD_PUSH_LIST_POST, pad, (guint64) (gint64) res, 0);
+}
+
+static void
+do_chain_pre (GstFlightRecorderTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  record (self, ts, RECORD_PAD_CHAIN_PRE, pad, gst_buffer_get_size (buffer), 0);
+}
+
+static void
+do_chain_post (GstFlightRecorderTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  record (self, ts, RECORD_PAD_CHAIN_POST, pad, (guint64) (gint64) res, 0);
+}
+
+static void
+do_chain_list_pre (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstBufferList * list)
+{
+  record (self, ts, RECORD_PAD_CHAIN_LIST_PRE, pad,
+      gst_buffer_list_length (list), 0);
+}
+
+static void
+do_chain_list_post (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstPad * pad, GstFlowReturn res)
+{
+  record (self, ts, RECORD_PAD_CHAIN_LIST_POST, pad, (guint64) (gint64) res,
+      0);
+}
+
+static void
+do_clock_wait_pre (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstClock * clock, GstClockID id)
+{
+  record (self, ts, RECORD_CLOCK_WAIT_PRE, clock, gst_clock_id_get_time (id),
+      0);
+}
+
+static void
+do_clock_wait_post (GstFlightRecorderTracer * self, GstClockTime ts,
+    GstClock * clock, GstClockID id, GstClockReturn res,
+    GstClockTimeDiff jitter)
+{
+  record (self, ts, RECORD_CLOCK_WAIT_POST, clock, (guint64) jitter,
+      (guint32) res);
+}
+
+/* dumping */
+
+/* copies the records of @ring that are not overwritten while copying into
+ * @records, returns the number of records */
+static guint
+copy_ring (FlightRing * ring, FlightRecord * records)
+{
+  guint size = ring->mask + 1;
+  guint head, tail, end, n, i;
+
+  head = (guint) g_atomic_int_get (&ring->head);
+  n = MIN (head, size);
+  tail = head - n;
+  for (i = 0; i < n; i++)
+    records[i] = ring->records[(tail + i) & ring->mask];
+
+  /* the writer might have wrapped around into the records we copied, drop
+   * the ones that were overwritten. Record @end is only published once it
+   * is written, so its slot, the one of record @end - @size, counts as lost
+   * too */
+  end = (guint) g_atomic_int_get (&ring->head);
+  if (end + 1 - tail > size) {
+    guint lost = MIN (end + 1 - tail - size, n);
+
+    memmove (records, records + lost, (n - lost) * sizeof (FlightRecord));
+    n -= lost;
+  }
+
+  return n;
+}
+
+typedef struct
+{
+  guint64 id;
+  guint64 parent;
+  guint32 header[2];
+  gchar *name;
+} FlightNameCopy;
+
+static gboolean
+write_all (FILE * f, gconstpointer data, gsize size)
+{
+  return size == 0 || fwrite (data, size, 1, f) == 1;
+}
+
+static gboolean
+gst_flight_recorder_tracer_dump (GstFlightRecorderTracer * self,
+    const gchar * filename)
+{
+  gchar *path = NULL;
+  FILE *f;
+  FlightRecord *records;
+  FlightNameCopy *names;
+  guint32 *ring_headers;
+  guint64 *threads;
+  GHashTableIter iter;
+  gpointer key, value;
+  gboolean ret = TRUE;
+  guint32 header[6];
+  guint n_rings, n_names, i;
+
+  if (filename == NULL) {
+    if (self->file)
+      filename = self->file;
+    else
+      filename = path = g_build_filename (g_get_tmp_dir (), DEFAULT_FILE, NULL);
+  }
+
+  f = g_fopen (filename, "wb");
+  if (f == NULL) {
+    GST_WARNING_OBJECT (self, "could not open %s: %s", filename,
+        g_strerror (errno));
+    g_free (path);
+    return FALSE;
+  }
+
+  /* only copy under the lock, streaming threads take it when they start
+   * recording or add pads and must not wait for the file to be written */
+  GST_OBJECT_LOCK (self);
+  n_rings = self->rings->len;
+  records = g_new (FlightRecord, (gsize) n_rings * self->ring_size);
+  ring_headers = g_new (guint32, 2 * n_rings);
+  threads = g_new (guint64, n_rings);
+  for (i = 0; i < n_rings; i++) {
+    FlightRing *ring = g_ptr_array_index (self->rings, i);
+
+    ring_headers[2 * i] = ring->index;
+    ring_headers[2 * i + 1] =
+        copy_ring (ring, records + (gsize) i * self->ring_size);
+    threads[i] = ring->thread;
+  }
+
+  n_names = g_hash_table_size (self->names);
+  names = g_new (FlightNameCopy, n_names);
+  i = 0;
+  g_hash_table_iter_init (&iter, self->names);
+  while (g_hash_table_iter_next (&iter, &key, &value)) {
+    FlightName *name = value;
+
+    names[i].id = (guint64) (guintptr) key;
+    names[i].parent = name->parent;
+    names[i].header[0] = name->kind;
+    names[i].header[1] = name->name ? strlen (name->name) : 0;
+    names[i].name = g_strdup (name->name);
+    i++;
+  }
+  GST_OBJECT_UNLOCK (self);
+
+  header[0] = DUMP_BYTE_ORDER;
+  header[1] = DUMP_VERSION;
+  header[2] = sizeof (FlightRecord);
+  header[3] = n_rings;
+  header[4] = n_names;
+  header[5] = 0;
+  ret &= write_all (f, DUMP_MAGIC, 8);
+  ret &= write_all (f, header, sizeof (header));
+
+  for (i = 0; i < n_rings; i++) {
+    ret &= write_all (f, &ring_headers[2 * i], 2 * sizeof (guint32));
+    ret &= write_all (f, &threads[i], sizeof (guint64));
+    ret &= write_all (f, records + (gsize) i * self->ring_size,
+        ring_headers[2 * i + 1] * sizeof (FlightRecord));
+  }
+
+  for (i = 0; i < n_names; i++) {
+    ret &= write_all (f, &names[i].id, sizeof (names[i].id));
+    ret &= write_all (f, &names[i].parent, sizeof (names[i].parent));
+    ret &= write_all (f, names[i].header, sizeof (names[i].header));
+    ret &= write_all (f, names[i].name, names[i].header[1]);
+    g_free (names[i].name);
+  }
+
+  g_free (names);
+  g_free (threads);
+  g_free (ring_headers);
+  g_free (records);
+  if (fclose (f) != 0)
+    ret = FALSE;
+
+  if (ret)
+    GST_INFO_OBJECT (self, "dumped to %s", filename);
+  else
+    GST_WARNING_OBJECT (self, "failed to write %s", filename);
+
+  g_free (path);
+  return ret;
+}
+
+#ifdef G_OS_UNIX
+static gboolean
+sig_usr2_handler (gpointer data)
+{
+  gst_flight_recorder_tracer_dump (GST_FLIGHT_RECORDER_TRACER (data), NULL);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gpointer
+gst_flight_recorder_tracer_signal_thread (GstFlightRecorderTracer * self)
+{
+  GMainContext *ctx = g_main_loop_get_context (self->signal_loop);
+  GSource *source;
+
+  g_main_context_push_thread_default (ctx);
+  source = g_unix_signal_source_new (SIGUSR2);
+  g_source_set_callback (source, sig_usr2_handler, self, NULL);
+  g_source_attach (source, ctx);
+
+  g_main_loop_run (self->signal_loop);
+
+  g_source_destroy (source);
+  g_source_unref (source);
+  g_main_context_pop_thread_default (ctx);
+
+  return NULL;
+}
+
+static void
+gst_flight_recorder_tracer_setup_signals (GstFlightRecorderTracer * self)
+{
+  GMainContext *ctx = g_main_context_new ();
+
+  GST_INFO_OBJECT (self, "dumping on SIGUSR2");
+  self->signal_loop = g_main_loop_new (ctx, FALSE);
+  g_main_context_unref (ctx);
+  self->signal_thread = g_thread_new ("gstflightrec-signal",
+      (GThreadFunc) gst_flight_recorder_tracer_signal_thread, self);
+}
+
+static void
+gst_flight_recorder_tracer_cleanup_signals (GstFlightRecorderTracer * self)
+{
+  if (!self->signal_thread)
+    return;
+
+  g_main_loop_quit (self->signal_loop);
+  g_thread_join (self->signal_thread);
+  self->signal_thread = NULL;
+  g_main_loop_unref (self->signal_loop);
+  self->signal_loop = NULL;
+}
+#endif /* G_OS_UNIX */
+
+/* tracer class */
+
+static void
+set_params (GstFlightRecorderTracer * self, gboolean * dump_on_signal)
+{
+  gchar *params, *tmp;
+  GstStructure *params_struct = NULL;
+  guint buffer_size, sample_interval;
+
+  g_object_get (self, "params", &params, NULL);
+  if (!params)
+    return;
+
+  tmp = g_strdup_printf ("flightrecorder,%s", params);
+  params_struct = gst_structure_from_string (tmp, NULL);
+  g_free (tmp);
+
+  if (params_struct) {
+    const gchar *file = gst_structure_get_string (params_struct, "file");
+
+    if (file)
+      self->file = g_strdup (file);
+    if (gst_structure_get_uint (params_struct, "buffer-size", &buffer_size)
+        && buffer_size > 0)
+      self->ring_size = 1 << g_bit_storage (buffer_size - 1);
+    gst_structure_get_boolean (params_struct, "dump-on-deinit",
+        &self->dump_on_deinit);
+    gst_structure_get_boolean (params_struct, "dump-on-signal",
+        dump_on_signal);
+    if (gst_structure_get_uint (params_struct, "sample-interval",
+            &sample_interval) && sample_interval > 0)
+      self->sample_interval = sample_interval;
+    gst_structure_free (params_struct);
+  } else {
+    GST_WARNING_OBJECT (self, "invalid params: %s", params);
+  }
+
+  g_free (params);
+}
+
+static void
+gst_flight_recorder_tracer_constructed (GObject * object)
+{
+  GstFlightRecorderTracer *self = GST_FLIGHT_RECORDER_TRACER (object);
+  GstTracer *tracer = GST_TRACER (object);
+  gboolean dump_on_signal = FALSE;
+
+  G_OBJECT_CLASS (parent_class)->constructed (object);
+
+  if (!g_atomic_pointer_compare_and_exchange (&recorder, NULL, self)) {
+    GST_WARNING_OBJECT (self, "another flight recorder is already recording");
+    return;
+  }
+
+  set_params (self, &dump_on_signal);
+  GST_INFO_OBJECT (self, "recording %u records per thread", self->ring_size);
+  gst_flight_recorder_tracer_start_sampling (self);
+
+  if (dump_on_signal) {
+#ifdef G_OS_UNIX
+    gst_flight_recorder_tracer_setup_signals (self);
+#else
+    g_warning ("System doesn't support POSIX signals");
+#endif /* G_OS_UNIX */
+  }
+
+  gst_tracing_register_hook (tracer, "element-add-pad",
+      G_CALLBACK (do_element_add_pad));
+  gst_tracing_register_hook (tracer, "bin-add-post",
+      G_CALLBACK (do_bin_add_post));
+  gst_tracing_register_hook (tracer, "object-destroyed",
+      G_CALLBACK (do_object_destroyed));
+  gst_tracing_register_hook (tracer, "pad-push-pre",
+      G_CALLBACK (do_push_buffer_pre));
+  gst_tracing_register_hook (tracer, "pad-push-post",
+      G_CALLBACK (do_push_buffer_post));
+  gst_tracing_register_hook (tracer, "pad-push-list-pre",
+      G_CALLBACK (do_push_buffer_list_pre));
+  gst_tracing_register_hook (tracer, "pad-push-list-post",
+      G_CALLBACK (do_push_buffer_list_post));
+  gst_tracing_register_hook (tracer, "pad-chain-pre",
+      G_CALLBACK (do_chain_pre));
+  gst_tracing_register_hook (tracer, "pad-chain-post",
+      G_CALLBACK (do_chain_post));
+  gst_tracing_register_hook (tracer, "pad-chain-list-pre",
+      G_CALLBACK (do_chain_list_pre));
+  gst_tracing_register_hook (tracer, "pad-chain-list-post",
+      G_CALLBACK (do_chain_list_post));
+  gst_tracing_register_hook (tracer, "clock-wait-pre",
+      G_CALLBACK (do_clock_wait_pre));
+  gst_tracing_register_hook (tracer, "clock-wait-post",
+      G_CALLBACK (do_clock_wait_post));
+}
+
+static void
+gst_flight_recorder_tracer_finalize (GObject * object)
+{
+  GstFlightRecorderTracer *self = GST_FLIGHT_RECORDER_TRACER (object);
+
+  if (g_atomic_pointer_compare_and_exchange (&recorder, self, NULL)) {
+    gst_flight_recorder_tracer_stop_sampling (self);
+#ifdef G_OS_UNIX
+    gst_flight_recorder_tracer_cleanup_signals (self);
+#endif
+    if (self->dump_on_deinit)
+      gst_flight_recorder_tracer_dump (self, NULL);
+  }
+
+  g_ptr_array_unref (self->rings);
+  g_hash_table_unref (self->names);
+  g_hash_table_unref (self->queues);
+  g_mutex_clear (&self->sample_lock);
+  g_cond_clear (&self->sample_cond);
+  g_free (self->file);
+
+  G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
+static void
+gst_flight_recorder_tracer_class_init (GstFlightRecorderTracerClass * klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->constructed = gst_flight_recorder_tracer_constructed;
+  gobject_class->finalize = gst_flight_recorder_tracer_finalize;
+
+  klass->dump = gst_flight_recorder_tracer_dump;
+
+  /**
+   * GstFlightRecorderTracer::dump:
+   * @flightrecorder: the flight recorder tracer object
+   * @filename: (nullable): the file to write to, or %NULL to use the file
+   *   param
+   *
+   * Writes the records of all threads to @filename.
+   *
+   * Returns: %TRUE if the records were written
+   *
+   * Since: 1.22
+   */
+  gst_flight_recorder_tracer_signals[SIGNAL_DUMP] =
+      g_signal_new ("dump", G_TYPE_FROM_CLASS (klass),
+      G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION,
+      G_STRUCT_OFFSET (GstFlightRecorderTracerClass, dump), NULL, NULL, NULL,
+      G_TYPE_BOOLEAN, 1, G_TYPE_STRING);
+}
+
+static void
+gst_flight_recorder_tracer_init (GstFlightRecorderTracer * self)
+{
+  self->generation = g_atomic_int_add (&generation_counter, 1) + 1;
+  self->ring_size = DEFAULT_BUFFER_SIZE;
+  self->sample_interval = DEFAULT_SAMPLE_INTERVAL;
+  self->rings = g_ptr_array_new_with_free_func (g_free);
+  self->names = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) flight_name_free);
+  self->queues = g_hash_table_new_full (NULL, NULL, NULL,
+      (GDestroyNotify) flight_weak_ref_free);
+  g_mutex_init (&self->sample_lock);
+  g_cond_init (&self->sample_cond);
+}
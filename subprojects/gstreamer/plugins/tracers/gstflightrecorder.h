@@ -0,0 +1,87 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * gstflightrecorder.h: tracing module that records events in ring buffers
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef __GST_FLIGHT_RECORDER_TRACER_H__
+#define __GST_FLIGHT_RECORDER_TRACER_H__
+
+#include <gst/gst.h>
+#include <gst/gsttracer.h>
+
+G_BEGIN_DECLS
+
+#define GST_TYPE_FLIGHT_RECORDER_TRACER \
+  (gst_flight_recorder_tracer_get_type())
+#define GST_FLIGHT_RECORDER_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_CAST((obj),GST_TYPE_FLIGHT_RECORDER_TRACER,GstFlightRecorderTracer))
+#define GST_FLIGHT_RECORDER_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_CAST((klass),GST_TYPE_FLIGHT_RECORDER_TRACER,GstFlightRecorderTracerClass))
+#define GST_IS_FLIGHT_RECORDER_TRACER(obj) \
+  (G_TYPE_CHECK_INSTANCE_TYPE((obj),GST_TYPE_FLIGHT_RECORDER_TRACER))
+#define GST_IS_FLIGHT_RECORDER_TRACER_CLASS(klass) \
+  (G_TYPE_CHECK_CLASS_TYPE((klass),GST_TYPE_FLIGHT_RECORDER_TRACER))
+#define GST_FLIGHT_RECORDER_TRACER_CAST(obj) ((GstFlightRecorderTracer *)(obj))
+
+typedef struct _GstFlightRecorderTracer GstFlightRecorderTracer;
+typedef struct _GstFlightRecorderTracerClass GstFlightRecorderTracerClass;
+
+/**
+ * GstFlightRecorderTracer:
+ *
+ * Opaque #GstFlightRecorderTracer data structure
+ */
+struct _GstFlightRecorderTracer {
+  GstTracer 	 parent;
+
+  /*< private >*/
+  guint generation;
+  guint ring_size;
+  gchar *file;
+  gboolean dump_on_deinit;
+
+  /* protected by the object lock */
+  GPtrArray *rings;
+  GHashTable *names;
+  GHashTable *queues;
+  GstClockTimeDiff ts_offset;
+
+  /* queue level sampling */
+  guint sample_interval;
+  GMutex sample_lock;
+  GCond sample_cond;
+  gboolean sampling;
+  GThread *sample_thread;
+
+  GMainLoop *signal_loop;
+  GThread *signal_thread;
+};
+
+struct _GstFlightRecorderTracerClass {
+  GstTracerClass parent_class;
+
+  /* actions */
+  gboolean (*dump) (GstFlightRecorderTracer * self, const gchar * filename);
+};
+
+G_GNUC_INTERNAL GType gst_flight_recorder_tracer_get_type (void);
+
+G_END_DECLS
+
+#endif /* __GST_FLIGHT_RECORDER_TRACER_H__ */
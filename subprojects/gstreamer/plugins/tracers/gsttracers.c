@@ -24,6 +24,8 @@
 #endif
 
 #include <gst/gst.h>
+#include "gstcputime.h"
+#include "gstflightrecorder.h"
 #include "gstlatency.h"
 #include "gstlog.h"
 #include "gstrusage.h"
@@ -43,6 +45,11 @@ plugin_init (GstPlugin * plugin)
 #ifdef HAVE_GETRUSAGE
   if (!gst_tracer_register (plugin, "rusage", gst_rusage_tracer_get_type ()))
     return FALSE;
+#endif
+#ifdef HAVE_CLOCK_GETTIME
+  if (!gst_tracer_register (plugin, "cputime",
+          gst_cpu_time_tracer_get_type ()))
+    return FALSE;
 #endif
   if (!gst_tracer_register (plugin, "stats", gst_stats_tracer_get_type ()))
     return FALSE;
@@ -51,6 +58,9 @@ plugin_init (GstPlugin * plugin)
   if (!gst_tracer_register (plugin, "factories",
           gst_factories_tracer_get_type ()))
     return FALSE;
+  if (!gst_tracer_register (plugin, "flightrecorder",
+          gst_flight_recorder_tracer_get_type ()))
+    return FALSE;
   return TRUE;
 }
 
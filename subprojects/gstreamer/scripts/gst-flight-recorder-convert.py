@@ -0,0 +1,196 @@
+#!/usr/bin/env python3
+#
+# Converts a dump of the flightrecorder tracer to the Chrome JSON trace format,
+# which can be opened in Perfetto (https://ui.perfetto.dev) or chrome://tracing
+#
+# example:
+#   GST_TRACERS="flightrecorder(file=rec.gstfr,dump-on-deinit=true)" \
+#       gst-launch-1.0 audiotestsrc num-buffers=100 ! queue ! fakesink sync=true
+#   gst-flight-recorder-convert.py rec.gstfr --output=rec.json
+
+import argparse
+import json
+import struct
+import sys
+
+MAGIC = b'GSTFLREC'
+VERSION = 1
+
+RECORD_PAD_PUSH_PRE = 1
+RECORD_PAD_PUSH_POST = 2
+RECORD_PAD_PUSH_LIST_PRE = 3
+RECORD_PAD_PUSH_LIST_POST = 4
+RECORD_PAD_CHAIN_PRE = 5
+RECORD_PAD_CHAIN_POST = 6
+RECORD_PAD_CHAIN_LIST_PRE = 7
+RECORD_PAD_CHAIN_LIST_POST = 8
+RECORD_QUEUE_LEVEL = 9
+RECORD_CLOCK_WAIT_PRE = 10
+RECORD_CLOCK_WAIT_POST = 11
+
+# (begin record, category) for the records that start a slice
+BEGIN = {
+    RECORD_PAD_PUSH_PRE: 'push',
+    RECORD_PAD_PUSH_LIST_PRE: 'push-list',
+    RECORD_PAD_CHAIN_PRE: 'chain',
+    RECORD_PAD_CHAIN_LIST_PRE: 'chain-list',
+    RECORD_CLOCK_WAIT_PRE: 'clock-wait',
+}
+END = {
+    RECORD_PAD_PUSH_POST: RECORD_PAD_PUSH_PRE,
+    RECORD_PAD_PUSH_LIST_POST: RECORD_PAD_PUSH_LIST_PRE,
+    RECORD_PAD_CHAIN_POST: RECORD_PAD_CHAIN_PRE,
+    RECORD_PAD_CHAIN_LIST_POST: RECORD_PAD_CHAIN_LIST_PRE,
+    RECORD_CLOCK_WAIT_POST: RECORD_CLOCK_WAIT_PRE,
+}
+
+FLOW_RETURNS = {
+    100: 'custom-success-2', 101: 'custom-success-1', 102: 'custom-success',
+    0: 'ok', -1: 'not-linked', -2: 'flushing', -3: 'eos',
+    -4: 'not-negotiated', -5: 'error', -6: 'not-supported',
+    -100: 'custom-error', -101: 'custom-error-1', -102: 'custom-error-2',
+}
+
+CLOCK_RETURNS = ['ok', 'early', 'unscheduled', 'busy', 'badtime', 'error',
+                 'unsupported', 'done']
+
+NAME_PAD = 1
+
+
+class Dump:
+    def __init__(self, data):
+        if data[:8] != MAGIC:
+            raise ValueError('not a flight recorder dump')
+
+        for order in '<>':
+            if struct.unpack_from(order + 'I', data, 8)[0] == 0x01020304:
+                break
+        else:
+            raise ValueError('unknown byte order')
+
+        version, record_size, n_rings, n_names, _ = struct.unpack_from(
+            order + '5I', data, 12)
+        if version != VERSION:
+            raise ValueError('unsupported version %d' % version)
+
+        record = struct.Struct(order + 'QQQHHI')
+        offset = 32
+        self.rings = []
+        for _ in range(n_rings):
+            index, n_records, thread = struct.unpack_from(order + 'IIQ', data,
+                                                          offset)
+            offset += 16
+            records = []
+            for _ in range(n_records):
+                records.append(record.unpack_from(data, offset))
+                offset += record_size
+            self.rings.append((index, thread, records))
+
+        self.names = {}
+        for _ in range(n_names):
+            obj, parent, kind, length = struct.unpack_from(order + 'QQII',
+                                                           data, offset)
+            offset += 24
+            name = data[offset:offset + length].decode('utf-8', 'replace')
+            offset += length
+            self.names[obj] = (parent, kind, name)
+
+    def name(self, obj):
+        if obj not in self.names:
+            return '0x%x' % obj
+        parent, kind, name = self.names[obj]
+        if kind == NAME_PAD and parent in self.names:
+            return '%s:%s' % (self.names[parent][2], name)
+        return name
+
+    def element_name(self, pad):
+        if pad in self.names:
+            parent, kind, name = self.names[pad]
+            if kind == NAME_PAD:
+                return self.name(parent)
+        return self.name(pad)
+
+
+def signed(value):
+    return value - (1 << 64) if value >= (1 << 63) else value
+
+
+def convert(dump):
+    events = []
+
+    for index, thread, records in dump.rings:
+        tid = index + 1
+        events.append({'ph': 'M', 'name': 'thread_name', 'pid': 1, 'tid': tid,
+                       'args': {'name': 'thread %d (0x%x)' % (index, thread)}})
+        # the oldest records of a ring might have lost their begin record
+        stack = []
+
+        for ts, obj, value, rtype, _, extra in records:
+            us = ts / 1000.0
+
+            if rtype in BEGIN:
+                category = BEGIN[rtype]
+                if category.startswith('chain'):
+                    name = dump.element_name(obj)
+                elif category == 'clock-wait':
+                    name = 'clock-wait'
+                else:
+                    name = dump.name(obj)
+
+                if category == 'clock-wait':
+                    args = {'time': value}
+                elif category.endswith('list'):
+                    args = {'pad': dump.name(obj), 'buffers': value}
+                else:
+                    args = {'pad': dump.name(obj), 'size': value}
+
+                stack.append(rtype)
+                events.append({'ph': 'B', 'name': name, 'cat': category,
+                               'ts': us, 'pid': 1, 'tid': tid,
+                               'args': args})
+            elif rtype in END:
+                if not stack or stack[-1] != END[rtype]:
+                    continue
+                stack.pop()
+
+                if rtype == RECORD_CLOCK_WAIT_POST:
+                    res = CLOCK_RETURNS[extra] \
+                        if extra < len(CLOCK_RETURNS) else str(extra)
+                    args = {'result': res, 'jitter': signed(value)}
+                else:
+                    flow = signed(value)
+                    args = {'result': FLOW_RETURNS.get(flow, str(flow))}
+
+                events.append({'ph': 'E', 'ts': us, 'pid': 1, 'tid': tid,
+                               'args': args})
+            elif rtype == RECORD_QUEUE_LEVEL:
+                events.append({'ph': 'C', 'name': dump.name(obj), 'ts': us,
+                               'pid': 1, 'args': {'buffers': extra,
+                                                  'bytes': value}})
+
+    events.sort(key=lambda e: e.get('ts', 0))
+
+    return {'traceEvents': events, 'displayTimeUnit': 'ns'}
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Convert a flightrecorder tracer dump for Perfetto')
+    parser.add_argument('dump', help='the dump written by the tracer')
+    parser.add_argument('--output', '-o', default='-',
+                        help='the JSON file to write, stdout by default')
+    args = parser.parse_args()
+
+    with open(args.dump, 'rb') as f:
+        dump = Dump(f.read())
+
+    trace = convert(dump)
+    if args.output == '-':
+        json.dump(trace, sys.stdout)
+    else:
+        with open(args.output, 'w') as f:
+            json.dump(trace, f)
+
+
+if __name__ == '__main__':
+    main()
@@ -111,6 +111,9 @@ main (gint argc, gchar * argv[])
   gst_message_unref (msg);
   g_print ("%" GST_TIME_FORMAT " - putting %d buffers through\n",
       GST_TIME_ARGS (end - start), BUFFER_COUNT);
+  /* every buffer is pushed over each of the links once */
+  g_print ("%" G_GUINT64_FORMAT " ns - pushing a buffer over a link\n",
+      (end - start) / ((guint64) BUFFER_COUNT * MAX (n_elements, 1)));
 
   start = gst_util_get_timestamp ();
   if (gst_element_set_state (pipeline,
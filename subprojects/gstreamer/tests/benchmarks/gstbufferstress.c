@@ -23,9 +23,25 @@
 #include "gst/glib-compat-private.h"
 
 #define MAX_THREADS  1000
+#define PAYLOAD_SIZE 200
+
+typedef enum
+{
+  MODE_EMPTY,
+  MODE_PAYLOAD,
+  MODE_META,
+  N_MODES
+} TestMode;
+
+static const gchar *mode_names[N_MODES] = {
+  "empty buffers",
+  "buffers with payload",
+  "buffers with payload and meta",
+};
 
 static guint64 nbbuffers;
 static GMutex mutex;
+static TestMode mode;
 
 
 static void *
@@ -44,7 +60,19 @@ run_test (void *user_data)
   g_assert (nbbuffers > 0);
 
   for (nb = nbbuffers; nb; nb--) {
-    buf = gst_buffer_new ();
+    switch (mode) {
+      case MODE_EMPTY:
+        buf = gst_buffer_new ();
+        break;
+      case MODE_PAYLOAD:
+        buf = gst_buffer_new_allocate (NULL, PAYLOAD_SIZE, NULL);
+        break;
+      case MODE_META:
+      default:
+        buf = gst_buffer_new_allocate (NULL, PAYLOAD_SIZE, NULL);
+        gst_buffer_add_custom_meta (buf, "GstBufferStressMeta");
+        break;
+    }
     gst_buffer_unref (buf);
   }
 
@@ -67,6 +95,7 @@ main (gint argc, gchar * argv[])
   GstBuffer *tmp;
   GstClockTime start, end;
 
+  /* pass --gst-enable-slab-allocator to compare with the slab allocator */
   gst_init (&argc, &argv);
   g_mutex_init (&mutex);
 
@@ -88,39 +117,46 @@ main (gint argc, gchar * argv[])
     exit (-3);
   }
 
-  g_mutex_lock (&mutex);
+  gst_meta_register_custom ("GstBufferStressMeta", NULL, NULL, NULL, NULL);
+
   /* Let's just make sure the GstBufferClass is loaded ... */
   tmp = gst_buffer_new ();
 
-  printf ("main(): Creating %d threads.\n", num_threads);
-  for (t = 0; t < num_threads; t++) {
-    GError *error = NULL;
+  for (mode = 0; mode < N_MODES; mode++) {
+    g_mutex_lock (&mutex);
+
+    printf ("main(): Creating %d threads for %s.\n", num_threads,
+        mode_names[mode]);
+    for (t = 0; t < num_threads; t++) {
+      GError *error = NULL;
 
-    threads[t] = g_thread_try_new ("bufferstresstest", run_test,
-        GINT_TO_POINTER (t), &error);
+      threads[t] = g_thread_try_new ("bufferstresstest", run_test,
+          GINT_TO_POINTER (t), &error);
 
-    if (error) {
-      printf ("ERROR: g_thread_try_new() %s\n", error->message);
-      g_clear_error (&error);
-      exit (-1);
+      if (error) {
+        printf ("ERROR: g_thread_try_new() %s\n", error->message);
+        g_clear_error (&error);
+        exit (-1);
+      }
     }
-  }
 
-  /* Signal all threads to start */
-  start = gst_util_get_timestamp ();
-  g_mutex_unlock (&mutex);
+    /* Signal all threads to start */
+    start = gst_util_get_timestamp ();
+    g_mutex_unlock (&mutex);
 
-  for (t = 0; t < num_threads; t++) {
-    if (threads[t])
-      g_thread_join (threads[t]);
-  }
+    for (t = 0; t < num_threads; t++) {
+      if (threads[t])
+        g_thread_join (threads[t]);
+    }
 
-  end = gst_util_get_timestamp ();
-  g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
-      "  - Done creating %" G_GUINT64_FORMAT " buffers\n",
-      GST_TIME_ARGS (end - start),
-      GST_TIME_ARGS ((end - start) / (num_threads * nbbuffers)),
-      num_threads * nbbuffers);
+    end = gst_util_get_timestamp ();
+    g_print ("*** total %" GST_TIME_FORMAT " - average %" GST_TIME_FORMAT
+        "  - Done creating %" G_GUINT64_FORMAT " %s - %.0f buffers/s\n",
+        GST_TIME_ARGS (end - start),
+        GST_TIME_ARGS ((end - start) / (num_threads * nbbuffers)),
+        num_threads * nbbuffers, mode_names[mode],
+        (gdouble) (num_threads * nbbuffers) * GST_SECOND / (end - start));
+  }
 
 
   gst_buffer_unref (tmp);
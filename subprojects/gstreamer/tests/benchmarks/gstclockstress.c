@@ -23,10 +23,20 @@
 #include <gst/glib-compat-private.h>
 
 #define MAX_THREADS  100
+#define NUM_ASYNC_ENTRIES 10000
 
 static gboolean running = TRUE;
 static gint count = 0;
 
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  guint n_fired;
+  GstClockTime total_late;
+  GstClockTime max_late;
+} AsyncStats;
+
 static void *
 run_test (void *user_data)
 {
@@ -43,18 +53,86 @@ run_test (void *user_data)
   return NULL;
 }
 
+static gboolean
+async_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  AsyncStats *stats = user_data;
+  GstClockTime now = gst_clock_get_time (clock);
+  GstClockTime late = now > time ? now - time : 0;
+
+  g_mutex_lock (&stats->lock);
+  stats->n_fired++;
+  stats->total_late += late;
+  stats->max_late = MAX (stats->max_late, late);
+  g_cond_signal (&stats->cond);
+  g_mutex_unlock (&stats->lock);
+
+  return TRUE;
+}
+
+/* schedules n_entries single shot async waits at random times in the next
+ * second and reports the insertion cost and how late the callbacks were */
+static void
+run_async_test (guint n_entries, GstClockTime tolerance)
+{
+  GstClock *clock;
+  GstClockID *ids;
+  AsyncStats stats = { {0,}, };
+  GstClockTime base, start, end;
+  guint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "clockstress",
+      "coalesce-tolerance", tolerance, NULL);
+  gst_object_ref_sink (clock);
+
+  g_mutex_init (&stats.lock);
+  g_cond_init (&stats.cond);
+
+  ids = g_new (GstClockID, n_entries);
+  base = gst_clock_get_time (clock) + 100 * GST_MSECOND;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < n_entries; i++) {
+    ids[i] = gst_clock_new_single_shot_id (clock,
+        base + g_random_int_range (0, GST_SECOND / GST_USECOND) * GST_USECOND);
+    gst_clock_id_wait_async (ids[i], async_cb, &stats, NULL);
+  }
+  end = gst_util_get_timestamp ();
+
+  g_mutex_lock (&stats.lock);
+  while (stats.n_fired < n_entries)
+    g_cond_wait (&stats.cond, &stats.lock);
+  g_mutex_unlock (&stats.lock);
+
+  g_print ("async: %u entries, tolerance %" GST_TIME_FORMAT ", insert %"
+      G_GUINT64_FORMAT " ns/entry, late avg %" GST_TIME_FORMAT " max %"
+      GST_TIME_FORMAT "\n", n_entries, GST_TIME_ARGS (tolerance),
+      (end - start) / n_entries, GST_TIME_ARGS (stats.total_late / n_entries),
+      GST_TIME_ARGS (stats.max_late));
+
+  for (i = 0; i < n_entries; i++)
+    gst_clock_id_unref (ids[i]);
+  g_free (ids);
+
+  g_mutex_clear (&stats.lock);
+  g_cond_clear (&stats.cond);
+  gst_object_unref (clock);
+}
+
 gint
 main (gint argc, gchar * argv[])
 {
   GThread *threads[MAX_THREADS];
   gint num_threads;
+  guint num_entries = NUM_ASYNC_ENTRIES;
   gint t;
   GstClock *sysclock;
 
   gst_init (&argc, &argv);
 
-  if (argc != 2) {
-    g_print ("usage: %s <num_threads>\n", argv[0]);
+  if (argc != 2 && argc != 3) {
+    g_print ("usage: %s <num_threads> [num_async_entries]\n", argv[0]);
     exit (-1);
   }
 
@@ -65,6 +143,9 @@ main (gint argc, gchar * argv[])
     exit (-2);
   }
 
+  if (argc == 3)
+    num_entries = MAX (atoi (argv[2]), 1);
+
   sysclock = gst_system_clock_obtain ();
 
   for (t = 0; t < num_threads; t++) {
@@ -96,5 +177,8 @@ main (gint argc, gchar * argv[])
 
   gst_object_unref (sysclock);
 
+  run_async_test (num_entries, 0);
+  run_async_test (num_entries, GST_MSECOND);
+
   return 0;
 }
@@ -23,6 +23,118 @@
 #include "gst/glib-compat-private.h"
 
 #define BUFFER_SIZE (1400)
+#define MAX_THREADS (32)
+#define THREAD_CACHE_SIZE (8)
+/* buffers each thread holds on to at the same time */
+#define BUFFERS_IN_FLIGHT (4)
+
+typedef struct
+{
+  GstBufferPool *pool;
+  guint64 nbuffers;
+  GMutex *lock;
+  GCond *cond;
+  gboolean *go;
+} ThreadData;
+
+static gpointer
+run_thread (gpointer user_data)
+{
+  ThreadData *data = user_data;
+  GstBuffer *bufs[BUFFERS_IN_FLIGHT];
+  guint64 i;
+  gint j;
+
+  g_mutex_lock (data->lock);
+  while (!*data->go)
+    g_cond_wait (data->cond, data->lock);
+  g_mutex_unlock (data->lock);
+
+  for (i = 0; i < data->nbuffers; i += BUFFERS_IN_FLIGHT) {
+    for (j = 0; j < BUFFERS_IN_FLIGHT; j++)
+      gst_buffer_pool_acquire_buffer (data->pool, &bufs[j], NULL);
+    for (j = 0; j < BUFFERS_IN_FLIGHT; j++)
+      gst_buffer_unref (bufs[j]);
+  }
+  return NULL;
+}
+
+/* acquires and releases @nbuffers buffers in total, spread over @nthreads
+ * threads, and returns the time it took */
+static GstClockTimeDiff
+run_threads (GstBufferPool * pool, gint nthreads, guint64 nbuffers)
+{
+  GThread *threads[MAX_THREADS];
+  ThreadData data;
+  GMutex lock;
+  GCond cond;
+  gboolean go = FALSE;
+  GstClockTime start, end;
+  gint i;
+
+  g_mutex_init (&lock);
+  g_cond_init (&cond);
+  data.pool = pool;
+  data.nbuffers = nbuffers / nthreads;
+  data.lock = &lock;
+  data.cond = &cond;
+  data.go = &go;
+
+  for (i = 0; i < nthreads; i++)
+    threads[i] = g_thread_new ("pool-stress", run_thread, &data);
+
+  start = gst_util_get_timestamp ();
+  g_mutex_lock (&lock);
+  go = TRUE;
+  g_cond_broadcast (&cond);
+  g_mutex_unlock (&lock);
+
+  for (i = 0; i < nthreads; i++)
+    g_thread_join (threads[i]);
+  end = gst_util_get_timestamp ();
+
+  g_cond_clear (&cond);
+  g_mutex_clear (&lock);
+
+  return GST_CLOCK_DIFF (start, end);
+}
+
+static void
+run_scaling (guint64 nbuffers, guint thread_cache_size)
+{
+  gint nthreads;
+
+  for (nthreads = 1; nthreads <= MAX_THREADS; nthreads *= 2) {
+    GstBufferPool *pool;
+    GstStructure *conf, *stats;
+    GstClockTimeDiff dur;
+    guint64 hits = 0, misses = 0, waits = 0;
+
+    pool = gst_buffer_pool_new ();
+    conf = gst_buffer_pool_get_config (pool);
+    gst_buffer_pool_config_set_params (conf, NULL, BUFFER_SIZE, 0, 0);
+    gst_buffer_pool_config_set_thread_cache_size (conf, thread_cache_size);
+    gst_buffer_pool_set_config (pool, conf);
+    gst_buffer_pool_set_active (pool, TRUE);
+
+    dur = run_threads (pool, nthreads, nbuffers);
+
+    stats = gst_buffer_pool_get_stats (pool);
+    gst_structure_get (stats, "thread-cache-hits", G_TYPE_UINT64, &hits,
+        "thread-cache-misses", G_TYPE_UINT64, &misses,
+        "waits", G_TYPE_UINT64, &waits, NULL);
+    gst_structure_free (stats);
+
+    g_print ("*** %2d threads, cache %u - total %" GST_TIME_FORMAT
+        " - average %" GST_TIME_FORMAT " - hits %" G_GUINT64_FORMAT
+        " misses %" G_GUINT64_FORMAT " waits %" G_GUINT64_FORMAT "\n",
+        nthreads, thread_cache_size, GST_TIME_ARGS (dur),
+        GST_TIME_ARGS (dur / nbuffers), hits, misses, waits);
+
+    gst_buffer_pool_set_active (pool, FALSE);
+    gst_object_unref (pool);
+  }
+}
 
 gint
 main (gint argc, gchar * argv[])
@@ -90,5 +202,9 @@ main (gint argc, gchar * argv[])
   gst_buffer_pool_set_active (pool, FALSE);
   gst_object_unref (pool);
 
+  /* the same from multiple threads, with and without thread caches */
+  run_scaling (nbuffers, 0);
+  run_scaling (nbuffers, THREAD_CACHE_SIZE);
+
   return 0;
 }
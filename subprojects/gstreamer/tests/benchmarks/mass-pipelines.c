@@ -0,0 +1,201 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * mass-pipelines.c: benchmark for running many small pipelines
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Runs a number of "fakesrc ! queue ! fakesink" pipelines at the same time,
+ * once with a streaming thread per queue, once with cooperative queues that
+ * share the workers of a work-stealing task pool and once with lock-free
+ * queues. For each run it reports the number of threads, the context switches
+ * of the process, the time per buffer handed over by the queues and the
+ * latency of the buffers from the source to the sink.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <gst/gst.h>
+
+#ifdef G_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+#define NUM_PIPELINES 200
+#define NUM_BUFFERS 1000
+
+typedef struct
+{
+  guint64 count;
+  GstClockTime total;
+  GstClockTime max;
+} Latency;
+
+static void
+src_handoff (GstElement * src, GstBuffer * buf, GstPad * pad,
+    gpointer user_data)
+{
+  /* the sink computes the latency from this */
+  GST_BUFFER_OFFSET_END (buf) = gst_util_get_timestamp ();
+}
+
+static void
+sink_handoff (GstElement * sink, GstBuffer * buf, GstPad * pad,
+    Latency * latency)
+{
+  GstClockTime diff = gst_util_get_timestamp () - GST_BUFFER_OFFSET_END (buf);
+
+  /* only called from the streaming thread of this pipeline */
+  latency->count++;
+  latency->total += diff;
+  latency->max = MAX (latency->max, diff);
+}
+
+static glong
+get_context_switches (void)
+{
+#ifdef G_OS_UNIX
+  struct rusage ru;
+
+  if (getrusage (RUSAGE_SELF, &ru) == 0)
+    return ru.ru_nvcsw + ru.ru_nivcsw;
+#endif
+  return -1;
+}
+
+static gint
+get_n_threads (void)
+{
+  gchar *status, *line;
+  gint n_threads = -1;
+
+  if (!g_file_get_contents ("/proc/self/status", &status, NULL, NULL))
+    return -1;
+
+  if ((line = strstr (status, "Threads:")))
+    n_threads = atoi (line + strlen ("Threads:"));
+  g_free (status);
+
+  return n_threads;
+}
+
+static void
+run (guint n_pipelines, guint n_buffers, const gchar * mode,
+    gboolean cooperative, gboolean lock_free)
+{
+  GstElement **pipelines;
+  Latency *latencies, total = { 0, };
+  GstClockTime start, end;
+  glong switches;
+  gint n_threads;
+  gchar *desc;
+  guint i;
+
+  pipelines = g_new0 (GstElement *, n_pipelines);
+  latencies = g_new0 (Latency, n_pipelines);
+
+  desc = g_strdup_printf ("fakesrc name=src num-buffers=%u "
+      "signal-handoffs=true ! queue name=queue max-size-buffers=2 ! "
+      "fakesink name=sink signal-handoffs=true", n_buffers);
+
+  for (i = 0; i < n_pipelines; i++) {
+    GstElement *src, *queue, *sink;
+
+    pipelines[i] = gst_parse_launch (desc, NULL);
+    g_assert (pipelines[i]);
+
+    src = gst_bin_get_by_name (GST_BIN (pipelines[i]), "src");
+    queue = gst_bin_get_by_name (GST_BIN (pipelines[i]), "queue");
+    sink = gst_bin_get_by_name (GST_BIN (pipelines[i]), "sink");
+
+    g_object_set (queue, "cooperative", cooperative, "lock-free", lock_free,
+        NULL);
+    g_signal_connect (src, "handoff", G_CALLBACK (src_handoff), NULL);
+    g_signal_connect (sink, "handoff", G_CALLBACK (sink_handoff),
+        &latencies[i]);
+
+    gst_object_unref (src);
+    gst_object_unref (queue);
+    gst_object_unref (sink);
+  }
+  g_free (desc);
+
+  switches = get_context_switches ();
+  start = gst_util_get_timestamp ();
+
+  for (i = 0; i < n_pipelines; i++)
+    gst_element_set_state (pipelines[i], GST_STATE_PLAYING);
+  n_threads = get_n_threads ();
+
+  for (i = 0; i < n_pipelines; i++) {
+    GstBus *bus = gst_element_get_bus (pipelines[i]);
+    GstMessage *msg;
+
+    msg = gst_bus_timed_pop_filtered (bus, GST_CLOCK_TIME_NONE,
+        GST_MESSAGE_EOS | GST_MESSAGE_ERROR);
+    if (GST_MESSAGE_TYPE (msg) == GST_MESSAGE_ERROR)
+      g_printerr ("pipeline %u failed\n", i);
+    gst_message_unref (msg);
+    gst_object_unref (bus);
+  }
+
+  end = gst_util_get_timestamp ();
+  switches = get_context_switches () - switches;
+
+  for (i = 0; i < n_pipelines; i++) {
+    gst_element_set_state (pipelines[i], GST_STATE_NULL);
+    gst_object_unref (pipelines[i]);
+
+    total.count += latencies[i].count;
+    total.total += latencies[i].total;
+    total.max = MAX (total.max, latencies[i].max);
+  }
+
+  g_print ("%-12s %" GST_TIME_FORMAT " %8d %10ld %10" G_GUINT64_FORMAT " %"
+      GST_TIME_FORMAT " %" GST_TIME_FORMAT "\n", mode,
+      GST_TIME_ARGS (end - start), n_threads, switches,
+      total.count ? (end - start) / total.count : 0,
+      GST_TIME_ARGS (total.count ? total.total / total.count : 0),
+      GST_TIME_ARGS (total.max));
+
+  g_free (latencies);
+  g_free (pipelines);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  guint n_pipelines = NUM_PIPELINES, n_buffers = NUM_BUFFERS;
+
+  gst_init (&argc, &argv);
+
+  if (argc > 1)
+    n_pipelines = atoi (argv[1]);
+  if (argc > 2)
+    n_buffers = atoi (argv[2]);
+
+  g_print ("*** %u pipelines of fakesrc num-buffers=%u ! queue ! fakesink\n",
+      n_pipelines, n_buffers);
+  g_print ("%-12s %-17s %8s %10s %10s %-17s %-17s\n", "mode", "time",
+      "threads", "switches", "ns/buffer", "latency avg", "latency max");
+
+  run (n_pipelines, n_buffers, "threads", FALSE, FALSE);
+  run (n_pipelines, n_buffers, "cooperative", TRUE, FALSE);
+  run (n_pipelines, n_buffers, "lock-free", FALSE, TRUE);
+
+  return 0;
+}
@@ -0,0 +1,165 @@
+/* GStreamer
+ * Copyright (C) 2022 Pexip
+ *
+ * tracerdispatch.c: benchmark for the cost of the tracer hooks in a pad push
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 51 Franklin St, Fifth Floor,
+ * Boston, MA 02110-1301, USA.
+ */
+
+/* Measures the time of a gst_pad_push() with no tracers, with a tracer that
+ * only hooks into an unrelated hook, and with one and three tracers hooked into
+ * the pad push. Tracers can't be removed again, so they are added between the
+ * runs.
+ */
+
+#include <stdlib.h>
+#include <gst/gst.h>
+
+#define NUM_PUSHES 1000000
+
+typedef struct
+{
+  GstTracer parent;
+  guint64 count;
+} GstDispatchTracer;
+
+typedef struct
+{
+  GstTracerClass parent_class;
+} GstDispatchTracerClass;
+
+static GType gst_dispatch_tracer_get_type (void);
+G_DEFINE_TYPE (GstDispatchTracer, gst_dispatch_tracer, GST_TYPE_TRACER);
+
+static void
+do_push_pre (GstDispatchTracer * self, GstClockTime ts, GstPad * pad,
+    GstBuffer * buffer)
+{
+  self->count++;
+}
+
+static void
+do_push_post (GstDispatchTracer * self, GstClockTime ts, GstPad * pad,
+    GstFlowReturn res)
+{
+  self->count++;
+}
+
+static void
+do_element_new (GstDispatchTracer * self, GstClockTime ts,
+    GstElement * element)
+{
+  self->count++;
+}
+
+static void
+gst_dispatch_tracer_class_init (GstDispatchTracerClass * klass)
+{
+}
+
+static void
+gst_dispatch_tracer_init (GstDispatchTracer * self)
+{
+}
+
+static void
+add_tracer (gboolean pad_push)
+{
+  GstTracer *tracer = g_object_new (gst_dispatch_tracer_get_type (), NULL);
+
+  gst_object_ref_sink (tracer);
+  if (pad_push) {
+    gst_tracing_register_hook (tracer, "pad-push-pre",
+        G_CALLBACK (do_push_pre));
+    gst_tracing_register_hook (tracer, "pad-push-post",
+        G_CALLBACK (do_push_post));
+  } else {
+    gst_tracing_register_hook (tracer, "element-new",
+        G_CALLBACK (do_element_new));
+  }
+  /* the hooks keep the tracer alive */
+  gst_object_unref (tracer);
+}
+
+static GstFlowReturn
+sink_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  gst_buffer_unref (buffer);
+  return GST_FLOW_OK;
+}
+
+static void
+run_test (const gchar * name, GstPad * srcpad, GstBuffer * buffer)
+{
+  GstClockTime start, end;
+  guint i;
+
+  start = gst_util_get_timestamp ();
+  for (i = 0; i < NUM_PUSHES; i++)
+    gst_pad_push (srcpad, gst_buffer_ref (buffer));
+  end = gst_util_get_timestamp ();
+
+  g_print ("%-32s total %" GST_TIME_FORMAT " - average %" G_GUINT64_FORMAT
+      " ns\n", name, GST_TIME_ARGS (end - start), (end - start) / NUM_PUSHES);
+}
+
+gint
+main (gint argc, gchar * argv[])
+{
+  GstPad *srcpad, *sinkpad;
+  GstBuffer *buffer;
+  GstSegment segment;
+
+  gst_init (&argc, &argv);
+
+  srcpad = gst_pad_new ("src", GST_PAD_SRC);
+  sinkpad = gst_pad_new ("sink", GST_PAD_SINK);
+  gst_pad_set_chain_function (sinkpad, sink_chain);
+  gst_pad_set_active (sinkpad, TRUE);
+  gst_pad_set_active (srcpad, TRUE);
+  if (gst_pad_link (srcpad, sinkpad) != GST_PAD_LINK_OK) {
+    g_print ("ERROR: could not link pads\n");
+    exit (-1);
+  }
+
+  gst_segment_init (&segment, GST_FORMAT_TIME);
+  gst_pad_push_event (srcpad, gst_event_new_stream_start ("tracerdispatch"));
+  gst_pad_push_event (srcpad, gst_event_new_segment (&segment));
+
+  buffer = gst_buffer_new ();
+
+  run_test ("no tracers", srcpad, buffer);
+
+  add_tracer (FALSE);
+  run_test ("1 tracer on another hook", srcpad, buffer);
+
+  add_tracer (TRUE);
+  run_test ("1 tracer", srcpad, buffer);
+
+  add_tracer (TRUE);
+  add_tracer (TRUE);
+  run_test ("3 tracers", srcpad, buffer);
+
+  gst_buffer_unref (buffer);
+  gst_pad_set_active (srcpad, FALSE);
+  gst_pad_set_active (sinkpad, FALSE);
+  gst_object_unref (srcpad);
+  gst_object_unref (sinkpad);
+
+  gst_deinit ();
+
+  return 0;
+}
@@ -1181,6 +1181,198 @@ GST_START_TEST (test_initial_events_nodelay)
 
 GST_END_TEST;
 
+static gint ordered_buffers;
+static gboolean ordered_ok;
+
+static GstFlowReturn
+ordered_chain (GstPad * pad, GstObject * parent, GstBuffer * buffer)
+{
+  if (GST_BUFFER_OFFSET (buffer) != ordered_buffers)
+    ordered_ok = FALSE;
+  ordered_buffers++;
+  gst_buffer_unref (buffer);
+
+  return GST_FLOW_OK;
+}
+
+static gboolean
+ordered_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_CUSTOM_DOWNSTREAM) {
+    gint n = -1;
+
+    gst_structure_get_int (gst_event_get_structure (event), "buffers", &n);
+    if (n != ordered_buffers)
+      ordered_ok = FALSE;
+  }
+
+  return event_func (pad, parent, event);
+}
+
+GST_START_TEST (test_lock_free)
+{
+  GstSegment segment;
+  GstEvent *event;
+  GstQuery *query;
+  guint i;
+
+  g_object_set (queue, "lock-free", TRUE, "max-size-buffers", 4, NULL);
+
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_chain_function (mysinkpad, ordered_chain);
+  gst_pad_set_event_function (mysinkpad, ordered_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  ordered_buffers = 0;
+  ordered_ok = TRUE;
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  /* serialized events and queries must stay in place between the buffers
+   * that go through the ring */
+  for (i = 0; i < 1000; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (4);
+
+    if (i % 10 == 0) {
+      event = gst_event_new_custom (GST_EVENT_CUSTOM_DOWNSTREAM,
+          gst_structure_new ("test", "buffers", G_TYPE_INT, i, NULL));
+      fail_unless (gst_pad_push_event (mysrcpad, event));
+    }
+    if (i % 100 == 0) {
+      query = gst_query_new_drain ();
+      gst_pad_peer_query (mysrcpad, query);
+      gst_query_unref (query);
+    }
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_mutex_lock (&events_lock);
+  while (events == NULL
+      || GST_EVENT_TYPE (g_list_last (events)->data) != GST_EVENT_EOS)
+    g_cond_wait (&events_cond, &events_lock);
+  g_mutex_unlock (&events_lock);
+
+  fail_unless_equals_int (ordered_buffers, 1000);
+  fail_unless (ordered_ok);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
+static gint segment_buffers;
+
+static gboolean
+segment_event (GstPad * pad, GstObject * parent, GstEvent * event)
+{
+  if (GST_EVENT_TYPE (event) == GST_EVENT_SEGMENT) {
+    const GstSegment *segment;
+
+    gst_event_parse_segment (event, &segment);
+    if (segment->start == 1000)
+      segment_buffers = ordered_buffers;
+  }
+
+  return event_func (pad, parent, event);
+}
+
+static gboolean
+position_query (GstPad * pad, GstObject * parent, GstQuery * query)
+{
+  if (GST_QUERY_TYPE (query) == GST_QUERY_POSITION) {
+    GstFormat format;
+
+    gst_query_parse_position (query, &format, NULL);
+    gst_query_set_position (query, format, 1000);
+    return TRUE;
+  }
+
+  return gst_pad_query_default (pad, parent, query);
+}
+
+GST_START_TEST (test_lock_free_segment)
+{
+  GstSegment segment;
+  gint64 position;
+  guint i;
+
+  g_object_set (queue, "lock-free", TRUE, "max-size-buffers", 10, NULL);
+
+  gst_pad_set_query_function (mysrcpad, position_query);
+  mysinkpad = gst_check_setup_sink_pad (queue, &sinktemplate);
+  gst_pad_set_chain_function (mysinkpad, ordered_chain);
+  gst_pad_set_event_function (mysinkpad, segment_event);
+  gst_pad_set_active (mysinkpad, TRUE);
+
+  ordered_buffers = 0;
+  ordered_ok = TRUE;
+  segment_buffers = -1;
+
+  fail_unless (gst_element_set_state (queue,
+          GST_STATE_PLAYING) == GST_STATE_CHANGE_SUCCESS,
+      "could not set to playing");
+
+  /* keep everything after the stream-start in the queue */
+  block_src ();
+
+  gst_pad_push_event (mysrcpad, gst_event_new_stream_start ("test"));
+  gst_segment_init (&segment, GST_FORMAT_BYTES);
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  for (i = 0; i < 5; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (4);
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+
+  /* a new segment while the ring still holds buffers of the old one */
+  segment.start = 1000;
+  gst_pad_push_event (mysrcpad, gst_event_new_segment (&segment));
+
+  /* the buffers in the ring are accounted for in byte positions, the queue
+   * can't tell how much time it holds */
+  fail_unless (gst_pad_peer_query_position (mysinkpad, GST_FORMAT_BYTES,
+          &position));
+  fail_unless_equals_int64 (position, 1000 - 5 * 4);
+  fail_if (gst_pad_peer_query_position (mysinkpad, GST_FORMAT_TIME,
+          &position));
+
+  unblock_src ();
+
+  for (i = 5; i < 10; i++) {
+    GstBuffer *buffer = gst_buffer_new_and_alloc (4);
+
+    GST_BUFFER_OFFSET (buffer) = i;
+    fail_unless_equals_int (gst_pad_push (mysrcpad, buffer), GST_FLOW_OK);
+  }
+  fail_unless (gst_pad_push_event (mysrcpad, gst_event_new_eos ()));
+
+  g_mutex_lock (&events_lock);
+  while (events == NULL
+      || GST_EVENT_TYPE (g_list_last (events)->data) != GST_EVENT_EOS)
+    g_cond_wait (&events_cond, &events_lock);
+  g_mutex_unlock (&events_lock);
+
+  /* the new segment comes after the buffers of the old one */
+  fail_unless_equals_int (ordered_buffers, 10);
+  fail_unless_equals_int (segment_buffers, 5);
+  fail_unless (ordered_ok);
+
+  gst_element_set_state (queue, GST_STATE_NULL);
+}
+
+GST_END_TEST;
+
 static Suite *
 queue_suite (void)
 {
@@ -1204,6 +1396,8 @@ queue_suite (void)
   tcase_add_test (tc_chain, test_sticky_not_linked);
   tcase_add_test (tc_chain, test_time_level_buffer_list);
   tcase_add_test (tc_chain, test_initial_events_nodelay);
+  tcase_add_test (tc_chain, test_lock_free);
+  tcase_add_test (tc_chain, test_lock_free_segment);
 
   return s;
 }
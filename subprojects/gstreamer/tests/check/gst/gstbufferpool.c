@@ -336,6 +336,119 @@ GST_START_TEST (test_no_deadlock_for_buffer_discard)
 
 GST_END_TEST;
 
+static GstBufferPool *
+create_cached_pool (guint size, guint min_buf, guint max_buf, guint cache_size)
+{
+  GstBufferPool *pool = gst_buffer_pool_new ();
+  GstStructure *conf = gst_buffer_pool_get_config (pool);
+  GstCaps *caps = gst_caps_new_empty_simple ("test/data");
+
+  gst_buffer_pool_config_set_params (conf, caps, size, min_buf, max_buf);
+  gst_buffer_pool_config_set_thread_cache_size (conf, cache_size);
+  fail_unless (gst_buffer_pool_set_config (pool, conf));
+  gst_caps_unref (caps);
+
+  return pool;
+}
+
+static guint64
+get_stat (GstBufferPool * pool, const gchar * name)
+{
+  GstStructure *stats = gst_buffer_pool_get_stats (pool);
+  guint64 val = 0;
+
+  fail_unless (gst_structure_get_uint64 (stats, name, &val));
+  gst_structure_free (stats);
+
+  return val;
+}
+
+GST_START_TEST (test_thread_cache)
+{
+  GstBufferPool *pool = create_cached_pool (10, 0, 0, 2);
+  GstBuffer *buf[3], *prev;
+  GstStructure *conf;
+  guint size;
+  gint dcount = 0;
+  gint i;
+
+  conf = gst_buffer_pool_get_config (pool);
+  fail_unless (gst_buffer_pool_config_get_thread_cache_size (conf, &size));
+  fail_unless_equals_int (size, 2);
+  gst_structure_free (conf);
+
+  gst_buffer_pool_set_active (pool, TRUE);
+  gst_buffer_pool_acquire_buffer (pool, &buf[0], NULL);
+  prev = buf[0];
+  buffer_track_destroy (buf[0], &dcount);
+  gst_buffer_unref (buf[0]);
+  fail_unless_equals_int (get_stat (pool, "thread-cache-hits"), 0);
+  fail_unless_equals_int (get_stat (pool, "thread-cache-misses"), 1);
+
+  /* the buffer comes back from the cache of this thread */
+  gst_buffer_pool_acquire_buffer (pool, &buf[0], NULL);
+  fail_unless (buf[0] == prev, "got a fresh buffer instead of previous");
+  fail_unless_equals_int (get_stat (pool, "thread-cache-hits"), 1);
+
+  /* more buffers than fit in the cache, the last one goes to the queue */
+  for (i = 1; i < 3; i++) {
+    gst_buffer_pool_acquire_buffer (pool, &buf[i], NULL);
+    buffer_track_destroy (buf[i], &dcount);
+  }
+  for (i = 0; i < 3; i++)
+    gst_buffer_unref (buf[i]);
+  fail_unless (dcount == 0);
+
+  /* deactivating frees the cached buffers too */
+  gst_buffer_pool_set_active (pool, FALSE);
+  fail_unless (dcount == 3);
+  fail_unless_equals_int (get_stat (pool, "waits"), 0);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
+static gpointer
+acquire_release_buf (gpointer p)
+{
+  GstBufferPool *pool = p;
+  GstBuffer *buf;
+
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf,
+          NULL) == GST_FLOW_OK);
+  gst_buffer_unref (buf);
+
+  return NULL;
+}
+
+GST_START_TEST (test_thread_cache_steal)
+{
+  GstBufferPool *pool = create_cached_pool (10, 0, 1, 4);
+  GstBufferPoolAcquireParams params = { GST_FORMAT_DEFAULT, 0, 0,
+    GST_BUFFER_POOL_ACQUIRE_FLAG_DONTWAIT,
+  };
+  GstBuffer *buf, *buf2;
+  GThread *thread;
+
+  gst_buffer_pool_set_active (pool, TRUE);
+
+  /* the only buffer ends up in the cache of another thread */
+  thread = g_thread_new (NULL, acquire_release_buf, pool);
+  g_thread_join (thread);
+
+  /* and is taken from there instead of failing */
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf,
+          &params) == GST_FLOW_OK);
+  fail_unless (gst_buffer_pool_acquire_buffer (pool, &buf2,
+          &params) == GST_FLOW_EOS);
+  gst_buffer_unref (buf);
+
+  gst_buffer_pool_set_active (pool, FALSE);
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_buffer_pool_suite (void)
 {
@@ -355,6 +468,8 @@ gst_buffer_pool_suite (void)
   tcase_add_test (tc_chain, test_pool_config_validate);
   tcase_add_test (tc_chain, test_flushing_pool_returns_flushing);
   tcase_add_test (tc_chain, test_no_deadlock_for_buffer_discard);
+  tcase_add_test (tc_chain, test_thread_cache);
+  tcase_add_test (tc_chain, test_thread_cache_steal);
 
   return s;
 }
@@ -633,6 +633,57 @@ GST_START_TEST (test_meta_iterate)
 
 GST_END_TEST;
 
+static gboolean
+remove_test_meta (GstBuffer * buffer, GstMeta ** meta, gpointer user_data)
+{
+  if ((*meta)->info->api == GST_META_TEST_API_TYPE) {
+    /* the other metas can still be looked up while iterating */
+    fail_unless (GST_META_FOO_GET (buffer) == user_data);
+    *meta = NULL;
+  }
+  return TRUE;
+}
+
+GST_START_TEST (test_meta_get_first)
+{
+  GstBuffer *buffer;
+  GstMeta *m1, *m2, *m3;
+
+  buffer = gst_buffer_new_and_alloc (4);
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          GST_META_TEST_API_TYPE), 0);
+
+  m1 = (GstMeta *) GST_META_TEST_ADD (buffer);
+  m2 = (GstMeta *) GST_META_FOO_ADD (buffer);
+  m3 = (GstMeta *) GST_META_TEST_ADD (buffer);
+
+  /* the first meta of an API is returned */
+  fail_unless (GST_META_TEST_GET (buffer) == (GstMetaTest *) m1);
+  fail_unless (GST_META_FOO_GET (buffer) == (GstMetaFoo *) m2);
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          GST_META_TEST_API_TYPE), 2);
+
+  /* and the next one once the first is removed */
+  fail_unless (gst_buffer_remove_meta (buffer, m1));
+  fail_unless (GST_META_TEST_GET (buffer) == (GstMetaTest *) m3);
+  fail_unless (GST_META_FOO_GET (buffer) == (GstMetaFoo *) m2);
+
+  fail_unless (gst_buffer_foreach_meta (buffer, remove_test_meta, m2));
+  fail_unless (GST_META_TEST_GET (buffer) == NULL);
+  fail_unless (GST_META_FOO_GET (buffer) == (GstMetaFoo *) m2);
+  fail_unless_equals_int (gst_buffer_get_n_meta (buffer,
+          GST_META_TEST_API_TYPE), 0);
+
+  fail_unless (gst_buffer_remove_meta (buffer, m2));
+  fail_unless (GST_META_FOO_GET (buffer) == NULL);
+
+  gst_buffer_unref (buffer);
+}
+
+GST_END_TEST;
+
 #define test_meta_compare_seqnum(a,b) \
     gst_meta_compare_seqnum((GstMeta*)(a),(GstMeta*)(b))
 
@@ -824,6 +875,7 @@ gst_buffermeta_suite (void)
   tcase_add_test (tc_chain, test_meta_foreach_remove_head_and_tail_of_three);
   tcase_add_test (tc_chain, test_meta_foreach_remove_several);
   tcase_add_test (tc_chain, test_meta_iterate);
+  tcase_add_test (tc_chain, test_meta_get_first);
   tcase_add_test (tc_chain, test_meta_seqnum);
   tcase_add_test (tc_chain, test_meta_custom);
   tcase_add_test (tc_chain, test_meta_custom_transform);
@@ -1030,6 +1030,93 @@ GST_START_TEST (test_push_linked_flushing)
 
 GST_END_TEST;
 
+static GstPadProbeReturn
+_count_probe_handler (GstPad * pad, GstPadProbeInfo * info, gpointer userdata)
+{
+  gint *count = userdata;
+
+  (*count)++;
+
+  return GST_PAD_PROBE_OK;
+}
+
+GST_START_TEST (test_push_fast_path)
+{
+  GstPad *src, *sink;
+  gint count = 0, idle = 0;
+  gulong id;
+  gint i;
+
+  /* setup */
+  src = gst_pad_new ("src", GST_PAD_SRC);
+  fail_if (src == NULL);
+  sink = gst_pad_new ("sink", GST_PAD_SINK);
+  fail_if (sink == NULL);
+  gst_pad_set_chain_function (sink, gst_check_chain_func);
+
+  gst_pad_set_active (src, TRUE);
+  gst_pad_set_active (sink, TRUE);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  fail_unless (gst_pad_push_event (src, gst_event_new_stream_start ("test")));
+  fail_unless (gst_pad_push_event (src,
+          gst_event_new_segment (&dummy_segment)));
+
+  /* the first push takes the slow path and enables the fast path for the
+   * following ones */
+  for (i = 0; i < 10; i++)
+    fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 10);
+
+  /* probes added afterwards see all buffers */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_BUFFER,
+      _count_probe_handler, &count, NULL);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (count, 2);
+  gst_pad_remove_probe (src, id);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (count, 2);
+  fail_unless_equals_int (g_list_length (buffers), 14);
+
+  /* nothing is pushing, so idle probes are called right away */
+  id = gst_pad_add_probe (src, GST_PAD_PROBE_TYPE_IDLE,
+      _count_probe_handler, &idle, NULL);
+  fail_unless_equals_int (idle, 1);
+  gst_pad_remove_probe (src, id);
+
+  /* flushing is not skipped */
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_start ()));
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_FLUSHING);
+  fail_unless (gst_pad_push_event (src, gst_event_new_flush_stop (FALSE)));
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 16);
+
+  /* neither is unlinking */
+  gst_pad_unlink (src, sink);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_NOT_LINKED);
+  fail_unless (GST_PAD_LINK_SUCCESSFUL (gst_pad_link (src, sink)));
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_OK);
+  fail_unless_equals_int (g_list_length (buffers), 18);
+
+  /* nor deactivating */
+  gst_pad_set_active (src, FALSE);
+  fail_unless (gst_pad_push (src, gst_buffer_new ()) == GST_FLOW_FLUSHING);
+  fail_unless_equals_int (g_list_length (buffers), 18);
+
+  /* cleanup */
+  gst_check_drop_buffers ();
+  gst_pad_unlink (src, sink);
+  ASSERT_OBJECT_REFCOUNT (src, "src", 1);
+  ASSERT_OBJECT_REFCOUNT (sink, "sink", 1);
+  gst_object_unref (src);
+  gst_object_unref (sink);
+}
+
+GST_END_TEST;
+
 static GstBuffer *
 buffer_from_string (const gchar * str)
 {
@@ -3399,6 +3486,7 @@ gst_pad_suite (void)
   tcase_add_test (tc_chain, test_push_unlinked);
   tcase_add_test (tc_chain, test_push_linked);
   tcase_add_test (tc_chain, test_push_linked_flushing);
+  tcase_add_test (tc_chain, test_push_fast_path);
   tcase_add_test (tc_chain, test_push_buffer_list_compat);
   tcase_add_test (tc_chain, test_flowreturn);
   tcase_add_test (tc_chain, test_push_negotiation);
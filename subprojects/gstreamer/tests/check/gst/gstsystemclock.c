@@ -385,6 +385,118 @@ GST_START_TEST (test_stress_reschedule)
 GST_END_TEST;
 
 
+#define ASYNC_ORDER_ENTRIES 200
+
+typedef struct
+{
+  GMutex lock;
+  GCond cond;
+  GstClockTime fired[ASYNC_ORDER_ENTRIES];
+  guint n_fired;
+} AsyncOrderData;
+
+static gboolean
+async_order_cb (GstClock * clock, GstClockTime time, GstClockID id,
+    gpointer user_data)
+{
+  AsyncOrderData *data = user_data;
+
+  g_mutex_lock (&data->lock);
+  data->fired[data->n_fired++] = time;
+  g_cond_signal (&data->cond);
+  g_mutex_unlock (&data->lock);
+
+  return TRUE;
+}
+
+GST_START_TEST (test_async_order)
+{
+  GstClock *clock;
+  GstClockID ids[ASYNC_ORDER_ENTRIES];
+  AsyncOrderData data = { {0,}, };
+  GstClockTime base, tolerance;
+  guint i;
+
+  clock = g_object_new (GST_TYPE_SYSTEM_CLOCK, "name", "TestClock",
+      "coalesce-tolerance", GST_MSECOND, NULL);
+  gst_object_ref_sink (clock);
+  g_object_get (clock, "coalesce-tolerance", &tolerance, NULL);
+  fail_unless_equals_uint64 (tolerance, GST_MSECOND);
+
+  g_mutex_init (&data.lock);
+  g_cond_init (&data.cond);
+
+  /* schedule the entries in a scrambled order, some at the same time */
+  base = gst_clock_get_time (clock) + 50 * GST_MSECOND;
+  for (i = 0; i < ASYNC_ORDER_ENTRIES; i++) {
+    GstClockTime time = base + ((i * 7919) % 100) * (GST_MSECOND / 2);
+
+    ids[i] = gst_clock_new_single_shot_id (clock, time);
+    fail_unless (gst_clock_id_wait_async (ids[i], async_order_cb, &data,
+            NULL) == GST_CLOCK_OK);
+  }
+
+  /* one of them is unscheduled before it fires */
+  gst_clock_id_unschedule (ids[0]);
+
+  g_mutex_lock (&data.lock);
+  while (data.n_fired < ASYNC_ORDER_ENTRIES - 1)
+    g_cond_wait (&data.cond, &data.lock);
+  g_mutex_unlock (&data.lock);
+
+  for (i = 1; i < data.n_fired; i++)
+    fail_unless (data.fired[i - 1] <= data.fired[i]);
+
+  for (i = 0; i < ASYNC_ORDER_ENTRIES; i++)
+    gst_clock_id_unref (ids[i]);
+
+  g_mutex_clear (&data.lock);
+  g_cond_clear (&data.cond);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
+GST_START_TEST (test_async_pending_again)
+{
+  GstClock *clock;
+  GstClockID id;
+  AsyncOrderData first = { {0,}, }, second = { {0,}, };
+
+  clock = gst_system_clock_obtain ();
+
+  g_mutex_init (&second.lock);
+  g_cond_init (&second.cond);
+
+  id = gst_clock_new_single_shot_id (clock,
+      gst_clock_get_time (clock) + 50 * GST_MSECOND);
+  fail_unless (gst_clock_id_wait_async (id, async_order_cb, &first,
+          NULL) == GST_CLOCK_OK);
+  /* waiting again on the pending entry replaces the callback */
+  fail_unless (gst_clock_id_wait_async (id, async_order_cb, &second,
+          NULL) == GST_CLOCK_OK);
+
+  g_mutex_lock (&second.lock);
+  while (second.n_fired == 0)
+    g_cond_wait (&second.cond, &second.lock);
+  g_mutex_unlock (&second.lock);
+
+  /* give a second callback the time to show up */
+  g_usleep (G_USEC_PER_SEC / 20);
+
+  g_mutex_lock (&second.lock);
+  fail_unless_equals_int (second.n_fired, 1);
+  g_mutex_unlock (&second.lock);
+  fail_unless_equals_int (first.n_fired, 0);
+
+  gst_clock_id_unref (id);
+  g_mutex_clear (&second.lock);
+  g_cond_clear (&second.cond);
+  gst_object_unref (clock);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_systemclock_suite (void)
 {
@@ -396,6 +508,8 @@ gst_systemclock_suite (void)
   tcase_add_test (tc_chain, test_signedness);
   tcase_add_test (tc_chain, test_diff);
   tcase_add_test (tc_chain, test_async_full);
+  tcase_add_test (tc_chain, test_async_order);
+  tcase_add_test (tc_chain, test_async_pending_again);
   tcase_add_test (tc_chain, test_set_default);
   tcase_add_test (tc_chain, test_resolution);
   tcase_add_test (tc_chain, test_stress_cleanup_unschedule);
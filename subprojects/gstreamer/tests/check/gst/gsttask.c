@@ -464,6 +464,105 @@ GST_START_TEST (test_shared_task_pool_two_threads)
 
 GST_END_TEST;
 
+static gint coop_count;
+
+static void
+task_cooperative_func (void *data)
+{
+  GstTask **t = data;
+
+  g_mutex_lock (&task_lock);
+  coop_count++;
+  /* go to sleep after every third iteration */
+  if (coop_count % 3 == 0)
+    fail_unless (gst_task_sleep (*t));
+  g_cond_signal (&task_cond);
+  g_mutex_unlock (&task_lock);
+}
+
+GST_START_TEST (test_cooperative)
+{
+  GstTask *t;
+
+  t = gst_task_new (task_cooperative_func, &t, NULL);
+  fail_if (t == NULL);
+
+  g_rec_mutex_init (&task_mutex);
+  gst_task_set_lock (t, &task_mutex);
+
+  g_cond_init (&task_cond);
+  g_mutex_init (&task_lock);
+
+  gst_task_set_cooperative (t, TRUE);
+  fail_unless (gst_task_get_cooperative (t));
+
+  coop_count = 0;
+  g_mutex_lock (&task_lock);
+  fail_unless (gst_task_start (t));
+  while (coop_count < 3)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* the task is not run again until it is woken up */
+  g_usleep (G_USEC_PER_SEC / 10);
+  g_mutex_lock (&task_lock);
+  fail_unless_equals_int (coop_count, 3);
+
+  gst_task_wakeup (t);
+  while (coop_count < 6)
+    g_cond_wait (&task_cond, &task_lock);
+  g_mutex_unlock (&task_lock);
+
+  /* joining a sleeping task stops it */
+  fail_unless (gst_task_join (t));
+  fail_unless (gst_task_get_state (t) == GST_TASK_STOPPED);
+
+  gst_object_unref (t);
+}
+
+GST_END_TEST;
+
+static void
+work_stealing_cb (gint * count)
+{
+  g_atomic_int_inc (count);
+}
+
+GST_START_TEST (test_work_stealing_task_pool)
+{
+  GstTaskPool *pool;
+  GError *err = NULL;
+  gint count = 0;
+  gint i;
+
+  pool = gst_work_stealing_task_pool_new ();
+  gst_work_stealing_task_pool_set_n_threads (GST_WORK_STEALING_TASK_POOL
+      (pool), 2);
+  fail_unless_equals_int (gst_work_stealing_task_pool_get_n_threads
+      (GST_WORK_STEALING_TASK_POOL (pool)), 2);
+  gst_task_pool_prepare (pool, &err);
+  fail_unless (err == NULL);
+
+  for (i = 0; i < 100; i++) {
+    fail_unless (gst_task_pool_push (pool,
+            (GstTaskPoolFunction) work_stealing_cb, &count, &err) == NULL);
+    fail_unless (err == NULL);
+  }
+
+  /* cleanup runs all queued jobs before stopping the workers */
+  gst_task_pool_cleanup (pool);
+  fail_unless_equals_int (count, 100);
+
+  gst_task_pool_push (pool, (GstTaskPoolFunction) work_stealing_cb, &count,
+      &err);
+  fail_unless (err != NULL);
+  g_clear_error (&err);
+
+  gst_object_unref (pool);
+}
+
+GST_END_TEST;
+
 static Suite *
 gst_task_suite (void)
 {
@@ -480,6 +579,8 @@ gst_task_suite (void)
   tcase_add_test (tc_chain, test_resume);
   tcase_add_test (tc_chain, test_shared_task_pool_shared_thread);
   tcase_add_test (tc_chain, test_shared_task_pool_two_threads);
+  tcase_add_test (tc_chain, test_cooperative);
+  tcase_add_test (tc_chain, test_work_stealing_task_pool);
 
   return s;
 }